@@ -15,7 +15,7 @@
  *                      original display is corroded beyond repair.
  *
  *  Programmer:         Roy Schneider
- *  Last Change:        16.08.2025
+ *  Last Change:        18.10.2026
  *
  *  Language:           C
  *  Toolchain:          GCC/GNU-Make
@@ -110,10 +110,10 @@
     (APP_WATCH_TYPE_BUILD==APP_PULSAR_WRIST_WATCH_12H_SIF_LEGACY_MOD) || \
     (APP_WATCH_TYPE_BUILD==APP_PULSAR_P4_WRIST_WATCH_12H_SIF_MARK_II_MOD)
 
-const unsigned char g_24_to_12_hours[] = { /* AM */12, 1, 2, 3, 4, 5, 6, \
-                                                    7, 8, 9, 10, 11, \
-                                           /* PM */12, 1, 2, 3, 4, 5, 6, \
-                                                    7, 8, 9, 10, 11 };
+const unsigned char g_24_to_12_hours[] = { /* AM */VALUE_CONST(12), 1, 2, 3, 4, 5, 6, \
+                                                    7, 8, 9, VALUE_CONST(10), VALUE_CONST(11), \
+                                           /* PM */VALUE_CONST(12), 1, 2, 3, 4, 5, 6, \
+                                                    7, 8, 9, VALUE_CONST(10), VALUE_CONST(11) };
 
 /**
  * 24 hour to AM/PM dot system conversion for the original Litronix display.
@@ -183,6 +183,13 @@ const unsigned char g_weekday_7segment[16] =
     MAKE_7SEG(0,0,0,0,0,0,1),   // -
 };
 
+/**
+ * The conversion tables are only needed, if not using the BCD-native
+ * arithmetic.
+ */
+
+#if APP_BCD_NATIVE_ARITHMETIC==0
+
 /**
  * BCD to decimal decoding table.
  * 
@@ -299,6 +306,8 @@ const unsigned char g_div10[100] =
     9,9,9,9,9,9,9,9,9,9,    // 90..99
 };
 
+#endif // #if APP_BCD_NATIVE_ARITHMETIC==0
+
 /**
  * Table for animating the dot, when
  * the alarm buzzer has been turned on.
@@ -320,6 +329,169 @@ unsigned char g_dot_banner_index = 0;
 
 #endif // #if APP_ALARM_SPECIAL_DOT_ANIMATION==1
 
+/**
+ * Number of days of each month, February assumed to be a leap year.
+ * See Days_Of_Month() for common years.
+ */
+
+const unsigned char g_days_of_month[13] =
+{
+    VALUE_CONST(30), VALUE_CONST(31), VALUE_CONST(29), VALUE_CONST(31),
+    VALUE_CONST(30), VALUE_CONST(31), VALUE_CONST(30), VALUE_CONST(31),
+    VALUE_CONST(31), VALUE_CONST(30), VALUE_CONST(31), VALUE_CONST(30),
+    VALUE_CONST(31)
+};
+
+/**
+ * Flags of the editable fields, that depend on the watch model. On a 12h
+ * display, forwarding the day will first toggle between AM and PM. When
+ * setting the minutes on a Pulsar, keep the RTC disabled and the seconds
+ * zero, until the user pressed a readout button.
+ */
+
+#if (APP_WATCH_TYPE_BUILD==APP_PULSAR_WRIST_WATCH_12H_LEGACY_MOD) || \
+    (APP_WATCH_TYPE_BUILD==APP_PULSAR_P3_WRIST_WATCH_12H_ODIN_MARK_II_MOD) || \
+    (APP_WATCH_TYPE_BUILD==APP_PULSAR_WRIST_WATCH_12H_SIF_LEGACY_MOD) || \
+    (APP_WATCH_TYPE_BUILD==APP_PULSAR_P4_WRIST_WATCH_12H_SIF_MARK_II_MOD)
+
+  #define FIELD_FLAGS_DAY     (FIELD_FLAG_DAY_OF_MONTH | FIELD_FLAG_AM_PM)
+
+#else
+
+  #define FIELD_FLAGS_DAY     (FIELD_FLAG_DAY_OF_MONTH)
+
+#endif
+
+#if APP_WATCH_ANY_PULSAR_MODEL==APP_WATCH_PULSAR_MAGNET_SET
+
+  #define FIELD_FLAGS_MINUTES (FIELD_FLAG_HIGH_BYTE | \
+                               FIELD_FLAG_ZERO_SECONDS | \
+                               FIELD_FLAG_KEEP_STOPPED)
+
+#else
+
+  #define FIELD_FLAGS_MINUTES (FIELD_FLAG_HIGH_BYTE | \
+                               FIELD_FLAG_ZERO_SECONDS)
+
+#endif
+
+/**
+ * Descriptors of the editable fields, indexed by FIELD_INDEX_xxx. Except
+ * for the binary calibration, minimum and maximum are given using the
+ * value representation (see VALUE_CONST).
+ */
+
+const FieldType g_fields[] =
+{
+    { 0,                        1, 0,    VALUE_CONST(23), 1 }, // Hours
+    { FIELD_FLAGS_MINUTES,      0, 0,    VALUE_CONST(59), 1 }, // Minutes
+    { FIELD_FLAG_HIGH_BYTE | \
+      FIELD_FLAG_CLAMP_DAY,     2, 1,    VALUE_CONST(12), 1 }, // Month
+    { FIELD_FLAGS_DAY,          2, 1,    VALUE_CONST(31), 1 }, // Day of month
+    { FIELD_FLAG_CLAMP_DAY,     3, 0,    VALUE_CONST(99), 1 }, // Year
+    { FIELD_FLAG_HIGH_BYTE,     1, 0,    6,               1 }, // Weekday
+    { FIELD_FLAG_CALIBRA,       0, 0x82, 0x7E,            2 }, // Calibration -126..126
+    { FIELD_FLAG_ALARM,         1, 0,    VALUE_CONST(23), 1 }, // Alarm hours
+    { FIELD_FLAG_ALARM | \
+      FIELD_FLAG_HIGH_BYTE | \
+      FIELD_FLAG_ZERO_SECONDS,  0, 0,    VALUE_CONST(59), 1 }, // Alarm minutes
+};
+
+/**
+ * Global RAM snapshot of the RTCC value and alarm registers. */
+
+RtccSnapshotType g_rtcc;
+
+/**
+ * Global RTCC values edited by a set mode, but not yet written. The bits
+ * of g_uRtccStaged mark the valid bytes, g_uRtccStageState holds the
+ * display state the edits have been made in. */
+
+RtccSnapshotType g_rtccStage;
+unsigned short g_uRtccStaged;
+DisplayStateType g_uRtccStageState;
+
+/**
+ * Global snapshot taken at the last edit of a time field and the RTCC as
+ * read at that time. The time passed since then is added to the edits,
+ * see Merge_RTCC_Stage(). */
+
+RtccSnapshotType g_rtccOrigin;
+RtccSnapshotType g_rtccOriginRead;
+
+/**
+ * Global snapshot as last read from the RTCC, without the edits merged. */
+
+RtccSnapshotType g_rtccRead;
+
+/**
+ * Global calibration steps currently added by the temperature compensation,
+ * the last temperature measured relative to the turnover temperature, the
+ * ppb left below one calibration step, carried into the next hour, and the
+ * timer 3 count at the turnover temperature of this very board, referenced
+ * when the calibration had been set. */
+
+#if APP_TEMPERATURE_COMPENSATION==1
+
+signed char g_cTempCompensation;
+signed char g_cTemperature;
+unsigned short g_uTempResidual;
+unsigned short g_uTempTurnoverCount = TEMP_TURNOVER_COUNT;
+
+#endif // #if APP_TEMPERATURE_COMPENSATION==1
+
+/**
+ * Global history of the drift learning and the days before each month
+ * of a common year. */
+
+#if APP_DRIFT_LEARNING_USAGE==1
+
+DriftHistoryType g_drift;
+
+const unsigned short g_days_before_month[13] =
+{
+    0, 0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334
+};
+
+#endif // #if APP_DRIFT_LEARNING_USAGE==1
+
+/**
+ * Global count of the overflows of timer 1, extending its count of the
+ * crystal ticks while awake, caught up after sleeping with the stopwatch
+ * running. */
+
+#if APP_TIMER_1_USAGE==1
+
+unsigned short g_uTimer1Overflows = 0;
+
+#endif // #if APP_TIMER_1_USAGE==1
+
+/**
+ * Global state of the stopwatch in timer 1 ticks. The start is moved by
+ * the time counted before, once started again. The edges of the TIME and
+ * DATE buttons are stamped, the split shown is zero for the time counted. */
+
+#if APP_STOPWATCH_USAGE==1
+
+unsigned char g_ucStopwatchRunning = 0;
+unsigned long g_ulStopwatchStart = 0;
+unsigned long g_ulStopwatchCounted = 0;
+unsigned long g_ulStopwatchSplits[STOPWATCH_SPLITS];
+unsigned char g_ucStopwatchSplitCnt = 0;
+unsigned char g_ucStopwatchView = 0;
+unsigned long g_ulStopwatchEdge[2];
+
+/**
+ * Global anchor of timer 1 to the RTC, taken before going to sleep while
+ * the stopwatch and the RTC are running: the ticks of timer 1 and the half
+ * seconds of the week counted by the RTC. */
+
+unsigned char g_ucStopwatchAnchored = 0;
+unsigned long g_ulStopwatchAnchorTicks;
+unsigned long g_ulStopwatchAnchorHalves;
+
+#endif // #if APP_STOPWATCH_USAGE==1
+
 /**
  * Global indication for the watch to stay awake. */
 
@@ -332,6 +504,17 @@ unsigned short g_ucRollOver;
 unsigned short g_ucOverallTimeoutLow;
 unsigned short g_ucOverallTimeoutHigh;
 
+/**
+ * Global counter for the display rounds spent in 'watch stalled' mode. */
+
+unsigned short g_uStalledRounds;
+
+/**
+ * Global flag for going to sleep in 'watch stalled' mode, with the RTC
+ * kept stopped until the TIME button is pressed. */
+
+unsigned char g_ucStalledSleep;
+
 /**
  * Global button state variables. */
 
@@ -350,17 +533,96 @@ short g_sPB1Timer = 0;
 short g_sPB2Timer = 0;
 short g_sPB3Timer = 0;
 
+/**
+ * Global chord of the buttons held together, when the last button handler
+ * had been called, and the latency in timer 0 ticks from the last button
+ * edge to the press handler taking the decision. */
+
+unsigned char g_ucChord = 0;
+short g_sChordLatency = 0;
+short g_sChordLatencyMax = 0;
+
+/**
+ * Start of the RTC in the 'watch stalled' mode. The RTC is started on the
+ * first edge of the TIME button, the flag is kept until the press has been
+ * confirmed or rejected. */
+
+unsigned char g_ucSyncEdgeStart = 0;
+
+/**
+ * Input statistics, kept in RAM across sleep, to find noisy contacts:
+ * rejected bounces per input, wakes without a confirmed press and the
+ * press durations (tap, short press, long press). All counters stop at
+ * 99, the maximum value to display. */
+
+#if APP_INPUT_STATISTICS_USAGE==1
+
+unsigned char g_ucStatBounces[5] = {0, 0, 0, 0, 0};
+unsigned char g_ucStatSpuriousWakes = 0;
+unsigned char g_ucStatPresses[3] = {0, 0, 0};
+unsigned char g_ucStatWakePending = 0;
+unsigned char g_ucStatPage = 0;
+
+/**
+ * Count an input statistic event. */
+
+inline void Count_Statistic(unsigned char *pcnt)
+{
+    if (*pcnt < 99)
+    {
+        (*pcnt)++;
+    }
+}
+
+#endif // #if APP_INPUT_STATISTICS_USAGE==1
+
 /**
  Wrist Flick support. */
 
 #if APP_WRIST_FLICK_USAGE==1
 
-ButtonStateType g_ucPB4FLICKState = PB_STATE_IDLE; // WRIST FLICK
-
 short g_sPB4Timer = 0;
-short g_FlickTimeSpan = 0;
 unsigned char g_WristFlick = 0;
 
+/**
+ * Classifier of the wrist flick, the ROM parameters, the edges seen since
+ * the first rising edge and their timer 0 ticks relative to it, the input
+ * level last seen, and the flicks accepted and rejected since reset with
+ * the reason of the last rejection. */
+
+const FlickParamsType g_flick_params =
+{
+    6,              // max_edges
+    2,              // max_pulses
+    0x0100,         // bounce_gap, 16ms
+    T0_DEBOUNCE,    // min_high, 65ms
+    0x2C00,         // max_span, 721ms
+    0x0800,         // settle, 131ms
+    0x3000          // window, 786ms
+};
+
+unsigned char g_ucFlickEdges = 0;
+short g_sFlickEdges[FLICK_EDGES_MAX];
+unsigned char g_ucFlickLevel = 0;
+unsigned short g_uFlickAccepted = 0;
+unsigned short g_uFlickRejected = 0;
+unsigned char g_ucFlickLastReject = FLICK_ACCEPT;
+
+/**
+ * Strictness of the wrist flick adapted to the wearer, kept in the deep
+ * sleep registers DSGPR0 and DSGPR1 across resets, and the limits derived
+ * from it. The outcomes of the flicks lighting the display since reset,
+ * and the ones of the current round. */
+
+unsigned char g_ucFlickStrict = FLICK_STRICT_DEFAULT;
+short g_sFlickMaxHigh = T0_WRIST_FLICK;
+unsigned char g_ucFlickMinPulses = 1;
+unsigned short g_uFlickEngaged = 0;
+unsigned short g_uFlickCancelled = 0;
+unsigned short g_uFlickUnused = 0;
+unsigned char g_ucFlickRound = 0;
+unsigned char g_ucFlickRoundUnused = 0;
+
 #endif // #if APP_WRIST_FLICK_USAGE==1
 
 /**
@@ -382,16 +644,115 @@ unsigned char g_ucTimer2Usage = 0;
 unsigned char g_ucMplexDigits = 0;
 
 /**
- * Brightness variable for the digits, reflecting
- * the readout from the AN11 analogue input. */
+ * Brightness variable for the digits, reflecting the readout from the
+ * AN11 analogue input or the night dimming schedule. */
 
-#if APP_LIGHT_SENSOR_USAGE==1
+#if APP_DISPLAY_DIMMING_USAGE==1
 
 unsigned char  g_ucDimmingCnt = 0;
 unsigned char  g_ucDimmingRef = 0;
 unsigned char  g_ucDimming = 0;
+
+#endif // #if APP_DISPLAY_DIMMING_USAGE==1
+
+#if APP_NIGHT_DIMMING_USAGE==1
+
+/**
+ * Hours of the night dimming schedule in BCD, the night is dimmed from
+ * the start hour up to the end hour. Equal hours turn the dimming off. */
+
+unsigned char  g_ucNightStart = NIGHT_START_HOURS;
+unsigned char  g_ucNightEnd = NIGHT_END_HOURS;
+
+/**
+ * Report of the night dimming, the multiplexing ticks kept dark and the
+ * readouts done at night since reset, whether the current readout is one
+ * of them, and the dark ticks per night readout updated when going to
+ * sleep. Each dark tick saves the charge of one digit being lit. */
+
+unsigned long  g_ulNightDarkTicks = 0;
+unsigned short g_uNightReadouts = 0;
+unsigned char  g_ucNightReadout = 0;
+unsigned short g_uNightSavedPerReadout = 0;
+
+#endif // #if APP_NIGHT_DIMMING_USAGE==1
+
+#if APP_LIGHT_SENSOR_USAGE==1
+
 unsigned char  g_ucLightSensor = 0;
 
+/**
+ * State of the light measurement spread across the multiplexing ticks,
+ * the raw ADC readout and the time blocking the multiplexing in timer 3
+ * ticks of 8us, of the last measurement and the longest tick. */
+
+unsigned char  g_ucLightState = LIGHT_STATE_IDLE;
+unsigned short g_uLightRaw = 0;
+unsigned short g_uLightBlock = 0;
+unsigned short g_uLightBlockMax = 0;
+
+/**
+ * Decision latency of the last light measurement in multiplexing ticks,
+ * from powering the sensor up to having the readout. */
+
+unsigned char  g_ucLightLatency = 0;
+
+/**
+ * Ambient light estimator, the moving average of the readouts with
+ * LIGHT_EMA_FRACTION fractional bits, the level taken from it and the
+ * number of level changes since reset. */
+
+unsigned short g_uLightAverage = 0;
+unsigned char  g_ucLightLevel = LIGHT_LEVEL_NONE;
+unsigned short g_uLightLevelChanges = 0;
+
+/**
+ * Adaptive interval between two light measurements, the readout it was
+ * last adapted to, and the counters since reset for the report: frames
+ * shown, measurements taken and timer 2 rounds with the display on. The
+ * measurements saved per 1000 display-on seconds are updated when going
+ * to sleep. */
+
+unsigned char  g_ucLightInterval = LIGHT_INTERVAL_MIN;
+unsigned short g_uLightPrevRaw = 0;
+unsigned long  g_ulLightFrames = 0;
+unsigned long  g_ulLightSamples = 0;
+unsigned long  g_ulLightRounds = 0;
+unsigned short g_uLightSavedPerKs = 0;
+
+/**
+ * Thresholds between two light levels in ADC counts divided by 4, and the
+ * dimming used for each level, darkest level first. */
+
+#if APP_LIGHT_SENSOR_THRESHOLD==1
+
+/* The threshold mode only tells dark from bright, the single threshold
+ * sits halfway, so the average has to move for two readouts. */
+
+const unsigned char g_light_thresholds[LIGHT_LEVELS - 1] = { 128 };
+
+ #if APP_WATCH_TYPE_BUILD==APP_PROTOTYPE_BREAD_BOARD
+
+const unsigned char g_light_dimming[LIGHT_LEVELS] = { 12, 0 };
+
+ #else
+
+const unsigned char g_light_dimming[LIGHT_LEVELS] = { 1, 0 };
+
+ #endif
+
+#elif APP_WATCH_TYPE_BUILD==APP_PROTOTYPE_BREAD_BOARD
+
+const unsigned char g_light_thresholds[LIGHT_LEVELS - 1] = { 64, 128, 250 };
+const unsigned char g_light_dimming[LIGHT_LEVELS] = { 12, 8, 4, 0 };
+
+#else
+
+const unsigned char g_light_thresholds[LIGHT_LEVELS - 1] = { 16 };
+const unsigned char g_light_dimming[LIGHT_LEVELS] = { 1, 0 };
+
+#endif
+
 #endif // #if APP_LIGHT_SENSOR_USAGE==1
 
 /**
@@ -404,10 +765,13 @@ unsigned char g_ucRightVal = 255;
 #if APP_BUZZER_ALARM_USAGE
 
 /**
- * Alarm piezo base period value. */
+ * Alarm piezo period value at its resonance, kept in the deep sleep
+ * registers DSGPR0 and DSGPR1 across resets, but not across a power-on
+ * reset. The service mode sweeping the period, and the period tried. */
 
-const unsigned char g_ualarm_period = 20 + 64;
-const unsigned char g_ualarm_duty_cycle = 10 + 32;
+unsigned char g_ucPiezoPeriod = PIEZO_PERIOD_DEFAULT;
+volatile unsigned char g_ucPiezoSweep = PIEZO_SWEEP_OFF;
+unsigned char g_ucPiezoCandidate = PIEZO_PERIOD_DEFAULT;
 
 #endif // #if APP_BUZZER_ALARM_USAGE
 
@@ -448,14 +812,82 @@ DisplayStateType g_uDispState;
 DisplayStateType g_uDispStateBackup;
 
 /**
- * Alarm counter, cancelled by expiring or pressing a button. */
+ * Alarm counter in seconds, cancelled by expiring or pressing a button,
+ * counted down by the interrupt routine. */
 
 #if APP_BUZZER_ALARM_USAGE==1
 
-unsigned short g_ucAlarm;
+volatile unsigned char g_ucAlarm;
+
+/**
+ * Alarm melody, four beeps at the resonance of the piezo and a pause. */
+
+const MelodyStepType g_alarm_melody[] =
+{
+    { 0, MELODY_DUTY_HALF, 100 }, { 0, 0, 60 },
+    { 0, MELODY_DUTY_HALF, 100 }, { 0, 0, 60 },
+    { 0, MELODY_DUTY_HALF, 100 }, { 0, 0, 60 },
+    { 0, MELODY_DUTY_HALF, 100 }, { 0, 0, 400 },
+    { 0, 0, 0 }
+};
+
+/**
+ * Chime melody, a single short beep played once. */
+
+#if APP_ALARM_SCHEDULE_USAGE==1
+
+const MelodyStepType g_chime_melody[] =
+{
+    { 0, MELODY_DUTY_HALF, ALARM_CHIME_MS },
+    { 0, MELODY_DUTY_STOP, 0 }
+};
+
+#endif
+
+/**
+ * State of the melody sequencer, the melody and the step playing, the
+ * timer 3 ticks left of the step and of the current second of the alarm,
+ * and the timer 3 value at the last call. An overrun is carried into the
+ * next step, so the melody keeps its timing however late the main loop
+ * comes by. */
+
+const MelodyStepType *g_pMelody = g_alarm_melody;
+unsigned char  g_ucMelodyStep = 0;
+signed long    g_slMelodyLeft = 0;
+signed long    g_slAlarmSecondLeft = 0;
+unsigned short g_uMelodyLast = 0;
 
 #endif
 
+/**
+ * Alarm schedule kept in RAM and the mask of the entries, which are due
+ * at the time programmed into the RTCC alarm. */
+
+#if APP_ALARM_SCHEDULE_USAGE==1
+
+AlarmEntryType g_alarms[ALARM_SCHEDULE_SIZE] =
+{
+    { 0x00, 0x00, 0x00, ALARM_WEEKDAYS_ALL, 0 },
+    { 0x00, 0x00, 0x00, 0, ALARM_FLAG_ONE_SHOT },
+    { 0x00, 0x00, 0x00, ALARM_WEEKDAYS_ALL, ALARM_FLAG_HOURLY | ALARM_FLAG_CHIME },
+    { 0x00, 0x00, 0x00, 0, 0 }
+};
+
+unsigned char g_ucAlarmsDue = 0;
+
+/**
+ * Number of chimes sounded while being asleep. */
+
+unsigned short g_uChimeCount = 0;
+
+/**
+ * Time the countdown is preset to as BCD, hours and minutes. */
+
+unsigned char g_ucCountdownHours = 0x00;
+unsigned char g_ucCountdownMinutes = 0x05;
+
+#endif // #if APP_ALARM_SCHEDULE_USAGE==1
+
 /**
  * Set the overall timeout to prevent the battery from draining
  * if a button is pressed and left unattended for too long. */
@@ -513,6 +945,13 @@ inline void Handle_Overall_Timeout(void)
                      * is to blank the display, when a button is
                      * pressed unattended long. */
 
+                    if (g_uDispState == DISP_STATE_SECONDS_STALLED)
+                    {
+                        /* Keep the RTC stopped, see the sleep. */
+
+                        g_ucStalledSleep = 1;
+                    }
+
                     g_uDispState = DISP_STATE_BLANK;
                 }
             }
@@ -550,2948 +989,3971 @@ inline void Lock_RTCC(void)
     RTCCFGbits.RTCWREN = 0; // RTCC Value Registers Write Enable bit
 }
 
+#if APP_BCD_NATIVE_ARITHMETIC==1
+
 /**
- * Initialize the ports of the general purpose inputs and outputs. */
+ * Convert a BCD value to decimal, using the hardware multiplier. */
 
-inline void Init_Inputs_Outputs_Ports(void)
+unsigned char Bcd_To_Decimal(unsigned char ubcd)
 {
-    /* Initialize LATA/B/C to clear output data latches. */
-
-    LATA = 0;
-    LATB = 0;
-    LATC = 0;
+    return (unsigned char)(VALUE_TENS(ubcd) * 10) + VALUE_ONES(ubcd);
+}
 
-    /* Free AN5 from being tight to the Voltage monitoring. */
+/**
+ * Convert a decimal value 0..99 to BCD by subtracting the tens. */
 
-    HLVDCON = 8;
+unsigned char Decimal_To_Bcd(unsigned char udec)
+{
+    unsigned char ucTens = 0;
 
-    /* Turn off SSDMA (SPI DMA Module) */
+    while (udec >= 10)
+    {
+        udec -= 10;
+        ucTens += 0x10;
+    }
 
-    DMACON1 = 0;
+    return ucTens | udec;
 }
 
 /**
- * Setting up the general purpose inputs and outputs
- * as well as the ananlogue input for the light sensor
- * or the PWM output for the alarm feature, if used. */
+ * Check a BCD value to have valid tetrades and to be within the range
+ * given as BCD. Returns 1 if being valid. */
 
-inline void Configure_Inputs_Outputs(void)
+unsigned char Bcd_Is_Valid(unsigned char ubcd, unsigned char umin,
+                           unsigned char umax)
 {
-    /* Disable the unused Charge Time Measurement Unit (CTMU)
-     * used for touch screens and capacitive sensors. */
+    return (VALUE_ONES(ubcd) <= 9) && (ubcd >= umin) && (ubcd <= umax);
+}
 
-    CTMUCONH = 0x00; // Make sure CTMU is disabled.
-    CTMUCONL = 0x90; // Edge 1/2 programmed for a positive edge response
-    CTMUICON = 0x01; // 0.55uA, Nominal - No Adjustment
+/**
+ * Forward (cdir = 1) or backward (cdir = -1) a BCD value by one and turn
+ * around on minimum and maximum, both given as BCD. The carry into the
+ * tens is adjusted like the DAW instruction does. */
 
-  #if APP_WATCH_ANY_PULSAR_MODEL==APP_WATCH_PULSAR_AUTO_SET
+unsigned char Bcd_Step(unsigned char ubcd, signed char cdir,
+                       unsigned char umin, unsigned char umax)
+{
+    if (!Bcd_Is_Valid(ubcd, umin, umax))
+    {
+        return umin;
+    }
 
-    /* Set RA1/5 to input, RA0/2/3/4/6/7 as output. */
+    if (cdir > 0)
+    {
+        if (ubcd >= umax)
+        {
+            return umin;
+        }
 
-    TRISA = 0x22;
+        ubcd++;
 
-    /* Set RB1/4/6 to input, keep RB0/2/3/5/7 as output. */
+        if (VALUE_ONES(ubcd) > 9)
+        {
+            ubcd += 6;
+        }
+    }
+    else if (cdir < 0)
+    {
+        if (ubcd <= umin)
+        {
+            return umax;
+        }
 
-    TRISB = 0x52;
-    
-  #else
+        if (!VALUE_ONES(ubcd))
+        {
+            ubcd -= 6;
+        }
 
-    /* Set RA0/1/2/5 to input, RA3/4/6/7 as output. */
+        ubcd--;
+    }
 
-    TRISA = 0x27;
+    return ubcd;
+}
 
-    /* Set RB0/1/4/6 to input, keep RB2/3/5/7 as output. */
+#else
 
-    TRISB = 0x53;
-    
-  #endif
+/**
+ * Forward (cdir = 1) or backward (cdir = -1) a BCD value by one and turn
+ * around on minimum and maximum, both given as decimal. */
 
-  #if (APP_BUZZER_ALARM_USAGE==1)
+unsigned char Bcd_Step(unsigned char ubcd, signed char cdir,
+                       unsigned char umin, unsigned char umax)
+{
+    signed short sValue = g_bcd_decimal[ubcd];
 
-    /* Set RC0/1/2/4/5..7 to output and RC3 as input. */
+    sValue += cdir;
 
-    TRISC = 0x08;
+    if (sValue > umax)
+    {
+        sValue = umin;
+    }
+    else if (sValue < umin)
+    {
+        sValue = umax;
+    }
 
-  #else
+    return g_decimal_bcd[sValue];
+}
 
-    /* Set RC0/1/4/5..7 to output and RC3 and RC2(AN11) as input. */
+#endif // #if APP_BCD_NATIVE_ARITHMETIC==1
 
-    TRISC = 0x0C;
+/**
+ * Copy the staged bytes marked by ustaged into the RTCC snapshot. */
 
-  #endif
-
-    /* Set unused port pins to drive low. */
-
-  #if APP_WATCH_ANY_PULSAR_MODEL==APP_WATCH_PULSAR_AUTO_SET
+void Apply_RTCC_Stage(unsigned short ustaged)
+{
+    unsigned char i;
 
-    PORTAbits.RA0 = 0;
-    PORTBbits.RB0 = 0;
-    
-  #endif
+    if (!ustaged)
+    {
+        return;
+    }
 
-    PORTAbits.RA3 = 0;
-    PORTAbits.RA7 = 0;
+    for (i = 0; i < sizeof(RtccSnapshotType); i++)
+    {
+        if (ustaged & (1 << i))
+        {
+            ((unsigned char *)&g_rtcc)[i] = ((unsigned char *)&g_rtccStage)[i];
+        }
+    }
+}
 
-  #if APP_LIGHT_SENSOR_USAGE==1
+/**
+ * Merge the edits marked by ustaged into the RTCC snapshot just read. The
+ * time fields are taken from the origin, so they do not follow the clock
+ * running meanwhile, and the time passed since the origin is added to them
+ * again. Editing the seconds sets the time as a whole.
+ */
 
-    /* ANCON0 - A/D PORT CONFIGURATION REGISTER
-     * Analog Port Configuration bits (AN<7:0>)
-     * 1 = Pin configured as a digital port
-     * 0 = Pin configured as an analog channel - digital input disabled
-     * and reads zero */
+void Merge_RTCC_Stage(unsigned short ustaged)
+{
+    unsigned char *plive = (unsigned char *)&g_rtcc;
+    const unsigned char *porigin = (const unsigned char *)&g_rtccOrigin;
+    signed char chours = 0;
+    signed char cminutes = 0;
+    signed char cseconds = 0;
+    unsigned char i;
 
-    ANCON0 = 0xFF;          // AN0...7
+    g_rtccRead = g_rtcc;
 
-    /* ANCON1 - A/D PORT CONFIGURATION REGISTER
-     * Analog Port Configuration bits (AN<7:0>)
-     * 1 = Pin configured as a digital port
-     * 0 = Pin configured as an analog channel - digital input disabled
-     * and reads zero */
+    if (ustaged & RTCC_STAGED_TIME)
+    {
+        /* Time passed since the origin, less than a day. */
 
-    ANCON1 = 0x17;          // AN8..12 Activate AN11 as being an analogue input.
+        chours = (signed char)BCD_TO_DECIMAL(g_rtcc.hours) -
+                 BCD_TO_DECIMAL(g_rtccOriginRead.hours);
 
-    // ADCON1
-    ADCON1bits.ADFM = 1;    // Result format 1= Right justified
-    ADCON1bits.ADCAL = 0;   // Normal A/D conversion operation
-    ADCON1bits.ACQT = 1;    // Acquisition time 7 = 20TAD 2 = 4TAD 1=2TAD
-    ADCON1bits.ADCS = 2;    // Clock conversion bits 6= FOSC/64 2=FOSC/32
-    
-    // ANCON1
-    ANCON1bits.VBGEN = 1;   // Turn on the Bandgap
+        if (g_rtcc.day != g_rtccOriginRead.day)
+        {
+            chours += 24;
+        }
 
-    // ADCON0
-    ADCON0bits.VCFG0 = 0;   // Vref+ = AVdd 3V battery
-    ADCON0bits.VCFG1 = 0;   // Vref- = AVss 0V battery
-    ADCON0bits.CHS = 11;    // Select ADC channel -> AN11
-    ADCON0bits.ADON = 1;    // Turn on ADC
+        cminutes = (signed char)BCD_TO_DECIMAL(g_rtcc.minutes) -
+                   BCD_TO_DECIMAL(g_rtccOriginRead.minutes);
 
-  #else // Light sensor not used. Anyway free the analogue inputs for digital use.
+        cseconds = (signed char)BCD_TO_DECIMAL(g_rtcc.seconds) -
+                   BCD_TO_DECIMAL(g_rtccOriginRead.seconds);
 
-    /* ANCON0 - A/D PORT CONFIGURATION REGISTER
-     * Analog Port Configuration bits (AN<7:0>)
-     * 1 = Pin configured as a digital port
-     * 0 = Pin configured as an analog channel - digital input disabled
-     * and reads zero */
+        for (i = 0; i < RTCC_SNAPSHOT_ALARM; i++)
+        {
+            plive[i] = porigin[i];
+        }
+    }
 
-    ANCON0 = 0xFF;          // AN0...7
+    Apply_RTCC_Stage(ustaged);
 
-    /* ANCON1 - A/D PORT CONFIGURATION REGISTER
-     * Analog Port Configuration bits (AN<7:0>)
-     * 1 = Pin configured as a digital port
-     * 0 = Pin configured as an analog channel - digital input disabled
-     * and reads zero */
+    if ((ustaged & RTCC_STAGED_TIME) && !(ustaged & 1))
+    {
+        cseconds += BCD_TO_DECIMAL(g_rtcc.seconds);
 
-    ANCON1 = 0x1F;          // AN8..12
+        if (cseconds < 0)
+        {
+            cseconds += 60;
+            cminutes--;
+        }
+        else if (cseconds >= 60)
+        {
+            cseconds -= 60;
+            cminutes++;
+        }
 
-    /* ADCON0 */
+        g_rtcc.seconds = DECIMAL_TO_BCD((unsigned char)cseconds);
 
-    ADCON0bits.ADON = 0;    // Turn off ADC
+        Forward_RTCC_Snapshot(chours, cminutes);
+    }
+}
 
-  #endif
+/**
+ * Read all RTCC value registers and the used alarm registers into the
+ * RAM snapshot in one pass, using the auto-decrement of the pointers.
+ * The seconds are read before and after the pass. If they differ, a
+ * rollover happened while reading and the pass is repeated.
+ */
 
-  #if APP_WATCH_ANY_PULSAR_MODEL==APP_WATCH_PULSAR_AUTO_SET
+void Read_RTCC_Snapshot(void)
+{
+    unsigned char ucSeconds;
 
-    /* Set RA1/5 to input, RA0/2/3/4/6/7 as output. */
+    do
+    {
+        RTCCFG &= ~3;
 
-    TRISA = 0x22;
-    
-  #else
+        ucSeconds = RTCVALL;
 
-    /* Set RA0/1/2/5 to input, RA3/4/6/7 as output. */
+        /* Start at the highest address. Reading the high byte will
+         * automatically decrement the address pointer. */
 
-    TRISA = 0x27;
-    
-  #endif
+        RTCCFG |= 3;
 
-    /* Configure the output as PWM output channel A.
-     * This can be used for the alarm buzzer of LOKI/HEL modules or
-     * the high voltage upstepper for a Nixi table clock. */
+        g_rtcc.year = RTCVALL;
+        g_rtcc.reserved = RTCVALH;
+        g_rtcc.day = RTCVALL;
+        g_rtcc.month = RTCVALH;
+        g_rtcc.hours = RTCVALL;
+        g_rtcc.weekday = RTCVALH;
+        g_rtcc.seconds = RTCVALL;
+        g_rtcc.minutes = RTCVALH;
+    }
+    while ((ucSeconds != g_rtcc.seconds) || (RTCVALL != ucSeconds));
 
-  #if (APP_BUZZER_ALARM_USAGE==1)
+    /* The alarm registers do not roll over. */
 
-    /* Write Magic */
+    ALRMCFG = (ALRMCFG & ~3) | 1;
 
-    EECON2 = 0x55;
-    EECON2 = 0xAA;
+    g_rtcc.alarm_hours = ALRMVALL;
+    g_rtcc.alarm_weekday = ALRMVALH;
+    g_rtcc.alarm_seconds = ALRMVALL;
+    g_rtcc.alarm_minutes = ALRMVALH;
 
-    /* Set write enable bit for the I/O mapping. */
+  #if APP_ALARM_SCHEDULE_USAGE==1
 
-    IOLOCK = 0;
+    /* The RTCC alarm holds the entry due next, show the daily alarm. */
 
-    /* Map RP13 to CCP1/P1A - PWM Channel A */
+    g_rtcc.alarm_hours = g_alarms[ALARM_ENTRY_DAILY].hours;
+    g_rtcc.alarm_minutes = g_alarms[ALARM_ENTRY_DAILY].minutes;
 
-    RPOR13 = 14;
+  #endif
 
-    /* Clear write enable bit for the I/O mapping. */
+    g_rtcc.calibration = RTCCAL;
 
-    IOLOCK = 1;
+    /* Apply the edits staged by a set mode. */
 
-  #endif
+    Merge_RTCC_Stage(g_uRtccStaged);
 }
 
 /**
- * Initialize the button states. */
+ * Stage a new value of a snapshot byte, it will be written to the RTCC
+ * by Commit_RTCC_Stage(). Editing a time field makes the snapshot the new
+ * origin, including the carries merged into the fields staged before. */
 
-inline void Init_Button_States(void)
+inline void Stage_RTCC_Value(unsigned char uoffset, unsigned char uvalue)
 {
-    g_ucPB0TIMEState = PB_STATE_IDLE; // TIME
-    g_ucPB1DATEState = PB_STATE_IDLE; // DATE
-    g_ucPB2HOURState = PB_STATE_IDLE; // HOUR
-    g_ucPB3MINTState = PB_STATE_IDLE; // MIN
-
-    g_sPB0Timer = 0;
-    g_sPB1Timer = 0;
-    g_sPB2Timer = 0;
-    g_sPB3Timer = 0;
-    
-  #if APP_WRIST_FLICK_USAGE==1
+    if (uoffset < RTCC_SNAPSHOT_ALARM)
+    {
+        g_rtccOrigin = g_rtcc;
+        g_rtccOriginRead = g_rtccRead;
+        g_rtccStage = g_rtcc;
+    }
 
-    g_ucPB4FLICKState = PB_STATE_IDLE; // WRIST FLICK
-    g_sPB4Timer = 0;
+    ((unsigned char *)&g_rtccStage)[uoffset] = uvalue;
+    ((unsigned char *)&g_rtcc)[uoffset] = uvalue;
 
-  #endif // #if APP_WRIST_FLICK_USAGE==1
+    g_uRtccStaged |= (1 << uoffset);
 }
 
+#if APP_DRIFT_LEARNING_USAGE==1
+
 /**
- * Setting up the onboard RTC. */
+ * Get the number of days since 1.1.2000 of the date in the snapshot. */
 
-inline void Configure_Real_Time_Clock(void)
+unsigned short Day_Number(void)
 {
-    unsigned char ucRTCInval;
-    unsigned char ucTemp;
-    unsigned char ucValue;
+    const unsigned char ucYear = BCD_TO_DECIMAL(g_rtcc.year);
+    unsigned char ucMonth = BCD_TO_DECIMAL(g_rtcc.month);
 
-    while(RTCCFGbits.RTCSYNC);
-
-    /* Unlock write operations to the RTC. */
-
-    Unlock_RTCC();
+    unsigned short uDays;
 
-    /* Set write enable bit. */
+    if ((ucMonth < 1) || (ucMonth > 12))
+    {
+        ucMonth = 1;
+    }
 
-    RTCCFGbits.RTCWREN = 1; // RTCC Value Registers Write Enable bit
+    uDays = (unsigned short)ucYear * 365 + ((ucYear + 3) >> 2) +
+            g_days_before_month[ucMonth] + BCD_TO_DECIMAL(g_rtcc.day);
 
-    /* Disable the RTCC */
+    /* Leap day of the current year. */
 
-    RTCCFGbits.RTCEN = 0;   // RTCC module is disabled
+    if ((ucMonth > 2) && !(ucYear & 3))
+    {
+        uDays++;
+    }
 
-    /* Poll RTCSYNC until it has cleared.
-     *
-     * The RTCSYNC bit indicates a time window during
-     * which the RTCC Clock Domain registers can be safely
-     * read and written without concern about a rollover.
-     * When RTCSYNC = 0, the registers can be safely accessed. */
+    return uDays;
+}
 
-    while(RTCCFGbits.RTCSYNC);
+/**
+ * Get the second of the day of the time in the snapshot. */
 
-    /* Check if the RTC has invalid values. */
+unsigned long Second_Of_Day(void)
+{
+    return (unsigned long)BCD_TO_DECIMAL(g_rtcc.hours) * 3600 +
+           (unsigned short)BCD_TO_DECIMAL(g_rtcc.minutes) * 60 +
+           BCD_TO_DECIMAL(g_rtcc.seconds);
+}
 
-    ucRTCInval = 0;
+/**
+ * Stop the drift learning from using the last sync. If uclear is set,
+ * the samples taken so far are dropped as well. */
 
-    RTCCFG |= 3;        // Highest RTC address
+void Drift_Invalidate(unsigned char uclear)
+{
+    g_drift.flags = 0;
 
-    ucTemp = RTCVALL; // Year
-    ucValue = g_bcd_decimal_testing[ucTemp];
-    if (ucValue > 99)
+    if (uclear)
     {
-        ucRTCInval = 1;
+        g_drift.count = 0;
+        g_drift.index = 0;
     }
+}
 
-    ucTemp = RTCVALH; // reserved, dummy for decrement
+/**
+ * Called when the RTC gets stopped to sync the watch. Keeps the time the
+ * watch had on its own, the snapshot must not contain staged values. The
+ * time the RTC is being stopped is counted by Timer1, which runs from the
+ * same 32kHz crystal. */
 
-    ucTemp = RTCVALL; // Day
-    ucValue = g_bcd_decimal_testing[ucTemp];
-    if ((ucValue < 1) || (ucValue > 31))
-    {
-        ucRTCInval = 1;
-    }
+void Drift_Sync_Begin(void)
+{
+    g_drift.own = Second_Of_Day();
+    g_drift.start = Read_Timer_1_Ticks();
+    g_drift.stopped = 0;
+    g_drift.flags |= DRIFT_FLAG_PENDING;
+}
 
-    ucTemp = RTCVALH; // Month
-    ucValue = g_bcd_decimal_testing[ucTemp];
-    if ((ucValue < 1) || (ucValue > 12))
-    {
-        ucRTCInval = 1;
-    }
+/**
+ * Called when the RTC gets started again at the time signal. Compares the
+ * time set with the time the watch would have shown on its own and
+ * estimates the calibration value from the correction and the time since
+ * the last sync. Once enough samples are known, RTCCAL is moved halfway
+ * towards their average.
+ */
 
-    ucTemp = RTCVALL; // Hour
-    ucValue = g_bcd_decimal_testing[ucTemp];
-    if (ucValue > 23)
-    {
-        ucRTCInval = 1;
-    }
+void Drift_Sync_End(void)
+{
+    unsigned long ulNow;
+    unsigned long ulStopped;
+    unsigned short uDays;
+    signed long slCorrection;
+    signed long slElapsed;
 
-    ucTemp = RTCVALH; // Weekday
-    ucValue = g_bcd_decimal_testing[ucTemp];
-    if (ucValue > 6)
+    if (!(g_drift.flags & DRIFT_FLAG_PENDING))
     {
-        ucRTCInval = 1;
+        return;
     }
 
-    ucTemp = RTCVALL; // Second
-    ucValue = g_bcd_decimal_testing[ucTemp];
-    if (ucValue > 59)
+    /* Get the time stopped in 1/32768 seconds until the edge. */
+
+    ulStopped = g_drift.stopped;
+
+    /* Get the time set. The RTC has been started on the edge of the
+     * button, so it is still within the first second. */
+
+    Read_RTCC_Snapshot();
+
+    ulNow = Second_Of_Day();
+    uDays = Day_Number();
+
+    /* Correction made by the user in seconds, turned around at midnight. */
+
+    slCorrection = (signed long)ulNow -
+                   (signed long)(g_drift.own + ((ulStopped + 16384) >> 15));
+
+    if (slCorrection > 43200)
     {
-        ucRTCInval = 1;
+        slCorrection -= 86400;
     }
-
-    ucTemp = RTCVALH; // Minute
-    ucValue = g_bcd_decimal_testing[ucTemp];
-    if (ucValue > 59)
+    else if (slCorrection < -43200)
     {
-        ucRTCInval = 1;
+        slCorrection += 86400;
     }
 
-    /* Reset RTC if invalid. */
-
-    if (ucRTCInval)
+    if ((g_drift.flags & DRIFT_FLAG_VALID) &&
+        (slCorrection <= DRIFT_MAX_CORRECTION) &&
+        (slCorrection >= -DRIFT_MAX_CORRECTION))
     {
-        while(RTCCFGbits.RTCSYNC);
+        slElapsed = (signed long)(uDays - g_drift.days) * 86400 +
+                    (signed long)ulNow - (signed long)g_drift.seconds;
 
-        RTCCFG |= 3;
-
-        RTCVALL = g_decimal_bcd[25]; // Default year 2025
+        if (slElapsed >= DRIFT_MIN_SECONDS)
+        {
+            signed short sCal = (signed char)RTCCAL;
+            signed short sSum = 0;
+            unsigned char i;
 
-        ucRTCInval = RTCVALH; // Dummy for decrement
+            /* Calibration, that would have avoided the correction. */
 
-        RTCVALL = 1; // Day
-        RTCVALH = 1; // Month
+            sCal += (signed short)(slCorrection * DRIFT_CAL_PER_SECOND / slElapsed);
 
-#if (APP_WATCH_TYPE_BUILD==APP_PULSAR_WRIST_WATCH_12H_LEGACY_MOD) || \
-    (APP_WATCH_TYPE_BUILD==APP_PULSAR_P3_WRIST_WATCH_12H_ODIN_MARK_II_MOD) || \
-    (APP_WATCH_TYPE_BUILD==APP_PULSAR_WRIST_WATCH_12H_SIF_LEGACY_MOD) || \
-    (APP_WATCH_TYPE_BUILD==APP_PULSAR_P4_WRIST_WATCH_12H_SIF_MARK_II_MOD)
+            if (sCal > DRIFT_CAL_LIMIT)
+            {
+                sCal = DRIFT_CAL_LIMIT;
+            }
+            else if (sCal < -DRIFT_CAL_LIMIT)
+            {
+                sCal = -DRIFT_CAL_LIMIT;
+            }
 
-        RTCVALL = 0; // Hour (midnight))
+            g_drift.cal[g_drift.index] = (signed char)sCal;
 
-#else
+            if (++g_drift.index >= DRIFT_HISTORY)
+            {
+                g_drift.index = 0;
+            }
 
-        RTCVALL = g_decimal_bcd[12]; // Hour (noon)
-        
-#endif
+            if (g_drift.count < DRIFT_HISTORY)
+            {
+                g_drift.count++;
+            }
 
-        RTCVALH = 3; // Weekday (1.1.2020 was a Wednesday)
+            /* Move the calibration halfway towards the average. */
 
-        RTCVALL = 0; // Seconds
-        RTCVALH = 0; // Minutes
-        
-        /* Initialize all alarm registers. */
+            if (g_drift.count >= DRIFT_MIN_SAMPLES)
+            {
+                for (i = 0; i < g_drift.count; i++)
+                {
+                    sSum += g_drift.cal[i];
+                }
 
-        ALRMCFGbits.ALRMPTR0 = 0;
-        ALRMCFGbits.ALRMPTR1 = 1;
+                sCal = (signed char)RTCCAL;
+                sCal += (sSum / g_drift.count - sCal) / 2;
 
-        ALRMVALL = 1; // Day
-        ALRMVALH = 1; // Month
+                while(RTCCFGbits.RTCSYNC);
 
-        ALRMVALL = 0; // Hour
-        ALRMVALH = 1; // Weekday
+                Unlock_RTCC();
 
-        ALRMVALL = 0; // Seconds
-        ALRMVALH = 0; // Minutes
-    }
-    else // RTC time/date was valid
-    {
-        /* Check alarm time only, if clock time/date was valid. */
-        
-        ucRTCInval = 0;
+                RTCCAL = (unsigned char)sCal;
 
-        ALRMCFGbits.ALRMPTR0 = 1;
-        ALRMCFGbits.ALRMPTR1 = 0;
-        
-        ucTemp = ALRMVALL; // Hour
-        ucValue = g_bcd_decimal_testing[ucTemp];
-        if (ucValue > 23)
-        {
-            ucRTCInval = 1;
+                Lock_RTCC();
+            }
         }
+    }
 
-        ucTemp = ALRMVALH; // Dummy to decrement address.
+    /* The time set is the reference for the next sync. */
 
-        ucTemp = ALRMVALH; // Minute
-        ucValue = g_bcd_decimal_testing[ucTemp];
-        if (ucValue > 59)
-        {
-            ucRTCInval = 1;
-        }
+    g_drift.seconds = ulNow;
+    g_drift.days = uDays;
+    g_drift.flags = DRIFT_FLAG_VALID;
+}
 
-        /* Initialize alarm registers. */
+#endif // #if APP_DRIFT_LEARNING_USAGE==1
 
-        ALRMCFGbits.ALRMPTR0 = 0;
-        ALRMCFGbits.ALRMPTR1 = 1;
+#if APP_TIMER_1_USAGE==1
 
-        if (ucRTCInval)
-        {
-            /* Initialize all alarm registers. */
+/**
+ * Count an overflow of timer 1, if one is pending. */
 
-            ALRMVALL = 1; // Day
-            ALRMVALH = 1; // Month
+inline void Count_Timer_1_Overflow(void)
+{
+    if (PIR1bits.TMR1IF)
+    {
+        PIR1bits.TMR1IF = 0;
 
-            ALRMVALL = 0; // Hour
-            ALRMVALH = 1; // Weekday
+        g_uTimer1Overflows++;
+    }
+}
 
-            ALRMVALL = 0; // Seconds
-            ALRMVALH = 0; // Minutes
-        }
-        else // RTC alarm time was valid
-        {
-            /* Initialize only not used alarm registers. */
-            
-            ALRMVALL = 1; // Day
-            ALRMVALH = 1; // Month, auto-decrement!
-            ALRMVALH = 1; // Weekday, auto-decrement!
-            ALRMVALL = 0; // Seconds
-        }
-    }
-    
-    while(RTCCFGbits.RTCSYNC);
-
-    /* Enable setting pointers to read MIN and SEC. */
-
-    RTCCFGbits.RTCPTR0 = 0; // Points to the RTCC Value registers when reading.
-    RTCCFGbits.RTCPTR1 = 0;
-
-    /* Set optional RTC alarm to 1 Hz, but keep it off. */
-
-    ALRMCFGbits.CHIME = 0;  /* If chime is enabled, ensure not to clear ALRMEN
-                             * bit. ALRMRPT<7:0> bits are allowed to roll over
-                             * from 00h to FFh */
+/**
+ * Read the crystal ticks counted by timer 1, extended by its overflows.
+ * An overflow right after counting the pending ones belongs to a low
+ * value read.
+ *
+ * @return  Ticks of 1/32768 seconds, turning around after 36 hours.
+ */
 
-    /* Configure an optional alarm every second. */
+unsigned long Read_Timer_1_Ticks(void)
+{
+    unsigned short uoverflows;
+    unsigned char ulow;
+    unsigned char uhigh;
 
-    ALRMCFGbits.AMASK = 0x06; // Alarm repeats every day.
+    Count_Timer_1_Overflow();
 
-    /* Disable the alarm for now. */
+    /* Reading the low byte buffers the high byte. */
 
-    ALRMCFGbits.ALRMEN = 0;
+    ulow = TMR1L;
+    uhigh = TMR1H;
 
-    /* Set Alarm repeat to zero. */
+    uoverflows = g_uTimer1Overflows;
 
-    ALRMRPT = 0;
+    if ((PIR1bits.TMR1IF) && (!(uhigh & 0x80)))
+    {
+        uoverflows++;
+    }
 
-    /* Disable the Alarm interrupt by default. */
+    return ((unsigned long)uoverflows << 16) | \
+           ((unsigned short)uhigh << 8) | ulow;
+}
 
-    PIE3bits.RTCCIE = 0;
+#endif // #if APP_TIMER_1_USAGE==1
 
-    /* Enable the RTCC */
+#if APP_STOPWATCH_USAGE==1
 
-    RTCCFGbits.RTCEN = 1;   // RTCC module is enabled
+/**
+ * Get the time of the stopwatch to show, the split selected or the time
+ * counted, which is only read from timer 1 while running.
+ *
+ * @return  Ticks of 1/32768 seconds.
+ */
 
-    while(RTCCFGbits.RTCSYNC);
+unsigned long Stopwatch_Shown(void)
+{
+    if (g_ucStopwatchView)
+    {
+        return g_ulStopwatchSplits[g_ucStopwatchView - 1];
+    }
 
-    /* Lock writing to the RTCC. */
+    if (g_ucStopwatchRunning)
+    {
+        return Read_Timer_1_Ticks() - g_ulStopwatchStart;
+    }
 
-    Lock_RTCC();
+    return g_ulStopwatchCounted;
 }
 
 /**
- * Configure the timer 0, featuring the internal oscillator as source
- * and 8-bit counting mode. The prescaler is set to 1:16.
- * Timer 0 is used to debounce the buttons. */
+ * Read the half seconds of the week counted by the RTC. The half second
+ * and the seconds are checked again after the pass. If they differ, the
+ * RTC ticked while reading and the pass is repeated.
+ */
 
-inline void Configure_Timer_0(void)
+unsigned long Read_RTCC_Half_Seconds(void)
 {
-    /* Set the clock source to the internal oscillator. */
-
-    T0CONbits.T0CS = 0;    // Clock source internal
-    T0CONbits.T08BIT = 0;  // Keep default 16 bit mode
-
-    /* Set the prescaler to 1:64.
-     *
-     * 1MHz * prescaler = 64 us -> 0xFFFF -> 4 s */
-
-    T0CONbits.T0PS = 0x05;
-    T0CONbits.PSA = 0;
+    unsigned char ucHalf;
+    unsigned char ucSeconds;
+    unsigned char ucMinutes;
+    unsigned char ucHours;
+    unsigned char ucWeekday;
 
-    /* Set the timer to zero. */
+    do
+    {
+        ucHalf = RTCCFGbits.HALFSEC;
 
-    TMR0H = 0;
-    TMR0L = 0;
+        /* Reading the high byte decrements the pointer to the seconds. */
 
-    /* Disable the timer interrupt. */
+        RTCCFG = (RTCCFG & ~3) | 1;
 
-    INTCONbits.TMR0IE = 0;  // Disables the TMR0 overflow interrupt
-    INTCONbits.TMR0IF = 0;  // Reset state bit TMR0 register did not overflow
+        ucHours = RTCVALL;
+        ucWeekday = RTCVALH;
+        ucSeconds = RTCVALL;
+        ucMinutes = RTCVALH;
+    }
+    while ((RTCCFGbits.HALFSEC != ucHalf) || (RTCVALL != ucSeconds));
 
-    /* Turn the timer 0 off. */
+    return ((((unsigned long)BCD_TO_DECIMAL(ucWeekday) * 24 +
+              BCD_TO_DECIMAL(ucHours)) * 60 +
+             BCD_TO_DECIMAL(ucMinutes)) * 60 +
+            BCD_TO_DECIMAL(ucSeconds)) * 2 + ucHalf;
+}
 
-    T0CONbits.TMR0ON = 0;
+/**
+ * Anchor timer 1 to the RTC before going to sleep, if the stopwatch and
+ * the RTC are running. The watch then sleeps through the overflows of
+ * timer 1, instead of waking up every 2 seconds to count them.
+ */
 
-    /* Timer usage */
+void Anchor_Stopwatch(void)
+{
+    g_ucStopwatchAnchored = g_ucStopwatchRunning && RTCCFGbits.RTCEN;
 
-    g_ucTimer0Usage = 0;
+    if (g_ucStopwatchAnchored)
+    {
+        g_ulStopwatchAnchorTicks = Read_Timer_1_Ticks();
+        g_ulStopwatchAnchorHalves = Read_RTCC_Half_Seconds();
+    }
 }
 
 /**
- * Configure the timer 1, featuring the external 32.768 crystal as source
- * and 16-bit counting mode. No prescaler is used.
- * This timer is not used yet. */
+ * Catch up with the overflows of timer 1 slept through since the anchor.
+ * The half seconds counted by the RTC give the ticks slept within half a
+ * second, less the calibration it applied at each minute passed. The
+ * phase of timer 1 then gives the exact count, sleeping for up to a week.
+ */
 
-inline void Configure_Timer_1(void)
+void Catch_Up_Stopwatch(void)
 {
-    /* Set the clock source to the external oscillator. */
-
-    T1CONbits.TMR1CS = 2; // Timer1 clock source is T1OSC or T1CKI pin
-
-    /* Set the prescaler to 0.
-     *
-     * (1/32.768KHz) * prescaler = 30.5 us -> 0xFFFF -> 2 s */
+    unsigned long ulHalves;
+    unsigned long ulTicks;
+    unsigned long ulMinutes;
+    unsigned short uPhase;
+    unsigned char ulow;
+    unsigned char uhigh;
+
+    if (!g_ucStopwatchAnchored)
+    {
+        return;
+    }
 
-    T1CONbits.T1CKPS = 0;
+    g_ucStopwatchAnchored = 0;
 
-    /* Enable T1 external oscillator. */
+    ulHalves = Read_RTCC_Half_Seconds();
 
-    T1CONbits.T1OSCEN = 1;  // Timer1 oscillator circuit enabled
+    if (ulHalves < g_ulStopwatchAnchorHalves)
+    {
+        ulHalves += STOPWATCH_HALF_WEEK;
+    }
 
-    /* Set timer to 16 bit width. */
+    ulHalves -= g_ulStopwatchAnchorHalves;
+    ulMinutes = (g_ulStopwatchAnchorHalves % STOPWATCH_HALF_MINUTE + ulHalves) /
+                STOPWATCH_HALF_MINUTE;
 
-    T1CONbits.RD16 = 1;
+    ulTicks = g_ulStopwatchAnchorTicks + (ulHalves << STOPWATCH_HALF_SHIFT) -
+              (signed long)(signed char)RTCCAL * STOPWATCH_CAL_TICKS * \
+              (signed long)ulMinutes;
 
-    /* Use the TIMER1 GATE CONTROL REGISTER
-     * to drop the Timer1 Gate Enable bit to ensure
-     * that Timer1 counts regardless of Timer1 gate
-     * function. */
+    /* The overflows slept through are in the estimate. An overflow right
+     * after dropping the pending one belongs to a low value read. */
 
-    T1GCONbits.TMR1GE = 0;
+    PIR1bits.TMR1IF = 0;
 
-     /* Clear the Overflow Interrupt Flag bit
-      * and disable the Overflow Interrupt Enable bit. */
+    ulow = TMR1L;
+    uhigh = TMR1H;
 
-    PIR1bits.TMR1IF = 0;
-    PIE1bits.TMR1IE = 0;
+    if ((PIR1bits.TMR1IF) && (!(uhigh & 0x80)))
+    {
+        PIR1bits.TMR1IF = 0;
+    }
 
-    /* Turn the timer 1 off. */
+    uPhase = ((unsigned short)uhigh << 8) | ulow;
+    ulTicks += (signed short)(uPhase - (unsigned short)ulTicks);
 
-    T1CONbits.TMR1ON = 0;
+    g_uTimer1Overflows = (unsigned short)(ulTicks >> 16);
 }
 
 /**
- * Configure the timer 2, featuring the internal oscillator as source
- * The prescaler is set to 1:16. This is an 8-bit counter.
- * This timer is used to define the time the display is on for readout. */
+ * Start or stop the stopwatch at the edge of the TIME button. Starting
+ * again continues with the time counted before.
+ */
 
-inline void Configure_Timer_2(void)
+void Toggle_Stopwatch(void)
 {
-    /* Set the clock prescaler to 1:16. */
+    const unsigned long ulEdge = g_ulStopwatchEdge[DEBOUNCE_INDEX_BUTTON_TIME];
 
-    T2CONbits.T2CKPS = 2; // Prescaler is 16
+    if (g_ucStopwatchRunning)
+    {
+        g_ulStopwatchCounted = ulEdge - g_ulStopwatchStart;
+        g_ucStopwatchRunning = 0;
+    }
+    else
+    {
+        g_ulStopwatchStart = ulEdge - g_ulStopwatchCounted;
+        g_ucStopwatchRunning = 1;
+    }
 
-    /* Set the timer to zero. */
+    g_ucStopwatchView = 0;
+}
 
-    TMR2 = 0;
+/**
+ * Take a split at the edge of the DATE button while running, dropping the
+ * oldest one if all are taken, and show it. Once stopped, step through the
+ * splits and reset the stopwatch after the last one.
+ */
 
-    /* Turn timer 2 off. */
+void Split_Stopwatch(void)
+{
+    unsigned char ucount = g_ucStopwatchSplitCnt;
 
-    T2CONbits.TMR2ON = 0;
+    if (g_ucStopwatchRunning)
+    {
+        if (ucount >= STOPWATCH_SPLITS)
+        {
+            unsigned char i = 0;
 
-    /* Timer usage */
+            do // while(++i < (STOPWATCH_SPLITS - 1));
+            {
+                g_ulStopwatchSplits[i] = g_ulStopwatchSplits[i + 1];
+            }
+            while(++i < (STOPWATCH_SPLITS - 1));
 
-    g_ucTimer2Usage = 0;
+            ucount = STOPWATCH_SPLITS - 1;
+        }
+
+        g_ulStopwatchSplits[ucount++] = \
+            g_ulStopwatchEdge[DEBOUNCE_INDEX_BUTTON_DATE] - g_ulStopwatchStart;
+
+        g_ucStopwatchSplitCnt = ucount;
+        g_ucStopwatchView = ucount;
+    }
+    else if (g_ucStopwatchView < ucount)
+    {
+        g_ucStopwatchView++;
+    }
+    else
+    {
+        g_ulStopwatchCounted = 0;
+        g_ucStopwatchSplitCnt = 0;
+        g_ucStopwatchView = 0;
+    }
 }
 
+#endif // #if APP_STOPWATCH_USAGE==1
+
 /**
- * Configure the timer 3, featuring the internal oscillator as source
- * and 16-bit counting mode. The prescaler is set to maximum.
- * This timer is not used yet. */
+ * Write the staged edits to the RTCC in one locked pass. The staged values
+ * are merged into a fresh snapshot first, so the time keeps running while
+ * setting, see Merge_RTCC_Stage(). The clock is only stopped, if an RTCC
+ * value register has to be written.
+ */
 
-inline void Configure_Timer_3(void)
+void Commit_RTCC_Stage(void)
 {
-    /* Set the clock source to the internal oscillator. */
-
-    T3CONbits.TMR3CS = 0;
+    const unsigned short ustaged = g_uRtccStaged;
 
-    /* Set the prescaler to 1:8. */
+    if (!ustaged)
+    {
+        return;
+    }
 
-    T3CONbits.T3CKPS = 3;
+    g_uRtccStaged = 0;
 
-    /* Set the timer to 16-bit mode. */
+    Read_RTCC_Snapshot();
 
-    T3CONbits.RD16 = 1;
+  #if APP_DRIFT_LEARNING_USAGE==1
 
-    /* Set the timer to zero. */
+    /* A sync via the 'watch stalled' mode starts with setting the minutes.
+     * Any other change of the time or the date breaks the reference of
+     * the drift learning, a manual calibration drops its history. */
 
-    TMR3H = 0;
-    TMR3L = 0;
+    if (ustaged & RTCC_STAGED_KEEP_STOPPED)
+    {
+        Drift_Sync_Begin();
+    }
+    else if (ustaged & RTCC_STAGED_CALIBRA)
+    {
+        Drift_Invalidate(1);
+    }
+    else if (ustaged & RTCC_STAGED_TIME)
+    {
+        Drift_Invalidate(0);
+    }
 
-    /* Turn timer 3 off. */
+  #endif // #if APP_DRIFT_LEARNING_USAGE==1
 
-    T3CONbits.TMR3ON = 0;
-}
+    /* Wait for a window without rollover right before the RTC is stopped
+     * and written, the one seen before the snapshot may have closed by
+     * now. Take a fresh snapshot, if the seconds rolled over since. */
 
-/**
- * Configure the timer 4.
- * This timer is used for the buzzer, driven via PWM. */
+    while(RTCCFGbits.RTCSYNC);
 
-inline void Configure_Timer_4(void)
-{
-    /* Set the clock prescaler to 1:16. */
+    RTCCFG &= ~3;
 
-    T4CONbits.T4CKPS = 2; // Prescaler is 16
+    if (RTCVALL != g_rtcc.seconds)
+    {
+        Read_RTCC_Snapshot();
+    }
 
-    /* Set the timer to zero. */
+    Merge_RTCC_Stage(ustaged);
 
-    TMR4 = 0;
+    /* Unlock write access to the RTC. */
 
-    /* Turn timer 4 off. */
+    Unlock_RTCC();
 
-    T4CONbits.TMR4ON = 0;
+    if (ustaged & RTCC_STAGED_TIME)
+    {
+        /* Stop RTC operation. */
 
-    /* ECCP1 and ECCP2 both use Timer3 (capture/compare) and Timer4 (PWM) */
+        RTCCFGbits.RTCEN = 0;
 
-  #if (APP_BUZZER_ALARM_USAGE==1)
+        /* Start at the highest address. Writing the high byte will
+         * automatically decrement the address pointer. */
 
-    TCLKCONbits.T3CCP1 = 0;
-    TCLKCONbits.T3CCP2 = 1;
+        RTCCFG |= 3;
 
-  #endif
-}
+        RTCVALL = g_rtcc.year;
+        g_rtcc.reserved = RTCVALH; // Dummy for decrement
+        RTCVALL = g_rtcc.day;
+        RTCVALH = g_rtcc.month;
+        RTCVALL = g_rtcc.hours;
+        RTCVALH = g_rtcc.weekday;
+        RTCVALL = g_rtcc.seconds;
+        RTCVALH = g_rtcc.minutes;
+    }
 
-/**
- * Enter deep sleep mode. This function will not return as the controller
- * will have entered sleep mode, before returning.
- *
- * Once the system wakes up, it will restart the program an the main entry point.
- */
+  #if APP_ALARM_SCHEDULE_USAGE==1
 
-inline void enterSleep(void)
-{
-  #if APP_WATCH_ANY_PULSAR_MODEL==APP_WATCH_PULSAR_AUTO_SET
+    if (ustaged & RTCC_STAGED_ALARM)
+    {
+        /* The daily alarm is kept in the schedule. */
 
-    /* Set RA1/5 to input, RA0/2/3/4/6/7 as output. */
+        g_alarms[ALARM_ENTRY_DAILY].hours = g_rtcc.alarm_hours;
+        g_alarms[ALARM_ENTRY_DAILY].minutes = g_rtcc.alarm_minutes;
+    }
 
-    TRISA = 0x22;
-    
   #else
 
-    /* Set RA0/1/2/5 to input, RA3/4/6/7 as output. */
+    if (ustaged & RTCC_STAGED_ALARM)
+    {
+        /* Ensure the not used alarm registers being valid. */
 
-    TRISA = 0x27;
-    
-  #endif
+        ALRMCFGbits.ALRMPTR0 = 0;
+        ALRMCFGbits.ALRMPTR1 = 1;
 
-  #if APP_WATCH_TYPE_BUILD==APP_PROTOTYPE_BREAD_BOARD
+        ALRMVALL = 1; // Day
+        ALRMVALH = 1; // Month, auto-decrement!
+        ALRMVALL = g_rtcc.alarm_hours;
+        ALRMVALH = 1; // Weekday, auto-decrement!
+        ALRMVALL = g_rtcc.alarm_seconds;
+        ALRMVALH = g_rtcc.alarm_minutes;
+    }
 
-    /* Map INT1 to RP0/RA0 (TIME - BREADBOARD) input for wake-up. */
+  #endif // #if APP_ALARM_SCHEDULE_USAGE==1
 
-    RPINR1 = 0; // RP0/RA0
+    if (ustaged & RTCC_STAGED_CALIBRA)
+    {
+        RTCCAL = g_rtcc.calibration;
 
-  #else // #if APP_WATCH_TYPE_BUILD==APP_PROTOTYPE_BREAD_BOARD
+      #if APP_TEMPERATURE_COMPENSATION==1
 
-  #if APP_WATCH_ANY_PULSAR_MODEL==APP_WATCH_PULSAR_AUTO_SET
+        /* The value set is the base of the temperature compensation. */
 
-   #if APP_WRIST_FLICK_USAGE==1
+        g_cTempCompensation = 0;
 
-    /* Map INT1 to RP13/RC2 (WRIST FLICK) input for wake-up. */
+      #endif
+    }
 
-    RPINR1 = 13; // RP13/RC2
+    /* Keep the RTC disabled and the seconds zero, until the user
+     * pressed a readout button. */
 
-   #else // #if APP_WRIST_FLICK_USAGE==1
+    if (!(ustaged & RTCC_STAGED_KEEP_STOPPED))
+    {
+        /* Enable the RTC operation again and lock writing to the RTCC. */
 
-    /* Map INT1 to RP0/RA0 input for wake-up. */
+        Lock_RTCC();
+    }
 
-    RPINR1 = 0; // RP0/RA0 (unused)
+  #if APP_TEMPERATURE_COMPENSATION==1
 
-   #endif // #else #if APP_WRIST_FLICK_USAGE==1
+    /* The calibration is set at room temperature, which references the
+     * internal oscillator of this board, removing its factory offset. The
+     * RTC is running again, the measurement takes 62ms. */
 
-  #else // #if APP_WATCH_ANY_PULSAR_MODEL==APP_WATCH_PULSAR_AUTO_SET
+    if (ustaged & RTCC_STAGED_CALIBRA)
+    {
+        g_uTempTurnoverCount = Count_Internal_Oscillator() - \
+                               TEMP_CALIBRATED_AT * TEMP_COUNTS_PER_DEGREE;
+    }
 
-    /* Map INT1 to RP0/RA0 (MIN) input for wake-up. */
+  #endif
 
-    RPINR1 = 0; // RP0/RA0
-    
-  #endif // #else #if APP_WATCH_ANY_PULSAR_MODEL==APP_WATCH_PULSAR_AUTO_SET
-
-    /* Map INT2 to RP0/RA1 (DATE) input for wake-up. */
-
-    RPINR2 = 1; // RP1/RA1
-
-    /* Map INT3 to RP2/RA5 (TIME) input for wake-up. */
+  #if APP_ALARM_SCHEDULE_USAGE==1
 
-    RPINR3 = 2; // RP2/RA5
+    /* The entry due next depends on the time and the daily alarm. */
 
-  #endif // #else #if APP_WATCH_TYPE_BUILD==APP_PROTOTYPE_BREAD_BOARD
+    if (ustaged & (RTCC_STAGED_TIME | RTCC_STAGED_ALARM))
+    {
+        Schedule_Next_Alarm();
+    }
 
-    /* Disable Ultra Low-Power Wake-up (ULPWU) usage. */
+  #endif
+}
 
-    WDTCONbits.REGSLP  = 1; /* On-chip regulator enters low-power operation
-                             * when device enters Sleep mode. */
-    DSCONHbits.RTCWDIS = 0; // Wake-up from RTCC is enabled.
-    DSCONHbits.DSULPEN = 0; // ULPWU module is disabled in Deep Sleep
-    DSCONLbits.ULPWDIS = 1; // ULPWU wake-up source is disabled.
+/**
+ * Get the number of days of the month in the snapshot, taking the leap
+ * years of 2000..2099 into account. */
 
-    /* Applications needing to save a small amount of data throughout a
-     * Deep Sleep cycle can save the data to the general purpose DSGPR0
-     * and DSGPR1 registers. */
+unsigned char Days_Of_Month(void)
+{
+    const unsigned char ucMonth = BCD_TO_DECIMAL(g_rtcc.month);
 
-    //DSGPR0
-    //DSGPR1
+    if ((ucMonth == 2) && (BCD_TO_DECIMAL(g_rtcc.year) & 3))
+    {
+        return VALUE_CONST(28);
+    }
 
-    /* Wake up on a rising edge of the HOUR button. */
+    return g_days_of_month[(ucMonth <= 12) ? ucMonth : 0];
+}
 
-    INTCON2bits.INTEDG0 = 1;    // External Interrupt 0 Edge Select bit
+/**
+ * Forward the snapshot by one day, carrying into the fields above within
+ * the calendar of the snapshot. */
 
-    /* Wake up on a rising edge of the DATE button. */
+void Carry_RTCC_Day(void)
+{
+    g_rtcc.weekday = Bcd_Step(g_rtcc.weekday, 1, 0, 6);
+    g_rtcc.day = Bcd_Step(g_rtcc.day, 1, 1, Days_Of_Month());
 
-    INTCON2bits.INTEDG1 = 1;    // External Interrupt 1 Edge Select bit
+    if (g_rtcc.day != 1)
+    {
+        return;
+    }
 
-    /* Wake up on a rising edge of the MIN button or WRIST FLICK button. */
+    g_rtcc.month = Bcd_Step(g_rtcc.month, 1, 1, VALUE_CONST(12));
 
-    INTCON2bits.INTEDG2 = 1;    // External Interrupt 2 Edge Select bit
+    if (g_rtcc.month != 1)
+    {
+        return;
+    }
 
-    /* Wake up on a rising edge of the TIME. */
+    g_rtcc.year = Bcd_Step(g_rtcc.year, 1, 0, VALUE_CONST(99));
+}
 
-    INTCON2bits.INTEDG3 = 1;    // External Interrupt 3 Edge Select bit
+/**
+ * Forward the snapshot by the hours and minutes passed, less than a day
+ * in total. The minutes are added in one go, so the cost does not grow
+ * with the time passed, and the day is carried at most once. Nothing is
+ * added, if no time passed. */
 
-    /* Clear all interuppts. */
+void Forward_RTCC_Snapshot(signed char chours, signed char cminutes)
+{
+    signed char cValue;
 
-    // HOURS
-    INTCONbits.INT0IF = 0;   // Clear INT0 Flag
-  #if APP_WATCH_ANY_PULSAR_MODEL==APP_WATCH_PULSAR_AUTO_SET
-    INTCONbits.INT0IE = 0;   // Disable INT0
-  #else
-    INTCONbits.INT0IE = 1;   // Enable INT0
-  #endif // #if APP_WATCH_ANY_PULSAR_MODEL!=APP_WATCH_PULSAR_AUTO_SET
+    if ((chours < 0) || ((chours == 0) && (cminutes <= 0)))
+    {
+        return;
+    }
 
-    // MIN / WRIST FLICK
-    INTCON3bits.INT1IF = 0;  // Clear INT1 Flag
-  #if APP_WATCH_ANY_PULSAR_MODEL==APP_WATCH_PULSAR_AUTO_SET
-   #if APP_WRIST_FLICK_USAGE==1
-    INTCON3bits.INT1IE = 1;  // Enable INT1
-   #else
-    INTCON3bits.INT1IE = 0;  // Disable INT1
-   #endif
-  #else
-    INTCON3bits.INT1IE = 1;  // Enable INT1
-  #endif
+    cValue = (signed char)BCD_TO_DECIMAL(g_rtcc.minutes) + cminutes;
 
-    // DATE
-    INTCON3bits.INT2IF = 0;  // Clear INT2 Flag
-    INTCON3bits.INT2IE = 1;  // Enable INT2
+    if (cValue < 0)
+    {
+        cValue += 60;
+        chours--;
+    }
+    else if (cValue >= 60)
+    {
+        cValue -= 60;
+        chours++;
+    }
 
-    // TIME
-    INTCON3bits.INT3IF = 0;  // Clear INT3 Flag
-    INTCON3bits.INT3IE = 1;  // Enable INT3
+    g_rtcc.minutes = DECIMAL_TO_BCD((unsigned char)cValue);
 
-#if APP_BUZZER_ALARM_USAGE==1
+    cValue = (signed char)BCD_TO_DECIMAL(g_rtcc.hours) + chours;
 
-    /* PERIPHERAL INTERRUPT REQUEST (FLAG) REGISTER 3 */
+    while (cValue >= 24)
+    {
+        cValue -= 24;
 
-    PIR3bits.RTCCIF = 0;    // No RTCC interrupt occurred.
+        Carry_RTCC_Day();
+    }
 
-    /* Enable the Alarm interrupt, if the alarm had been enabled. */
+    g_rtcc.hours = DECIMAL_TO_BCD((unsigned char)cValue);
+}
 
-    PIE3bits.RTCCIE = ALRMCFGbits.ALRMEN ? 1 : 0;
+/**
+ * Forward (cdir = 1) or backward (cdir = -1) an editable field of the RTC
+ * by the step width of its descriptor and turn around on minimum and
+ * maximum. The value is only staged, it is written to the RTC by
+ * Commit_RTCC_Stage() when the set mode is left.
+ */
 
-#endif // #if APP_BUZZER_ALARM_USAGE==1
+void Edit_Field(unsigned char uindex, signed char cdir)
+{
+    const FieldType *pf = &g_fields[uindex];
+    const unsigned char uflags = pf->flags;
 
-    /* INTERRUPT CONTROL REGISTER */
+    unsigned char ucTemp;
+    unsigned char ucOffset;
+    unsigned char ucMax = pf->max;
 
-    // Global Interrupt Enable bit
-    INTCONbits.GIE = 1;      // Enables all unmasked interrupts
-    // Peripheral Interrupt Enable bit
-    INTCONbits.PEIE = 1;     // Enables all unmasked peripheral interrupts
+    /* Get the current values including the edits staged so far. */
 
-    /* Double check the TIME & DATE buttons to be low. Otherwise we
-     * may fail to detect a rising edge. */
+    Read_RTCC_Snapshot();
 
-#if APP_WATCH_ANY_PULSAR_MODEL==APP_WATCH_PULSAR_AUTO_SET
+    if (uflags & FIELD_FLAG_CALIBRA)
+    {
+        /* Negative calibration for clocks running too fast, positive
+         * calibration for clocks running too slow. */
 
-    if ((!PB0 /*TIME*/) && (!PB1 /*DATE*/))
+        signed short sValue = (signed char)g_rtcc.calibration;
 
-#else
+        /* Forward or backward the value and turn around. */
 
-    if ((!PB0 /*TIME*/) && (!PB1 /*DATE*/) && (!PB2 /*HOUR*/) && (!PB3 /*MIN*/))
+        sValue += cdir * (signed short)pf->step;
 
-#endif        
+        if (sValue > (signed char)pf->max)
+        {
+            sValue = (signed char)pf->min;
+        }
+        else if (sValue < (signed char)pf->min)
+        {
+            sValue = (signed char)pf->max;
+        }
 
+        Stage_RTCC_Value(RTCC_SNAPSHOT_CALIBRA, (unsigned char)sValue);
+    }
+    else
     {
-        /* Sleep vs. deep sleep mode. */
+        /* On every second cycle change betwen AM and PM and otherwise
+         * forward the day. */
 
-        OSCCONbits.IDLEN = 0;     // Disable deep sleep.
-        DSCONHbits.DSEN = 0;      // Must be set to 1 DS just before Sleep();
+        if (uflags & FIELD_FLAG_AM_PM)
+        {
+            ucTemp = BCD_TO_DECIMAL(g_rtcc.hours);
 
-        Sleep();
-    }
-}
+            if (ucTemp < 12)
+            {
+                /* AM -> PM, do not forward the day. */
 
-#if APP_BUZZER_ALARM_USAGE==1
+                Stage_RTCC_Value(2, DECIMAL_TO_BCD(ucTemp + 12)); // Hours
 
-/**
- * This function will turn the alarm buzzer on again.
- *
- * @param duration  Duration in ticks.
- */
+                cdir = 0;
+            }
+            else
+            {
+                /* PM -> AM */
 
-void Turn_Buzzer_On(unsigned short duration)
-{
-    /* Alarm counter used to keep the buzzer on. */
+                Stage_RTCC_Value(2, DECIMAL_TO_BCD(ucTemp - 12)); // Hours
+            }
+        }
 
-    g_ucAlarm = duration;
+        /* Take the value from the snapshot, its position follows
+         * the register pointer. */
 
-    /* Set the display state to time reading. */
+        ucOffset = (unsigned char)(pf->ptr << 1) |
+                   (uflags & FIELD_FLAG_HIGH_BYTE);
 
-    if (g_uDispState == DISP_STATE_BLANK)
-    {
-        g_uDispState = DISP_STATE_TIME;
-    }
+        if (uflags & FIELD_FLAG_ALARM)
+        {
+            ucOffset += RTCC_SNAPSHOT_ALARM;
+        }
 
-    /* Turn the 'stay awake' timer on, if activating the buzzer. */
+        /* Get the number of days of the month. */
 
-    g_ucTimer2Usage = 1;    // Indicate using the timer.
-    TMR2 = 0;               // Zero the timer.
-    T2CONbits.TMR2ON = 1;   // Turn timer 2 on.
+        if (uflags & FIELD_FLAG_DAY_OF_MONTH)
+        {
+            ucMax = Days_Of_Month();
+        }
 
-    /* Single output: PxA, PxB, PxC and PxD controlled by steering. */
+        /* Forward or backward the value, turn around and stage it. */
 
-    CCP1CONbits.P1M1 = 0;
-    CCP1CONbits.P1M0 = 0;
+        ucTemp = ((unsigned char *)&g_rtcc)[ucOffset];
 
-    /* Assuming 40Mhz/4 as FOSC makes 0,0000001s as TOSC.
-     * Having a timer 4 pre-scaler of 16 and using this equation
-     * pwm period = (PR4+1)*4*TOSC*(TMR4 Prescaler) and turning
-     * that around to PR4 = ((1/1700)/4/16/0,0000001)-1 */
+        Stage_RTCC_Value(ucOffset, Bcd_Step(ucTemp, cdir, pf->min, ucMax));
 
-    PR4bits.PR4 = g_ualarm_period; // We are using timer 4 for the PWM!
+        /* Zero the seconds when forwarding the minutes. */
 
-    /* Set duty cycle.
-     * Assuming 40Mhz/4 as FOSC makes 0,0000001s as TOSC.
-     * Having a timer 4 pre-scaler of 16 and using this equation
-     * duty cycle = (CCPRXL:CCPXCON<5:4>))*TOSC*(TMR4 Prescaler)
-     * and turning that around to DC = (1/1700/2)/16/0,0000001 */
+        if (uflags & FIELD_FLAG_ZERO_SECONDS)
+        {
+            Stage_RTCC_Value(ucOffset & RTCC_SNAPSHOT_ALARM, 0);
+        }
 
-    CCP1CONbits.DC1B = 0;    // Lower 2 bit
-    CCPR1Lbits.CCPR1L = g_ualarm_duty_cycle;  // Upper 8 Bit
+        /* Keep the day valid, if the month got shorter. */
 
-    /* Turn timer 4 as PWM source. */
+        if (uflags & FIELD_FLAG_CLAMP_DAY)
+        {
+            ucMax = Days_Of_Month();
 
-    T4CONbits.TMR4ON = 1;
+            if (VALUE_FROM_BCD(g_rtcc.day) > ucMax)
+            {
+                Stage_RTCC_Value(4, VALUE_TO_BCD(ucMax)); // Day
+            }
+        }
+    }
 
-    /* Activate PWM mode PxA and PxC active-high; PxB and PxD active-high */
+    if (uflags & FIELD_FLAG_KEEP_STOPPED)
+    {
+        g_uRtccStaged |= RTCC_STAGED_KEEP_STOPPED;
+    }
 
-    CCP1CONbits.CCP1M = 0xC;
+    g_uRtccStageState = g_uDispState;
 }
 
 /**
- * This function will turn the alarm buzzer off again.
- */
+ * Initialize the ports of the general purpose inputs and outputs. */
 
-inline void Turn_Buzzer_Off(void)
+inline void Init_Inputs_Outputs_Ports(void)
 {
-    /* Zero the Alarm counter used to keep the buzzer on. */
+    /* Initialize LATA/B/C to clear output data latches. */
 
-    g_ucAlarm = 0;
+    LATA = 0;
+    LATB = 0;
+    LATC = 0;
 
-    /* Deactivate PWM mode PxA and PxC active-high; PxB and PxD active-high */
+    /* Free AN5 from being tight to the Voltage monitoring. */
 
-    CCP1CONbits.CCP1M = 0;
+    HLVDCON = 8;
 
-    /* Turn timer 4 off again. */
+    /* Turn off SSDMA (SPI DMA Module) */
 
-    T4CONbits.TMR4ON = 0;
+    DMACON1 = 0;
 }
 
 /**
- * This function will turn the alarm buzzer off again.
- *
- * @param ufancy  Alter the sound (0-off, 1..3 frequency variant)
- */
+ * Setting up the general purpose inputs and outputs
+ * as well as the ananlogue input for the light sensor
+ * or the PWM output for the alarm feature, if used. */
 
-inline void Turn_Buzzer_Fancy(unsigned char ufancy)
+inline void Configure_Inputs_Outputs(void)
 {
-    /* Deactivate PWM mode PxA and PxC active-high; PxB and PxD active-high */
+    /* Disable the unused Charge Time Measurement Unit (CTMU)
+     * used for touch screens and capacitive sensors. */
 
-    CCP1CONbits.CCP1M = 0;
+    CTMUCONH = 0x00; // Make sure CTMU is disabled.
+    CTMUCONL = 0x90; // Edge 1/2 programmed for a positive edge response
+    CTMUICON = 0x01; // 0.55uA, Nominal - No Adjustment
 
-    /* Turn timer 4 as PWM source off. */
+  #if APP_WATCH_ANY_PULSAR_MODEL==APP_WATCH_PULSAR_AUTO_SET
 
-    T4CONbits.TMR4ON = 0;
+    /* Set RA1/5 to input, RA0/2/3/4/6/7 as output. */
 
-    /* Assuming 40Mhz/4 as FOSC makes 0,0000001s as TOSC.
-     * Having a timer 4 pre-scaler of 16 and using this equation
-     * pwm period = (PR4+1)*4*TOSC*(TMR4 Prescaler) and turning
-     * that around to PR4 = ((1/1000)/4/16/0,0000001)-1 */
+    TRISA = 0x22;
 
-    PR4bits.PR4 = (unsigned char) (g_ualarm_period - (ufancy << 3)); // We are using timer 4 for the PWM!
+    /* Set RB1/4/6 to input, keep RB0/2/3/5/7 as output. */
 
-    /* Set duty cycle.
-     * Assuming 40Mhz/4 as FOSC makes 0,0000001s as TOSC.
-     * Having a timer 4 pre-scaler of 16 and using this equation
-     * duty cycle = (CCPRXL:CCPXCON<5:4>))*TOSC*(TMR4 Prescaler)
-     * and turning that around to DC = (1/1000/2)/16/0,0000001 */
+    TRISB = 0x52;
+    
+  #else
 
-    CCPR1Lbits.CCPR1L = (unsigned char) (g_ualarm_duty_cycle - (ufancy << 2));  // Upper 8 Bit
+    /* Set RA0/1/2/5 to input, RA3/4/6/7 as output. */
 
-    /* Turn timer 4 as PWM source. */
+    TRISA = 0x27;
 
-    T4CONbits.TMR4ON = 1;
+    /* Set RB0/1/4/6 to input, keep RB2/3/5/7 as output. */
 
-    /* Activate PWM mode PxA and PxC active-high; PxB and PxD active-high */
+    TRISB = 0x53;
+    
+  #endif
 
-    CCP1CONbits.CCP1M = 0xC;
-}
+  #if (APP_BUZZER_ALARM_USAGE==1)
 
-#endif // #if APP_BUZZER_ALARM_USAGE==1
+    /* Set RC0/1/2/4/5..7 to output and RC3 as input. */
 
-/**
- * This function will read and debounce the push buttons.
- *
- * @return  Return zero, if the watch can enter sleep, non-zero otherwise.
- */
+    TRISC = 0x08;
 
-unsigned char DebounceButtons(void)
-{
-    short *ptimer;
-    unsigned char *pstate;
-    unsigned char ubutton;
-    short itimer;
+  #else
 
-    /* Button handler pointer. */
+    /* Set RC0/1/4/5..7 to output and RC3 and RC2(AN11) as input. */
 
-    ButtonHandlerType ppressed;
-    ButtonHandlerType phold;
-    ButtonHandlerType preleased;
+    TRISC = 0x0C;
 
-    /* Check for a wrist flick event, if that feature has been enabled. */
+  #endif
 
-#if APP_WRIST_FLICK_USAGE==1
-    
-    static const unsigned char imaxb = 5; // Buttons and wrist flick.
+    /* Set unused port pins to drive low. */
 
-#else
-    
-    static const unsigned char imaxb = 4; // Buttons only.
+  #if APP_WATCH_ANY_PULSAR_MODEL==APP_WATCH_PULSAR_AUTO_SET
+
+    PORTAbits.RA0 = 0;
+    PORTBbits.RB0 = 0;
     
-#endif // #if APP_WRIST_FLICK_USAGE==1
+  #endif
 
-    /* Init */
+    PORTAbits.RA3 = 0;
+    PORTAbits.RA7 = 0;
 
-    unsigned char ibtns = 0;
-    unsigned char istayawake = 0;
-    unsigned char *pusage = &g_ucTimer0Usage;
+  #if (APP_LIGHT_SENSOR_USAGE==1) && (APP_LIGHT_SENSOR_THRESHOLD==0)
+
+    /* ANCON0 - A/D PORT CONFIGURATION REGISTER
+     * Analog Port Configuration bits (AN<7:0>)
+     * 1 = Pin configured as a digital port
+     * 0 = Pin configured as an analog channel - digital input disabled
+     * and reads zero */
+
+    ANCON0 = 0xFF;          // AN0...7
+
+    /* ANCON1 - A/D PORT CONFIGURATION REGISTER
+     * Analog Port Configuration bits (AN<7:0>)
+     * 1 = Pin configured as a digital port
+     * 0 = Pin configured as an analog channel - digital input disabled
+     * and reads zero */
+
+    ANCON1 = 0x17;          // AN8..12 Activate AN11 as being an analogue input.
+
+    // ADCON1
+    ADCON1bits.ADFM = 1;    // Result format 1= Right justified
+    ADCON1bits.ADCAL = 0;   // Normal A/D conversion operation
+    ADCON1bits.ACQT = 1;    // Acquisition time 7 = 20TAD 2 = 4TAD 1=2TAD
+    ADCON1bits.ADCS = 2;    // Clock conversion bits 6= FOSC/64 2=FOSC/32
+    
+    // ANCON1
+    ANCON1bits.VBGEN = 1;   // Turn on the Bandgap
+
+    // ADCON0
+    ADCON0bits.VCFG0 = 0;   // Vref+ = AVdd 3V battery
+    ADCON0bits.VCFG1 = 0;   // Vref- = AVss 0V battery
+    ADCON0bits.CHS = 11;    // Select ADC channel -> AN11
+    ADCON0bits.ADON = 1;    // Turn on ADC
+
+  #else // Light sensor not used or read as digital input on RC2. Anyway
+        // free the analogue inputs for digital use.
+
+    /* ANCON0 - A/D PORT CONFIGURATION REGISTER
+     * Analog Port Configuration bits (AN<7:0>)
+     * 1 = Pin configured as a digital port
+     * 0 = Pin configured as an analog channel - digital input disabled
+     * and reads zero */
+
+    ANCON0 = 0xFF;          // AN0...7
+
+    /* ANCON1 - A/D PORT CONFIGURATION REGISTER
+     * Analog Port Configuration bits (AN<7:0>)
+     * 1 = Pin configured as a digital port
+     * 0 = Pin configured as an analog channel - digital input disabled
+     * and reads zero */
+
+    ANCON1 = 0x1F;          // AN8..12
+
+    /* ADCON0 */
+
+    ADCON0bits.ADON = 0;    // Turn off ADC
+
+  #endif
+
+  #if APP_WATCH_ANY_PULSAR_MODEL==APP_WATCH_PULSAR_AUTO_SET
+
+    /* Set RA1/5 to input, RA0/2/3/4/6/7 as output. */
+
+    TRISA = 0x22;
+    
+  #else
+
+    /* Set RA0/1/2/5 to input, RA3/4/6/7 as output. */
+
+    TRISA = 0x27;
+    
+  #endif
+
+    /* Configure the output as PWM output channel A.
+     * This can be used for the alarm buzzer of LOKI/HEL modules or
+     * the high voltage upstepper for a Nixi table clock. */
+
+  #if (APP_BUZZER_ALARM_USAGE==1)
+
+    /* Write Magic */
+
+    EECON2 = 0x55;
+    EECON2 = 0xAA;
+
+    /* Set write enable bit for the I/O mapping. */
+
+    IOLOCK = 0;
+
+    /* Map RP13 to CCP1/P1A - PWM Channel A */
+
+    RPOR13 = 14;
+
+    /* Clear write enable bit for the I/O mapping. */
+
+    IOLOCK = 1;
+
+  #endif
+}
+
+/**
+ * Initialize the button states. */
+
+inline void Init_Button_States(void)
+{
+    g_ucPB0TIMEState = PB_STATE_IDLE; // TIME
+    g_ucPB1DATEState = PB_STATE_IDLE; // DATE
+    g_ucPB2HOURState = PB_STATE_IDLE; // HOUR
+    g_ucPB3MINTState = PB_STATE_IDLE; // MIN
+
+    g_sPB0Timer = 0;
+    g_sPB1Timer = 0;
+    g_sPB2Timer = 0;
+    g_sPB3Timer = 0;
+    
+  #if APP_WRIST_FLICK_USAGE==1
+
+    g_ucFlickEdges = 0; // WRIST FLICK
+    g_sPB4Timer = 0;
+
+  #endif // #if APP_WRIST_FLICK_USAGE==1
+}
+
+/**
+ * Setting up the onboard RTC. */
+
+inline void Configure_Real_Time_Clock(void)
+{
+    unsigned char ucRTCInval;
+
+    while(RTCCFGbits.RTCSYNC);
+
+    /* Unlock write operations to the RTC. */
+
+    Unlock_RTCC();
+
+    /* Set write enable bit. */
+
+    RTCCFGbits.RTCWREN = 1; // RTCC Value Registers Write Enable bit
+
+    /* Disable the RTCC */
+
+    RTCCFGbits.RTCEN = 0;   // RTCC module is disabled
+
+    /* Poll RTCSYNC until it has cleared.
+     *
+     * The RTCSYNC bit indicates a time window during
+     * which the RTCC Clock Domain registers can be safely
+     * read and written without concern about a rollover.
+     * When RTCSYNC = 0, the registers can be safely accessed. */
+
+    while(RTCCFGbits.RTCSYNC);
+
+    /* Check if the RTC has invalid values. */
+
+    Read_RTCC_Snapshot();
+
+    ucRTCInval = 0;
+
+    if (!BCD_IS_VALID(g_rtcc.year, 0, 99))
+    {
+        ucRTCInval = 1;
+    }
+
+    if (!BCD_IS_VALID(g_rtcc.day, 1, 31))
+    {
+        ucRTCInval = 1;
+    }
+
+    if (!BCD_IS_VALID(g_rtcc.month, 1, 12))
+    {
+        ucRTCInval = 1;
+    }
+
+    if (!BCD_IS_VALID(g_rtcc.hours, 0, 23))
+    {
+        ucRTCInval = 1;
+    }
+
+    if (!BCD_IS_VALID(g_rtcc.weekday, 0, 6))
+    {
+        ucRTCInval = 1;
+    }
+
+    if (!BCD_IS_VALID(g_rtcc.seconds, 0, 59))
+    {
+        ucRTCInval = 1;
+    }
+
+    if (!BCD_IS_VALID(g_rtcc.minutes, 0, 59))
+    {
+        ucRTCInval = 1;
+    }
+
+    /* Reset RTC if invalid. */
+
+    if (ucRTCInval)
+    {
+        while(RTCCFGbits.RTCSYNC);
+
+        RTCCFG |= 3;
+
+        RTCVALL = 0x25; // Default year 2025
+
+        ucRTCInval = RTCVALH; // Dummy for decrement
+
+        RTCVALL = 1; // Day
+        RTCVALH = 1; // Month
+
+#if (APP_WATCH_TYPE_BUILD==APP_PULSAR_WRIST_WATCH_12H_LEGACY_MOD) || \
+    (APP_WATCH_TYPE_BUILD==APP_PULSAR_P3_WRIST_WATCH_12H_ODIN_MARK_II_MOD) || \
+    (APP_WATCH_TYPE_BUILD==APP_PULSAR_WRIST_WATCH_12H_SIF_LEGACY_MOD) || \
+    (APP_WATCH_TYPE_BUILD==APP_PULSAR_P4_WRIST_WATCH_12H_SIF_MARK_II_MOD)
+
+        RTCVALL = 0; // Hour (midnight))
+
+#else
+
+        RTCVALL = 0x12; // Hour (noon)
+        
+#endif
+
+        RTCVALH = 3; // Weekday (1.1.2020 was a Wednesday)
+
+        RTCVALL = 0; // Seconds
+        RTCVALH = 0; // Minutes
+        
+        /* Initialize all alarm registers. */
+
+        ALRMCFGbits.ALRMPTR0 = 0;
+        ALRMCFGbits.ALRMPTR1 = 1;
+
+        ALRMVALL = 1; // Day
+        ALRMVALH = 1; // Month
+
+        ALRMVALL = 0; // Hour
+        ALRMVALH = 1; // Weekday
+
+        ALRMVALL = 0; // Seconds
+        ALRMVALH = 0; // Minutes
+    }
+    else // RTC time/date was valid
+    {
+        /* Check alarm time only, if clock time/date was valid. */
+        
+        ucRTCInval = 0;
+
+        if (!BCD_IS_VALID(g_rtcc.alarm_hours, 0, 23))
+        {
+            ucRTCInval = 1;
+        }
+
+        if (!BCD_IS_VALID(g_rtcc.alarm_minutes, 0, 59))
+        {
+            ucRTCInval = 1;
+        }
+
+        /* Initialize alarm registers. */
+
+        ALRMCFGbits.ALRMPTR0 = 0;
+        ALRMCFGbits.ALRMPTR1 = 1;
+
+        if (ucRTCInval)
+        {
+            /* Initialize all alarm registers. */
+
+            ALRMVALL = 1; // Day
+            ALRMVALH = 1; // Month
+
+            ALRMVALL = 0; // Hour
+            ALRMVALH = 1; // Weekday
+
+            ALRMVALL = 0; // Seconds
+            ALRMVALH = 0; // Minutes
+        }
+        else // RTC alarm time was valid
+        {
+            /* Initialize only not used alarm registers. */
+            
+            ALRMVALL = 1; // Day
+            ALRMVALH = 1; // Month, auto-decrement!
+            ALRMVALH = 1; // Weekday, auto-decrement!
+            ALRMVALL = 0; // Seconds
+        }
+    }
+    
+    while(RTCCFGbits.RTCSYNC);
+
+    /* Enable setting pointers to read MIN and SEC. */
+
+    RTCCFGbits.RTCPTR0 = 0; // Points to the RTCC Value registers when reading.
+    RTCCFGbits.RTCPTR1 = 0;
+
+    /* Set optional RTC alarm to 1 Hz, but keep it off. */
+
+    ALRMCFGbits.CHIME = 0;  /* If chime is enabled, ensure not to clear ALRMEN
+                             * bit. ALRMRPT<7:0> bits are allowed to roll over
+                             * from 00h to FFh */
+
+    /* Configure an optional alarm every second. */
+
+    ALRMCFGbits.AMASK = 0x06; // Alarm repeats every day.
+
+    /* Disable the alarm for now. */
+
+    ALRMCFGbits.ALRMEN = 0;
+
+    /* Set Alarm repeat to zero. */
+
+    ALRMRPT = 0;
+
+    /* Disable the Alarm interrupt by default. */
+
+    PIE3bits.RTCCIE = 0;
+
+  #if APP_TEMPERATURE_COMPENSATION==1
+
+    /* Use the alarm to sample the temperature every hour. */
+
+    ALRMCFGbits.AMASK = 0x05; // Alarm repeats every hour.
+    ALRMCFGbits.CHIME = 1;
+    ALRMRPT = 255;
+    ALRMCFGbits.ALRMEN = 1;
+    PIE3bits.RTCCIE = 1;
+
+  #endif
+
+    /* Enable the RTCC */
+
+    RTCCFGbits.RTCEN = 1;   // RTCC module is enabled
+
+    while(RTCCFGbits.RTCSYNC);
+
+    /* Lock writing to the RTCC. */
+
+    Lock_RTCC();
+}
+
+/**
+ * Configure the timer 0, featuring the internal oscillator as source
+ * and 8-bit counting mode. The prescaler is set to 1:16.
+ * Timer 0 is used to debounce the buttons. */
+
+inline void Configure_Timer_0(void)
+{
+    /* Set the clock source to the internal oscillator. */
+
+    T0CONbits.T0CS = 0;    // Clock source internal
+    T0CONbits.T08BIT = 0;  // Keep default 16 bit mode
+
+    /* Set the prescaler to 1:64.
+     *
+     * 1MHz * prescaler = 64 us -> 0xFFFF -> 4 s */
+
+    T0CONbits.T0PS = 0x05;
+    T0CONbits.PSA = 0;
+
+    /* Set the timer to zero. */
+
+    TMR0H = 0;
+    TMR0L = 0;
+
+    /* Disable the timer interrupt. */
+
+    INTCONbits.TMR0IE = 0;  // Disables the TMR0 overflow interrupt
+    INTCONbits.TMR0IF = 0;  // Reset state bit TMR0 register did not overflow
+
+    /* Turn the timer 0 off. */
+
+    T0CONbits.TMR0ON = 0;
+
+    /* Timer usage */
+
+    g_ucTimer0Usage = 0;
+}
+
+/**
+ * Configure the timer 1, featuring the external 32.768 crystal as source
+ * and 16-bit counting mode. No prescaler is used.
+ * This timer keeps counting for the drift learning and the stopwatch. */
+
+inline void Configure_Timer_1(void)
+{
+    /* Set the clock source to the external oscillator. */
+
+    T1CONbits.TMR1CS = 2; // Timer1 clock source is T1OSC or T1CKI pin
+
+    /* Set the prescaler to 0.
+     *
+     * (1/32.768KHz) * prescaler = 30.5 us -> 0xFFFF -> 2 s */
+
+    T1CONbits.T1CKPS = 0;
+
+    /* Enable T1 external oscillator. */
+
+    T1CONbits.T1OSCEN = 1;  // Timer1 oscillator circuit enabled
+
+    /* Set timer to 16 bit width. */
+
+    T1CONbits.RD16 = 1;
+
+    /* Use the TIMER1 GATE CONTROL REGISTER
+     * to drop the Timer1 Gate Enable bit to ensure
+     * that Timer1 counts regardless of Timer1 gate
+     * function. */
+
+    T1GCONbits.TMR1GE = 0;
+
+     /* Clear the Overflow Interrupt Flag bit
+      * and disable the Overflow Interrupt Enable bit. */
+
+    PIR1bits.TMR1IF = 0;
+    PIE1bits.TMR1IE = 0;
+
+  #if APP_TIMER_1_USAGE==1
+
+    /* Turn the timer 1 on, counting from now on. */
+
+    T1CONbits.TMR1ON = 1;
+
+  #else
+
+    /* Turn the timer 1 off. */
+
+    T1CONbits.TMR1ON = 0;
+
+  #endif
+}
+
+/**
+ * Configure the timer 2, featuring the internal oscillator as source
+ * The prescaler is set to 1:16. This is an 8-bit counter.
+ * This timer is used to define the time the display is on for readout. */
+
+inline void Configure_Timer_2(void)
+{
+    /* Set the clock prescaler to 1:16. */
+
+    T2CONbits.T2CKPS = 2; // Prescaler is 16
+
+    /* Set the timer to zero. */
+
+    TMR2 = 0;
+
+    /* Turn timer 2 off. */
+
+    T2CONbits.TMR2ON = 0;
+
+    /* Timer usage */
+
+    g_ucTimer2Usage = 0;
+}
+
+/**
+ * Configure the timer 3, featuring the internal oscillator as source
+ * and 16-bit counting mode. The prescaler is set to maximum.
+ * This timer is used by the temperature measurement and to measure the
+ * time the light measurement blocks the multiplexing. */
+
+inline void Configure_Timer_3(void)
+{
+    /* Set the clock source to the internal oscillator. */
+
+    T3CONbits.TMR3CS = 0;
+
+    /* Set the prescaler to 1:8. */
+
+    T3CONbits.T3CKPS = 3;
+
+    /* Set the timer to 16-bit mode. */
+
+    T3CONbits.RD16 = 1;
+
+    /* Set the timer to zero. */
+
+    TMR3H = 0;
+    TMR3L = 0;
+
+    /* Turn timer 3 off. */
+
+    T3CONbits.TMR3ON = 0;
+}
+
+#if APP_TEMPERATURE_COMPENSATION==1
+
+/**
+ * Count the instruction clock by timer 3 within a window of crystal ticks
+ * counted by timer 1. Timer 1 is only read, as it might be in use by
+ * the drift learning. */
+
+unsigned short Count_Internal_Oscillator(void)
+{
+    unsigned short uStart;
+    unsigned short uNow;
+    unsigned short uCount;
+
+    const unsigned char ucTimer1On = T1CONbits.TMR1ON;
+
+    T1CONbits.TMR1ON = 1;
+
+    /* Count the instruction clock without prescaler. */
+
+    T3CONbits.TMR3ON = 0;
+    T3CONbits.T3CKPS = 0;
+
+    TMR3H = 0;
+    TMR3L = 0;
+
+    /* Start with the next crystal tick. */
+
+    uStart = TMR1L;
+    uStart |= (unsigned short)TMR1H << 8;
+
+    do
+    {
+        uNow = TMR1L;
+        uNow |= (unsigned short)TMR1H << 8;
+    }
+    while (uNow == uStart);
+
+    T3CONbits.TMR3ON = 1;
+
+    do
+    {
+        uStart = TMR1L;
+        uStart |= (unsigned short)TMR1H << 8;
+    }
+    while ((unsigned short)(uStart - uNow) < TEMP_WINDOW_TICKS);
+
+    T3CONbits.TMR3ON = 0;
+
+    uCount = TMR3L;
+    uCount |= (unsigned short)TMR3H << 8;
+
+    /* Restore timer 1 and the prescaler of timer 3. */
+
+    T1CONbits.TMR1ON = ucTimer1On;
+    T3CONbits.T3CKPS = 3;
+
+    return uCount;
+}
+
+/**
+ * Measure the die temperature relative to the turnover temperature of the
+ * crystal. The PIC18F24J11 has no internal temperature diode the CTMU
+ * could be connected to, so the drift of the internal oscillator is used,
+ * relative to its count at the turnover of this board. */
+
+signed char Measure_Die_Temperature(void)
+{
+    signed long slDelta;
+
+    /* Turn the count into degrees. */
+
+    slDelta = ((signed long)Count_Internal_Oscillator() - g_uTempTurnoverCount) / \
+              TEMP_COUNTS_PER_DEGREE;
+
+    if (slDelta > TEMP_DELTA_LIMIT)
+    {
+        slDelta = TEMP_DELTA_LIMIT;
+    }
+    else if (slDelta < -TEMP_DELTA_LIMIT)
+    {
+        slDelta = -TEMP_DELTA_LIMIT;
+    }
 
-    do // while(++ibtns < 4);
+    return (signed char)slDelta;
+}
+
+/**
+ * Called by the hourly alarm. The crystal runs slow the further the
+ * temperature is away from its turnover temperature. Add the matching
+ * calibration steps on top of the base value, that had been set by the
+ * user or the drift learning. A step corrects 2ppm, more than the drift
+ * within a few degrees of the turnover, so the rest below a step is
+ * carried into the next hour instead of being dropped.
+ */
+
+void Compensate_Temperature(void)
+{
+    signed short sBase;
+    signed short sCal;
+    signed short sComp;
+    unsigned long ulPpb;
+
+    /* Do not touch a clock stopped for setting it. */
+
+    if (!RTCCFGbits.RTCEN)
     {
-        /* Read the button status and state machine value. */
+        return;
+    }
 
-        switch(ibtns)
-        {
-            // PB0 - TIME
-            case DEBOUNCE_INDEX_BUTTON_TIME: // 0
-                pstate = &g_ucPB0TIMEState;
-                ptimer = &g_sPB0Timer;
-                ubutton = PB0;
-                ppressed = &PressPB0;
-                phold = &HoldPB0;
-                preleased = &ReleasePB0;
-            break;
+  #if APP_BUZZER_ALARM_USAGE==1
 
-          #if !APP_ONE_TIME_BUTTON_OPERATION
+    /* Timer 3 is busy timing the melody, skip this sample. */
 
-            // PB1 - DATE
-            case DEBOUNCE_INDEX_BUTTON_DATE: // 1
-                pstate = &g_ucPB1DATEState;
-                ptimer = &g_sPB1Timer;
-                ubutton = PB1;
-                ppressed = &PressPB1;
-                phold = &HoldPB1;
-                preleased = &ReleasePB1;
-            break;
+    if (g_ucAlarm)
+    {
+        return;
+    }
 
-          #endif // #if !APP_ONE_TIME_BUTTON_OPERATION
+  #endif
 
-          #if APP_WATCH_ANY_PULSAR_MODEL!=APP_WATCH_PULSAR_AUTO_SET
+    const signed char cTemp = Measure_Die_Temperature();
 
-            // PB2 - HOUR
-            case DEBOUNCE_INDEX_BUTTON_HOUR: // 2
-                pstate = &g_ucPB2HOURState;
-                ptimer = &g_sPB2Timer;
-                ubutton = PB2;
-                ppressed = &PressPB2;
-                phold = &HoldPB2;
-                preleased = &ReleasePB2;
-            break;
+    g_cTemperature = cTemp;
 
-            // PB3 - MIN
-            case DEBOUNCE_INDEX_BUTTON_MIN: // 3
-                pstate = &g_ucPB3MINTState;
-                ptimer = &g_sPB3Timer;
-                ubutton = PB3;
-                ppressed = &PressPB3;
-                phold = &HoldPB3;
-                preleased = &ReleasePB3;
-            break;
+    ulPpb = (unsigned long)TEMP_CRYSTAL_PPB * (cTemp * cTemp) + g_uTempResidual;
 
-          #endif // #if APP_WATCH_ANY_PULSAR_MODEL!=APP_WATCH_PULSAR_AUTO_SET
+    sComp = (signed short)(ulPpb / TEMP_PPB_PER_CAL);
 
-          #if APP_WRIST_FLICK_USAGE==1
-            
-            // PB4 - WRIST FLICK
-            case DEBOUNCE_INDEX_BUTTON_FLICK: // 4
-                pstate = &g_ucPB4FLICKState;
-                ptimer = &g_sPB4Timer;
-                ubutton = PB4;
-                ppressed = &PressPB4;
-                phold = NULL;
-                preleased = &ReleasePB4;
-            break;
+    g_uTempResidual = (unsigned short)(ulPpb % TEMP_PPB_PER_CAL);
 
-          #endif // #if APP_WRIST_FLICK_USAGE==1
+    sBase = (signed char)RTCCAL;
+    sBase -= g_cTempCompensation;
 
-            default:
-                pstate = NULL;
-            break;
-        }
+    sCal = sBase + sComp;
 
-        if (pstate)
-        {
-            /* Check if the button has been pressed. */
+    if (sCal > DRIFT_CAL_LIMIT)
+    {
+        sCal = DRIFT_CAL_LIMIT;
+    }
 
-            if (ubutton) // pressed
-            {
-                switch(*pstate)
-                {
-                    case PB_STATE_IDLE:
+    g_cTempCompensation = (signed char)(sCal - sBase);
 
-                    /* Ignore the Wrist Flick if the display
-                     * is not in blank mode anymore or any
-                     * other event is keeping the watch awake. */
+    /* Write the calibration. */
 
-                  #if APP_WRIST_FLICK_USAGE==1
+    while(RTCCFGbits.RTCSYNC);
 
-                    if (ibtns == DEBOUNCE_INDEX_BUTTON_FLICK)
-                    {
-                        /* Already in a display mode, ignore the wrist flick. */
-                        
-                        if (g_uDispState)
-                        {
-                            break;
-                        }
-                        
-                        /* The watch is already awake, so it was not the wrist
-                         * flick waking it up, ignore the wrist flick. */
-                        
-                        if (g_ucStayAwake)
-                        {
-                            break;
-                        }
-                    }
+    Unlock_RTCC();
 
-                  #endif // #if APP_WRIST_FLICK_USAGE==1
+    RTCCAL = (unsigned char)sCal;
 
-                    /* If the button has been pressed, start debouncing it. */
+    Lock_RTCC();
+}
 
-                    *pstate = PB_STATE_DEBOUNCING;
+#endif // #if APP_TEMPERATURE_COMPENSATION==1
 
-                    /* Start the timer, if not started yet by another
-                     * button before. */
+/**
+ * Configure the timer 4.
+ * This timer is used for the buzzer, driven via PWM. */
 
-                    if (!(*pusage))
-                    {
-                        /* Zero timer */
+inline void Configure_Timer_4(void)
+{
+    /* Set the clock prescaler to 1:16. */
 
-                        TMR0H = 0;
-                        TMR0L = 0;
+    T4CONbits.T4CKPS = 2; // Prescaler is 16
 
-                        /* Turn timer 0 on. */
+    /* Set the timer to zero. */
 
-                        T0CONbits.TMR0ON = 1;
+    TMR4 = 0;
 
-                        /* Set the start timer value for this button. */
+    /* Turn timer 4 off. */
 
-                        *ptimer = 0;
-                    }
-                    else // Timer already in use and running.
-                    {
-                        /* Read out the start timer value for this button,
-                         * if the timer is already running, triggered by
-                         * another button already using it.
-                         *
-                         * TMR0H is not the actual high byte of Timer0 in 16-bit
-                         * mode. It is actually a buffered version of the real high
-                         * byte of Timer0, which is not directly readable nor
-                         * writable. TMR0H is updated with the contents of the high
-                         * byte of Timer0 during a read of TMR0L.
-                         * This provides the ability to read all 16 bits of
-                         * Timer0 without having to verify that the read of the high
-                         * and low byte were valid, due to a rollover between
-                         * successive reads of the high and low byte. */
+    T4CONbits.TMR4ON = 0;
 
-                        /* First read the low byte of the timer, which will buffer
-                         * the high byte. */
+    /* ECCP1 and ECCP2 both use Timer3 (capture/compare) and Timer4 (PWM) */
 
-                        const unsigned char ulow = TMR0L;
+  #if (APP_BUZZER_ALARM_USAGE==1)
 
-                        /* Read now the buffered high byte of the timer, that
-                         * had been stored, when the low byte had been read. */
+    TCLKCONbits.T3CCP1 = 0;
+    TCLKCONbits.T3CCP2 = 1;
 
-                        const unsigned char uhigh = TMR0H;
+  #endif
+}
 
-                        *ptimer = ulow | (uhigh << 8);
-                    }
+/**
+ * Enable the interrupts. The buzzer builds vector the overflow of timer 3
+ * to the melody sequencer, as the only high priority interrupt. All other
+ * interrupts are low priority, which stay masked by GIEL: they only wake
+ * the controller up and their flags are polled by the main loop. */
 
-                    /* Indicate that this button is using the timer. */
+inline void Enable_Interrupts(void)
+{
+  #if APP_BUZZER_ALARM_USAGE==1
 
-                    *pusage |= 1 << ibtns;
+    /* INTERRUPT PRIORITY */
 
-                    /* Return none-zero to indicate not to enter
-                     * deep sleep mode. */
+    RCONbits.IPEN = 1;          // Enable priority levels on interrupts
 
-                    istayawake = 1;
+    IPR1 = 0;                   // Low priority peripheral interrupts
+    IPR2 = 0;
+    IPR3 = 0;
 
-                    /* Continue checking the next button. */
+    INTCON2bits.TMR0IP = 0;     // Low priority TMR0 overflow
+    INTCON2bits.INT3IP = 0;     // Low priority INT3
+    INTCON3bits.INT1IP = 0;     // Low priority INT1
+    INTCON3bits.INT2IP = 0;     // Low priority INT2
 
-                    break;
+    IPR2bits.TMR3IP = 1;        // High priority melody sequencer
 
-                    case PB_STATE_DEBOUNCING:
-                    case PB_STATE_SHORT_PRESS:
+    /* INTERRUPT CONTROL REGISTER */
 
-                    /* If the button is still pressed, read
-                     * out the current timer value. */
+    // Global Interrupt Enable bit of the high priority
+    INTCONbits.GIEH = 1;        // Enables the high priority interrupts
+    // Global Interrupt Enable bit of the low priority
+    INTCONbits.GIEL = 0;        // Low priority interrupts only wake up
 
-                    {
-                        /* TMR0H is not the actual high byte of Timer0 in 16-bit
-                         * mode. It is actually a buffered version of the real high
-                         * byte of Timer0, which is not directly readable nor
-                         * writable. TMR0H is updated with the contents of the high
-                         * byte of Timer0 during a read of TMR0L.
-                         * This provides the ability to read all 16 bits of
-                         * Timer0 without having to verify that the read of the high
-                         * and low byte were valid, due to a rollover between
-                         * successive reads of the high and low byte. */
+  #else
 
-                        /* First read the low byte of the timer, which will buffer
-                         * the high byte. */
+    /* INTERRUPT CONTROL REGISTER */
 
-                        const unsigned char ulow = TMR0L;
+    // Global Interrupt Enable bit
+    INTCONbits.GIE = 1;         // Enables all unmasked interrupts
+    // Peripheral Interrupt Enable bit
+    INTCONbits.PEIE = 1;        // Enables all unmasked peripheral interrupts
 
-                        /* Read now the buffered high byte of the timer, that
-                         * had been stored, when the low byte had been read. */
+  #endif
+}
 
-                        const unsigned char uhigh = TMR0H;
+/**
+ * Enter deep sleep mode. This function will not return as the controller
+ * will have entered sleep mode, before returning.
+ *
+ * Once the system wakes up, it will restart the program an the main entry point.
+ */
 
-                        itimer = ulow | (uhigh << 8);
-                    }
+inline void enterSleep(void)
+{
+  #if APP_WATCH_ANY_PULSAR_MODEL==APP_WATCH_PULSAR_AUTO_SET
 
-                    /* Check if the long (hold) debounce timer has been expired.
-                     * Use signed values to take mathimatical a rollover in account.
-                     * This will work as long as the time span is lower than the
-                     * half of the timer's range. */
+    /* Set RA1/5 to input, RA0/2/3/4/6/7 as output. */
 
-                    if ((itimer - (*ptimer + T0_HOLD)) >= 0)
-                    {
-                        /* Check if the button is using a 'hold' handler. */
-                        
-                        if (phold)
-                        {
-                            /* Set the button to 'hold' state. */
+    TRISA = 0x22;
+    
+  #else
 
-                            *pstate = PB_STATE_LONG_PRESS;
+    /* Set RA0/1/2/5 to input, RA3/4/6/7 as output. */
 
-                            /* Store timer value as new start point. */
+    TRISA = 0x27;
+    
+  #endif
 
-                            *ptimer = itimer;
+  #if APP_WATCH_TYPE_BUILD==APP_PROTOTYPE_BREAD_BOARD
 
-                            /* Call the hold handler for this button. */
+    /* Map INT1 to RP0/RA0 (TIME - BREADBOARD) input for wake-up. */
 
-                            (*phold)();
+    RPINR1 = 0; // RP0/RA0
 
-                            /* Turn the 'stay awake' timer on. */
+  #else // #if APP_WATCH_TYPE_BUILD==APP_PROTOTYPE_BREAD_BOARD
 
-                            g_ucTimer2Usage = 1;    // Indicate using the timer.
-                            TMR2 = 0;               // Zero the timer.
-                            T2CONbits.TMR2ON = 1;   // Turn timer 2 on.
-                        }
-                        else // if (phold)
-                        {
-                            /* If the button is not featuring a 'hold' handler drop the state. */
-                            
-                            *pstate = PB_STATE_IDLE;
+  #if APP_WATCH_ANY_PULSAR_MODEL==APP_WATCH_PULSAR_AUTO_SET
 
-                            /* Indicate that this button is not using the timer anymore. */
+   #if APP_WRIST_FLICK_USAGE==1
 
-                            *pusage &= ~(1 << ibtns);
+    /* Map INT1 to RP13/RC2 (WRIST FLICK) input for wake-up. */
+
+    RPINR1 = 13; // RP13/RC2
+
+   #else // #if APP_WRIST_FLICK_USAGE==1
+
+    /* Map INT1 to RP0/RA0 input for wake-up. */
+
+    RPINR1 = 0; // RP0/RA0 (unused)
+
+   #endif // #else #if APP_WRIST_FLICK_USAGE==1
+
+  #else // #if APP_WATCH_ANY_PULSAR_MODEL==APP_WATCH_PULSAR_AUTO_SET
+
+    /* Map INT1 to RP0/RA0 (MIN) input for wake-up. */
+
+    RPINR1 = 0; // RP0/RA0
+    
+  #endif // #else #if APP_WATCH_ANY_PULSAR_MODEL==APP_WATCH_PULSAR_AUTO_SET
 
-                            /* If this was the last button using the timer, stop the timer. */
+    /* Map INT2 to RP0/RA1 (DATE) input for wake-up. */
 
-                            if (!(*pusage))
-                            {
-                                /* Stop the debouncing timer used. */
+    RPINR2 = 1; // RP1/RA1
 
-                                T0CONbits.TMR0ON = 0;
-                            }
-                            else
-                            {
-                                /* As long as another button is still
-                                 * using the timer, do not enter
-                                 * deep sleep mode. */
+    /* Map INT3 to RP2/RA5 (TIME) input for wake-up. */
 
-                                istayawake = 1;
-                            }
-                        }
-                    }
-                    else if ((itimer - (*ptimer + T0_DEBOUNCE)) >= 0)
-                    {
-                        /* If the short debounce timer has been expired. */
+    RPINR3 = 2; // RP2/RA5
 
-                        if (*pstate != PB_STATE_SHORT_PRESS)
-                        {
-                            /* Set the button to 'pressed' state. */
+  #endif // #else #if APP_WATCH_TYPE_BUILD==APP_PROTOTYPE_BREAD_BOARD
 
-                            *pstate = PB_STATE_SHORT_PRESS;
+    /* Disable Ultra Low-Power Wake-up (ULPWU) usage. */
 
-                            /* Call the 'press' handler. */
+    WDTCONbits.REGSLP  = 1; /* On-chip regulator enters low-power operation
+                             * when device enters Sleep mode. */
+    DSCONHbits.RTCWDIS = 0; // Wake-up from RTCC is enabled.
+    DSCONHbits.DSULPEN = 0; // ULPWU module is disabled in Deep Sleep
+    DSCONLbits.ULPWDIS = 1; // ULPWU wake-up source is disabled.
 
-                            if (ppressed)
-                            {
-                                (*ppressed)();
-                            }
+    /* Applications needing to save a small amount of data throughout a
+     * Deep Sleep cycle can save the data to the general purpose DSGPR0
+     * and DSGPR1 registers. */
 
-                            /* Trigger 'stay awake' timer. */
+    //DSGPR0
+    //DSGPR1
 
-                            g_ucTimer2Usage = 1;    // Indicate using the timer.
-                            TMR2 = 0;               // Zero the timer.
-                            T2CONbits.TMR2ON = 1;   // Turn timer 2 on.
+    /* Wake up on a rising edge of the HOUR button. */
 
-                            /* Keep the timer going as we have to detect
-                             * the 'hold' state as well.*/
-                        }
-                    }
+    INTCON2bits.INTEDG0 = 1;    // External Interrupt 0 Edge Select bit
 
-                    /* Do not enter deep sleep mode. */
+    /* Wake up on a rising edge of the DATE button. */
 
-                    istayawake = 1;
+    INTCON2bits.INTEDG1 = 1;    // External Interrupt 1 Edge Select bit
 
-                    /* Continue checking the next button. */
+    /* Wake up on a rising edge of the MIN button or WRIST FLICK button. */
 
-                    break;
+    INTCON2bits.INTEDG2 = 1;    // External Interrupt 2 Edge Select bit
 
-                    case PB_STATE_LONG_PRESS:
+    /* Wake up on a rising edge of the TIME. */
 
-                    /* If the button is still pressed, read
-                     * out the current timer value. */
+    INTCON2bits.INTEDG3 = 1;    // External Interrupt 3 Edge Select bit
 
-                    {
-                        /* TMR0H is not the actual high byte of Timer0 in 16-bit
-                         * mode. It is actually a buffered version of the real high
-                         * byte of Timer0, which is not directly readable nor
-                         * writable. TMR0H is updated with the contents of the high
-                         * byte of Timer0 during a read of TMR0L.
-                         * This provides the ability to read all 16 bits of
-                         * Timer0 without having to verify that the read of the high
-                         * and low byte were valid, due to a rollover between
-                         * successive reads of the high and low byte. */
+    /* Clear all interuppts. */
 
-                        /* First read the low byte of the timer, which will buffer
-                         * the high byte. */
+    // HOURS
+    INTCONbits.INT0IF = 0;   // Clear INT0 Flag
+  #if APP_WATCH_ANY_PULSAR_MODEL==APP_WATCH_PULSAR_AUTO_SET
+    INTCONbits.INT0IE = 0;   // Disable INT0
+  #else
+    INTCONbits.INT0IE = 1;   // Enable INT0
+  #endif // #if APP_WATCH_ANY_PULSAR_MODEL!=APP_WATCH_PULSAR_AUTO_SET
 
-                        const unsigned char ulow = TMR0L;
+    // MIN / WRIST FLICK
+    INTCON3bits.INT1IF = 0;  // Clear INT1 Flag
+  #if APP_WATCH_ANY_PULSAR_MODEL==APP_WATCH_PULSAR_AUTO_SET
+   #if APP_WRIST_FLICK_USAGE==1
+    INTCON3bits.INT1IE = 1;  // Enable INT1
+   #else
+    INTCON3bits.INT1IE = 0;  // Disable INT1
+   #endif
+  #else
+    INTCON3bits.INT1IE = 1;  // Enable INT1
+  #endif
 
-                        /* Read now the buffered high byte of the timer, that
-                         * had been stored, when the low byte had been read. */
+    // DATE
+    INTCON3bits.INT2IF = 0;  // Clear INT2 Flag
+    INTCON3bits.INT2IE = 1;  // Enable INT2
 
-                        const unsigned char uhigh = TMR0H;
+    // TIME
+    INTCON3bits.INT3IF = 0;  // Clear INT3 Flag
+    INTCON3bits.INT3IE = 1;  // Enable INT3
 
-                        itimer = ulow | (uhigh << 8);
-                    }
+#if APP_BUZZER_ALARM_USAGE==1
 
-                    /* Check if the long (hold) debounce timer has been expired.
-                     * Use signed values to take mathimatical a rollover in account.
-                     * This will work as long as the time span is lower than the
-                     * half of the timer's range. */
+    /* PERIPHERAL INTERRUPT REQUEST (FLAG) REGISTER 3 */
 
-                    short ltime = T0_REPEAT_SLOW;
+    PIR3bits.RTCCIF = 0;    // No RTCC interrupt occurred.
 
-                    switch(ibtns)
-                    {
-                        case 0: // TIME
-                     #if APP_WATCH_ANY_PULSAR_MODEL == APP_WATCH_PULSAR_AUTO_SET
-                            if (g_uDispState >= DISP_STATE_AUTOSET_TIME)
-                            {
-                                ltime = T0_REPEAT_QUICK;
-                            }
-                     #endif
-                     #if APP_ONE_TIME_BUTTON_OPERATION
-                            if ((g_uDispState == DISP_STATE_DATE) || \
-                                (g_uDispState == DISP_STATE_WEEKDAY) || \
-                                (g_uDispState == DISP_STATE_YEAR))
-                            {
-                                ltime = T0_HOLD;
-                            }
-                     #endif
-                        break;
+    /* Enable the Alarm interrupt, if the alarm had been enabled. */
 
-                        case 1: // DATE
-                     #if APP_WATCH_ANY_PULSAR_MODEL == APP_WATCH_PULSAR_AUTO_SET
-                            if (g_uDispState >= DISP_STATE_AUTOSET_TIME)
-                            {
-                                ltime = T0_REPEAT_QUICK;
-                            }
-                            else
-                            {
-                                ltime = T0_HOLD;
-                            }
-                     #else
-                            ltime = T0_HOLD;
-                     #endif
-                        break;
+    PIE3bits.RTCCIE = ALRMCFGbits.ALRMEN ? 1 : 0;
 
-                        case 2: // HOUR
-                        case 3: // MINUTE
-                            ltime = T0_REPEAT_QUICK;
-                        break;
+#endif // #if APP_BUZZER_ALARM_USAGE==1
 
-                        default:
-                        break;
-                    }
+#if APP_STOPWATCH_USAGE==1
 
-                    /* Check if the long-press time has expired.
-                     * If yes, recharge the timer again. */
-                    
-                    if ((itimer - (*ptimer + (ltime))) >= 0)
-                    {
-                        *ptimer = itimer;
+    /* The overflows of timer 1 are caught up from the RTC, while the
+     * stopwatch is running. With the RTC stopped, wake up on each of them
+     * to count it. */
 
-                        /* Call the hold handler for this button. */
+    PIE1bits.TMR1IE = g_ucStopwatchRunning && !RTCCFGbits.RTCEN;
 
-                        if (phold)
-                        {
-                            (*phold)();
-                        }
-                    }
+    Anchor_Stopwatch();
 
-                    /* As long as another button is still
-                     * using the timer, do not enter
-                     * deep sleep mode. */
+#endif // #if APP_STOPWATCH_USAGE==1
 
-                    istayawake = 1;
+    Enable_Interrupts();
 
-                    /* Continue checking the next button. */
+    /* Double check the TIME & DATE buttons to be low. Otherwise we
+     * may fail to detect a rising edge. */
 
-                    break;
+#if APP_WATCH_ANY_PULSAR_MODEL==APP_WATCH_PULSAR_AUTO_SET
 
-                    case PB_STATE_RELEASED:
+    if ((!PB0 /*TIME*/) && (!PB1 /*DATE*/))
 
-                    /* If the button was held and then was dropped
-                     * but actually was turned on again within the
-                     * debounce time for dropping, go back to the
-                     * held state again. */
+#else
 
-                    *pstate = PB_STATE_LONG_PRESS;
+    if ((!PB0 /*TIME*/) && (!PB1 /*DATE*/) && (!PB2 /*HOUR*/) && (!PB3 /*MIN*/))
 
-                    /* As long as another button is still
-                     * pressed, do not enter
-                     * deep sleep mode. */
+#endif        
 
-                    istayawake = 1;
+    {
+        /* Sleep vs. deep sleep mode. */
 
-                    /* Continue checking the next button. */
+        OSCCONbits.IDLEN = 0;     // Disable deep sleep.
+        DSCONHbits.DSEN = 0;      // Must be set to 1 DS just before Sleep();
 
-                    break;
+        Sleep();
+    }
 
-                    default:
-                    break;
-                }
-            }
-            else // if (ubutton)
-            {
-                /* If the button has been released or is not pressed at all
-                 * return zero to indicate, that it would be safe to enter deep
-                 * sleep again. */
+  #if APP_STOPWATCH_USAGE==1
 
-                switch(*pstate)
-                {
-                    /* The button has not been pressed and the state machine
-                     * is idle. */
+    Catch_Up_Stopwatch();
 
-                    case PB_STATE_IDLE:
+  #endif // #if APP_STOPWATCH_USAGE==1
+}
 
-                    /* Continue checking the next button. */
+#if APP_BUZZER_ALARM_USAGE==1
 
-                    break;
+/**
+ * This function will turn the alarm buzzer on again.
+ *
+ * @param duration  Duration in seconds.
+ */
 
-                    /* If the button was on debouncing for a peak up
-                     * and the signal peaked down again, dismiss the
-                     * debouncing process. */
+void Turn_Buzzer_On(unsigned char duration)
+{
+    /* Set the display state to time reading. */
 
-                    case PB_STATE_DEBOUNCING:
+    if (g_uDispState == DISP_STATE_BLANK)
+    {
+        g_uDispState = DISP_STATE_TIME;
+    }
 
-                    *pstate = PB_STATE_IDLE;
+    /* Turn the 'stay awake' timer on, if activating the buzzer. */
 
-                    /* Indicate that this button is not using the timer anymore. */
+    g_ucTimer2Usage = 1;    // Indicate using the timer.
+    TMR2 = 0;               // Zero the timer.
+    T2CONbits.TMR2ON = 1;   // Turn timer 2 on.
 
-                    *pusage &= ~(1 << ibtns);
+    Start_Melody(g_alarm_melody, duration);
+}
 
-                    /* If this was the last button using the timer, stop the timer. */
+/**
+ * This function will start a melody on the alarm buzzer, without turning
+ * the display on.
+ *
+ * @param pmelody   Melody to play.
+ * @param duration  Duration in seconds.
+ */
 
-                    if (!(*pusage))
-                    {
-                        /* Stop the debouncing timer used. */
+void Start_Melody(const MelodyStepType *pmelody, unsigned char duration)
+{
+    /* Keep the interrupt routine off the melody, while it is set up. */
 
-                        T0CONbits.TMR0ON = 0;
-                    }
-                    else
-                    {
-                        /* As long as another button is still
-                         * using the timer, do not enter
-                         * deep sleep mode. */
+    PIE2bits.TMR3IE = 0;
 
-                        istayawake = 1;
-                    }
+    /* Alarm counter used to keep the buzzer on. */
 
-                    /* Continue checking the next button. */
+    g_ucAlarm = duration;
 
-                    break;
+    /* Start the melody from its first step, timed by timer 3. */
 
-                    case PB_STATE_SHORT_PRESS:
+    TMR3H = 0;
+    TMR3L = 0;
 
-                    *pstate = PB_STATE_IDLE;
+    g_pMelody = pmelody;
+    g_uMelodyLast = 0;
+    g_slMelodyLeft = pmelody[0].duration * MELODY_TICKS_PER_MS;
+    g_slAlarmSecondLeft = MELODY_TICKS_PER_SECOND;
 
-                    /* Indicate that this button is not using the timer anymore. */
+    Arm_Melody_Timer();
 
-                    *pusage &= ~(1 << ibtns);
+    T3CONbits.TMR3ON = 1;
 
-                    /* If this was the last button using the timer,
-                     * stop the timer. */
+    Play_Melody_Step(0);
 
-                    if (!(*pusage))
-                    {
-                        /* Stop the debouncing timer used. */
+    PIE2bits.TMR3IE = 1;
+}
 
-                        T0CONbits.TMR0ON = 0;
-                    }
-                    else
-                    {
-                        /* As long as another button is still
-                         * using the timer, do not enter
-                         * deep sleep mode. */
+/**
+ * Let timer 3 overflow, once the step of the melody or the second of the
+ * alarm is over, whichever comes first. Service_Melody() counts the ticks
+ * elapsed from g_uMelodyLast, which is moved along with the value loaded.
+ */
 
-                        istayawake = 1;
-                    }
+void Arm_Melody_Timer(void)
+{
+    signed long slnext = g_slMelodyLeft;
+    signed long slstart;
+    unsigned short unow;
 
-                    /* Call the hold handler for this button. */
+    if (g_slAlarmSecondLeft < slnext)
+    {
+        slnext = g_slAlarmSecondLeft;
+    }
 
-                    if (preleased)
-                    {
-                        (*preleased)();
-                    }
+    /* A second is longer than the timer, which is serviced early then. */
 
-                    /* Continue checking the next button. */
+    if (slnext > 0xFFFF)
+    {
+        slnext = 0xFFFF;
+    }
 
-                    break;
+    /* Keep the ticks elapsed since the last count and those passing until
+     * the timer is loaded, which also clears the prescaler. Reading the
+     * low byte buffers the high byte. */
 
-                    /* If the button is not pressed anymore, but was hold
-                     * down before for a while, debounce the dropping as well. */
+    unow = TMR3L;
+    unow |= (unsigned short)TMR3H << 8;
 
-                    case PB_STATE_LONG_PRESS:
+    slstart = 0x10000L - slnext + (unsigned short)(unow - g_uMelodyLast) + \
+              MELODY_LOAD_TICKS;
 
-                    *pstate = PB_STATE_RELEASED;
+    if (slstart > 0xFFFF)
+    {
+        slstart = 0xFFFF;
+    }
 
-                    /* Start the timer, if not started yet by any other button. */
+    g_uMelodyLast = (unsigned short)(0x10000L - slnext);
 
-                    if (!(*pusage))
-                    {
-                        /* Zero timer */
+    /* The high byte is buffered until the low byte is written. */
 
-                        TMR0H = 0;
-                        TMR0L = 0;
+    TMR3H = (unsigned char)(slstart >> 8);
+    TMR3L = (unsigned char)slstart;
 
-                        /* Turn tmer 0 on. */
+    PIR2bits.TMR3IF = 0;
+}
 
-                        T0CONbits.TMR0ON = 1;
+/**
+ * High priority interrupt routine. The overflow of timer 3 is due at the
+ * next step of the melody or second of the alarm, so the melody keeps its
+ * timing however long a pass of the main loop takes. INT0 is always high
+ * priority, its flag only wakes the controller up.
+ */
 
-                        /* Set the start timer value for this button. */
+void __interrupt(high_priority) High_Priority_Isr(void)
+{
+    if ((PIE2bits.TMR3IE) && (PIR2bits.TMR3IF))
+    {
+        PIR2bits.TMR3IF = 0;
 
-                        *ptimer = 0;
-                    }
-                    else
-                    {
-                        /* Read out the start timer value for this button,
-                         * if the timer is already running, triggered by
-                         * another button already using it.
-                         *
-                         * TMR0H is not the actual high byte of Timer0 in 16-bit
-                         * mode. It is actually a buffered version of the real high
-                         * byte of Timer0, which is not directly readable nor
-                         * writable. TMR0H is updated with the contents of the high
-                         * byte of Timer0 during a read of TMR0L.
-                         * This provides the ability to read all 16 bits of
-                         * Timer0 without having to verify that the read of the high
-                         * and low byte were valid, due to a rollover between
-                         * successive reads of the high and low byte. */
+        Service_Melody();
 
-                        /* First read the low byte of the timer, which will buffer
-                         * the high byte. */
+        if (g_ucAlarm)
+        {
+            Arm_Melody_Timer();
+        }
+    }
 
-                        const unsigned char ulow = TMR0L;
+    INTCONbits.INT0IF = 0;
+}
 
-                        /* Read now the buffered high byte of the timer, that
-                         * had been stored, when the low byte had been read. */
+/**
+ * This function will play a tone on the alarm buzzer.
+ *
+ * @param uperiod  Period of timer 4.
+ * @param uduty    Duty cycle in eighths of the period, zero is quiet.
+ */
 
-                        const unsigned char uhigh = TMR0H;
+void Play_Tone(unsigned char uperiod, unsigned char uduty)
+{
+    /* Deactivate PWM mode PxA and PxC active-high; PxB and PxD active-high */
 
-                        *ptimer = ulow | (uhigh << 8);
-                    }
+    CCP1CONbits.CCP1M = 0;
 
-                    /* Indicate that this button is using the timer. */
+    /* Turn timer 4 as PWM source off. */
 
-                    *pusage |= 1 << ibtns;
+    T4CONbits.TMR4ON = 0;
 
-                    /* Return none-zero to indicate not to enter
-                     * deep sleep mode. */
+    /* Keep quiet for a rest. */
 
-                    istayawake = 1;
+    if (!uduty)
+    {
+        return;
+    }
 
-                    /* Continue checking the next button. */
+    /* Single output: PxA, PxB, PxC and PxD controlled by steering. */
 
-                    break;
+    CCP1CONbits.P1M1 = 0;
+    CCP1CONbits.P1M0 = 0;
 
-                    /* If the button has been dropped and was hold, before,
-                     * debounce the dropping of the button as well. */
+    /* At 1MHz as FOSC/4 and a timer 4 pre-scaler of 16 the period is
+     * (PR4+1)*16us, the duty cycle CCPR1L*16us. */
 
-                    case PB_STATE_RELEASED:
+    PR4bits.PR4 = uperiod; // We are using timer 4 for the PWM!
 
-                    /* Read out the timer value. */
+    CCP1CONbits.DC1B = 0;    // Lower 2 bit
+    CCPR1Lbits.CCPR1L = (unsigned char)(((unsigned short)(uperiod + 1) * uduty) >> 3);  // Upper 8 Bit
 
-                    {
-                        /* TMR0H is not the actual high byte of Timer0 in 16-bit
-                         * mode. It is actually a buffered version of the real high
-                         * byte of Timer0, which is not directly readable nor
-                         * writable. TMR0H is updated with the contents of the high
-                         * byte of Timer0 during a read of TMR0L.
-                         * This provides the ability to read all 16 bits of
-                         * Timer0 without having to verify that the read of the high
-                         * and low byte were valid, due to a rollover between
-                         * successive reads of the high and low byte. */
+    /* Turn timer 4 as PWM source. */
 
-                        /* First read the low byte of the timer, which will buffer
-                         * the high byte. */
+    T4CONbits.TMR4ON = 1;
 
-                        const unsigned char ulow = TMR0L;
+    /* Activate PWM mode PxA and PxC active-high; PxB and PxD active-high */
 
-                        /* Read now the buffered high byte of the timer, that
-                         * had been stored, when the low byte had been read. */
+    CCP1CONbits.CCP1M = 0xC;
+}
 
-                        const unsigned char uhigh = TMR0H;
+/**
+ * This function will turn the alarm buzzer off again.
+ */
 
-                        itimer = ulow | (uhigh << 8);
-                    }
+inline void Turn_Buzzer_Off(void)
+{
+    /* Stop the interrupt routine servicing the melody. */
 
-                    /* Check if the long (hold) debounce timer for dropping
-                     * the button has been expired.
-                     * Use signed values to take mathimatical a rollover in account.
-                     * This will work as long as the time span is lower than the
-                     * half of the timer's range. */
+    PIE2bits.TMR3IE = 0;
 
-                    if ((itimer - (*ptimer + T0_DEBOUNCE)) >= 0)
-                    {
-                        /* Indicate that this button is using the timer
-                         * not anymore. */
+    /* Zero the Alarm counter used to keep the buzzer on. */
 
-                        *pusage &= ~(1 << ibtns);
+    g_ucAlarm = 0;
 
-                        /* Check if any other button is not using the
-                         * timer anymore. Then it is safe to turn it off. */
+    /* Deactivate PWM mode PxA and PxC active-high; PxB and PxD active-high */
 
-                        if (!(*pusage))
-                        {
-                            /* Stop the debouncing timer used. */
+    CCP1CONbits.CCP1M = 0;
 
-                            T0CONbits.TMR0ON = 0;
-                        }
-                        else
-                        {
-                            /* As long as another button is still
-                             * using the timer, do not enter
-                             * deep sleep mode. */
+    /* Turn timer 4 off again. */
 
-                            istayawake = 1;
-                        }
+    T4CONbits.TMR4ON = 0;
 
-                        /* Set the state machine for the button back to 'idle. */
+    /* Stop timing the melody and end the service mode. */
 
-                        *pstate = PB_STATE_IDLE;
+    T3CONbits.TMR3ON = 0;
 
-                        /* Call the hold handler for this button. */
+    g_ucPiezoSweep = PIEZO_SWEEP_OFF;
+}
 
-                        if (preleased)
-                        {
-                            (*preleased)();
-                        }
+/**
+ * This function will play a step of the melody started.
+ *
+ * @param ustep  Step of the melody.
+ */
 
-                        /* Continue checking the next button. */
-                    }
-                    else // if ((itimer - (*ptimer + T0_DEBOUNCE)) >= 0)
-                    {
-                        /* As long as another button is still
-                         * using the timer, do not enter
-                         * deep sleep mode. */
+void Play_Melody_Step(unsigned char ustep)
+{
+    const MelodyStepType *pstep = &g_pMelody[ustep];
+    signed short speriod = (signed short)g_ucPiezoPeriod + pstep->offset;
 
-                        istayawake = 1;
-                    }
-                    break;
+    g_ucMelodyStep = ustep;
 
-                    default:
-                    break;
-                }
-            }
-        } // if (pstate)
+    if (speriod < PIEZO_PERIOD_MIN)
+    {
+        speriod = PIEZO_PERIOD_MIN;
+    }
+    else if (speriod > PIEZO_PERIOD_MAX)
+    {
+        speriod = PIEZO_PERIOD_MAX;
     }
-    while(++ibtns < imaxb);
-
-    /* Return none-zero to indicate not to enter
-     * deep sleep mode. */
 
-    return (istayawake);
+    Play_Tone((unsigned char)speriod, pstep->duty);
 }
 
 /**
- * Called when button 0 TIME has been pressed.
+ * Advance the melody and count down the alarm duration by the time
+ * elapsed on timer 3 since it has been armed, called by the interrupt
+ * routine on its overflow. Turns the buzzer off, once the alarm duration
+ * has expired or a melody played once is over.
  */
 
-void PressPB0(void)
+void Service_Melody(void)
 {
-  #if APP_BUZZER_ALARM_USAGE==1
+    const MelodyStepType *pmelody = g_pMelody;
+    unsigned short unow;
+    unsigned short uelapsed;
+    unsigned char ustep = g_ucMelodyStep;
 
-    /* Check if the alarm buzzer is still active. */
+    /* Reading the low byte buffers the high byte. */
 
-    if (g_ucAlarm)
+    unow = TMR3L;
+    unow |= (unsigned short)TMR3H << 8;
+
+    uelapsed = unow - g_uMelodyLast;
+    g_uMelodyLast = unow;
+
+    /* Count down the seconds of the alarm. */
+
+    g_slAlarmSecondLeft -= uelapsed;
+
+    while (g_slAlarmSecondLeft <= 0)
     {
-        Turn_Buzzer_Off();
+        g_slAlarmSecondLeft += MELODY_TICKS_PER_SECOND;
+
+        if (!--g_ucAlarm)
+        {
+            Turn_Buzzer_Off();
+
+            return;
+        }
     }
 
-  #endif
+    /* Move on to the next step, once this one is over. */
 
-    const DisplayStateType istate = g_uDispState;
+    g_slMelodyLeft -= uelapsed;
 
-    /* If using the Pulsar Autoset button mode, there
-     * are two button press counters for the TIME and DATE
-     * buttons, that are reset, when the display is turned off. */
+    if (g_slMelodyLeft > 0)
+    {
+        return;
+    }
 
-  #if APP_WATCH_ANY_PULSAR_MODEL == APP_WATCH_PULSAR_AUTO_SET
+    /* The service mode sweeps the period instead of playing the melody. */
 
-    if (istate == DISP_STATE_AUTOSET_DATE)
+    if (g_ucPiezoSweep)
     {
-        /* Restart the time, the display will stay lit up. */
+        g_slMelodyLeft += PIEZO_STEP_MS * MELODY_TICKS_PER_MS;
 
-        g_ucRollOver = 1;
+        if (g_ucPiezoSweep == PIEZO_SWEEP_AUTO)
+        {
+            Step_Piezo_Sweep(1);
+        }
 
-        /* Unlock write access to the RTC and disable the clock. */
+        return;
+    }
 
-        Unlock_RTCC();
+    do // while(g_slMelodyLeft <= 0);
+    {
+        if (!pmelody[++ustep].duration)
+        {
+            if (pmelody[ustep].duty == MELODY_DUTY_STOP)
+            {
+                Turn_Buzzer_Off();
+
+                return;
+            }
+
+            ustep = 0;
+        }
+
+        g_slMelodyLeft += pmelody[ustep].duration * MELODY_TICKS_PER_MS;
+    }
+    while(g_slMelodyLeft <= 0);
+
+    Play_Melody_Step(ustep);
+}
+
+/**
+ * Restore the period at the resonance of the piezo, if the deep sleep
+ * registers hold one, which is checked by its complement.
+ */
 
-        /* Enable writing to the RTC */
+void Load_Piezo_Period(void)
+{
+    const unsigned char uperiod = DSGPR0;
+    const unsigned char ucheck = ~uperiod;
+
+    if ((DSGPR1 == ucheck) && \
+        (uperiod >= PIEZO_PERIOD_MIN) && (uperiod <= PIEZO_PERIOD_MAX))
+    {
+        g_ucPiezoPeriod = uperiod;
+    }
+}
 
-        RTCCFGbits.RTCWREN = 1;
+/**
+ * Start the service mode, sweeping the period of the buzzer upwards from
+ * the highest tone, one step each PIEZO_STEP_MS.
+ */
 
-        /* Stop RTC operation. */
+void Start_Piezo_Sweep(void)
+{
+    Turn_Buzzer_On(PIEZO_SWEEP_SECONDS);
 
-        RTCCFGbits.RTCEN = 0;
+    /* Time the first step of the sweep instead of the melody. */
 
-        unsigned char ucExtra;
-        unsigned char ucTemp;
-        unsigned char ucValue;
+    PIE2bits.TMR3IE = 0;
 
-     #if (APP_WATCH_TYPE_BUILD==APP_PULSAR_WRIST_WATCH_12H_LEGACY_MOD) || \
-         (APP_WATCH_TYPE_BUILD==APP_PULSAR_P3_WRIST_WATCH_12H_ODIN_MARK_II_MOD) || \
-         (APP_WATCH_TYPE_BUILD==APP_PULSAR_WRIST_WATCH_12H_SIF_LEGACY_MOD) || \
-         (APP_WATCH_TYPE_BUILD==APP_PULSAR_P4_WRIST_WATCH_12H_SIF_MARK_II_MOD)
+    g_ucPiezoSweep = PIEZO_SWEEP_AUTO;
+    g_ucPiezoCandidate = PIEZO_PERIOD_MIN;
+    g_slMelodyLeft = PIEZO_STEP_MS * MELODY_TICKS_PER_MS;
 
-        ucExtra = 1;
+    Arm_Melody_Timer();
 
-        /* On every second cycle change betwen AM and PM and otherwise
-         * forward the day. */
+    Play_Tone(PIEZO_PERIOD_MIN, MELODY_DUTY_HALF);
 
-        RTCCFGbits.RTCPTR0 = 1;
-        RTCCFGbits.RTCPTR1 = 0;
+    PIE2bits.TMR3IE = 1;
+}
 
-        ucTemp = RTCVALL;
-        ucValue = g_bcd_decimal[ucTemp];
+/**
+ * Step the period tried by the service mode, turning around at the ends.
+ *
+ * @param sdelta  Steps to move the period.
+ */
 
-        if (ucValue < 12)
-        {
-            /* AM -> PM */
+void Step_Piezo_Sweep(signed char sdelta)
+{
+    unsigned char uperiod = (unsigned char)(g_ucPiezoCandidate + sdelta);
 
-            ucValue += 12;
+    if (uperiod > PIEZO_PERIOD_MAX)
+    {
+        uperiod = PIEZO_PERIOD_MIN;
+    }
+    else if (uperiod < PIEZO_PERIOD_MIN)
+    {
+        uperiod = PIEZO_PERIOD_MAX;
+    }
 
-            ucTemp = g_decimal_bcd[ucValue];
-            RTCVALL = ucTemp;
+    g_ucPiezoCandidate = uperiod;
 
-            /* Do not forward the day. */
+    Play_Tone(uperiod, MELODY_DUTY_HALF);
+}
 
-            ucExtra = 0;
-        }
-        else
-        {
-            /* PM -> AM */
+/**
+ * Keep the period marked as the loudest one in the service mode. The deep
+ * sleep registers hold it through the resets of the controller, but not
+ * through a power-on reset when the battery is changed. The default period
+ * is used then, until the service mode is run again.
+ */
 
-            ucValue -= 12;
+void Store_Piezo_Period(void)
+{
+    const unsigned char uperiod = g_ucPiezoCandidate;
 
-            ucTemp = g_decimal_bcd[ucValue];
-            RTCVALL = ucTemp;
-        }
+    g_ucPiezoPeriod = uperiod;
 
-        if (ucExtra)
+    DSGPR0 = uperiod;
+    DSGPR1 = (unsigned char)~uperiod;
+}
 
-      #endif
+#if APP_ALARM_SCHEDULE_USAGE==1
 
-        {
-            /* Forward the day of month. */
+/**
+ * Get the minutes from now until the minute an entry of the alarm schedule
+ * is due. Zero if it is due later within the current minute, which only
+ * entries with seconds can be. The loop is bounded by eight days, so a
+ * weekday of the mask is always found.
+ *
+ * @param palarm    Entry of the alarm schedule.
+ * @param unow      Current minute of the day 0..1439.
+ * @param useconds  Current seconds as BCD.
+ * @param uweekday  Current weekday 0..6.
+ * @return          Minutes until being due or ALARM_MINUTES_NONE.
+ */
 
-            RTCCFGbits.RTCPTR0 = 0;
-            RTCCFGbits.RTCPTR1 = 1;
-            //while(RTCCFGbits.RTCSYNC);
+unsigned short Minutes_Until_Alarm(const AlarmEntryType *palarm,
+                                   unsigned short unow,
+                                   unsigned char useconds,
+                                   unsigned char uweekday)
+{
+    unsigned short ubase = 0;
+    unsigned short utime;
+    unsigned char uday = 0;
 
-            ucTemp = RTCVALL; // day
-            ucValue = 1 + g_bcd_decimal[ucTemp];
+    if (!(palarm->flags & ALARM_FLAG_ENABLED))
+    {
+        return ALARM_MINUTES_NONE;
+    }
 
-            ucTemp = RTCVALH; // month
-            ucExtra = g_bcd_decimal[ucTemp];
+    do // while(++uday < 8);
+    {
+        if (palarm->weekdays & (1 << uweekday))
+        {
+            utime = ubase + BCD_TO_DECIMAL(palarm->minutes);
 
-            if (ucExtra == 2) // February, always assume it to be a leap year.
+            if (palarm->flags & ALARM_FLAG_HOURLY)
             {
-                /* Assume february to have 29 days to support leap years. */
+                /* Forward to the first full hour after now. */
 
-                if (ucValue >= 30) // 29 days (leap year)
+                if (utime <= unow)
                 {
-                    ucValue = 1;
+                    utime += ((unow - utime) / 60 + 1) * 60;
                 }
-            }
-            else if ((ucExtra == 1) || (ucExtra == 3) || (ucExtra == 5) || \
-                     (ucExtra == 7) || (ucExtra == 8) || (ucExtra == 10) || \
-                     (ucExtra == 12))
-            {
-                if (ucValue >= 32) // 31 days
+
+                if (utime < ubase + ALARM_MINUTES_PER_DAY)
                 {
-                    ucValue = 1;
+                    return utime - unow;
                 }
             }
             else
             {
-                if (ucValue >= 31) // 30 days
+                utime += BCD_TO_DECIMAL(palarm->hours) * 60;
+
+                if ((utime > unow) || \
+                    ((utime == unow) && (palarm->seconds > useconds)))
                 {
-                    ucValue = 1;
+                    return utime - unow;
                 }
             }
+        }
 
-            RTCCFGbits.RTCPTR0 = 0;
-            RTCCFGbits.RTCPTR1 = 1;
+        ubase += ALARM_MINUTES_PER_DAY;
 
-            ucTemp = g_decimal_bcd[ucValue];
-            RTCVALL = ucTemp;
+        if (++uweekday > 6)
+        {
+            uweekday = 0;
         }
+    }
+    while(++uday < 8);
 
-        /* Enable the RTC operation again.*/
+    return ALARM_MINUTES_NONE;
+}
 
-        RTCCFGbits.RTCEN = 1;
+/**
+ * Program the entry of the alarm schedule due next into the RTCC alarm,
+ * or turn the alarm off, if no entry is enabled. The alarm repeats once a
+ * week, so it is due on the weekday, hour, minute and second written only.
+ */
 
-        /* Lock writing to the RTCC. */
+void Schedule_Next_Alarm(void)
+{
+    unsigned short unow;
+    unsigned short unext = ALARM_MINUTES_NONE;
+    unsigned short uminutes;
+    unsigned char useconds = 0;
+    unsigned char ucDue = 0;
+    unsigned char uweekday;
+    unsigned char ientry = 0;
 
-        Lock_RTCC();
-    }
-    else if (istate == DISP_STATE_AUTOSET_TIME)
+    Read_RTCC_Snapshot();
+
+    unow = BCD_TO_DECIMAL(g_rtcc.hours) * 60 + BCD_TO_DECIMAL(g_rtcc.minutes);
+    uweekday = g_rtcc.weekday;
+
+    /* Find the entries due next. */
+
+    do // while(++ientry < ALARM_SCHEDULE_SIZE);
     {
-        /* Restart the time, the display will stay lit up. */
-        
-        g_ucRollOver = 1;
+        const AlarmEntryType *palarm = &g_alarms[ientry];
 
-        /* Unlock write access to the RTC and disable the clock. */
+        uminutes = Minutes_Until_Alarm(palarm, unow, g_rtcc.seconds, uweekday);
 
-        Unlock_RTCC();
+        if ((uminutes < unext) || \
+            ((uminutes == unext) && (palarm->seconds < useconds)))
+        {
+            unext = uminutes;
+            useconds = palarm->seconds;
+            ucDue = 0;
+        }
 
-        /* Enabling writing to the RTC. */
+        if ((uminutes == unext) && (palarm->seconds == useconds) && \
+            (uminutes != ALARM_MINUTES_NONE))
+        {
+            ucDue |= 1 << ientry;
+        }
+    }
+    while(++ientry < ALARM_SCHEDULE_SIZE);
 
-        RTCCFGbits.RTCWREN = 1;
+    /* The alarm registers must not be written while being enabled. */
 
-        /* Stop the RTC */
+    ALRMCFGbits.ALRMEN = 0;
+    PIE3bits.RTCCIE = 0;
+    PIR3bits.RTCCIF = 0;
 
-        RTCCFGbits.RTCEN = 0;
+    g_ucAlarmsDue = ucDue;
 
-        /* Set the RTC register to read/write. */
+    if (!ucDue)
+    {
+        return;
+    }
 
-        RTCCFG &= ~3;
+    /* Turn the minutes into the weekday, hour and minute being due. */
 
-        /* Forward the minutes. */
+    unext += unow;
 
-        unsigned char ucTemp = RTCVALH;
-        unsigned char ucValue = 1 + g_bcd_decimal[ucTemp];
+    while (unext >= ALARM_MINUTES_PER_DAY)
+    {
+        unext -= ALARM_MINUTES_PER_DAY;
 
-        if (ucValue >= 60)
+        if (++uweekday > 6)
         {
-            ucValue = 0;
+            uweekday = 0;
         }
+    }
 
-        /* Set the RTC register to read/write. */
+    while(RTCCFGbits.RTCSYNC);
 
-        ucTemp = g_decimal_bcd[ucValue];
-        RTCVALH = ucTemp;
+    ALRMCFG = (ALRMCFG & ~3) | 1;
 
-        /* Set seconds to zero. */
+    ALRMVALL = DECIMAL_TO_BCD((unsigned char)(unext / 60)); // Hours
+    ALRMVALH = uweekday; // Weekday, auto-decrement!
+    ALRMVALL = useconds; // Seconds
+    ALRMVALH = DECIMAL_TO_BCD((unsigned char)(unext % 60)); // Minutes
 
-        RTCVALL = 0; // Zero the second when forwarding the minute.
+    ALRMCFGbits.AMASK = 0x07; // Alarm repeats every week.
+    ALRMCFGbits.CHIME = 0;
+    ALRMRPT = 0;
 
-        /* Enable the RTC operation again.*/
+    ALRMCFGbits.ALRMEN = 1;
+    PIE3bits.RTCCIE = 1;
+}
 
-        RTCCFGbits.RTCEN = 1;
+/**
+ * Called when the RTCC alarm has been due. Disables the one-shot entries
+ * due and arms the entry due next.
+ *
+ * @return  Duration in ticks to turn the alarm buzzer on, zero if none.
+ */
 
-        /* Lock writing to the RTCC. */
+unsigned char Handle_Alarm_Due(void)
+{
+    unsigned char uduration = 0;
+    unsigned char ientry = 0;
 
-        Lock_RTCC();
-        
-        /* Indicate to zero the seconds and stall the watch. */
-        
-        g_ucTimePressCnt = HINT_AUTOSET_MINUTES_SET;
-    }
-    else if (istate == DISP_STATE_AUTOSET_WEEKDAY)
+    do // while(++ientry < ALARM_SCHEDULE_SIZE);
     {
-        /* Restart the time, the display will stay lit up. */
-        
-        g_ucRollOver = 1;
+        if (g_ucAlarmsDue & (1 << ientry))
+        {
+            if (g_alarms[ientry].flags & ALARM_FLAG_ONE_SHOT)
+            {
+                g_alarms[ientry].flags &= ~ALARM_FLAG_ENABLED;
+            }
 
-        /* Unlock write access to the RTC and disable the clock. */
+            /* Show the countdown expired, while the alarm rings. */
 
-        Unlock_RTCC();
+            if (ientry == ALARM_ENTRY_COUNTDOWN)
+            {
+                g_uDispState = DISP_STATE_COUNTDOWN_EXPIRED;
+            }
 
-        /* Enabling writing to the RTC. */
+            if (!(g_alarms[ientry].flags & ALARM_FLAG_CHIME))
+            {
+                uduration = ALARM_DURATION_ALARM;
+            }
+            else if (!uduration)
+            {
+                uduration = ALARM_DURATION_CHIME;
+            }
+        }
+    }
+    while(++ientry < ALARM_SCHEDULE_SIZE);
 
-        RTCCFGbits.RTCWREN = 1;
+    Schedule_Next_Alarm();
 
-        /* Stop the RTC */
+    return uduration;
+}
 
-        RTCCFGbits.RTCEN = 0;
+/**
+ * Sound the hourly chime while the watch is asleep. The chime melody is
+ * started on the melody sequencer, the display and the 'stay awake' timer
+ * are left off, so the watch goes back to sleep once it is over.
+ */
 
-        /* Set the RTC register to read/write. */
+void Sound_Chime(void)
+{
+    Start_Melody(g_chime_melody, ALARM_DURATION_CHIME);
 
-        RTCCFGbits.RTCPTR0 = 1;
-        RTCCFGbits.RTCPTR1 = 0;
-        //while(RTCCFGbits.RTCSYNC);
+    g_uChimeCount++;
+}
 
-        /* Backward the weekday. */
+/**
+ * Start the countdown with the time preset, by setting the countdown entry
+ * of the alarm schedule to the absolute time it expires. A preset of zero
+ * cancels the countdown.
+ */
 
-        unsigned char ucTemp = RTCVALH;
-        unsigned char ucValue = (ucTemp & 7);
+void Start_Countdown(void)
+{
+    AlarmEntryType *palarm = &g_alarms[ALARM_ENTRY_COUNTDOWN];
+    unsigned short utarget;
+    unsigned char uweekday;
 
-        if (!ucValue)
-        {
-            ucValue = 6;
-        }
-        else
+    utarget = BCD_TO_DECIMAL(g_ucCountdownHours) * 60 +
+              BCD_TO_DECIMAL(g_ucCountdownMinutes);
+
+    palarm->flags &= ~ALARM_FLAG_ENABLED;
+
+    if (utarget)
+    {
+        Read_RTCC_Snapshot();
+
+        utarget += BCD_TO_DECIMAL(g_rtcc.hours) * 60 +
+                   BCD_TO_DECIMAL(g_rtcc.minutes);
+
+        uweekday = g_rtcc.weekday;
+
+        if (utarget >= ALARM_MINUTES_PER_DAY)
         {
-            ucValue--;
+            utarget -= ALARM_MINUTES_PER_DAY;
+
+            if (++uweekday > 6)
+            {
+                uweekday = 0;
+            }
         }
 
-        /* As accessing the hi-byte will automatically decrement
-         * the address pointer, we have to set the address again, before
-         * writing the weekday. */
+        palarm->hours = DECIMAL_TO_BCD((unsigned char)(utarget / 60));
+        palarm->minutes = DECIMAL_TO_BCD((unsigned char)(utarget % 60));
+        palarm->seconds = g_rtcc.seconds;
+        palarm->weekdays = 1 << uweekday;
+        palarm->flags |= ALARM_FLAG_ENABLED;
+    }
 
-        RTCCFGbits.RTCPTR0 = 1;
+    Schedule_Next_Alarm();
+}
 
-        RTCVALH = ucValue;
+/**
+ * Get the seconds remaining until the countdown expires, zero if the
+ * countdown is not running. Reads the snapshot of the RTCC.
+ */
 
-        /* Enable the RTC operation again.*/
+unsigned long Countdown_Remaining(void)
+{
+    const AlarmEntryType *palarm = &g_alarms[ALARM_ENTRY_COUNTDOWN];
+    unsigned short uminutes;
 
-        RTCCFGbits.RTCEN = 1;
+    Read_RTCC_Snapshot();
 
-        /* Lock writing to the RTCC. */
+    uminutes = Minutes_Until_Alarm(palarm,
+        BCD_TO_DECIMAL(g_rtcc.hours) * 60 + BCD_TO_DECIMAL(g_rtcc.minutes),
+        g_rtcc.seconds, g_rtcc.weekday);
 
-        Lock_RTCC();
-    }
-    else if (istate == DISP_STATE_AUTOSET_YEAR)
+    if (uminutes == ALARM_MINUTES_NONE)
     {
-        /* Restart the time, the display will stay lit up. */
-        
-        g_ucRollOver = 1;
+        return 0;
+    }
 
-        /* Unlock write access to the RTC and disable the clock. */
+    return (unsigned long)uminutes * 60 + BCD_TO_DECIMAL(palarm->seconds) -
+           BCD_TO_DECIMAL(g_rtcc.seconds);
+}
 
-        Unlock_RTCC();
+#endif // #if APP_ALARM_SCHEDULE_USAGE==1
 
-        /* Enable writing to the RTC */
+#endif // #if APP_BUZZER_ALARM_USAGE==1
 
-        RTCCFGbits.RTCWREN = 1;
+/**
+ * Detect the buttons held together, before calling a button handler.
+ * A button counts as held, when it is pressed or still debouncing a press
+ * that started within the chord window. So the chord does not depend on
+ * the order, in which the debouncing of the buttons had been finished.
+ *
+ * @param   upress  None-zero, if called for a press handler, to measure
+ *                  the latency from the last button edge.
+ */
 
-        /* Stop RTC operation. */
+void Detect_Chord(unsigned char upress)
+{
+    ButtonStateType ustate;
+    short sedge;
+    short itimer;
 
-        RTCCFGbits.RTCEN = 0;
+    unsigned char ucChord = 0;
+    unsigned char ibtns = 0;
 
-        /* Set the RTC register to read/write. */
+    /* First read the low byte of the timer, which will buffer
+     * the high byte. */
 
-        RTCCFG |= 3;
-        //while(RTCCFGbits.RTCSYNC);
+    {
+        const unsigned char ulow = TMR0L;
 
-        /* Backward the year. */
+        /* Read now the buffered high byte of the timer, that
+         * had been stored, when the low byte had been read. */
+
+        const unsigned char uhigh = TMR0H;
+
+        itimer = ulow | (uhigh << 8);
+    }
 
-        unsigned char ucTemp = RTCVALL;
-        unsigned char ucValue = g_bcd_decimal[ucTemp];
+    short slatest = 0;
+    unsigned char uedge = 0;
 
-        if (!ucValue)
+    do // while(++ibtns < 4);
+    {
+        switch(ibtns)
         {
-            ucValue = 99;
+            case DEBOUNCE_INDEX_BUTTON_TIME: // 0
+                ustate = g_ucPB0TIMEState;
+                sedge = g_sPB0Timer;
+            break;
+
+            case DEBOUNCE_INDEX_BUTTON_DATE: // 1
+                ustate = g_ucPB1DATEState;
+                sedge = g_sPB1Timer;
+            break;
+
+            case DEBOUNCE_INDEX_BUTTON_HOUR: // 2
+                ustate = g_ucPB2HOURState;
+                sedge = g_sPB2Timer;
+            break;
+
+            default: // DEBOUNCE_INDEX_BUTTON_MIN
+                ustate = g_ucPB3MINTState;
+                sedge = g_sPB3Timer;
+            break;
         }
-        else
+
+        /* A button still debouncing only counts, if the press
+         * started within the chord window. */
+
+        if ((ustate == PB_STATE_DEBOUNCING) && \
+            ((short)(itimer - (sedge + T0_CHORD_WINDOW)) >= 0))
         {
-            ucValue--;
+            continue;
         }
 
-        ucTemp = g_decimal_bcd[ucValue];
-        RTCVALL = ucTemp;
+        if (ustate != PB_STATE_IDLE)
+        {
+            ucChord |= 1 << ibtns;
 
-        /* Enable the RTC operation again.*/
+            /* Remember the last edge of the buttons pressed recently.
+             * Use signed values to take mathimatical a rollover in account. */
 
-        RTCCFGbits.RTCEN = 1;
+            if (((ustate == PB_STATE_DEBOUNCING) || \
+                 (ustate == PB_STATE_SHORT_PRESS)) && \
+                ((!uedge) || ((short)(sedge - slatest) > 0)))
+            {
+                slatest = sedge;
+                uedge = 1;
+            }
+        }
+    }
+    while(++ibtns < 4);
 
-        /* Lock writing to the RTCC. */
+    g_ucChord = ucChord;
 
-        Lock_RTCC();
-    }
-    else if (istate == DISP_STATE_AUTOSET_CALIBRA)
+    /* Measure the decision latency of a chord, if at least two
+     * buttons are held together. */
+
+    if (upress && uedge && (ucChord & (ucChord - 1)))
     {
-        /* Restart the time, the display will stay lit up. */
-        
-        g_ucRollOver = 1;
+        g_sChordLatency = itimer - slatest;
 
-        /* Unlock write access to the RTC and disable the clock. */
+        if (g_sChordLatency > g_sChordLatencyMax)
+        {
+            g_sChordLatencyMax = g_sChordLatency;
+        }
+    }
+}
 
-        Unlock_RTCC();
+/**
+ * Called on the first edge of the TIME button in the 'watch stalled' mode.
+ * Starts the RTC right away, instead of waiting for the press to be
+ * debounced, so the seconds start at the edge and not some 65ms later.
+ */
 
-        /* Enable writing to the RTC */
+void Start_Stalled_RTCC(void)
+{
+    /* The minutes set before had been written, when the 'watch stalled'
+     * mode was entered. Unlock via magic. */
 
-        RTCCFGbits.RTCWREN = 1;
+    Unlock_RTCC();
 
-        /* Stop RTC operation. */
+    /* Enable write to RTC */
 
-        RTCCFGbits.RTCEN = 0;
+    RTCCFGbits.RTCWREN = 1;
 
-        /* Backward the calibration register and turn around on max. */
+    /* Enable RTC operation and lock writing to the RTCC. */
 
-        unsigned char ucTemp = RTCCAL;
-        
-        /* Check if passing the maximum absolute value. */
-        
-        if (ucTemp & 0x80)
-        {
-            /* Negative calibration for clocks running too fast. */
-            
-            if (ucTemp <= 0x81)
-            {
-                /* Turn around to zero value. */
+    Lock_RTCC();
 
-                ucTemp = 0x7E;
-            }
-            else
-            {
-                ucTemp -= 2;
-            }
-        }
-        else // if (ucTemp & 0x80)
-        {
-            /* Positive calibration for clocks running too slow. */
+  #if APP_DRIFT_LEARNING_USAGE==1
 
-            if (ucTemp <= 0x01)
-            {
-                /* Turn around to maximum negative value. */
+    /* Take the time stopped counted by Timer1 at the edge. */
 
-                ucTemp = 0xFE;
-            }
-            else
-            {
-                ucTemp -= 2;
-            }
-        }
-        
-        RTCCAL = ucTemp;
+    g_drift.stopped = Read_Timer_1_Ticks() - g_drift.start;
+
+  #endif
+
+    g_ucSyncEdgeStart = 1;
+}
+
+/**
+ * Called if the edge that started the RTC in the 'watch stalled' mode
+ * turned out to be a bounce. Stops the RTC and zeros the seconds again.
+ */
+
+void Revoke_Stalled_RTCC(void)
+{
+    g_ucSyncEdgeStart = 0;
+
+    /* Unlock via magic. */
+
+    Unlock_RTCC();
 
-        /* Enable the RTC operation again.*/
+    /* Enable write to RTC */
 
-        RTCCFGbits.RTCEN = 1;
+    RTCCFGbits.RTCWREN = 1;
 
-        /* Lock writing to the RTCC. */
+    /* Stop the RTC */
 
-        Lock_RTCC();
-    }
-    else // No autoset mode in charge.
-    {
-        g_ucDatePressCnt = 0;
+    RTCCFGbits.RTCEN = 0;
 
-        if (g_ucTimePressCnt < 3)
-        {
-            if (++g_ucTimePressCnt == 3)
-            {
-                if (istate == DISP_STATE_SET_CALIBRA)
-                {
-                    g_uDispState = DISP_STATE_AUTOSET_CALIBRA;
-                }
-                else
-                {
-                    g_uDispState = DISP_STATE_AUTOSET_TIME;
-                }
-            }
-        }
-    }
+    /* Set the RTC register to read/write and zero the seconds. */
 
-  #endif // #if APP_WATCH_ANY_PULSAR_MODEL == APP_WATCH_PULSAR_AUTO_SET
+    RTCCFG &= ~3;
 
-    /* When having set the time, the RTC will be disabled until
-     * you press the very first time the 'TIME' button.
-     * This will make the watch start counting time at zero seconds. */
+    RTCVALL = 0;
 
-    if (istate == DISP_STATE_SECONDS_STALLED)
-    {
-        g_uDispState = DISP_STATE_TIME;
+    /* Lock writing to the RTCC, while keeping the RTC stopped. */
 
-        /* Unlock via magic. */
+    RTCCFGbits.RTCWREN = 0;
+}
 
-        Unlock_RTCC();
+/**
+ * This function will read and debounce the push buttons.
+ *
+ * @return  Return zero, if the watch can enter sleep, non-zero otherwise.
+ */
 
-        /* Enable write to RTC */
+unsigned char DebounceButtons(void)
+{
+    short *ptimer;
+    unsigned char *pstate;
+    unsigned char ubutton;
+    short itimer;
 
-        RTCCFGbits.RTCWREN = 1;
+    /* Button handler pointer. */
 
-        /* Enable RTC operation. */
+    ButtonHandlerType ppressed;
+    ButtonHandlerType phold;
+    ButtonHandlerType preleased;
 
-        RTCCFGbits.RTCEN = 1;
+    /* Check for a wrist flick event, if that feature has been enabled.
+     * It is classified by Track_Flick() instead of being debounced. */
 
-        /* Lock writing to the RTCC. */
+#if APP_WRIST_FLICK_USAGE==1
+    
+    static const unsigned char imaxb = 5; // Buttons and wrist flick.
 
-        Lock_RTCC();
-    }
+#else
+    
+    static const unsigned char imaxb = 4; // Buttons only.
+    
+#endif // #if APP_WRIST_FLICK_USAGE==1
 
-    /* Revoke the 'blanked' state in order to turn the display on. */
+    /* Init */
 
-    if (istate == DISP_STATE_BLANK)
+    unsigned char ibtns = 0;
+    unsigned char istayawake = 0;
+    unsigned char *pusage = &g_ucTimer0Usage;
+
+    do // while(++ibtns < 4);
     {
-        /* Restart the time, the display will stay lit up. */
+        /* Read the button status and state machine value. */
 
-        g_ucRollOver = 1;
+        switch(ibtns)
+        {
+            // PB0 - TIME
+            case DEBOUNCE_INDEX_BUTTON_TIME: // 0
+                pstate = &g_ucPB0TIMEState;
+                ptimer = &g_sPB0Timer;
+                ubutton = PB0;
+                ppressed = &PressPB0;
+                phold = &HoldPB0;
+                preleased = &ReleasePB0;
+            break;
 
-        /* Show the time. */
+          #if !APP_ONE_TIME_BUTTON_OPERATION
 
-        g_uDispState = DISP_STATE_TIME;
-    }
-    else
-    {
-        /* Pressing the TIME button will usually show the time.
-         * But reagrding how Pulsar P2/P3 and early P4 worked,
-         * the time button can be pressed together with the DATE button,
-         * when setting the day of month. */
+            // PB1 - DATE
+            case DEBOUNCE_INDEX_BUTTON_DATE: // 1
+                pstate = &g_ucPB1DATEState;
+                ptimer = &g_sPB1Timer;
+                ubutton = PB1;
+                ppressed = &PressPB1;
+                phold = &HoldPB1;
+                preleased = &ReleasePB1;
+            break;
 
-      #if APP_WATCH_ANY_PULSAR_MODEL==APP_WATCH_PULSAR_MAGNET_SET
+          #endif // #if !APP_ONE_TIME_BUTTON_OPERATION
 
-        #if APP_ONE_TIME_BUTTON_OPERATION
-      
-        /* If we have a Pulsar with only one button and you press the time
-         * button two times in a row, show the DATE. This is not original
-         * but a nice feature anyway. */
-        
-        if (istate == DISP_STATE_TIME)
-        {
-            /* Restart the time, the display will stay lit up. */
-        
-            g_ucRollOver = 1;
+          #if APP_WATCH_ANY_PULSAR_MODEL!=APP_WATCH_PULSAR_AUTO_SET
 
-            /* Alter from showing the time to date. */
+            // PB2 - HOUR
+            case DEBOUNCE_INDEX_BUTTON_HOUR: // 2
+                pstate = &g_ucPB2HOURState;
+                ptimer = &g_sPB2Timer;
+                ubutton = PB2;
+                ppressed = &PressPB2;
+                phold = &HoldPB2;
+                preleased = &ReleasePB2;
+            break;
 
-            g_uDispState = DISP_STATE_DATE;
-        }
+            // PB3 - MIN
+            case DEBOUNCE_INDEX_BUTTON_MIN: // 3
+                pstate = &g_ucPB3MINTState;
+                ptimer = &g_sPB3Timer;
+                ubutton = PB3;
+                ppressed = &PressPB3;
+                phold = &HoldPB3;
+                preleased = &ReleasePB3;
+            break;
 
-        #else // #if APP_ONE_TIME_BUTTON_OPERATION
+          #endif // #if APP_WATCH_ANY_PULSAR_MODEL!=APP_WATCH_PULSAR_AUTO_SET
 
-        if ((istate == DISP_STATE_DATE) || (istate == DISP_STATE_SET_MONTH))
-        {
-            g_uDispState = DISP_STATE_SET_DAY;
+          #if APP_WRIST_FLICK_USAGE==1
+            
+            // PB4 - WRIST FLICK
+            case DEBOUNCE_INDEX_BUTTON_FLICK: // 4
+                istayawake |= Track_Flick();
+                pstate = NULL;
+            break;
+
+          #endif // #if APP_WRIST_FLICK_USAGE==1
+
+            default:
+                pstate = NULL;
+            break;
         }
-        else if (istate == DISP_STATE_SET_WEEKDAY)
+
+        if (pstate)
         {
-            g_uDispState = DISP_STATE_SET_YEAR                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                   ;
-        }
+            /* Check if the button has been pressed. */
 
-        #endif // #else #if APP_ONE_TIME_BUTTON_OPERATION
+            if (ubutton) // pressed
+            {
+                switch(*pstate)
+                {
+                    case PB_STATE_IDLE:
 
-      #endif
-    }
-}
+                    /* If the button has been pressed, start debouncing it. */
 
-/**
- * Called when button 0 TIME has been held pressed.
- */
+                    *pstate = PB_STATE_DEBOUNCING;
 
-void HoldPB0(void)
-{
-    DisplayStateType istate = g_uDispState;
+                    /* Start the timer, if not started yet by another
+                     * button before. */
 
-    /* If using the Pulsar Autoset button mode, there
-     * are two button press counters for the TIME and DATE
-     * buttons, that are reset, when the display is turned off. */
+                    if (!(*pusage))
+                    {
+                        /* Zero timer */
 
-  #if APP_WATCH_ANY_PULSAR_MODEL == APP_WATCH_PULSAR_AUTO_SET
+                        TMR0H = 0;
+                        TMR0L = 0;
 
-    if (istate == DISP_STATE_AUTOSET_DATE)
-    {
-        /* Restart the time, the display will stay lit up. */
-        
-        g_ucRollOver = 1;
+                        /* Turn timer 0 on. */
 
-        /* Unlock write access to the RTC and disable the clock. */
+                        T0CONbits.TMR0ON = 1;
 
-        Unlock_RTCC();
+                        /* Set the start timer value for this button. */
+
+                        *ptimer = 0;
+                    }
+                    else // Timer already in use and running.
+                    {
+                        /* Read out the start timer value for this button,
+                         * if the timer is already running, triggered by
+                         * another button already using it.
+                         *
+                         * TMR0H is not the actual high byte of Timer0 in 16-bit
+                         * mode. It is actually a buffered version of the real high
+                         * byte of Timer0, which is not directly readable nor
+                         * writable. TMR0H is updated with the contents of the high
+                         * byte of Timer0 during a read of TMR0L.
+                         * This provides the ability to read all 16 bits of
+                         * Timer0 without having to verify that the read of the high
+                         * and low byte were valid, due to a rollover between
+                         * successive reads of the high and low byte. */
 
-        /* Enable writing to the RTC */
+                        /* First read the low byte of the timer, which will buffer
+                         * the high byte. */
 
-        RTCCFGbits.RTCWREN = 1;
+                        const unsigned char ulow = TMR0L;
 
-        /* Stop RTC operation. */
+                        /* Read now the buffered high byte of the timer, that
+                         * had been stored, when the low byte had been read. */
 
-        RTCCFGbits.RTCEN = 0;
+                        const unsigned char uhigh = TMR0H;
 
-        unsigned char ucExtra;
-        unsigned char ucTemp;
-        unsigned char ucValue;
+                        *ptimer = ulow | (uhigh << 8);
+                    }
 
-     #if (APP_WATCH_TYPE_BUILD==APP_PULSAR_WRIST_WATCH_12H_LEGACY_MOD) || \
-         (APP_WATCH_TYPE_BUILD==APP_PULSAR_P3_WRIST_WATCH_12H_ODIN_MARK_II_MOD) || \
-         (APP_WATCH_TYPE_BUILD==APP_PULSAR_WRIST_WATCH_12H_SIF_LEGACY_MOD) || \
-         (APP_WATCH_TYPE_BUILD==APP_PULSAR_P4_WRIST_WATCH_12H_SIF_MARK_II_MOD)
+                    /* Indicate that this button is using the timer. */
 
-        ucExtra = 1;
+                    *pusage |= 1 << ibtns;
 
-        /* On every second cycle change betwen AM and PM and otherwise
-         * forward the day. */
+                    /* Start the RTC on the very edge of the TIME button, if
+                     * the watch has been stalled. */
 
-        RTCCFGbits.RTCPTR0 = 1;
-        RTCCFGbits.RTCPTR1 = 0;
+                    if ((ibtns == DEBOUNCE_INDEX_BUTTON_TIME) && \
+                        (g_uDispState == DISP_STATE_SECONDS_STALLED))
+                    {
+                        Start_Stalled_RTCC();
+                    }
 
-        ucTemp = RTCVALL;
-        ucValue = g_bcd_decimal[ucTemp];
+                  #if APP_STOPWATCH_USAGE==1
 
-        if (ucValue < 12)
-        {
-            /* AM -> PM */
+                    /* Stamp the edges operating the stopwatch in crystal
+                     * ticks, the press is confirmed after debouncing. */
 
-            ucValue += 12;
+                    if (ibtns <= DEBOUNCE_INDEX_BUTTON_DATE)
+                    {
+                        g_ulStopwatchEdge[ibtns] = Read_Timer_1_Ticks();
+                    }
 
-            ucTemp = g_decimal_bcd[ucValue];
-            RTCVALL = ucTemp;
+                  #endif // #if APP_STOPWATCH_USAGE==1
 
-            /* Do not forward the day. */
+                    /* Return none-zero to indicate not to enter
+                     * deep sleep mode. */
 
-            ucExtra = 0;
-        }
-        else
-        {
-            /* PM -> AM */
+                    istayawake = 1;
 
-            ucValue -= 12;
+                    /* Continue checking the next button. */
 
-            ucTemp = g_decimal_bcd[ucValue];
-            RTCVALL = ucTemp;
-        }
+                    break;
 
-        if (ucExtra)
+                    case PB_STATE_DEBOUNCING:
+                    case PB_STATE_SHORT_PRESS:
 
-      #endif
+                    /* If the button is still pressed, read
+                     * out the current timer value. */
 
-        {
-            /* Forward the day of month. */
+                    {
+                        /* TMR0H is not the actual high byte of Timer0 in 16-bit
+                         * mode. It is actually a buffered version of the real high
+                         * byte of Timer0, which is not directly readable nor
+                         * writable. TMR0H is updated with the contents of the high
+                         * byte of Timer0 during a read of TMR0L.
+                         * This provides the ability to read all 16 bits of
+                         * Timer0 without having to verify that the read of the high
+                         * and low byte were valid, due to a rollover between
+                         * successive reads of the high and low byte. */
+
+                        /* First read the low byte of the timer, which will buffer
+                         * the high byte. */
+
+                        const unsigned char ulow = TMR0L;
+
+                        /* Read now the buffered high byte of the timer, that
+                         * had been stored, when the low byte had been read. */
 
-            RTCCFGbits.RTCPTR0 = 0;
-            RTCCFGbits.RTCPTR1 = 1;
-            //while(RTCCFGbits.RTCSYNC);
+                        const unsigned char uhigh = TMR0H;
 
-            ucTemp = RTCVALL; // day
-            ucValue = 1 + g_bcd_decimal[ucTemp];
+                        itimer = ulow | (uhigh << 8);
+                    }
 
-            ucTemp = RTCVALH; // month
-            ucExtra = g_bcd_decimal[ucTemp];
+                    /* Check if the long (hold) debounce timer has been expired.
+                     * Use signed values to take mathimatical a rollover in account.
+                     * This will work as long as the time span is lower than the
+                     * half of the timer's range, the difference being taken
+                     * in 16 bit even if int is wider. */
 
-            if (ucExtra == 2) // February, always assume it to be a leap year.
-            {
-                /* Assume february to have 29 days to support leap years. */
+                    if ((short)(itimer - (*ptimer + T0_HOLD)) >= 0)
+                    {
+                        /* Check if the button is using a 'hold' handler. */
+                        
+                        if (phold)
+                        {
+                            /* Set the button to 'hold' state. */
 
-                if (ucValue >= 30) // 29 days (leap year)
-                {
-                    ucValue = 1;
-                }
-            }
-            else if ((ucExtra == 1) || (ucExtra == 3) || (ucExtra == 5) || \
-                     (ucExtra == 7) || (ucExtra == 8) || (ucExtra == 10) || \
-                     (ucExtra == 12))
-            {
-                if (ucValue >= 32) // 31 days
-                {
-                    ucValue = 1;
-                }
-            }
-            else
-            {
-                if (ucValue >= 31) // 30 days
-                {
-                    ucValue = 1;
-                }
-            }
+                            *pstate = PB_STATE_LONG_PRESS;
 
-            RTCCFGbits.RTCPTR0 = 0;
-            RTCCFGbits.RTCPTR1 = 1;
+                            /* Arm the overall timeout, if no handler did so
+                             * far, to prevent the battery from draining if a
+                             * button is held unattended for too long. */
 
-            ucTemp = g_decimal_bcd[ucValue];
-            RTCVALL = ucTemp;
-        }
+                            if (!g_ucOverallTimeoutHigh)
+                            {
+                                Set_Overall_Timeout();
+                            }
 
-        /* Enable the RTC operation again.*/
+                            /* Store timer value as new start point. */
 
-        RTCCFGbits.RTCEN = 1;
+                            *ptimer = itimer;
 
-        /* Lock writing to the RTCC. */
+                            /* Call the hold handler for this button. */
 
-        Lock_RTCC();
-    }
-    else if (istate == DISP_STATE_AUTOSET_TIME)
-    {
-        /* Restart the time, the display will stay lit up. */
-        
-        g_ucRollOver = 1;
+                            Detect_Chord(0);
 
-        /* Unlock write access to the RTC and disable the clock. */
+                            (*phold)();
 
-        Unlock_RTCC();
+                            /* Turn the 'stay awake' timer on. */
 
-        /* Enabling writing to the RTC. */
+                            g_ucTimer2Usage = 1;    // Indicate using the timer.
+                            TMR2 = 0;               // Zero the timer.
+                            T2CONbits.TMR2ON = 1;   // Turn timer 2 on.
+                        }
+                        else // if (phold)
+                        {
+                            /* If the button is not featuring a 'hold' handler drop the state. */
+                            
+                            *pstate = PB_STATE_IDLE;
 
-        RTCCFGbits.RTCWREN = 1;
+                            /* Indicate that this button is not using the timer anymore. */
 
-        /* Stop the RTC */
+                            *pusage &= ~(1 << ibtns);
 
-        RTCCFGbits.RTCEN = 0;
+                            /* If this was the last button using the timer, stop the timer. */
 
-        /* Set the RTC register to read/write. */
+                            if (!(*pusage))
+                            {
+                                /* Stop the debouncing timer used. */
 
-        RTCCFG &= ~3;
+                                T0CONbits.TMR0ON = 0;
+                            }
+                            else
+                            {
+                                /* As long as another button is still
+                                 * using the timer, do not enter
+                                 * deep sleep mode. */
 
-        /* Forward the minutes. */
+                                istayawake = 1;
+                            }
+                        }
+                    }
+                    else if ((short)(itimer - (*ptimer + T0_DEBOUNCE)) >= 0)
+                    {
+                        /* If the short debounce timer has been expired. */
 
-        unsigned char ucTemp = RTCVALH;
-        unsigned char ucValue = 1 + g_bcd_decimal[ucTemp];
+                        if (*pstate != PB_STATE_SHORT_PRESS)
+                        {
+                            /* Set the button to 'pressed' state. */
 
-        if (ucValue >= 60)
-        {
-            ucValue = 0;
-        }
+                            *pstate = PB_STATE_SHORT_PRESS;
 
-        /* Set the RTC register to read/write. */
+                          #if APP_INPUT_STATISTICS_USAGE==1
 
-        ucTemp = g_decimal_bcd[ucValue];
-        RTCVALH = ucTemp;
+                            /* The wake up had been caused by a real press. */
 
-        /* Set seconds to zero. */
+                            g_ucStatWakePending = 0;
 
-        RTCVALL = 0; // Zero the second when forwarding the minute.
+                          #endif
 
-        /* Enable the RTC operation again.*/
+                            /* Call the 'press' handler. */
 
-        RTCCFGbits.RTCEN = 1;
+                            if (ppressed)
+                            {
+                              #if APP_WRIST_FLICK_USAGE==1
 
-        /* Lock writing to the RTCC. */
+                                /* The wearer made use of the display lit
+                                 * by the flick. */
 
-        Lock_RTCC();
+                                if (g_WristFlick == FLICK_LIT)
+                                {
+                                    g_WristFlick = FLICK_ENGAGED;
 
-        /* Indicate to zero the seconds and stall the watch. */
-        
-        g_ucTimePressCnt = HINT_AUTOSET_MINUTES_SET;
-    }
-    else if (istate == DISP_STATE_AUTOSET_WEEKDAY)
-    {
-        /* Restart the time, the display will stay lit up. */
-        
-        g_ucRollOver = 1;
+                                    Count_Flick_Outcome(FLICK_ENGAGED);
+                                }
 
-        /* Unlock write access to the RTC and disable the clock. */
+                              #endif // #if APP_WRIST_FLICK_USAGE==1
 
-        Unlock_RTCC();
+                                Detect_Chord(1);
 
-        /* Enabling writing to the RTC. */
+                                (*ppressed)();
+                            }
 
-        RTCCFGbits.RTCWREN = 1;
+                            /* Trigger 'stay awake' timer. */
 
-        /* Stop the RTC */
+                            g_ucTimer2Usage = 1;    // Indicate using the timer.
+                            TMR2 = 0;               // Zero the timer.
+                            T2CONbits.TMR2ON = 1;   // Turn timer 2 on.
 
-        RTCCFGbits.RTCEN = 0;
+                            /* Keep the timer going as we have to detect
+                             * the 'hold' state as well.*/
+                        }
+                    }
 
-        /* Set the RTC register to read/write. */
+                    /* Do not enter deep sleep mode. */
 
-        RTCCFGbits.RTCPTR0 = 1;
-        RTCCFGbits.RTCPTR1 = 0;
-        //while(RTCCFGbits.RTCSYNC);
+                    istayawake = 1;
 
-        /* Backward the weekday. */
+                    /* Continue checking the next button. */
 
-        unsigned char ucTemp = RTCVALH;
-        unsigned char ucValue = (ucTemp & 7);
+                    break;
 
-        if (!ucValue)
-        {
-            ucValue = 6;
-        }
-        else
-        {
-            ucValue--;
-        }
+                    case PB_STATE_LONG_PRESS:
 
-        /* As accessing the hi-byte will automatically decrement
-         * the address pointer, we have to set the address again, before
-         * writing the weekday. */
+                    /* If the button is still pressed, read
+                     * out the current timer value. */
 
-        RTCCFGbits.RTCPTR0 = 1;
+                    {
+                        /* TMR0H is not the actual high byte of Timer0 in 16-bit
+                         * mode. It is actually a buffered version of the real high
+                         * byte of Timer0, which is not directly readable nor
+                         * writable. TMR0H is updated with the contents of the high
+                         * byte of Timer0 during a read of TMR0L.
+                         * This provides the ability to read all 16 bits of
+                         * Timer0 without having to verify that the read of the high
+                         * and low byte were valid, due to a rollover between
+                         * successive reads of the high and low byte. */
 
-        RTCVALH = ucValue;
+                        /* First read the low byte of the timer, which will buffer
+                         * the high byte. */
 
-        /* Enable the RTC operation again.*/
+                        const unsigned char ulow = TMR0L;
 
-        RTCCFGbits.RTCEN = 1;
+                        /* Read now the buffered high byte of the timer, that
+                         * had been stored, when the low byte had been read. */
 
-        /* Lock writing to the RTCC. */
+                        const unsigned char uhigh = TMR0H;
 
-        Lock_RTCC();
-    }
-    else if (istate == DISP_STATE_AUTOSET_YEAR)
-    {
-        /* Restart the time, the display will stay lit up. */
-        
-        g_ucRollOver = 1;
+                        itimer = ulow | (uhigh << 8);
+                    }
 
-        /* Unlock write access to the RTC and disable the clock. */
+                    /* Check if the long (hold) debounce timer has been expired.
+                     * Use signed values to take mathimatical a rollover in account.
+                     * This will work as long as the time span is lower than the
+                     * half of the timer's range. */
 
-        Unlock_RTCC();
+                    short ltime = T0_REPEAT_SLOW;
 
-        /* Enable writing to the RTC */
+                    switch(ibtns)
+                    {
+                        case 0: // TIME
+                     #if APP_WATCH_ANY_PULSAR_MODEL == APP_WATCH_PULSAR_AUTO_SET
+                            if (g_uDispState >= DISP_STATE_AUTOSET_TIME)
+                            {
+                                ltime = T0_REPEAT_QUICK;
+                            }
+                     #endif
+                     #if APP_ONE_TIME_BUTTON_OPERATION
+                            if ((g_uDispState == DISP_STATE_DATE) || \
+                                (g_uDispState == DISP_STATE_WEEKDAY) || \
+                                (g_uDispState == DISP_STATE_YEAR))
+                            {
+                                ltime = T0_HOLD;
+                            }
+                     #endif
+                        break;
 
-        RTCCFGbits.RTCWREN = 1;
+                        case 1: // DATE
+                     #if APP_WATCH_ANY_PULSAR_MODEL == APP_WATCH_PULSAR_AUTO_SET
+                            if (g_uDispState >= DISP_STATE_AUTOSET_TIME)
+                            {
+                                ltime = T0_REPEAT_QUICK;
+                            }
+                            else
+                            {
+                                ltime = T0_HOLD;
+                            }
+                     #else
+                            ltime = T0_HOLD;
+                     #endif
+                        break;
 
-        /* Stop RTC operation. */
+                        case 2: // HOUR
+                        case 3: // MINUTE
+                            ltime = T0_REPEAT_QUICK;
+                        break;
 
-        RTCCFGbits.RTCEN = 0;
+                        default:
+                        break;
+                    }
 
-        /* Set the RTC register to read/write. */
+                    /* Check if the long-press time has expired.
+                     * If yes, recharge the timer again. */
+                    
+                    if ((short)(itimer - (*ptimer + (ltime))) >= 0)
+                    {
+                        *ptimer = itimer;
 
-        RTCCFG |= 3;
-        //while(RTCCFGbits.RTCSYNC);
+                        /* Call the hold handler for this button. */
 
-        /* Backward the year. */
+                        if (phold)
+                        {
+                            Detect_Chord(0);
 
-        unsigned char ucTemp = RTCVALL;
-        unsigned char ucValue = g_bcd_decimal[ucTemp];
+                            (*phold)();
+                        }
+                    }
 
-        if (!ucValue)
-        {
-            ucValue = 99;
-        }
-        else
-        {
-            ucValue--;
-        }
+                    /* As long as another button is still
+                     * using the timer, do not enter
+                     * deep sleep mode. */
 
-        ucTemp = g_decimal_bcd[ucValue];
-        RTCVALL = ucTemp;
+                    istayawake = 1;
 
-        /* Enable the RTC operation again.*/
+                    /* Continue checking the next button. */
 
-        RTCCFGbits.RTCEN = 1;
+                    break;
 
-        /* Lock writing to the RTCC. */
+                    case PB_STATE_RELEASED:
 
-        Lock_RTCC();
-    }
-    else if (istate == DISP_STATE_AUTOSET_CALIBRA)
-    {
-        /* Restart the time, the display will stay lit up. */
-        
-        g_ucRollOver = 1;
+                    /* If the button was held and then was dropped
+                     * but actually was turned on again within the
+                     * debounce time for dropping, go back to the
+                     * held state again. */
 
-        /* Unlock write access to the RTC and disable the clock. */
+                    *pstate = PB_STATE_LONG_PRESS;
 
-        Unlock_RTCC();
+                  #if APP_INPUT_STATISTICS_USAGE==1
 
-        /* Enable writing to the RTC */
+                    Count_Statistic(&g_ucStatBounces[ibtns]);
 
-        RTCCFGbits.RTCWREN = 1;
+                  #endif
 
-        /* Stop RTC operation. */
+                    /* As long as another button is still
+                     * pressed, do not enter
+                     * deep sleep mode. */
 
-        RTCCFGbits.RTCEN = 0;
+                    istayawake = 1;
 
-        /* Forward the calibration register and turn around on max. */
+                    /* Continue checking the next button. */
 
-        unsigned char ucTemp = RTCCAL;
-        
-        /* Check if passing the maximum absolute value. */
-        
-        if (ucTemp & 0x80)
-        {
-            /* Negative calibration for clocks running too fast. */
-            
-            if (ucTemp <= 0x81)
-            {
-                /* Turn around to zero value. */
+                    break;
 
-                ucTemp = 0x7E;
+                    default:
+                    break;
+                }
             }
-            else
+            else // if (ubutton)
             {
-                ucTemp -= 2;
-            }
-        }
-        else // if (ucTemp & 0x80)
-        {
-            /* Positive calibration for clocks running too slow. */
+                /* If the button has been released or is not pressed at all
+                 * return zero to indicate, that it would be safe to enter deep
+                 * sleep again. */
 
-            if (ucTemp <= 0x01)
-            {
-                /* Turn around to maximum negative value. */
+                switch(*pstate)
+                {
+                    /* The button has not been pressed and the state machine
+                     * is idle. */
 
-                ucTemp = 0xFE;
-            }
-            else
-            {
-                ucTemp -= 2;
-            }
-        }
-        
-        RTCCAL = ucTemp;
+                    case PB_STATE_IDLE:
 
-        /* Enable the RTC operation again.*/
+                    /* Continue checking the next button. */
 
-        RTCCFGbits.RTCEN = 1;
+                    break;
 
-        /* Lock writing to the RTCC. */
+                    /* If the button was on debouncing for a peak up
+                     * and the signal peaked down again, dismiss the
+                     * debouncing process. */
 
-        Lock_RTCC();
-    }
+                    case PB_STATE_DEBOUNCING:
 
-  #endif // #if APP_WATCH_ANY_PULSAR_MODEL == APP_WATCH_PULSAR_AUTO_SET
+                    *pstate = PB_STATE_IDLE;
 
-    /* Holding the TIME button pressed will usually show the seconds.
-     * But reagrding how Pulsar P2/P3 and eraly P4 works, the
-     * time button can be hold pressed after the DATE button,
-     * when setting the day of month. */
+                    /* Stop the RTC again, if it had been started by a bounce. */
 
-    if ((g_ucPB2HOURState == PB_STATE_IDLE) && \
-        (g_ucPB3MINTState == PB_STATE_IDLE))
-    {
-        /* If we have to deal with a Pulsar, that only has the TIME button,
-         * pressing it twice will show the DATE. That might not be original
-         * but is a nice feature anyway. Anyhow if holding the TIME button
-         * pressed, once it shows the date, it will continue with the weekday
-         * and the year. */
+                    if ((ibtns == DEBOUNCE_INDEX_BUTTON_TIME) && \
+                        g_ucSyncEdgeStart)
+                    {
+                        Revoke_Stalled_RTCC();
+                    }
 
-      #if APP_ONE_TIME_BUTTON_OPERATION
-      
-        if (istate == DISP_STATE_TIME)
-        {
-            g_uDispState = DISP_STATE_SECONDS;
+                  #if APP_INPUT_STATISTICS_USAGE==1
 
-            /* Set the overall timeout to prevent the battery from draining
-             * if a button is pressed and left unattended for too long. */
+                    Count_Statistic(&g_ucStatBounces[ibtns]);
 
-            Set_Overall_Timeout();
-        }
-        else if (istate == DISP_STATE_DATE)
-        {
-            g_uDispState = DISP_STATE_WEEKDAY;
-        }
-        else if (istate == DISP_STATE_WEEKDAY)
-        {
-            g_uDispState = DISP_STATE_YEAR;
-        }
-        else if (istate == DISP_STATE_YEAR)
-        {
-            g_uDispState = DISP_STATE_SET_CALIBRA;
+                  #endif
 
-            /* Set the overall timeout to prevent the battery from draining
-             * if a button is pressed and left unattended for too long. */
+                    /* Indicate that this button is not using the timer anymore. */
 
-            Set_Overall_Timeout();
-        }
+                    *pusage &= ~(1 << ibtns);
 
-      #else // #if APP_ONE_TIME_BUTTON_OPERATION
+                    /* If this was the last button using the timer, stop the timer. */
 
-        if (istate == DISP_STATE_TIME)
-        {
-            g_uDispState = DISP_STATE_SECONDS;
+                    if (!(*pusage))
+                    {
+                        /* Stop the debouncing timer used. */
 
-            /* Set the overall timeout to prevent the battery from draining
-             * if a button is pressed and left unattended for too long. */
+                        T0CONbits.TMR0ON = 0;
+                    }
+                    else
+                    {
+                        /* As long as another button is still
+                         * using the timer, do not enter
+                         * deep sleep mode. */
 
-            Set_Overall_Timeout();
-        }
-        else if ((istate == DISP_STATE_YEAR) || \
-                 (istate == DISP_STATE_LIGHT_SENSOR))
-        {
-            g_uDispState = DISP_STATE_SET_CALIBRA;
+                        istayawake = 1;
+                    }
 
-            /* Set the overall timeout to prevent the battery from draining
-             * if a button is pressed and left unattended for too long. */
+                    /* Continue checking the next button. */
 
-            Set_Overall_Timeout();
-        }
+                    break;
 
-      #endif // #else #if APP_ONE_TIME_BUTTON_OPERATION
-    }
-}
+                    case PB_STATE_SHORT_PRESS:
 
-/**
- * Called when button 0 TIME has been released.
- */
+                    *pstate = PB_STATE_IDLE;
 
-void ReleasePB0(void)
-{
-    const DisplayStateType istate = g_uDispState;
+                  #if APP_INPUT_STATISTICS_USAGE==1
 
-  #if APP_WATCH_ANY_PULSAR_MODEL==APP_WATCH_PULSAR_MAGNET_SET
+                    /* Sort the press duration into tap or short press. */
 
-    if (istate == DISP_STATE_SET_DAY)
-    {
-        g_uDispState = DISP_STATE_SET_MONTH;
-    }
-    else if (istate == DISP_STATE_SET_YEAR)
-    {
-        g_uDispState = DISP_STATE_SET_WEEKDAY;
-    }
-    else
+                    {
+                        const unsigned char ulow = TMR0L;
+                        const unsigned char uhigh = TMR0H;
 
-  #endif
+                        itimer = ulow | (uhigh << 8);
+                    }
 
-    {
-        if (istate == DISP_STATE_SECONDS)
-        {
-            /* Turn timer 2 off. */
+                    Count_Statistic(&g_ucStatPresses[
+                        ((short)(itimer - (*ptimer + T0_STAT_TAP)) >= 0) ? 1 : 0]);
 
-            T2CONbits.TMR2ON = 0;
+                  #endif
 
-            /* Timer usage */
+                    /* Indicate that this button is not using the timer anymore. */
 
-            g_ucTimer2Usage = 0;
-        }
-    }
+                    *pusage &= ~(1 << ibtns);
 
-    /* Clear the overall timeout to prevent the battery from draining
-     * if a button is pressed and left unattended for too long. */
+                    /* If this was the last button using the timer,
+                     * stop the timer. */
 
-    if (g_ucPB1DATEState == PB_STATE_IDLE)
-    {
-        Clear_Overall_Timeout();
-    }
-}
+                    if (!(*pusage))
+                    {
+                        /* Stop the debouncing timer used. */
 
-#if !APP_ONE_TIME_BUTTON_OPERATION
+                        T0CONbits.TMR0ON = 0;
+                    }
+                    else
+                    {
+                        /* As long as another button is still
+                         * using the timer, do not enter
+                         * deep sleep mode. */
 
-/**
- * Called when button 1 DATE has been pressed.
- */
+                        istayawake = 1;
+                    }
 
-void PressPB1(void)
-{
-  #if APP_BUZZER_ALARM_USAGE==1
+                    /* Call the hold handler for this button. */
 
-    /* Check if the alarm buzzer is still active. */
+                    if (preleased)
+                    {
+                        Detect_Chord(0);
 
-    if (g_ucAlarm)
-    {
-        Turn_Buzzer_Off();
-    }
+                        (*preleased)();
+                    }
 
-  #endif
+                    /* Continue checking the next button. */
 
-    DisplayStateType *pb = &g_uDispState;
+                    break;
 
-    /* If using the Pulsar Autoset button mode, there
-     * are two button press counters for the TIME and DATE
-     * buttons, that are reset, when the display is turned off. */
+                    /* If the button is not pressed anymore, but was hold
+                     * down before for a while, debounce the dropping as well. */
 
-  #if APP_WATCH_ANY_PULSAR_MODEL == APP_WATCH_PULSAR_AUTO_SET
+                    case PB_STATE_LONG_PRESS:
 
-    if (*pb == DISP_STATE_AUTOSET_DATE)
-    {
-        /* Restart the time, the display will stay lit up. */
-        
-        g_ucRollOver = 1;
+                    *pstate = PB_STATE_RELEASED;
 
-        /* Unlock write access to the RTC and disable the clock. */
+                    /* Start the timer, if not started yet by any other button. */
 
-        Unlock_RTCC();
+                    if (!(*pusage))
+                    {
+                        /* Zero timer */
 
-        /* Enable writing to the RTC */
+                        TMR0H = 0;
+                        TMR0L = 0;
 
-        RTCCFGbits.RTCWREN = 1;
+                        /* Turn tmer 0 on. */
 
-        /* Stop RTC operation. */
+                        T0CONbits.TMR0ON = 1;
 
-        RTCCFGbits.RTCEN = 0;
+                        /* Set the start timer value for this button. */
 
-        /* Forward the month. */
+                        *ptimer = 0;
+                    }
+                    else
+                    {
+                        /* Read out the start timer value for this button,
+                         * if the timer is already running, triggered by
+                         * another button already using it.
+                         *
+                         * TMR0H is not the actual high byte of Timer0 in 16-bit
+                         * mode. It is actually a buffered version of the real high
+                         * byte of Timer0, which is not directly readable nor
+                         * writable. TMR0H is updated with the contents of the high
+                         * byte of Timer0 during a read of TMR0L.
+                         * This provides the ability to read all 16 bits of
+                         * Timer0 without having to verify that the read of the high
+                         * and low byte were valid, due to a rollover between
+                         * successive reads of the high and low byte. */
 
-        RTCCFGbits.RTCPTR0 = 0;
-        RTCCFGbits.RTCPTR1 = 1;
-        //while(RTCCFGbits.RTCSYNC);
+                        /* First read the low byte of the timer, which will buffer
+                         * the high byte. */
 
-        unsigned char ucTemp = RTCVALH;
-        unsigned char ucValue = 1 + g_bcd_decimal[ucTemp];
+                        const unsigned char ulow = TMR0L;
 
-        if (ucValue >= 13)
-        {
-            ucValue = 1;
-        }
+                        /* Read now the buffered high byte of the timer, that
+                         * had been stored, when the low byte had been read. */
+
+                        const unsigned char uhigh = TMR0H;
 
-        RTCCFGbits.RTCPTR0 = 0;
-        RTCCFGbits.RTCPTR1 = 1;
+                        *ptimer = ulow | (uhigh << 8);
+                    }
+
+                    /* Indicate that this button is using the timer. */
 
-        ucTemp = g_decimal_bcd[ucValue];
-        RTCVALH = ucTemp;
+                    *pusage |= 1 << ibtns;
 
-        /* Enable the RTC operation again.*/
+                    /* Return none-zero to indicate not to enter
+                     * deep sleep mode. */
 
-        RTCCFGbits.RTCEN = 1;
+                    istayawake = 1;
 
-        /* Lock writing to the RTCC. */
+                    /* Continue checking the next button. */
 
-        Lock_RTCC();
-    }
-    else if (*pb == DISP_STATE_AUTOSET_TIME)
-    {
-        /* Restart the time, the display will stay lit up. */
-        
-        g_ucRollOver = 1;
+                    break;
 
-        /* Unlock write access to the RTC and disable the clock. */
+                    /* If the button has been dropped and was hold, before,
+                     * debounce the dropping of the button as well. */
 
-        Unlock_RTCC();
+                    case PB_STATE_RELEASED:
 
-        /* Enable writing to the RTC */
+                    /* Read out the timer value. */
 
-        RTCCFGbits.RTCWREN = 1;
+                    {
+                        /* TMR0H is not the actual high byte of Timer0 in 16-bit
+                         * mode. It is actually a buffered version of the real high
+                         * byte of Timer0, which is not directly readable nor
+                         * writable. TMR0H is updated with the contents of the high
+                         * byte of Timer0 during a read of TMR0L.
+                         * This provides the ability to read all 16 bits of
+                         * Timer0 without having to verify that the read of the high
+                         * and low byte were valid, due to a rollover between
+                         * successive reads of the high and low byte. */
 
-        /* Stop RTC operation. */
+                        /* First read the low byte of the timer, which will buffer
+                         * the high byte. */
 
-        RTCCFGbits.RTCEN = 0;
+                        const unsigned char ulow = TMR0L;
 
-        /* Forward the hour. */
+                        /* Read now the buffered high byte of the timer, that
+                         * had been stored, when the low byte had been read. */
 
-        RTCCFGbits.RTCPTR0 = 1;
-        RTCCFGbits.RTCPTR1 = 0;
-        //while(RTCCFGbits.RTCSYNC);
+                        const unsigned char uhigh = TMR0H;
 
-        unsigned char ucTemp = RTCVALL;
-        unsigned char ucValue = 1 + g_bcd_decimal[ucTemp];
+                        itimer = ulow | (uhigh << 8);
+                    }
 
-        if (ucValue >= 24)
-        {
-            ucValue = 0;
-        }
+                    /* Check if the long (hold) debounce timer for dropping
+                     * the button has been expired.
+                     * Use signed values to take mathimatical a rollover in account.
+                     * This will work as long as the time span is lower than the
+                     * half of the timer's range. */
 
-        ucTemp = g_decimal_bcd[ucValue];
-        RTCVALL = ucTemp;
+                    if ((short)(itimer - (*ptimer + T0_DEBOUNCE)) >= 0)
+                    {
+                        /* Indicate that this button is using the timer
+                         * not anymore. */
 
-        /* Enable the RTC operation again.*/
+                        *pusage &= ~(1 << ibtns);
 
-        RTCCFGbits.RTCEN = 1;
+                        /* Check if any other button is not using the
+                         * timer anymore. Then it is safe to turn it off. */
 
-        /* Lock writing to the RTCC. */
+                        if (!(*pusage))
+                        {
+                            /* Stop the debouncing timer used. */
 
-        Lock_RTCC();
-    }
-    else if (*pb == DISP_STATE_AUTOSET_WEEKDAY)
-    {
-        /* Restart the time, the display will stay lit up. */
-        
-        g_ucRollOver = 1;
+                            T0CONbits.TMR0ON = 0;
+                        }
+                        else
+                        {
+                            /* As long as another button is still
+                             * using the timer, do not enter
+                             * deep sleep mode. */
 
-        /* Unlock write access to the RTC and disable the clock. */
+                            istayawake = 1;
+                        }
 
-        Unlock_RTCC();
+                        /* Set the state machine for the button back to 'idle. */
 
-        /* Enabling writing to the RTC. */
+                        *pstate = PB_STATE_IDLE;
 
-        RTCCFGbits.RTCWREN = 1;
+                      #if APP_INPUT_STATISTICS_USAGE==1
 
-        /* Stop the RTC */
+                        Count_Statistic(&g_ucStatPresses[2]);
 
-        RTCCFGbits.RTCEN = 0;
+                      #endif
 
-        /* Set the RTC register to read/write. */
+                        /* Call the hold handler for this button. */
 
-        RTCCFGbits.RTCPTR0 = 1;
-        RTCCFGbits.RTCPTR1 = 0;
-        //while(RTCCFGbits.RTCSYNC);
+                        if (preleased)
+                        {
+                            Detect_Chord(0);
 
-        /* Forward the weekday. */
+                            (*preleased)();
+                        }
 
-        unsigned char ucTemp = RTCVALH;
-        unsigned char ucValue = 1 + (ucTemp & 7);
+                        /* Continue checking the next button. */
+                    }
+                    else // if ((short)(itimer - (*ptimer + T0_DEBOUNCE)) >= 0)
+                    {
+                        /* As long as another button is still
+                         * using the timer, do not enter
+                         * deep sleep mode. */
 
-        if (ucValue >= 7)
-        {
-            ucValue = 0;
-        }
+                        istayawake = 1;
+                    }
+                    break;
 
-        /* As accessing the hi-byte will automatically decrement
-         * the address pointer, we have to set the address again, before
-         * writing the weekday. */
+                    default:
+                    break;
+                }
+            }
+        } // if (pstate)
+    }
+    while(++ibtns < imaxb);
 
-        RTCCFGbits.RTCPTR0 = 1;
+    /* Return none-zero to indicate not to enter
+     * deep sleep mode. */
 
-        RTCVALH = ucValue;
+    return (istayawake);
+}
 
-        /* Enable the RTC operation again.*/
+/**
+ * Called when button 0 TIME has been pressed.
+ */
 
-        RTCCFGbits.RTCEN = 1;
+void PressPB0(void)
+{
+  #if APP_BUZZER_ALARM_USAGE==1
 
-        /* Lock writing to the RTCC. */
+    /* Check if the alarm buzzer is still active. */
 
-        Lock_RTCC();
-    }
-    else if (*pb == DISP_STATE_AUTOSET_YEAR)
+    if (g_ucAlarm)
     {
-        /* Restart the time, the display will stay lit up. */
-        
-        g_ucRollOver = 1;
+        Turn_Buzzer_Off();
+    }
 
-        /* Unlock write access to the RTC and disable the clock. */
+  #endif
 
-        Unlock_RTCC();
+    const DisplayStateType istate = g_uDispState;
 
-        /* Enable writing to the RTC */
+  #if (APP_STOPWATCH_USAGE==1) && \
+      (APP_WATCH_ANY_PULSAR_MODEL == APP_WATCH_PULSAR_AUTO_SET)
 
-        RTCCFGbits.RTCWREN = 1;
+    /* Operating the stopwatch does not count towards the autoset mode. */
 
-        /* Stop RTC operation. */
+    if (istate == DISP_STATE_STOPWATCH)
+    {
+        /* Restart the time, the display will stay lit up. */
 
-        RTCCFGbits.RTCEN = 0;
+        g_ucRollOver = 1;
 
-        /* Set the RTC register to read/write. */
+        /* Start or stop the stopwatch. */
 
-        RTCCFG |= 3;
-        //while(RTCCFGbits.RTCSYNC);
+        Toggle_Stopwatch();
 
-        /* Forward the year. */
+        return;
+    }
 
-        unsigned char ucTemp = RTCVALL;
-        unsigned char ucValue = 1 + g_bcd_decimal[ucTemp];
+  #endif
 
-        if (ucValue >= 100)
-        {
-            ucValue = 0;
-        }
+    /* If using the Pulsar Autoset button mode, there
+     * are two button press counters for the TIME and DATE
+     * buttons, that are reset, when the display is turned off. */
 
-        ucTemp = g_decimal_bcd[ucValue];
-        RTCVALL = ucTemp;
+  #if APP_WATCH_ANY_PULSAR_MODEL == APP_WATCH_PULSAR_AUTO_SET
 
-        /* Enable the RTC operation again.*/
+    if (istate == DISP_STATE_AUTOSET_DATE)
+    {
+        /* Restart the time, the display will stay lit up. */
 
-        RTCCFGbits.RTCEN = 1;
+        g_ucRollOver = 1;
 
-        /* Lock writing to the RTCC. */
+        /* Forward the day of month. */
 
-        Lock_RTCC();
+        Edit_Field(FIELD_INDEX_DAY, 1);
     }
-    else if (*pb == DISP_STATE_AUTOSET_CALIBRA)
+    else if (istate == DISP_STATE_AUTOSET_TIME)
     {
         /* Restart the time, the display will stay lit up. */
-        
-        g_ucRollOver = 1;
-
-        /* Unlock write access to the RTC and disable the clock. */
 
-        Unlock_RTCC();
+        g_ucRollOver = 1;
 
-        /* Enable writing to the RTC */
+        /* Forward the minutes. */
 
-        RTCCFGbits.RTCWREN = 1;
+        Edit_Field(FIELD_INDEX_MINUTES, 1);
 
-        /* Stop RTC operation. */
+        /* Indicate to zero the seconds and stall the watch. */
 
-        RTCCFGbits.RTCEN = 0;
+        g_ucTimePressCnt = HINT_AUTOSET_MINUTES_SET;
+    }
+    else if (istate == DISP_STATE_AUTOSET_WEEKDAY)
+    {
+        /* Restart the time, the display will stay lit up. */
 
-        /* Forward the calibration register and turn around on max. */
+        g_ucRollOver = 1;
 
-        unsigned char ucTemp = RTCCAL;
-        
-        /* Check if passing the maximum absolute value. */
-        
-        if (ucTemp & 0x80)
-        {
-            /* Negative calibration for clocks running too fast. */
-            
-            if (ucTemp >= 0xFE)
-            {
-                /* Turn around to zero value. */
+        /* Backward the weekday. */
 
-                ucTemp = 0;
-            }
-            else
-            {
-                ucTemp += 2;
-            }
-        }
-        else // if (ucTemp & 0x80)
-        {
-            /* Positive calibration for clocks running too slow. */
+        Edit_Field(FIELD_INDEX_WEEKDAY, -1);
+    }
+    else if (istate == DISP_STATE_AUTOSET_YEAR)
+    {
+        /* Restart the time, the display will stay lit up. */
 
-            if (ucTemp >= 0x7E)
-            {
-                /* Turn around to maximum negative value. */
+        g_ucRollOver = 1;
 
-                ucTemp = 0x82;
-            }
-            else
-            {
-                ucTemp += 2;
-            }
-        }
-        
-        RTCCAL = ucTemp;
+        /* Backward the year. */
 
-        /* Enable the RTC operation again.*/
+        Edit_Field(FIELD_INDEX_YEAR, -1);
+    }
+    else if (istate == DISP_STATE_AUTOSET_CALIBRA)
+    {
+        /* Restart the time, the display will stay lit up. */
 
-        RTCCFGbits.RTCEN = 1;
+        g_ucRollOver = 1;
 
-        /* Lock writing to the RTCC. */
+        /* Backward the calibration register and turn around on max. */
 
-        Lock_RTCC();
+        Edit_Field(FIELD_INDEX_CALIBRA, -1);
     }
-    else
+    else // No autoset mode in charge.
     {
-        g_ucTimePressCnt = 0;
+        g_ucDatePressCnt = 0;
 
-        if (g_ucDatePressCnt < 3)
+        if (g_ucTimePressCnt < 3)
         {
-            if (++g_ucDatePressCnt == 3)
+            if (++g_ucTimePressCnt == 3)
             {
-                if (*pb == DISP_STATE_WEEKDAY)
-                {
-                    *pb = DISP_STATE_AUTOSET_WEEKDAY;
-                }
-                else if (*pb == DISP_STATE_YEAR)
+                if (istate == DISP_STATE_SET_CALIBRA)
                 {
-                    *pb = DISP_STATE_AUTOSET_YEAR;
+                    g_uDispState = DISP_STATE_AUTOSET_CALIBRA;
                 }
                 else
                 {
-                    *pb = DISP_STATE_AUTOSET_DATE;
+                    g_uDispState = DISP_STATE_AUTOSET_TIME;
                 }
             }
         }
-    }
+    }
+
+  #endif // #if APP_WATCH_ANY_PULSAR_MODEL == APP_WATCH_PULSAR_AUTO_SET
+
+    /* When having set the time, the RTC will be disabled until
+     * you press the very first time the 'TIME' button.
+     * This will make the watch start counting time at zero seconds. */
+
+    if (istate == DISP_STATE_SECONDS_STALLED)
+    {
+        g_uDispState = DISP_STATE_TIME;
+
+        /* The RTC usually has been started on the edge of the button
+         * already, start it now if not. */
+
+        if (!g_ucSyncEdgeStart)
+        {
+            Start_Stalled_RTCC();
+        }
 
-  #endif // #if APP_WATCH_ANY_PULSAR_MODEL == APP_WATCH_PULSAR_AUTO_SET
+        g_ucSyncEdgeStart = 0;
+
+      #if APP_DRIFT_LEARNING_USAGE==1
+
+        /* Learn from the correction made by this sync. */
+
+        Drift_Sync_End();
+
+      #endif
+    }
 
     /* Revoke the 'blanked' state in order to turn the display on. */
 
-    if (*pb == DISP_STATE_BLANK)
+    if (istate == DISP_STATE_BLANK)
     {
         /* Restart the time, the display will stay lit up. */
 
         g_ucRollOver = 1;
 
-        /* Show the date. */
+        /* Show the time. */
 
-        *pb = DISP_STATE_DATE;
+        g_uDispState = DISP_STATE_TIME;
     }
 
-  #if (APP_WATCH_TYPE_BUILD==APP_PULSAR_WRIST_WATCH_12H_LEGACY_MOD) || \
-      (APP_WATCH_TYPE_BUILD==APP_PULSAR_P3_WRIST_WATCH_12H_ODIN_MARK_II_MOD) || \
-      (APP_WATCH_TYPE_BUILD==APP_PULSAR_WRIST_WATCH_12H_SIF_LEGACY_MOD) || \
-      (APP_WATCH_TYPE_BUILD==APP_PULSAR_P4_WRIST_WATCH_12H_SIF_MARK_II_MOD)
+  #if APP_WATCH_ANY_PULSAR_MODEL==APP_WATCH_PULSAR_MAGNET_SET
 
-    else if (*pb == DISP_STATE_TIME)
-    {
-        *pb = DISP_STATE_DATE;
-    }
+    /* Pressing the TIME button will usually show the time.
+     * But reagrding how Pulsar P2/P3 and early P4 worked,
+     * the time button can be pressed together with the DATE button,
+     * when setting the day of month. */
 
-  #else
+   #if APP_ONE_TIME_BUTTON_OPERATION
 
-   #if APP_BUZZER_ALARM_USAGE==1
+    /* If we have a Pulsar with only one button and you press the time
+     * button two times in a row, show the DATE. This is not original
+     * but a nice feature anyway. */
 
-    else if ((*pb == DISP_STATE_TIME) || \
-             (*pb == DISP_STATE_SECONDS))
+    else if (istate == DISP_STATE_TIME)
     {
-        /* Show Alarm Time */
+        /* Alter from showing the time to date. */
 
-        *pb = DISP_STATE_ALARM;
+        g_uDispState = DISP_STATE_DATE;
 
-        /* Set the overall timeout to prevent the battery from draining
-         * if a button is pressed and left unattended for too long. */
+        /* Restart the time, the display will stay lit up. */
 
-        Set_Overall_Timeout();
+        g_ucRollOver = 1;
     }
-    else if (*pb == DISP_STATE_TOGGLE_ALARM)
-    {
-        if (((g_ucPB0TIMEState == PB_STATE_SHORT_PRESS) || \
-             (g_ucPB0TIMEState == PB_STATE_LONG_PRESS)) \
-             \
-             && \
-             \
-            (g_ucPB2HOURState == PB_STATE_IDLE) && \
-            (g_ucPB3MINTState == PB_STATE_IDLE))
-        {
-            /* Unlock write access to the RTC and disable the clock. */
 
-            Unlock_RTCC();
+   #else // #if APP_ONE_TIME_BUTTON_OPERATION
 
-            /* Enable writing to the RTC */
+    else if ((istate == DISP_STATE_DATE) || (istate == DISP_STATE_SET_MONTH))
+    {
+        g_uDispState = DISP_STATE_SET_DAY;
+    }
+    else if (istate == DISP_STATE_SET_WEEKDAY)
+    {
+        g_uDispState = DISP_STATE_SET_YEAR;
+    }
 
-            RTCCFGbits.RTCWREN = 1;
+   #endif // #else #if APP_ONE_TIME_BUTTON_OPERATION
 
-            /* Stop RTC operation. */
+  #endif // #if APP_WATCH_ANY_PULSAR_MODEL==APP_WATCH_PULSAR_MAGNET_SET
 
-            RTCCFGbits.RTCEN = 0;
+  #if APP_ALARM_SCHEDULE_USAGE==1
 
-            /* Toggle the alarm bit. */
+    /* Countdown, pressing TIME while the alarm is shown. It is set first,
+     * releasing TIME after setting it will start the countdown. */
 
-            ALRMCFGbits.AMASK = 0x06; // Alarm repeats every day.
+    else if (istate == DISP_STATE_ALARM)
+    {
+        if (g_alarms[ALARM_ENTRY_COUNTDOWN].flags & ALARM_FLAG_ENABLED)
+        {
+            g_uDispState = DISP_STATE_COUNTDOWN;
+        }
+        else
+        {
+            g_uDispState = DISP_STATE_SET_COUNTDOWN;
+        }
 
-            int ival = ALRMCFGbits.ALRMEN ? 0 : 1;
+        /* Set the overall timeout to prevent the battery from draining
+         * if a button is pressed and left unattended for too long. */
 
-            ALRMCFGbits.CHIME = ival ? 1 : 0;  // Chime enable;
+        Set_Overall_Timeout();
+    }
+    else if (istate == DISP_STATE_COUNTDOWN_EXPIRED)
+    {
+        g_uDispState = DISP_STATE_TIME;
 
-            /* Set Alarm repeat */
+        /* Restart the time, the display will stay lit up. */
 
-            ALRMRPT = ival ? 255 : 0;
+        g_ucRollOver = 1;
+    }
 
-            /* Enable the Alarm interrupt, if the alarm had been enabled. */
+  #endif // #if APP_ALARM_SCHEDULE_USAGE==1
 
-            PIE3bits.RTCCIE = ival ? 1 : 0;
+  #if (APP_BUZZER_ALARM_USAGE==1) && \
+      (APP_WATCH_ANY_PULSAR_MODEL!=APP_WATCH_PULSAR_AUTO_SET)
 
-            /* PERIPHERAL INTERRUPT REQUEST (FLAG) REGISTER 3 */
+    /* Leave the service mode of the buzzer, keeping the period marked. */
 
-            PIR3bits.RTCCIF = 0;    // No RTCC interrupt occurred.
+    else if (istate == DISP_STATE_PIEZO_SWEEP)
+    {
+        g_uDispState = DISP_STATE_TIME;
 
-            /* Enable/diable alarm */
-            
-            ALRMCFGbits.ALRMEN = ival ? 1 : 0;  // Alarm enable
+        /* Restart the time, the display will stay lit up. */
 
-            /* Enable the RTC operation again.*/
+        g_ucRollOver = 1;
 
-            RTCCFGbits.RTCEN = 1;
+        Store_Piezo_Period();
+    }
 
-            /* Lock writing to the RTCC. */
+  #endif
 
-            Lock_RTCC();
-        }
-    }
-   #else
+  #if (APP_STOPWATCH_USAGE==1) && \
+      (APP_WATCH_ANY_PULSAR_MODEL!=APP_WATCH_PULSAR_AUTO_SET)
 
-    else if (*pb == DISP_STATE_TIME)
+    else if (istate == DISP_STATE_STOPWATCH)
     {
-        *pb = DISP_STATE_DATE;
-    }
+        /* Restart the time, the display will stay lit up. */
 
-   #endif
+        g_ucRollOver = 1;
+
+        /* Start or stop the stopwatch. */
+
+        Toggle_Stopwatch();
+    }
 
   #endif
 }
 
 /**
- * Called when button 1 DATE has been held pressed.
+ * Called when button 0 TIME has been held pressed.
  */
 
-void HoldPB1(void)
+void HoldPB0(void)
 {
     DisplayStateType istate = g_uDispState;
-    
+
     /* If using the Pulsar Autoset button mode, there
      * are two button press counters for the TIME and DATE
      * buttons, that are reset, when the display is turned off. */
@@ -3501,796 +4963,832 @@ void HoldPB1(void)
     if (istate == DISP_STATE_AUTOSET_DATE)
     {
         /* Restart the time, the display will stay lit up. */
-        
-        g_ucRollOver = 1;
-
-        /* Unlock write access to the RTC and disable the clock. */
-
-        Unlock_RTCC();
 
-        /* Enable writing to the RTC */
+        g_ucRollOver = 1;
 
-        RTCCFGbits.RTCWREN = 1;
+        /* Forward the day of month. */
 
-        /* Stop RTC operation. */
+        Edit_Field(FIELD_INDEX_DAY, 1);
+    }
+    else if (istate == DISP_STATE_AUTOSET_TIME)
+    {
+        /* Restart the time, the display will stay lit up. */
 
-        RTCCFGbits.RTCEN = 0;
+        g_ucRollOver = 1;
 
-        /* Forward the month. */
+        /* Forward the minutes. */
 
-        RTCCFGbits.RTCPTR0 = 0;
-        RTCCFGbits.RTCPTR1 = 1;
-        //while(RTCCFGbits.RTCSYNC);
+        Edit_Field(FIELD_INDEX_MINUTES, 1);
 
-        unsigned char ucTemp = RTCVALH;
-        unsigned char ucValue = 1 + g_bcd_decimal[ucTemp];
+        /* Indicate to zero the seconds and stall the watch. */
 
-        if (ucValue >= 13)
-        {
-            ucValue = 1;
-        }
+        g_ucTimePressCnt = HINT_AUTOSET_MINUTES_SET;
+    }
+    else if (istate == DISP_STATE_AUTOSET_WEEKDAY)
+    {
+        /* Restart the time, the display will stay lit up. */
 
-        RTCCFGbits.RTCPTR0 = 0;
-        RTCCFGbits.RTCPTR1 = 1;
+        g_ucRollOver = 1;
 
-        ucTemp = g_decimal_bcd[ucValue];
-        RTCVALH = ucTemp;
+        /* Backward the weekday. */
 
-        /* Enable the RTC operation again.*/
+        Edit_Field(FIELD_INDEX_WEEKDAY, -1);
+    }
+    else if (istate == DISP_STATE_AUTOSET_YEAR)
+    {
+        /* Restart the time, the display will stay lit up. */
 
-        RTCCFGbits.RTCEN = 1;
+        g_ucRollOver = 1;
 
-        /* Lock writing to the RTCC. */
+        /* Backward the year. */
 
-        Lock_RTCC();
+        Edit_Field(FIELD_INDEX_YEAR, -1);
     }
-    else if (istate == DISP_STATE_AUTOSET_TIME)
+    else if (istate == DISP_STATE_AUTOSET_CALIBRA)
     {
         /* Restart the time, the display will stay lit up. */
-        
+
         g_ucRollOver = 1;
 
-        /* Unlock write access to the RTC and disable the clock. */
+        /* Backward the calibration register and turn around on max. */
 
-        Unlock_RTCC();
+        Edit_Field(FIELD_INDEX_CALIBRA, -1);
+    }
 
-        /* Enable writing to the RTC */
+  #endif // #if APP_WATCH_ANY_PULSAR_MODEL == APP_WATCH_PULSAR_AUTO_SET
 
-        RTCCFGbits.RTCWREN = 1;
+    /* Holding the TIME button pressed will usually show the seconds.
+     * But reagrding how Pulsar P2/P3 and eraly P4 works, the
+     * time button can be hold pressed after the DATE button,
+     * when setting the day of month. */
 
-        /* Stop RTC operation. */
+    if (!(g_ucChord & (CHORD_HOUR | CHORD_MIN)))
+    {
+        /* If we have to deal with a Pulsar, that only has the TIME button,
+         * pressing it twice will show the DATE. That might not be original
+         * but is a nice feature anyway. Anyhow if holding the TIME button
+         * pressed, once it shows the date, it will continue with the weekday
+         * and the year. */
 
-        RTCCFGbits.RTCEN = 0;
+      #if APP_ONE_TIME_BUTTON_OPERATION
+      
+        if (istate == DISP_STATE_TIME)
+        {
+            g_uDispState = DISP_STATE_SECONDS;
 
-        /* Forward the hour. */
+            /* Set the overall timeout to prevent the battery from draining
+             * if a button is pressed and left unattended for too long. */
 
-        RTCCFGbits.RTCPTR0 = 1;
-        RTCCFGbits.RTCPTR1 = 0;
-        //while(RTCCFGbits.RTCSYNC);
+            Set_Overall_Timeout();
+        }
+        else if (istate == DISP_STATE_DATE)
+        {
+            g_uDispState = DISP_STATE_WEEKDAY;
+        }
+        else if (istate == DISP_STATE_WEEKDAY)
+        {
+            g_uDispState = DISP_STATE_YEAR;
+        }
+        else if (istate == DISP_STATE_YEAR)
+        {
+            g_uDispState = DISP_STATE_SET_CALIBRA;
+
+            /* Set the overall timeout to prevent the battery from draining
+             * if a button is pressed and left unattended for too long. */
+
+            Set_Overall_Timeout();
+        }
+
+      #else // #if APP_ONE_TIME_BUTTON_OPERATION
+
+        if (istate == DISP_STATE_TIME)
+        {
+            g_uDispState = DISP_STATE_SECONDS;
 
-        unsigned char ucTemp = RTCVALL;
-        unsigned char ucValue = 1 + g_bcd_decimal[ucTemp];
+            /* Set the overall timeout to prevent the battery from draining
+             * if a button is pressed and left unattended for too long. */
 
-        if (ucValue >= 24)
+            Set_Overall_Timeout();
+        }
+        else if ((istate == DISP_STATE_YEAR) || \
+                 (istate == DISP_STATE_LIGHT_SENSOR) || \
+                 (istate == DISP_STATE_INPUT_STATISTICS))
         {
-            ucValue = 0;
+            g_uDispState = DISP_STATE_SET_CALIBRA;
+
+            /* Set the overall timeout to prevent the battery from draining
+             * if a button is pressed and left unattended for too long. */
+
+            Set_Overall_Timeout();
         }
 
-        ucTemp = g_decimal_bcd[ucValue];
-        RTCVALL = ucTemp;
+      #endif // #else #if APP_ONE_TIME_BUTTON_OPERATION
+    }
+}
 
-        /* Enable the RTC operation again.*/
+/**
+ * Called when button 0 TIME has been released.
+ */
 
-        RTCCFGbits.RTCEN = 1;
+void ReleasePB0(void)
+{
+    const DisplayStateType istate = g_uDispState;
 
-        /* Lock writing to the RTCC. */
+  #if APP_WATCH_ANY_PULSAR_MODEL==APP_WATCH_PULSAR_MAGNET_SET
 
-        Lock_RTCC();
+    if (istate == DISP_STATE_SET_DAY)
+    {
+        g_uDispState = DISP_STATE_SET_MONTH;
     }
-    else if (istate == DISP_STATE_AUTOSET_WEEKDAY)
+    else if (istate == DISP_STATE_SET_YEAR)
     {
-        /* Restart the time, the display will stay lit up. */
-        
-        g_ucRollOver = 1;
+        g_uDispState = DISP_STATE_SET_WEEKDAY;
+    }
+    else
 
-        /* Unlock write access to the RTC and disable the clock. */
+  #endif
 
-        Unlock_RTCC();
+    if (istate == DISP_STATE_SECONDS)
+    {
+        /* Turn timer 2 off. */
 
-        /* Enabling writing to the RTC. */
+        T2CONbits.TMR2ON = 0;
 
-        RTCCFGbits.RTCWREN = 1;
+        /* Timer usage */
 
-        /* Stop the RTC */
+        g_ucTimer2Usage = 0;
+    }
 
-        RTCCFGbits.RTCEN = 0;
+  #if APP_ALARM_SCHEDULE_USAGE==1
 
-        /* Set the RTC register to read/write. */
+    else if (istate == DISP_STATE_SET_COUNTDOWN)
+    {
+        g_uDispState = DISP_STATE_COUNTDOWN;
 
-        RTCCFGbits.RTCPTR0 = 1;
-        RTCCFGbits.RTCPTR1 = 0;
-        //while(RTCCFGbits.RTCSYNC);
+        /* Start the countdown with the time set. */
+
+        Start_Countdown();
+    }
+
+  #endif
+
+    /* Clear the overall timeout to prevent the battery from draining
+     * if a button is pressed and left unattended for too long. */
+
+    if (g_ucPB1DATEState == PB_STATE_IDLE)
+    {
+        Clear_Overall_Timeout();
+    }
+}
 
-        /* Forward the weekday. */
+#if !APP_ONE_TIME_BUTTON_OPERATION
 
-        unsigned char ucTemp = RTCVALH;
-        unsigned char ucValue = 1 + (ucTemp & 7);
+/**
+ * Called when button 1 DATE has been pressed.
+ */
 
-        if (ucValue >= 7)
-        {
-            ucValue = 0;
-        }
+void PressPB1(void)
+{
+  #if APP_BUZZER_ALARM_USAGE==1
 
-        /* As accessing the hi-byte will automatically decrement
-         * the address pointer, we have to set the address again, before
-         * writing the weekday. */
+    /* Check if the alarm buzzer is still active. */
 
-        RTCCFGbits.RTCPTR0 = 1;
+    if (g_ucAlarm)
+    {
+        Turn_Buzzer_Off();
+    }
 
-        RTCVALH = ucValue;
+  #endif
 
-        /* Enable the RTC operation again.*/
+    DisplayStateType *pb = &g_uDispState;
 
-        RTCCFGbits.RTCEN = 1;
+  #if (APP_STOPWATCH_USAGE==1) && \
+      (APP_WATCH_ANY_PULSAR_MODEL == APP_WATCH_PULSAR_AUTO_SET)
 
-        /* Lock writing to the RTCC. */
+    /* Operating the stopwatch does not count towards the autoset mode. */
 
-        Lock_RTCC();
-    }
-    else if (istate == DISP_STATE_AUTOSET_YEAR)
+    if (*pb == DISP_STATE_STOPWATCH)
     {
         /* Restart the time, the display will stay lit up. */
-        
-        g_ucRollOver = 1;
-
-        /* Unlock write access to the RTC and disable the clock. */
 
-        Unlock_RTCC();
-
-        /* Enable writing to the RTC */
+        g_ucRollOver = 1;
 
-        RTCCFGbits.RTCWREN = 1;
+        /* Take a split, or step through the splits. */
 
-        /* Stop RTC operation. */
+        Split_Stopwatch();
 
-        RTCCFGbits.RTCEN = 0;
+        return;
+    }
 
-        /* Set the RTC register to read/write. */
+  #endif
 
-        RTCCFG |= 3;
-        //while(RTCCFGbits.RTCSYNC);
+    /* If using the Pulsar Autoset button mode, there
+     * are two button press counters for the TIME and DATE
+     * buttons, that are reset, when the display is turned off. */
 
-        /* Forward the year. */
+  #if APP_WATCH_ANY_PULSAR_MODEL == APP_WATCH_PULSAR_AUTO_SET
 
-        unsigned char ucTemp = RTCVALL;
-        unsigned char ucValue = 1 + g_bcd_decimal[ucTemp];
+    if (*pb == DISP_STATE_AUTOSET_DATE)
+    {
+        /* Restart the time, the display will stay lit up. */
 
-        if (ucValue >= 100)
-        {
-            ucValue = 0;
-        }
+        g_ucRollOver = 1;
 
-        ucTemp = g_decimal_bcd[ucValue];
-        RTCVALL = ucTemp;
+        /* Forward the month. */
 
-        /* Enable the RTC operation again.*/
+        Edit_Field(FIELD_INDEX_MONTH, 1);
+    }
+    else if (*pb == DISP_STATE_AUTOSET_TIME)
+    {
+        /* Restart the time, the display will stay lit up. */
 
-        RTCCFGbits.RTCEN = 1;
+        g_ucRollOver = 1;
 
-        /* Lock writing to the RTCC. */
+        /* Forward the hour. */
 
-        Lock_RTCC();
+        Edit_Field(FIELD_INDEX_HOURS, 1);
     }
-    else if (istate == DISP_STATE_AUTOSET_CALIBRA)
+    else if (*pb == DISP_STATE_AUTOSET_WEEKDAY)
     {
         /* Restart the time, the display will stay lit up. */
-        
+
         g_ucRollOver = 1;
 
-        /* Unlock write access to the RTC and disable the clock. */
+        /* Forward the weekday. */
 
-        Unlock_RTCC();
+        Edit_Field(FIELD_INDEX_WEEKDAY, 1);
+    }
+    else if (*pb == DISP_STATE_AUTOSET_YEAR)
+    {
+        /* Restart the time, the display will stay lit up. */
 
-        /* Enable writing to the RTC */
+        g_ucRollOver = 1;
 
-        RTCCFGbits.RTCWREN = 1;
+        /* Forward the year. */
 
-        /* Stop RTC operation. */
+        Edit_Field(FIELD_INDEX_YEAR, 1);
+    }
+    else if (*pb == DISP_STATE_AUTOSET_CALIBRA)
+    {
+        /* Restart the time, the display will stay lit up. */
 
-        RTCCFGbits.RTCEN = 0;
+        g_ucRollOver = 1;
 
         /* Forward the calibration register and turn around on max. */
 
-        unsigned char ucTemp = RTCCAL;
-        
-        /* Check if passing the maximum absolute value. */
-        
-        if (ucTemp & 0x80)
-        {
-            /* Negative calibration for clocks running too fast. */
-            
-            if (ucTemp >= 0xFE)
-            {
-                /* Turn around to zero value. */
+        Edit_Field(FIELD_INDEX_CALIBRA, 1);
+    }
+    else
+    {
+        g_ucTimePressCnt = 0;
 
-                ucTemp = 0;
-            }
-            else
-            {
-                ucTemp += 2;
-            }
-        }
-        else // if (ucTemp & 0x80)
+        if (g_ucDatePressCnt < 3)
         {
-            /* Positive calibration for clocks running too slow. */
-
-            if (ucTemp >= 0x7E)
-            {
-                /* Turn around to maximum negative value. */
-
-                ucTemp = 0x82;
-            }
-            else
+            if (++g_ucDatePressCnt == 3)
             {
-                ucTemp += 2;
+                if (*pb == DISP_STATE_WEEKDAY)
+                {
+                    *pb = DISP_STATE_AUTOSET_WEEKDAY;
+                }
+                else if (*pb == DISP_STATE_YEAR)
+                {
+                    *pb = DISP_STATE_AUTOSET_YEAR;
+                }
+                else
+                {
+                    *pb = DISP_STATE_AUTOSET_DATE;
+                }
             }
         }
-        
-        RTCCAL = ucTemp;
-
-        /* Enable the RTC operation again.*/
-
-        RTCCFGbits.RTCEN = 1;
-
-        /* Lock writing to the RTCC. */
-
-        Lock_RTCC();
     }
 
-  #endif //   #if APP_WATCH_ANY_PULSAR_MODEL == APP_WATCH_PULSAR_AUTO_SET
+  #endif // #if APP_WATCH_ANY_PULSAR_MODEL == APP_WATCH_PULSAR_AUTO_SET
 
-    /* Holding the date button pressed, will forward to the weekday and year. */
+    const DisplayStateType istate = *pb;
+
+    /* Revoke the 'blanked' state in order to turn the display on. */
 
-    if ((g_ucPB0TIMEState == PB_STATE_IDLE) && \
-        (g_ucPB2HOURState == PB_STATE_IDLE) && \
-        (g_ucPB3MINTState == PB_STATE_IDLE))
+    if (istate == DISP_STATE_BLANK)
     {
-        if (istate == DISP_STATE_DATE)
-        {
-            g_uDispState = DISP_STATE_WEEKDAY;
-        }
-        else if (istate == DISP_STATE_WEEKDAY)
-        {
-            g_uDispState = DISP_STATE_YEAR;
+        /* Restart the time, the display will stay lit up. */
 
-        #if APP_LIGHT_SENSOR_USAGE_DEBUG_SHOW_VALUE==0
+        g_ucRollOver = 1;
 
-            /* Set the overall timeout to prevent the battery from draining
-             * if a button is pressed and left unattended for too long. */
+      #if APP_STOPWATCH_USAGE==1
 
-            Set_Overall_Timeout();
+        /* Show the stopwatch instead of the date, while it is running. */
 
-        #endif
+        if (g_ucStopwatchRunning)
+        {
+            *pb = DISP_STATE_STOPWATCH;
         }
+        else
 
-      #if APP_LIGHT_SENSOR_USAGE_DEBUG_SHOW_VALUE==1
+      #endif
 
-        else if (istate == DISP_STATE_YEAR)
         {
-            g_uDispState = DISP_STATE_LIGHT_SENSOR;
+            *pb = DISP_STATE_DATE;
+        }
+    }
 
-            /* Set the overall timeout to prevent the battery from draining
-             * if a button is pressed and left unattended for too long. */
+    /* Show the date respectively the alarm time. */
 
-            Set_Overall_Timeout();
-        }
+  #if (APP_WATCH_TYPE_BUILD==APP_PULSAR_WRIST_WATCH_12H_LEGACY_MOD) || \
+      (APP_WATCH_TYPE_BUILD==APP_PULSAR_P3_WRIST_WATCH_12H_ODIN_MARK_II_MOD) || \
+      (APP_WATCH_TYPE_BUILD==APP_PULSAR_WRIST_WATCH_12H_SIF_LEGACY_MOD) || \
+      (APP_WATCH_TYPE_BUILD==APP_PULSAR_P4_WRIST_WATCH_12H_SIF_MARK_II_MOD)
 
-      #endif
+    else if (istate == DISP_STATE_TIME)
+    {
+        *pb = DISP_STATE_DATE;
     }
-}
 
-/**
- * Called when button 1 DATE has been released.
- */
+  #elif APP_BUZZER_ALARM_USAGE==1
 
-void ReleasePB1(void)
-{
-  #if APP_BUZZER_ALARM_USAGE==1
+    else if ((istate == DISP_STATE_TIME) || (istate == DISP_STATE_SECONDS))
+    {
+        *pb = DISP_STATE_ALARM;
 
-    DisplayStateType *pb = &g_uDispState;
+        /* Set the overall timeout to prevent the battery from draining
+         * if a button is pressed and left unattended for too long. */
+
+        Set_Overall_Timeout();
+    }
+
+  #else
 
-    if (*pb == DISP_STATE_ALARM)
+    else if (istate == DISP_STATE_TIME)
     {
-        if (((g_ucPB0TIMEState == PB_STATE_SHORT_PRESS) || \
-             (g_ucPB0TIMEState == PB_STATE_LONG_PRESS)) \
-             \
-             && \
-             \
-            (g_ucPB2HOURState == PB_STATE_IDLE) && \
-            (g_ucPB3MINTState == PB_STATE_IDLE))
-        {
-            *pb = DISP_STATE_TOGGLE_ALARM;
-        }
+        *pb = DISP_STATE_DATE;
     }
 
   #endif
 
-    /* Clear the overall timeout to prevent the battery from draining
-     * if a button is pressed and left unattended for too long. */
+  #if (APP_BUZZER_ALARM_USAGE==1) && \
+      (APP_WATCH_ANY_PULSAR_MODEL!=APP_WATCH_PULSAR_AUTO_SET)
 
-    if (g_ucPB0TIMEState == PB_STATE_IDLE)
+    /* Leave the service mode of the buzzer without keeping the period. */
+
+    else if (istate == DISP_STATE_PIEZO_SWEEP)
     {
-        Clear_Overall_Timeout();
+        *pb = DISP_STATE_ALARM;
     }
-}
 
-#endif // #if !APP_ONE_TIME_BUTTON_OPERATION
+  #endif
 
-#if APP_WATCH_ANY_PULSAR_MODEL!=APP_WATCH_PULSAR_AUTO_SET
+  #if (APP_STOPWATCH_USAGE==1) && \
+      (APP_WATCH_ANY_PULSAR_MODEL!=APP_WATCH_PULSAR_AUTO_SET)
 
-/**
- * Called when button 2 HOUR has been pressed.
- */
+    else if (istate == DISP_STATE_STOPWATCH)
+    {
+        /* Restart the time, the display will stay lit up. */
 
-void PressPB2(void)
-{
-  #if APP_BUZZER_ALARM_USAGE==1
+        g_ucRollOver = 1;
 
-    /* Check if the alarm buzzer is still active. */
+        /* Take a split, or step through the splits. */
 
-    if (g_ucAlarm)
-    {
-        Turn_Buzzer_Off();
+        Split_Stopwatch();
     }
 
   #endif
 
-    /* Revoke the 'blanked' state in order to turn the display on. */
+  #if !((APP_WATCH_TYPE_BUILD==APP_PULSAR_WRIST_WATCH_12H_LEGACY_MOD) || \
+        (APP_WATCH_TYPE_BUILD==APP_PULSAR_P3_WRIST_WATCH_12H_ODIN_MARK_II_MOD) || \
+        (APP_WATCH_TYPE_BUILD==APP_PULSAR_WRIST_WATCH_12H_SIF_LEGACY_MOD) || \
+        (APP_WATCH_TYPE_BUILD==APP_PULSAR_P4_WRIST_WATCH_12H_SIF_MARK_II_MOD))
 
-    DisplayStateType *pb = &g_uDispState;
+   #if APP_BUZZER_ALARM_USAGE==1
 
-    if (*pb == DISP_STATE_BLANK)
-    {
-        *pb = DISP_STATE_SET_HOURS;
-    }
-    else
+    else if (istate == DISP_STATE_TOGGLE_ALARM)
     {
-        /* If the display is in DATE mode and the HOUR button is pressed,
-         * enter setting the month mode. */
+        /* Toggle the alarm, if the TIME button is held pressed, but
+         * neither HOUR nor MIN. */
 
-        const unsigned char ust = *pb;
-
-        if (((ust == DISP_STATE_DATE) || \
-             (ust == DISP_STATE_SET_DAY) || \
-             (ust == DISP_STATE_SET_MONTH)))
+        if ((g_ucChord & (CHORD_TIME | CHORD_HOUR | CHORD_MIN)) == CHORD_TIME)
         {
-            /* If time and date button have been pressed and the HOUR
-             * button is pressed as well, forward the day of month.*/
+          #if APP_ALARM_SCHEDULE_USAGE==1
 
-          #if APP_WATCH_ANY_PULSAR_MODEL==APP_WATCH_PULSAR_MAGNET_SET
+            /* Cycle through alarm, alarm and chime, chime only and off,
+             * then arm the entry due next. */
 
-           #if APP_ONE_TIME_BUTTON_OPERATION
+            static const unsigned char ucycles[4] = { 1, 3, 0, 2 };
 
-            if (g_ucPB0TIMEState >= PB_STATE_SHORT_PRESS)
-            {
-                *pb = DISP_STATE_SET_MONTH;
-            }
+            unsigned char *pdaily = &g_alarms[ALARM_ENTRY_DAILY].flags;
+            unsigned char *pchime = &g_alarms[ALARM_ENTRY_CHIME].flags;
 
-           #else // #if APP_ONE_TIME_BUTTON_OPERATION
+            unsigned char ucycle = (*pdaily & ALARM_FLAG_ENABLED) ? 1 : 0;
 
-            if (g_ucPB1DATEState >= PB_STATE_SHORT_PRESS)
-            {
-                if (g_ucPB0TIMEState >= PB_STATE_SHORT_PRESS)
-                {
-                    *pb = DISP_STATE_SET_DAY;
-                }
-                else
-                {
-                    *pb = DISP_STATE_SET_MONTH;
-                }
-            }
+            ucycle |= (*pchime & ALARM_FLAG_ENABLED) ? 2 : 0;
+            ucycle = ucycles[ucycle];
 
-            #endif // #else #if APP_ONE_TIME_BUTTON_OPERATION
+            *pdaily = (*pdaily & ~ALARM_FLAG_ENABLED) |
+                      ((ucycle & 1) ? ALARM_FLAG_ENABLED : 0);
+            *pchime = (*pchime & ~ALARM_FLAG_ENABLED) |
+                      ((ucycle & 2) ? ALARM_FLAG_ENABLED : 0);
+
+            Schedule_Next_Alarm();
 
           #else
 
-            *pb = DISP_STATE_SET_MONTH;
+            /* Unlock write access to the RTC and disable the clock. */
+
+            Unlock_RTCC();
 
-          #endif
-        }
-        else
-        {
-            /* If the display is not in DATE mode, go to set HOURS mode. */
+            /* Enable writing to the RTC */
+
+            RTCCFGbits.RTCWREN = 1;
+
+            /* Stop RTC operation. */
+
+            RTCCFGbits.RTCEN = 0;
+
+            /* Toggle the alarm bit. */
+
+            ALRMCFGbits.AMASK = 0x06; // Alarm repeats every day.
+
+            int ival = ALRMCFGbits.ALRMEN ? 0 : 1;
+
+            ALRMCFGbits.CHIME = ival ? 1 : 0;  // Chime enable;
+
+            /* Set Alarm repeat */
+
+            ALRMRPT = ival ? 255 : 0;
+
+            /* Enable the Alarm interrupt, if the alarm had been enabled. */
+
+            PIE3bits.RTCCIE = ival ? 1 : 0;
+
+            /* PERIPHERAL INTERRUPT REQUEST (FLAG) REGISTER 3 */
+
+            PIR3bits.RTCCIF = 0;    // No RTCC interrupt occurred.
 
-            if ((ust == DISP_STATE_TIME) || (ust == DISP_STATE_SET_MINUTES) || \
-                (ust == DISP_STATE_SET_SECONDS))
-            {
-                *pb = DISP_STATE_SET_HOURS;
-            }
+            /* Enable/diable alarm */
+            
+            ALRMCFGbits.ALRMEN = ival ? 1 : 0;  // Alarm enable
 
-          #if APP_WATCH_ANY_PULSAR_MODEL==APP_WATCH_PULSAR_MAGNET_SET
+            /* Enable the RTC operation again.*/
 
-            else
-            {
-                /* If the display is in YEAR mode, go to set YEAR mode. */
+            RTCCFGbits.RTCEN = 1;
 
-                if (ust == DISP_STATE_YEAR)
-                {
-                    *pb = DISP_STATE_SET_YEAR;
-                }
-            }
+            /* Lock writing to the RTCC. */
 
-          #endif
+            Lock_RTCC();
+
+          #endif // #if APP_ALARM_SCHEDULE_USAGE==1
         }
     }
 
-    /* Quick forward the value */
-
-    HoldPB2();
-
-    /* Cancel the overall timeout to prevent the battery from draining
-     * if a button is pressed and left unattended for too long. */
+   #endif // #if APP_BUZZER_ALARM_USAGE==1
 
-    Clear_Overall_Timeout();
+  #endif
 }
 
 /**
- * Called when button 2 HOUR has been held pressed.
+ * Called when button 1 DATE has been held pressed.
  */
 
-void HoldPB2(void)
+void HoldPB1(void)
 {
-    unsigned char ucTemp;
-    unsigned char ucValue;
-    unsigned char ucExtra;
-
-    /* Check if setting hours, minutes, month or day. */
+    DisplayStateType istate = g_uDispState;
+    
+    /* If using the Pulsar Autoset button mode, there
+     * are two button press counters for the TIME and DATE
+     * buttons, that are reset, when the display is turned off. */
 
-    const DisplayStateType ust = g_uDispState;
+  #if APP_WATCH_ANY_PULSAR_MODEL == APP_WATCH_PULSAR_AUTO_SET
 
-    if (ust == DISP_STATE_SET_HOURS)
+    if (istate == DISP_STATE_AUTOSET_DATE)
     {
-        /* Unlock write access to the RTC and disable the clock. */
-
-        Unlock_RTCC();
+        /* Restart the time, the display will stay lit up. */
 
-        /* Enable writing to the RTC */
+        g_ucRollOver = 1;
 
-        RTCCFGbits.RTCWREN = 1;
+        /* Forward the month. */
 
-        /* Stop RTC operation. */
+        Edit_Field(FIELD_INDEX_MONTH, 1);
+    }
+    else if (istate == DISP_STATE_AUTOSET_TIME)
+    {
+        /* Restart the time, the display will stay lit up. */
 
-        RTCCFGbits.RTCEN = 0;
+        g_ucRollOver = 1;
 
         /* Forward the hour. */
 
-        RTCCFGbits.RTCPTR0 = 1;
-        RTCCFGbits.RTCPTR1 = 0;
-        //while(RTCCFGbits.RTCSYNC);
-
-        ucTemp = RTCVALL;
-        ucValue = 1 + g_bcd_decimal[ucTemp];
-
-        if (ucValue >= 24)
-        {
-            ucValue = 0;
-        }
-
-        ucTemp = g_decimal_bcd[ucValue];
-        RTCVALL = ucTemp;
-
-        /* Enable the RTC operation again.*/
+        Edit_Field(FIELD_INDEX_HOURS, 1);
+    }
+    else if (istate == DISP_STATE_AUTOSET_WEEKDAY)
+    {
+        /* Restart the time, the display will stay lit up. */
 
-        RTCCFGbits.RTCEN = 1;
+        g_ucRollOver = 1;
 
-        /* Lock writing to the RTCC. */
+        /* Forward the weekday. */
 
-        Lock_RTCC();
+        Edit_Field(FIELD_INDEX_WEEKDAY, 1);
     }
-    else if (ust == DISP_STATE_SET_MONTH)
+    else if (istate == DISP_STATE_AUTOSET_YEAR)
     {
-        /* Unlock write access to the RTC and disable the clock. */
+        /* Restart the time, the display will stay lit up. */
 
-        Unlock_RTCC();
+        g_ucRollOver = 1;
 
-        /* Enable writing to the RTC */
+        /* Forward the year. */
 
-        RTCCFGbits.RTCWREN = 1;
+        Edit_Field(FIELD_INDEX_YEAR, 1);
+    }
+    else if (istate == DISP_STATE_AUTOSET_CALIBRA)
+    {
+        /* Restart the time, the display will stay lit up. */
 
-        /* Stop RTC operation. */
+        g_ucRollOver = 1;
 
-        RTCCFGbits.RTCEN = 0;
+        /* Forward the calibration register and turn around on max. */
 
-        /* Forward the month. */
+        Edit_Field(FIELD_INDEX_CALIBRA, 1);
+    }
 
-        RTCCFGbits.RTCPTR0 = 0;
-        RTCCFGbits.RTCPTR1 = 1;
-        //while(RTCCFGbits.RTCSYNC);
+  #endif //   #if APP_WATCH_ANY_PULSAR_MODEL == APP_WATCH_PULSAR_AUTO_SET
 
-        ucTemp = RTCVALH;
-        ucValue = 1 + g_bcd_decimal[ucTemp];
+    /* Holding the date button pressed, will forward to the weekday and year. */
 
-        if (ucValue >= 13)
+    if (!(g_ucChord & (CHORD_TIME | CHORD_HOUR | CHORD_MIN)))
+    {
+        if (istate == DISP_STATE_DATE)
         {
-            ucValue = 1;
+            g_uDispState = DISP_STATE_WEEKDAY;
         }
+        else if (istate == DISP_STATE_WEEKDAY)
+        {
+            g_uDispState = DISP_STATE_YEAR;
 
-        RTCCFGbits.RTCPTR0 = 0;
-        RTCCFGbits.RTCPTR1 = 1;
-
-        ucTemp = g_decimal_bcd[ucValue];
-        RTCVALH = ucTemp;
-
-        /* Enable the RTC operation again.*/
+        #if APP_LIGHT_SENSOR_USAGE_DEBUG_SHOW_VALUE==0
 
-        RTCCFGbits.RTCEN = 1;
+            /* Set the overall timeout to prevent the battery from draining
+             * if a button is pressed and left unattended for too long. */
 
-        /* Lock writing to the RTCC. */
+            Set_Overall_Timeout();
 
-        Lock_RTCC();
-    }
-    else if (ust == DISP_STATE_SET_DAY)
-    {
-        /* Unlock write access to the RTC and disable the clock. */
+        #endif
+        }
 
-        Unlock_RTCC();
+      #if APP_STOPWATCH_USAGE==1
 
-        /* Enable writing to the RTC */
+        else if (istate == DISP_STATE_YEAR)
+        {
+            /* Show the stopwatch, keeping its state. */
 
-        RTCCFGbits.RTCWREN = 1;
+            g_uDispState = DISP_STATE_STOPWATCH;
+        }
 
-        /* Stop RTC operation. */
+      #endif
 
-        RTCCFGbits.RTCEN = 0;
+      #if APP_LIGHT_SENSOR_USAGE_DEBUG_SHOW_VALUE==1
 
-      #if (APP_WATCH_TYPE_BUILD==APP_PULSAR_WRIST_WATCH_12H_LEGACY_MOD) || \
-          (APP_WATCH_TYPE_BUILD==APP_PULSAR_P3_WRIST_WATCH_12H_ODIN_MARK_II_MOD) || \
-          (APP_WATCH_TYPE_BUILD==APP_PULSAR_WRIST_WATCH_12H_SIF_LEGACY_MOD) || \
-          (APP_WATCH_TYPE_BUILD==APP_PULSAR_P4_WRIST_WATCH_12H_SIF_MARK_II_MOD)
+       #if APP_STOPWATCH_USAGE==1
+        else if (istate == DISP_STATE_STOPWATCH)
+       #else
+        else if (istate == DISP_STATE_YEAR)
+       #endif
+        {
+            g_uDispState = DISP_STATE_LIGHT_SENSOR;
 
-        ucExtra = 1;
+            /* Set the overall timeout to prevent the battery from draining
+             * if a button is pressed and left unattended for too long. */
 
-        /* On every second cycle change betwen AM and PM and otherwise
-         * forward the day. */
+            Set_Overall_Timeout();
+        }
 
-        RTCCFGbits.RTCPTR0 = 1;
-        RTCCFGbits.RTCPTR1 = 0;
+      #endif
 
-        ucTemp = RTCVALL;
-        ucValue = g_bcd_decimal[ucTemp];
+      #if APP_INPUT_STATISTICS_USAGE==1
 
-        if (ucValue < 12)
+       #if APP_LIGHT_SENSOR_USAGE_DEBUG_SHOW_VALUE==1
+        else if (istate == DISP_STATE_LIGHT_SENSOR)
+       #elif APP_STOPWATCH_USAGE==1
+        else if (istate == DISP_STATE_STOPWATCH)
+       #else
+        else if (istate == DISP_STATE_YEAR)
+       #endif
         {
-            /* AM -> PM */
-
-            ucValue += 12;
+            /* Show the input statistics, starting with the first page. */
 
-            ucTemp = g_decimal_bcd[ucValue];
-            RTCVALL = ucTemp;
+            g_uDispState = DISP_STATE_INPUT_STATISTICS;
+            g_ucStatPage = 0;
 
-            /* Do not forward the day. */
+            /* Set the overall timeout to prevent the battery from draining
+             * if a button is pressed and left unattended for too long. */
 
-            ucExtra = 0;
+            Set_Overall_Timeout();
         }
-        else
+        else if ((istate == DISP_STATE_INPUT_STATISTICS) && \
+                 (g_ucStatPage < 3))
         {
-            /* PM -> AM */
+            /* Show the next page of the input statistics. */
 
-            ucValue -= 12;
-
-            ucTemp = g_decimal_bcd[ucValue];
-            RTCVALL = ucTemp;
+            g_ucStatPage++;
         }
 
-        if (ucExtra)
-
       #endif
+    }
+}
 
-        {
-            /* Forward the day of month. */
+/**
+ * Called when button 1 DATE has been released.
+ */
 
-            RTCCFGbits.RTCPTR0 = 0;
-            RTCCFGbits.RTCPTR1 = 1;
-            //while(RTCCFGbits.RTCSYNC);
+void ReleasePB1(void)
+{
+  #if APP_BUZZER_ALARM_USAGE==1
 
-            ucTemp = RTCVALL; // day
-            ucValue = 1 + g_bcd_decimal[ucTemp];
+    /* Toggle the alarm, if the TIME button is held pressed, but neither
+     * HOUR nor MIN. */
 
-            ucTemp = RTCVALH; // month
-            ucExtra = g_bcd_decimal[ucTemp];
+    if ((g_uDispState == DISP_STATE_ALARM) && \
+        ((g_ucChord & (CHORD_TIME | CHORD_HOUR | CHORD_MIN)) == CHORD_TIME))
+    {
+        g_uDispState = DISP_STATE_TOGGLE_ALARM;
+    }
 
-            if (ucExtra == 2) // February, always assume it to be a leap year.
-            {
-                /* Assume february to have 29 days to support leap years. */
+  #endif
 
-                if (ucValue >= 30) // 29 days (leap year)
-                {
-                    ucValue = 1;
-                }
-            }
-            else if ((ucExtra == 1) || (ucExtra == 3) || (ucExtra == 5) || \
-                     (ucExtra == 7) || (ucExtra == 8) || (ucExtra == 10) || \
-                     (ucExtra == 12))
-            {
-                if (ucValue >= 32) // 31 days
-                {
-                    ucValue = 1;
-                }
-            }
-            else
-            {
-                if (ucValue >= 31) // 30 days
-                {
-                    ucValue = 1;
-                }
-            }
+    /* Clear the overall timeout to prevent the battery from draining
+     * if a button is pressed and left unattended for too long. */
 
-            RTCCFGbits.RTCPTR0 = 0;
-            RTCCFGbits.RTCPTR1 = 1;
+    if (g_ucPB0TIMEState == PB_STATE_IDLE)
+    {
+        Clear_Overall_Timeout();
+    }
+}
 
-            ucTemp = g_decimal_bcd[ucValue];
-            RTCVALL = ucTemp;
-        }
+#endif // #if !APP_ONE_TIME_BUTTON_OPERATION
 
-        /* Enable the RTC operation again.*/
+#if APP_WATCH_ANY_PULSAR_MODEL!=APP_WATCH_PULSAR_AUTO_SET
 
-        RTCCFGbits.RTCEN = 1;
+/**
+ * Called when button 2 HOUR has been pressed.
+ */
 
-        /* Lock writing to the RTCC. */
+void PressPB2(void)
+{
+  #if APP_BUZZER_ALARM_USAGE==1
 
-        Lock_RTCC();
-    }
-    else if (ust == DISP_STATE_SET_YEAR)
-    {
-        /* Unlock write access to the RTC and disable the clock. */
+    /* Check if the alarm buzzer is still active, the service mode keeps
+     * sounding while stepping the period. */
 
-        Unlock_RTCC();
+    if ((g_ucAlarm) && (!g_ucPiezoSweep))
+    {
+        Turn_Buzzer_Off();
+    }
 
-        /* Enable writing to the RTC */
+  #endif
 
-        RTCCFGbits.RTCWREN = 1;
+    const DisplayStateType istate = g_uDispState;
 
-        /* Stop RTC operation. */
+    /* Revoke the 'blanked' state in order to turn the display on,
+     * or enter setting the hours respectively the month. */
 
-        RTCCFGbits.RTCEN = 0;
+    if ((istate == DISP_STATE_BLANK) || (istate == DISP_STATE_TIME) || \
+        (istate == DISP_STATE_SET_MINUTES) || (istate == DISP_STATE_SET_SECONDS))
+    {
+        g_uDispState = DISP_STATE_SET_HOURS;
+    }
+    else if ((istate == DISP_STATE_DATE) || (istate == DISP_STATE_SET_DAY) || \
+             (istate == DISP_STATE_SET_MONTH))
+    {
+      #if APP_WATCH_ANY_PULSAR_MODEL==APP_WATCH_PULSAR_MAGNET_SET
 
-        /* Set the RTC register to read/write. */
+       #if APP_ONE_TIME_BUTTON_OPERATION
 
-        RTCCFG |= 3;
-        //while(RTCCFGbits.RTCSYNC);
+        if (g_ucChord & CHORD_TIME)
+        {
+            g_uDispState = DISP_STATE_SET_MONTH;
+        }
 
-        /* Forward the year. */
+       #else // #if APP_ONE_TIME_BUTTON_OPERATION
 
-        ucTemp = RTCVALL;
-        ucValue = 1 + g_bcd_decimal[ucTemp];
+        /* If time and date button have been pressed and the HOUR button
+         * is pressed as well, forward the day of month. */
 
-        if (ucValue >= 100)
+        if ((g_ucChord & (CHORD_TIME | CHORD_DATE)) == \
+            (CHORD_TIME | CHORD_DATE))
         {
-            ucValue = 0;
+            g_uDispState = DISP_STATE_SET_DAY;
+        }
+        else if (g_ucChord & CHORD_DATE)
+        {
+            g_uDispState = DISP_STATE_SET_MONTH;
         }
 
-        ucTemp = g_decimal_bcd[ucValue];
-        RTCVALL = ucTemp;
-
-        /* Enable the RTC operation again.*/
+       #endif // #else #if APP_ONE_TIME_BUTTON_OPERATION
 
-        RTCCFGbits.RTCEN = 1;
+      #else // #if APP_WATCH_ANY_PULSAR_MODEL==APP_WATCH_PULSAR_MAGNET_SET
 
-        /* Lock writing to the RTCC. */
+        g_uDispState = DISP_STATE_SET_MONTH;
 
-        Lock_RTCC();
+      #endif // #else #if APP_WATCH_ANY_PULSAR_MODEL==APP_WATCH_PULSAR_MAGNET_SET
     }
-    else if (ust == DISP_STATE_SET_CALIBRA)
-    {
-        /* Unlock write access to the RTC and disable the clock. */
 
-        Unlock_RTCC();
-
-        /* Enable writing to the RTC */
-
-        RTCCFGbits.RTCWREN = 1;
-
-        /* Stop RTC operation. */
-
-        RTCCFGbits.RTCEN = 0;
-
-        /* Forward the calibration register and turn around on max. */
+  #if APP_WATCH_ANY_PULSAR_MODEL==APP_WATCH_PULSAR_MAGNET_SET
 
-        ucTemp = RTCCAL;
-        
-        /* Check if passing the maximum absolute value. */
-        
-        if (ucTemp & 0x80)
-        {
-            /* Negative calibration for clocks running too fast. */
-            
-            if (ucTemp <= 0x81)
-            {
-                /* Turn around to zero value. */
+    else if (istate == DISP_STATE_YEAR)
+    {
+        g_uDispState = DISP_STATE_SET_YEAR;
+    }
 
-                ucTemp = 0x7E;
-            }
-            else
-            {
-                ucTemp -= 2;
-            }
-        }
-        else // if (ucTemp & 0x80)
-        {
-            /* Positive calibration for clocks running too slow. */
+  #endif
 
-            if (ucTemp <= 0x01)
-            {
-                /* Turn around to maximum negative value. */
+  #if APP_ALARM_SCHEDULE_USAGE==1
 
-                ucTemp = 0xFE;
-            }
-            else
-            {
-                ucTemp -= 2;
-            }
-        }
-        
-        RTCCAL = ucTemp;
+    else if (istate == DISP_STATE_COUNTDOWN)
+    {
+        g_uDispState = DISP_STATE_SET_COUNTDOWN;
+    }
 
-        /* Enable the RTC operation again.*/
+  #endif
 
-        RTCCFGbits.RTCEN = 1;
+    /* Quick forward the value */
 
-        /* Lock writing to the RTCC. */
+    HoldPB2();
 
-        Lock_RTCC();
-    }
+    /* Cancel the overall timeout to prevent the battery from draining
+     * if a button is pressed and left unattended for too long. */
 
-  #if APP_BUZZER_ALARM_USAGE==1
+    Clear_Overall_Timeout();
+}
 
-    else if ((ust == DISP_STATE_ALARM) || \
-             (ust == DISP_STATE_TOGGLE_ALARM))
-    {
-        /* Unlock write access to the RTC and disable the clock. */
+/**
+ * Called when button 2 HOUR has been held pressed.
+ */
 
-        Unlock_RTCC();
+void HoldPB2(void)
+{
+    /* Check if setting hours, minutes, month or day. */
 
-        /* Enable writing to the RTC */
+    const DisplayStateType ust = g_uDispState;
 
-        RTCCFGbits.RTCWREN = 1;
+    if (ust == DISP_STATE_SET_HOURS)
+    {
+        /* Forward the hour. */
 
-        /* Stop RTC operation. */
+        Edit_Field(FIELD_INDEX_HOURS, 1);
+    }
+    else if (ust == DISP_STATE_SET_MONTH)
+    {
+        /* Forward the month. */
 
-        RTCCFGbits.RTCEN = 0;
+        Edit_Field(FIELD_INDEX_MONTH, 1);
+    }
+    else if (ust == DISP_STATE_SET_DAY)
+    {
+        /* Forward the day of month. */
 
-        /* Forward the alarm hour. */
+        Edit_Field(FIELD_INDEX_DAY, 1);
+    }
+    else if (ust == DISP_STATE_SET_YEAR)
+    {
+        /* Forward the year. */
 
-        ALRMCFGbits.ALRMPTR0 = 1;
-        ALRMCFGbits.ALRMPTR1 = 0;
+        Edit_Field(FIELD_INDEX_YEAR, 1);
+    }
+    else if (ust == DISP_STATE_SET_CALIBRA)
+    {
+        /* Backward the calibration register and turn around on max. */
 
-        ucTemp = ALRMVALL;
-        ucValue = 1 + g_bcd_decimal[ucTemp];
+        Edit_Field(FIELD_INDEX_CALIBRA, -1);
+    }
 
-        if (ucValue >= 24)
-        {
-            ucValue = 0;
-        }
+  #if APP_BUZZER_ALARM_USAGE==1
 
-        ucTemp = g_decimal_bcd[ucValue];
-        ALRMVALL = ucTemp;
+    else if ((ust == DISP_STATE_ALARM) || \
+             (ust == DISP_STATE_TOGGLE_ALARM))
+    {
+        /* Forward the alarm hour. */
 
-        /* Ensure the other register being valid. */
+        Edit_Field(FIELD_INDEX_ALARM_HOURS, 1);
+    }
+    else if (ust == DISP_STATE_PIEZO_SWEEP)
+    {
+        /* Step to a higher tone, once DATE entering the service mode
+         * has been released. */
 
-        ALRMCFGbits.ALRMPTR0 = 0;
-        ALRMCFGbits.ALRMPTR1 = 1;
+        if ((g_ucPiezoSweep) && (!(g_ucChord & CHORD_DATE)))
+        {
+            g_ucPiezoSweep = PIEZO_SWEEP_MANUAL;
 
-        ALRMVALL = 1; // Day
-        ALRMVALH = 1; // Month, auto-decrement!
-        ALRMVALH = 1; // Weekday
+            Step_Piezo_Sweep(-1);
+        }
+    }
 
-        /* Enable the RTC operation again.*/
+  #endif
 
-        RTCCFGbits.RTCEN = 1;
+  #if APP_ALARM_SCHEDULE_USAGE==1
 
-        /* Lock writing to the RTCC. */
+    else if (ust == DISP_STATE_SET_COUNTDOWN)
+    {
+        /* Forward the hours of the countdown. */
 
-        Lock_RTCC();
+        g_ucCountdownHours = Bcd_Step(g_ucCountdownHours, 1, 0x00, 0x23);
     }
 
   #endif
@@ -4323,97 +5821,115 @@ void PressPB3(void)
 {
   #if APP_BUZZER_ALARM_USAGE==1
 
-    /* Check if the alarm buzzer is still active. */
+    /* Check if the alarm buzzer is still active, the service mode keeps
+     * sounding while stepping the period. */
 
-    if (g_ucAlarm)
+    if ((g_ucAlarm) && (!g_ucPiezoSweep))
     {
         Turn_Buzzer_Off();
     }
 
   #endif
 
-    /* Revoke the 'blanked' state in order to turn the display on. */
+    const DisplayStateType istate = g_uDispState;
 
-    DisplayStateType *pb = &g_uDispState;
-    DisplayStateType ust = *pb;
+    /* Revoke the 'blanked' state in order to turn the display on,
+     * or enter setting the minutes respectively the date. */
 
-    if (ust == DISP_STATE_BLANK)
+    if ((istate == DISP_STATE_BLANK) || (istate == DISP_STATE_TIME) || \
+        (istate == DISP_STATE_SET_HOURS))
     {
-        *pb = DISP_STATE_SET_MINUTES;
+        g_uDispState = DISP_STATE_SET_MINUTES;
     }
-    else
+
+  #if APP_WATCH_ANY_PULSAR_MODEL==APP_WATCH_PULSAR_MAGNET_SET
+
+   #if APP_ONE_TIME_BUTTON_OPERATION
+
+    else if (((istate == DISP_STATE_DATE) || (istate == DISP_STATE_SET_MONTH)) && \
+             (g_ucChord & CHORD_TIME))
+    {
+        g_uDispState = DISP_STATE_SET_DAY;
+    }
+    else if ((istate == DISP_STATE_YEAR) && (g_ucChord & CHORD_TIME))
+    {
+        g_uDispState = DISP_STATE_SET_YEAR;
+    }
+    else if ((istate == DISP_STATE_WEEKDAY) && (g_ucChord & CHORD_TIME))
     {
-        /* If the time is pressed, enable to set the MINUTES. */
+        g_uDispState = DISP_STATE_SET_WEEKDAY;
+    }
+
+   #else // #if APP_ONE_TIME_BUTTON_OPERATION
+
+    else if ((istate == DISP_STATE_DATE) || (istate == DISP_STATE_YEAR) || \
+             (istate == DISP_STATE_WEEKDAY) || (istate == DISP_STATE_SET_DAY))
+    {
+        /* Set the year while time and date button are pressed, else the
+         * weekday while the date button is pressed. */
 
-        if ((ust == DISP_STATE_TIME) || (ust == DISP_STATE_SET_HOURS))
+        if ((g_ucChord & (CHORD_TIME | CHORD_DATE)) == \
+            (CHORD_TIME | CHORD_DATE))
         {
-            *pb = DISP_STATE_SET_MINUTES;
+            g_uDispState = DISP_STATE_SET_YEAR;
         }
-        else
+        else if (g_ucChord & CHORD_DATE)
         {
-          #if APP_WATCH_ANY_PULSAR_MODEL==APP_WATCH_PULSAR_MAGNET_SET
+            g_uDispState = DISP_STATE_SET_WEEKDAY;
+        }
+    }
 
-            #if APP_ONE_TIME_BUTTON_OPERATION
+   #endif // #else #if APP_ONE_TIME_BUTTON_OPERATION
 
-            if (g_ucPB0TIMEState >= PB_STATE_SHORT_PRESS)
-            {
-                if ((ust == DISP_STATE_DATE) || (ust == DISP_STATE_SET_MONTH))
-                {
-                    *pb = DISP_STATE_SET_DAY;
-                }
-                else if (ust == DISP_STATE_YEAR)
-                {
-                    *pb = DISP_STATE_SET_YEAR;
-                }
-                else if (ust == DISP_STATE_WEEKDAY)
-                {
-                    *pb = DISP_STATE_SET_WEEKDAY;
-                }
-            }
+  #else // #if APP_WATCH_ANY_PULSAR_MODEL==APP_WATCH_PULSAR_MAGNET_SET
 
-           #else // #if APP_ONE_TIME_BUTTON_OPERATION
+    else if ((istate == DISP_STATE_DATE) || (istate == DISP_STATE_SET_MONTH))
+    {
+        g_uDispState = DISP_STATE_SET_DAY;
+    }
+    else if (istate == DISP_STATE_YEAR)
+    {
+        g_uDispState = DISP_STATE_SET_YEAR;
+    }
+    else if (istate == DISP_STATE_WEEKDAY)
+    {
+        g_uDispState = DISP_STATE_SET_WEEKDAY;
+    }
+    else if (istate == DISP_STATE_SECONDS)
+    {
+        g_uDispState = DISP_STATE_SET_SECONDS;
+    }
 
-            if (((ust == DISP_STATE_DATE) || (ust == DISP_STATE_YEAR) || \
-                 (ust == DISP_STATE_WEEKDAY) || (ust == DISP_STATE_SET_DAY)))
-            {
-                if (g_ucPB1DATEState >= PB_STATE_SHORT_PRESS)
-                {
-                    if (g_ucPB0TIMEState >= PB_STATE_SHORT_PRESS)
-                    {
-                        *pb = DISP_STATE_SET_YEAR;
-                    }
-                    else
-                    {
-                        *pb = DISP_STATE_SET_WEEKDAY;
-                    }
-                }
-            }
+  #endif // #else #if APP_WATCH_ANY_PULSAR_MODEL==APP_WATCH_PULSAR_MAGNET_SET
 
-            #endif // #else #if APP_ONE_TIME_BUTTON_OPERATION
+  #if APP_ALARM_SCHEDULE_USAGE==1
 
-          #else // #if APP_WATCH_ANY_PULSAR_MODEL==APP_WATCH_PULSAR_MAGNET_SET
+    else if (istate == DISP_STATE_COUNTDOWN)
+    {
+        g_uDispState = DISP_STATE_SET_COUNTDOWN;
+    }
 
-            if ((ust == DISP_STATE_DATE) || (ust == DISP_STATE_SET_MONTH))
-            {
-                g_uDispState = DISP_STATE_SET_DAY;
-            }
-            else if (ust == DISP_STATE_YEAR)
-            {
-                g_uDispState = DISP_STATE_SET_YEAR;
-            }
-            else if (ust == DISP_STATE_WEEKDAY)
-            {
-                g_uDispState = DISP_STATE_SET_WEEKDAY;
-            }
-            else if (ust == DISP_STATE_SECONDS)
-            {
-                g_uDispState = DISP_STATE_SET_SECONDS;
-            }
+  #endif
 
-          #endif
-        }
+  #if APP_BUZZER_ALARM_USAGE==1
+
+    /* Service mode sweeping the period of the buzzer, pressing MIN while
+     * still holding DATE to show the alarm. */
+
+    else if ((istate == DISP_STATE_ALARM) && (g_ucChord & CHORD_DATE))
+    {
+        g_uDispState = DISP_STATE_PIEZO_SWEEP;
+
+        /* Set the overall timeout to prevent the battery from draining
+         * if a button is pressed and left unattended for too long. */
+
+        Set_Overall_Timeout();
+
+        Start_Piezo_Sweep();
     }
 
+  #endif
+
     /* Quick forward the value */
 
     HoldPB3();
@@ -4430,12 +5946,89 @@ void PressPB3(void)
 
 void HoldPB3(void)
 {
-    unsigned char ucTemp;
-    unsigned char ucValue;
-
     const DisplayStateType ust = g_uDispState;
 
     if (ust == DISP_STATE_SET_MINUTES)
+    {
+        /* Forward the minutes. */
+
+        Edit_Field(FIELD_INDEX_MINUTES, 1);
+    }
+    else if (ust == DISP_STATE_SET_YEAR)
+    {
+        /* Forward the year. */
+
+        Edit_Field(FIELD_INDEX_YEAR, 1);
+    }
+    else if (ust == DISP_STATE_SET_WEEKDAY)
+    {
+        /* Forward the weekday. */
+
+        Edit_Field(FIELD_INDEX_WEEKDAY, 1);
+    }
+    else if (ust == DISP_STATE_SET_CALIBRA)
+    {
+        /* Forward the calibration register and turn around on max. */
+
+        Edit_Field(FIELD_INDEX_CALIBRA, 1);
+    }
+
+  #if (APP_WATCH_ANY_PULSAR_MODEL!=APP_WATCH_GENERIC_BUTTON) && \
+      (APP_ONE_TIME_BUTTON_OPERATION)
+
+    else if (ust == DISP_STATE_SET_DAY)
+    {
+        /* Forward the day of month. */
+
+        Edit_Field(FIELD_INDEX_DAY, 1);
+    }
+    
+  #endif // Not APP_WATCH_GENERIC_BUTTON and APP_ONE_TIME_BUTTON_OPERATION.
+
+  #if APP_BUZZER_ALARM_USAGE==1
+
+    else if ((ust == DISP_STATE_ALARM) || \
+             (ust == DISP_STATE_TOGGLE_ALARM))
+    {
+        /* Forward the alarm minute. */
+
+        Edit_Field(FIELD_INDEX_ALARM_MINUTES, 1);
+    }
+    else if (ust == DISP_STATE_PIEZO_SWEEP)
+    {
+        /* Step to a lower tone, once DATE entering the service mode
+         * has been released. */
+
+        if ((g_ucPiezoSweep) && (!(g_ucChord & CHORD_DATE)))
+        {
+            g_ucPiezoSweep = PIEZO_SWEEP_MANUAL;
+
+            Step_Piezo_Sweep(1);
+        }
+    }
+
+  #endif
+
+  #if APP_ALARM_SCHEDULE_USAGE==1
+
+    else if (ust == DISP_STATE_SET_COUNTDOWN)
+    {
+        /* Forward the minutes of the countdown. */
+
+        g_ucCountdownMinutes = Bcd_Step(g_ucCountdownMinutes, 1, 0x00, 0x59);
+    }
+
+  #endif
+
+  #if APP_WATCH_ANY_PULSAR_MODEL==APP_WATCH_GENERIC_BUTTON
+
+    else if (ust == DISP_STATE_SET_DAY)
+    {
+        /* Forward the day of month. */
+
+        Edit_Field(FIELD_INDEX_DAY, 1);
+    }
+    else if (ust == DISP_STATE_SET_SECONDS)
     {
         /* Unlock write access to the RTC and disable the clock. */
 
@@ -4454,587 +6047,725 @@ void HoldPB3(void)
         RTCCFG &= ~3;
         //while(RTCCFGbits.RTCSYNC);
 
-        /* Forward the minutes. */
+        /* Zero the seconds. */
 
-        ucTemp = RTCVALH;
-        ucValue = 1 + g_bcd_decimal[ucTemp];
+        RTCVALL = 0;
 
-        if (ucValue >= 60)
-        {
-            ucValue = 0;
-        }
+        /* Enable the RTC operation again.*/
 
-        /* Set the RTC register to read/write. */
+        RTCCFGbits.RTCEN = 1;
 
-        //RTCCFG &= ~3;
-        //while(RTCCFGbits.RTCSYNC);
+        /* Lock writing to the RTCC. */
+
+        Lock_RTCC();
+    }
+
+  #endif
+}
+
+/**
+ * Called when button 3 MIN has been released.
+ */
+
+void ReleasePB3(void)
+{
+  #if APP_WATCH_ANY_PULSAR_MODEL==APP_WATCH_PULSAR_MAGNET_SET
+
+    /* For Pulsar P2/P3/P4 compatibility, indicate to stop/stall the RTC,
+     * until the time readout button has been pressed the first time. */
+
+    if (g_uDispState == DISP_STATE_SET_MINUTES)
+    {
+        g_uDispState = DISP_STATE_SECONDS_STALLED;
+
+        /* Write the minutes set and keep the RTC stopped right now, so
+         * the edge of the TIME button only has to start the RTC. */
+
+        Commit_RTCC_Stage();
+    }
+    else
+    {
+        /* Turn timer 2 off. */
+
+        T2CONbits.TMR2ON = 0;
+
+        /* Timer usage */
+
+        g_ucTimer2Usage = 0;
+    }
+
+  #endif
+}
 
-        ucTemp = g_decimal_bcd[ucValue];
-        RTCVALH = ucTemp;
+#endif // #if APP_WATCH_ANY_PULSAR_MODEL!=APP_WATCH_PULSAR_AUTO_SET
 
-        /* Set seconds to zero. */
+#if APP_WRIST_FLICK_USAGE==1
 
-        //RTCCFG &= ~3;
+/**
+ * Classify the edges of the wrist flick input seen within a window. A
+ * flick tilts the switch once or twice for a moment, the input bouncing
+ * on each edge. Rattling while walking gives many pulses, resting the arm
+ * keeps the input high.
+ *
+ * @param pedges  Ticks of the edges relative to the first rising one.
+ * @param ucount  Number of edges seen, might exceed the ones buffered.
+ * @return        FLICK_ACCEPT or the reason of the rejection.
+ */
 
-        RTCVALL = 0; // Zero the second when forwarding the minute.
+unsigned char Classify_Flick(const short *pedges, unsigned char ucount)
+{
+    const FlickParamsType *pp = &g_flick_params;
+    unsigned char upulses = 0;
+    unsigned char i = 0;
+    short shigh = 0;
 
-  #if APP_WATCH_ANY_PULSAR_MODEL==APP_WATCH_GENERIC_BUTTON
+    if (((ucount + 1) >> 1) > pp->max_edges)
+    {
+        return FLICK_REJECT_RATTLE;
+    }
 
-        /* Enable the RTC operation again.*/
+    if (ucount & 1)
+    {
+        return FLICK_REJECT_HELD;
+    }
 
-        RTCCFGbits.RTCEN = 1;
+    /* Sum up the time being high, and count the pulses with the gaps of
+     * the bounces merged. */
 
-        /* Lock writing to the RTCC. */
+    do // while((i += 2) < ucount);
+    {
+        shigh += pedges[i + 1] - pedges[i];
 
-        Lock_RTCC();
+        if ((!i) || ((pedges[i] - pedges[i - 1]) >= pp->bounce_gap))
+        {
+            upulses++;
+        }
+    }
+    while((i += 2) < ucount);
 
-  #endif
+    if (upulses > pp->max_pulses)
+    {
+        return FLICK_REJECT_PULSES;
+    }
 
-        /* Keep the RTC disabled and the seconds zero, until the user
-         * pressed a readout button. */
+    if (upulses < g_ucFlickMinPulses)
+    {
+        return FLICK_REJECT_SINGLE;
     }
-    else if (ust == DISP_STATE_SET_YEAR)
+
+    if (shigh < pp->min_high)
     {
-        /* Unlock write access to the RTC and disable the clock. */
+        return FLICK_REJECT_SHORT;
+    }
 
-        Unlock_RTCC();
+    if (shigh > g_sFlickMaxHigh)
+    {
+        return FLICK_REJECT_LONG;
+    }
 
-        /* Enabling writing to the RTC. */
+    if (pedges[ucount - 1] > pp->max_span)
+    {
+        return FLICK_REJECT_SPAN;
+    }
 
-        RTCCFGbits.RTCWREN = 1;
+    return FLICK_ACCEPT;
+}
 
-        /* Stop the RTC */
+/**
+ * Track the edges of the wrist flick input from the rising edge waking
+ * the watch, and classify them once the input settled or the window
+ * expired. An accepted flick presses the TIME button virtually, while a
+ * rejected one lets the watch go back to sleep right away.
+ *
+ * @return  Return zero, if the watch can enter sleep, non-zero otherwise.
+ */
 
-        RTCCFGbits.RTCEN = 0;
+unsigned char Track_Flick(void)
+{
+    const FlickParamsType *pp = &g_flick_params;
+    unsigned char *pusage = &g_ucTimer0Usage;
+    unsigned char ucount = g_ucFlickEdges;
+    const unsigned char ulevel = PB4 ? 1 : 0;
+    unsigned char uresult;
+    short itimer;
 
-        /* Set the RTC register to read/write. */
+    if (!ucount)
+    {
+        /* Start on a rising edge only, so an input kept high after having
+         * been rejected does not keep the watch awake. */
 
-        RTCCFG |= 3;
-        //while(RTCCFGbits.RTCSYNC);
+        const unsigned char urising = (ulevel) && (!g_ucFlickLevel);
 
-        /* Forward the year. */
+        g_ucFlickLevel = ulevel;
 
-        ucTemp = RTCVALL;
-        ucValue = 1 + g_bcd_decimal[ucTemp];
+        /* Ignore the Wrist Flick if the display is not in blank mode
+         * anymore or any other event is keeping the watch awake, so it
+         * was not the wrist flick waking it up. A display lit by a flick
+         * for a while and not used yet can be cancelled by another one. */
 
-        if (ucValue >= 100)
+        if ((!urising) || \
+            (((g_uDispState) || (g_ucStayAwake)) && \
+             ((g_WristFlick != FLICK_LIT) || \
+              (g_ucRollOver < FLICK_CANCEL_ROUNDS))))
         {
-            ucValue = 0;
+            return 0;
         }
 
-        /* Set the RTC register to read/write. */
+        /* Start the timer, if not started yet by a button before. */
 
-        ucTemp = g_decimal_bcd[ucValue];
-        RTCVALL = ucTemp;
+        if (!(*pusage))
+        {
+            TMR0H = 0;
+            TMR0L = 0;
 
-        /* Enable the RTC operation again.*/
+            T0CONbits.TMR0ON = 1;
 
-        RTCCFGbits.RTCEN = 1;
+            g_sPB4Timer = 0;
+        }
+        else
+        {
+            /* Reading the low byte buffers the high byte. */
 
-        /* Lock writing to the RTCC. */
+            const unsigned char ulow = TMR0L;
+            const unsigned char uhigh = TMR0H;
 
-        Lock_RTCC();
-    }
-    else if (ust == DISP_STATE_SET_WEEKDAY)
-    {
-        /* Unlock write access to the RTC and disable the clock. */
+            g_sPB4Timer = ulow | (uhigh << 8);
+        }
 
-        Unlock_RTCC();
+        *pusage |= 1 << DEBOUNCE_INDEX_BUTTON_FLICK;
 
-        /* Enabling writing to the RTC. */
+        g_sFlickEdges[0] = 0;
+        g_ucFlickEdges = 1;
 
-        RTCCFGbits.RTCWREN = 1;
+        return 1;
+    }
 
-        /* Stop the RTC */
+    {
+        /* Reading the low byte buffers the high byte. */
 
-        RTCCFGbits.RTCEN = 0;
+        const unsigned char ulow = TMR0L;
+        const unsigned char uhigh = TMR0H;
 
-        /* Set the RTC register to read/write. */
+        itimer = (short)(ulow | (uhigh << 8)) - g_sPB4Timer;
+    }
 
-        RTCCFGbits.RTCPTR0 = 1;
-        RTCCFGbits.RTCPTR1 = 0;
-        //while(RTCCFGbits.RTCSYNC);
+    /* Record an edge, keep counting them beyond the buffer. */
 
-        /* Forward the weekday. */
+    if (ulevel != g_ucFlickLevel)
+    {
+        g_ucFlickLevel = ulevel;
 
-        ucTemp = RTCVALH;
-        ucValue = 1 + (ucTemp & 7);
+        if (ucount < FLICK_EDGES_MAX)
+        {
+            g_sFlickEdges[ucount] = itimer;
+        }
 
-        if (ucValue >= 7)
+        if (ucount < 255)
         {
-            ucValue = 0;
+            ucount++;
         }
 
-        /* As accessing the hi-byte will automatically decrement
-         * the address pointer, we have to set the address again, before
-         * writing the weekday. */
+        g_ucFlickEdges = ucount;
+    }
+
+    /* Keep observing, until the input settled low, the window expired or
+     * it is rattling too much already. */
 
-        RTCCFGbits.RTCPTR0 = 1;
+    if ((itimer < pp->window) && \
+        ((ulevel) || (ucount > FLICK_EDGES_MAX) || \
+         ((itimer - g_sFlickEdges[ucount - 1]) < pp->settle)) && \
+        (((ucount + 1) >> 1) <= pp->max_edges))
+    {
+        return 1;
+    }
 
-        RTCVALH = ucValue;
+    uresult = Classify_Flick(g_sFlickEdges, ucount);
 
-        /* Enable the RTC operation again.*/
+    g_ucFlickEdges = 0;
 
-        RTCCFGbits.RTCEN = 1;
+    /* Indicate that the wrist flick is not using the timer anymore. */
 
-        /* Lock writing to the RTCC. */
+    *pusage &= ~(1 << DEBOUNCE_INDEX_BUTTON_FLICK);
 
-        Lock_RTCC();
-    }
-    else if (ust == DISP_STATE_SET_CALIBRA)
+    if (!(*pusage))
     {
-        /* Unlock write access to the RTC and disable the clock. */
+        T0CONbits.TMR0ON = 0;
+    }
 
-        Unlock_RTCC();
+    if (uresult != FLICK_ACCEPT)
+    {
+        g_ucFlickLastReject = uresult;
+        g_uFlickRejected++;
 
-        /* Enable writing to the RTC */
+      #if APP_INPUT_STATISTICS_USAGE==1
 
-        RTCCFGbits.RTCWREN = 1;
+        Count_Statistic(&g_ucStatBounces[DEBOUNCE_INDEX_BUTTON_FLICK]);
 
-        /* Stop RTC operation. */
+      #endif
 
-        RTCCFGbits.RTCEN = 0;
+        return (*pusage) ? 1 : 0;
+    }
 
-        /* Forward the calibration register and turn around on max. */
+    g_uFlickAccepted++;
 
-        ucTemp = RTCCAL;
-        
-        /* Check if passing the maximum absolute value. */
-        
-        if (ucTemp & 0x80)
-        {
-            /* Negative calibration for clocks running too fast. */
-            
-            if (ucTemp >= 0xFE)
-            {
-                /* Turn around to zero value. */
+    /* Dismiss the display lit by the previous flick. */
 
-                ucTemp = 0;
-            }
-            else
-            {
-                ucTemp += 2;
-            }
-        }
-        else // if (ucTemp & 0x80)
-        {
-            /* Positive calibration for clocks running too slow. */
+    if ((g_WristFlick == FLICK_LIT) && (g_uDispState == DISP_STATE_TIME))
+    {
+        g_WristFlick = FLICK_CANCELLED;
 
-            if (ucTemp >= 0x7E)
-            {
-                /* Turn around to maximum negative value. */
+        Count_Flick_Outcome(FLICK_CANCELLED);
 
-                ucTemp = 0x82;
-            }
-            else
-            {
-                ucTemp += 2;
-            }
-        }
-        
-        RTCCAL = ucTemp;
+        g_uDispState = DISP_STATE_BLANK;
 
-        /* Enable the RTC operation again.*/
+        /* Turn timer 2 off, to let the watch go to sleep. */
 
-        RTCCFGbits.RTCEN = 1;
+        T2CONbits.TMR2ON = 0;
 
-        /* Lock writing to the RTCC. */
+        g_ucTimer2Usage = 0;
 
-        Lock_RTCC();
+        return (*pusage) ? 1 : 0;
     }
 
-  #if (APP_WATCH_ANY_PULSAR_MODEL!=APP_WATCH_GENERIC_BUTTON) && \
-      (APP_ONE_TIME_BUTTON_OPERATION)
+    /* Check if the display is still blank and no button is pressed. */
 
-    else if (ust == DISP_STATE_SET_DAY)
+    if ((g_uDispState == DISP_STATE_BLANK) && \
+        (!g_ucPB0TIMEState) && \
+        (!g_ucPB1DATEState)
+
+      #if APP_WATCH_ANY_PULSAR_MODEL != APP_WATCH_PULSAR_AUTO_SET
+        && (!g_ucPB2HOURState) \
+        && (!g_ucPB3MINTState)
+      #endif
+       )
     {
-        /* Unlock write access to the RTC and disable the clock. */
+      #if APP_INPUT_STATISTICS_USAGE==1
 
-        Unlock_RTCC();
+        /* The wake up had been caused by a real flick. */
 
-        /* Enable writing to the RTC */
+        g_ucStatWakePending = 0;
 
-        RTCCFGbits.RTCWREN = 1;
+      #endif
 
-        /* Stop RTC operation. */
+        /* Press virtually the readout button for the time. */
 
-        RTCCFGbits.RTCEN = 0;
+        PressPB0();
 
-        unsigned char ucExtra;
+        /* Trigger 'stay awake' timer. */
 
-      #if (APP_WATCH_TYPE_BUILD==APP_PULSAR_WRIST_WATCH_12H_LEGACY_MOD) || \
-          (APP_WATCH_TYPE_BUILD==APP_PULSAR_P3_WRIST_WATCH_12H_ODIN_MARK_II_MOD) || \
-          (APP_WATCH_TYPE_BUILD==APP_PULSAR_WRIST_WATCH_12H_SIF_LEGACY_MOD) || \
-          (APP_WATCH_TYPE_BUILD==APP_PULSAR_P4_WRIST_WATCH_12H_SIF_MARK_II_MOD)
+        g_ucTimer2Usage = 1;    // Indicate using the timer.
+        TMR2 = 0;               // Zero the timer.
+        T2CONbits.TMR2ON = 1;   // Turn timer 2 on.
 
-        ucExtra = 1;
+        /* Indicate, that the display is lit up by a wrist flick,
+         * if the state has been altered to 'TIME'. */
 
-        /* On every second cycle change betwen AM and PM and otherwise
-         * forward the day. */
+        if (g_uDispState == DISP_STATE_TIME)
+        {
+            g_WristFlick = FLICK_LIT;
+        }
+    }
 
-        RTCCFGbits.RTCPTR0 = 1;
-        RTCCFGbits.RTCPTR1 = 0;
+    return 1;
+}
 
-        ucTemp = RTCVALL;
-        ucValue = g_bcd_decimal[ucTemp];
+/**
+ * Set the strictness of the wrist flick classifier, shortening the time
+ * being high accepted each level up to the top one, which asks for a
+ * double flick instead.
+ *
+ * @param ustrict  Level from zero up to FLICK_STRICT_DOUBLE.
+ */
 
-        if (ucValue < 12)
-        {
-            /* AM -> PM */
+void Set_Flick_Strictness(unsigned char ustrict)
+{
+    const unsigned char ulevel = (ustrict < FLICK_STRICT_DOUBLE) ? \
+        ustrict : (FLICK_STRICT_DOUBLE - 1);
 
-            ucValue += 12;
+    g_ucFlickStrict = ustrict;
+    g_sFlickMaxHigh = FLICK_MAX_HIGH_WIDEST - ulevel * FLICK_ADAPT_STEP;
+    g_ucFlickMinPulses = (ustrict < FLICK_STRICT_DOUBLE) ? 1 : 2;
+}
 
-            ucTemp = g_decimal_bcd[ucValue];
-            RTCVALL = ucTemp;
+/**
+ * Restore the strictness of the wrist flick adapted before a reset, if the
+ * deep sleep registers hold one, which is checked by its complement.
+ */
 
-            /* Do not forward the day. */
+void Load_Flick_Strictness(void)
+{
+    const unsigned char ustrict = DSGPR0;
+    const unsigned char ucheck = ~ustrict;
 
-            ucExtra = 0;
-        }
-        else
-        {
-            /* PM -> AM */
+    if ((DSGPR1 == ucheck) && (ustrict <= FLICK_STRICT_DOUBLE))
+    {
+        Set_Flick_Strictness(ustrict);
+    }
+}
 
-            ucValue -= 12;
+/**
+ * Count the outcome of a flick having lit the display, and adapt the
+ * strictness by one level at the end of a round, if most of its flicks
+ * have been unused, or almost all of them followed by a button press or
+ * cancelled.
+ *
+ * @param uoutcome  FLICK_ENGAGED, FLICK_CANCELLED or FLICK_LIT if timed out.
+ */
 
-            ucTemp = g_decimal_bcd[ucValue];
-            RTCVALL = ucTemp;
-        }
+void Count_Flick_Outcome(unsigned char uoutcome)
+{
+    unsigned char ustrict = g_ucFlickStrict;
 
-        if (ucExtra)
+    if (uoutcome == FLICK_ENGAGED)
+    {
+        g_uFlickEngaged++;
+    }
+    else if (uoutcome == FLICK_CANCELLED)
+    {
+        g_uFlickCancelled++;
+    }
+    else
+    {
+        g_uFlickUnused++;
+        g_ucFlickRoundUnused++;
+    }
 
-      #endif // Not a 12h display but a 24h display.
+    if (++g_ucFlickRound < FLICK_ADAPT_ROUND)
+    {
+        return;
+    }
 
-        {
-            /* Forward the day of month. */
+    if ((g_ucFlickRoundUnused >= FLICK_ADAPT_TIGHTEN) && \
+        (ustrict < FLICK_STRICT_DOUBLE))
+    {
+        ustrict++;
+    }
+    else if ((g_ucFlickRoundUnused <= FLICK_ADAPT_WIDEN) && (ustrict))
+    {
+        ustrict--;
+    }
 
-            RTCCFGbits.RTCPTR0 = 0;
-            RTCCFGbits.RTCPTR1 = 1;
-            //while(RTCCFGbits.RTCSYNC);
+    g_ucFlickRound = 0;
+    g_ucFlickRoundUnused = 0;
 
-            ucTemp = RTCVALL; // day
-            ucValue = 1 + g_bcd_decimal[ucTemp];
+    if (ustrict != g_ucFlickStrict)
+    {
+        Set_Flick_Strictness(ustrict);
 
-            ucTemp = RTCVALH; // month
-            ucExtra = g_bcd_decimal[ucTemp];
+        DSGPR0 = ustrict;
+        DSGPR1 = (unsigned char)~ustrict;
+    }
+}
 
-            if (ucExtra == 2) // February, always assume it to be a leap year.
-            {
-                /* Assume february to have 29 days to support leap years. */
+#endif // #if APP_WRIST_FLICK_USAGE==1
 
-                if (ucValue >= 30) // 29 days (leap year)
-                {
-                    ucValue = 1;
-                }
-            }
-            else if ((ucExtra == 1) || (ucExtra == 3) || (ucExtra == 5) || \
-                     (ucExtra == 7) || (ucExtra == 8) || (ucExtra == 10) || \
-                     (ucExtra == 12))
-            {
-                if (ucValue >= 32) // 31 days
-                {
-                    ucValue = 1;
-                }
-            }
-            else
-            {
-                if (ucValue >= 31) // 30 days
-                {
-                    ucValue = 1;
-                }
-            }
+#if APP_LIGHT_SENSOR_USAGE==1
 
-            RTCCFGbits.RTCPTR0 = 0;
-            RTCCFGbits.RTCPTR1 = 1;
+/**
+ * Take one step of the light measurement, called once each multiplexing
+ * tick. The sensor is powered and drained in one tick, charged and the
+ * conversion started in the next one. The charging is kept in one piece,
+ * as its duration sets the voltage measured, and timed by timer 3, so it
+ * does not depend on the code the compiler generates. The result is
+ * collected in a later tick, once the A/D interrupt flag tells the
+ * conversion to have completed. In the threshold mode the sensor is
+ * powered in one tick and RC2 read in the next one.
+ *
+ * @return  Return non-zero, if the readout is available in g_uLightRaw.
+ */
 
-            ucTemp = g_decimal_bcd[ucValue];
-            RTCVALL = ucTemp;
-        }
+unsigned char Measure_Light_Step(void)
+{
+    unsigned char udone = 0;
+    unsigned short uticks;
 
-        /* Enable the RTC operation again.*/
+  #if APP_LIGHT_SENSOR_THRESHOLD==0
 
-        RTCCFGbits.RTCEN = 1;
+    unsigned char ustart;
 
-        /* Lock writing to the RTCC. */
+  #endif
 
-        Lock_RTCC();
-    }
-    
-  #endif // Not APP_WATCH_GENERIC_BUTTON and APP_ONE_TIME_BUTTON_OPERATION.
+    /* Measure the time blocking the multiplexing. */
 
-  #if APP_BUZZER_ALARM_USAGE==1
+    TMR3H = 0;
+    TMR3L = 0;
 
-    else if ((ust == DISP_STATE_ALARM) || \
-             (ust == DISP_STATE_TOGGLE_ALARM))
+    T3CONbits.TMR3ON = 1;
+
+    g_ucLightLatency++;
+
+    switch (g_ucLightState)
     {
-        /* Unlock write access to the RTC and disable the clock. */
+        case LIGHT_STATE_POWER:
 
-        Unlock_RTCC();
+            /* Turn on RA6 to power up the light sensor. */
 
-        /* Enable writing to the RTC */
+            PWR_LGTH_SENSOR = 1;
 
-        RTCCFGbits.RTCWREN = 1;
+            g_uLightBlock = 0;
+            g_ucLightLatency = 1;
 
-        /* Stop RTC operation. */
+          #if APP_LIGHT_SENSOR_THRESHOLD==1
 
-        RTCCFGbits.RTCEN = 0;
+            /* Let the divider settle until the next tick. */
 
-        /* Forward the alarm minute. */
+            g_ucLightState = LIGHT_STATE_SAMPLE;
+        break;
 
-        ALRMCFGbits.ALRMPTR0 = 0;
-        ALRMCFGbits.ALRMPTR1 = 0;
+        case LIGHT_STATE_SAMPLE:
 
-        ucTemp = ALRMVALH;
-        ucValue = 1 + g_bcd_decimal[ucTemp];
+            /* The input buffer of RC2 reads high in bright light. */
 
-        if (ucValue >= 60)
-        {
-            ucValue = 0;
-        }
+            g_uLightRaw = PORTCbits.RC2 ? LIGHT_THRESHOLD_BRIGHT :
+                                          LIGHT_THRESHOLD_DARK;
 
-        ucTemp = g_decimal_bcd[ucValue];
-        ALRMVALH = ucTemp;
+            /* Turn off RA6 to power down the light sensor. */
 
-        /* Set Alarm seconds to zero. */
-        
-        ALRMVALL = 0;
+            PWR_LGTH_SENSOR = 0;
 
-        /* Ensure the other register being valid. */
+            g_ucLightState = LIGHT_STATE_IDLE;
 
-        ALRMCFGbits.ALRMPTR0 = 0;
-        ALRMCFGbits.ALRMPTR1 = 1;
+            udone = 1;
+        break;
 
-        ALRMVALL = 1; // Day
-        ALRMVALH = 1; // Month, auto-decrement!
-        ALRMVALH = 1; // Weekday
+          #else
 
-        /* Enable the RTC operation again.*/
+            /* Measure the voltage across the resistor. */
 
-        RTCCFGbits.RTCEN = 1;
+            CTMUCONHbits.CTMUEN = 1;    // Enable Charge Time Measurement Unit
+            CTMUCONLbits.EDG1STAT = 0;  // Set Edge status bits to zero
+            CTMUCONLbits.EDG2STAT = 0;
 
-        /* Lock writing to the RTCC. */
+            CTMUCONHbits.IDISSEN = 1;   // Drain charge on the circuit
 
-        Lock_RTCC();
-    }
+            g_ucLightState = LIGHT_STATE_DRAIN;
+        break;
 
-  #endif
+        case LIGHT_STATE_DRAIN:
 
-  #if APP_WATCH_ANY_PULSAR_MODEL==APP_WATCH_GENERIC_BUTTON
+            CTMUCONHbits.IDISSEN = 0;   // End drain of circuit
 
-    else if (ust == DISP_STATE_SET_DAY)
-    {
-        /* Unlock write access to the RTC and disable the clock. */
+            /* Start charging on a tick of timer 3. */
 
-        Unlock_RTCC();
+            ustart = TMR3L;
 
-        /* Enabling writing to the RTC. */
+            while (TMR3L == ustart);
 
-        RTCCFGbits.RTCWREN = 1;
+            ustart++;
 
-        /* Stop the RTC */
+            CTMUCONLbits.EDG1STAT = 1;  // Begin charging the circuit
 
-        RTCCFGbits.RTCEN = 0;
+            while ((unsigned char)(TMR3L - ustart) < LIGHT_CHARGE_TICKS);
 
-        /* Forward the day of month. */
+            CTMUCONLbits.EDG1STAT = 0;  // Stop charging circuit
 
-        RTCCFGbits.RTCPTR0 = 0;
-        RTCCFGbits.RTCPTR1 = 1;
-        //while(RTCCFGbits.RTCSYNC);
+            PIR1bits.ADIF = 0;          // Make sure A/D Int not set
 
-        ucTemp = RTCVALL; // day
-        ucValue = 1 + g_bcd_decimal[ucTemp];
+            ADCON0bits.GODONE = 1;      // and begin A/D conv.
 
-        ucTemp = RTCVALH; // month
-        unsigned char ucExtra = g_bcd_decimal[ucTemp];
+            g_ucLightState = LIGHT_STATE_CONVERT;
+        break;
 
-        if (ucExtra == 2) // February, always assume it to be a leap year.
-        {
-            /* Assume february to have 29 days to support leap years. */
+        default: // LIGHT_STATE_CONVERT
 
-            if (ucValue >= 30) // 29 days (leap year)
-            {
-                ucValue = 1;
-            }
-        }
-        else if ((ucExtra == 1) || (ucExtra == 3) || (ucExtra == 5) || \
-                 (ucExtra == 7) || (ucExtra == 8) || (ucExtra == 10) || \
-                 (ucExtra == 12))
-        {
-            if (ucValue >= 32) // 31 days
-            {
-                ucValue = 1;
-            }
-        }
-        else
-        {
-            if (ucValue >= 31) // 30 days
+            if (PIR1bits.ADIF)          // A/D convert complete?
             {
-                ucValue = 1;
-            }
-        }
+                g_uLightRaw = ADRES;    // Get the value from the A/D
 
-        RTCCFGbits.RTCPTR0 = 0;
-        RTCCFGbits.RTCPTR1 = 1;
+                PIR1bits.ADIF = 0;      // Clear A/D Interrupt Flag
 
-        ucTemp = g_decimal_bcd[ucValue];
-        RTCVALL = ucTemp;
+                /* Turn off RA6 to power down the light sensor. */
 
-        /* Enable the RTC operation again.*/
+                PWR_LGTH_SENSOR = 0;
 
-        RTCCFGbits.RTCEN = 1;
+                g_ucLightState = LIGHT_STATE_IDLE;
 
-        /* Lock writing to the RTCC. */
+                udone = 1;
+            }
+        break;
 
-        Lock_RTCC();
+          #endif // #if APP_LIGHT_SENSOR_THRESHOLD==1
     }
-    else if (ust == DISP_STATE_SET_SECONDS)
-    {
-        /* Unlock write access to the RTC and disable the clock. */
 
-        Unlock_RTCC();
+    T3CONbits.TMR3ON = 0;
 
-        /* Enabling writing to the RTC. */
+    /* Reading the low byte buffers the high byte. */
 
-        RTCCFGbits.RTCWREN = 1;
+    uticks = TMR3L;
+    uticks |= (unsigned short)TMR3H << 8;
 
-        /* Stop the RTC */
+    g_uLightBlock += uticks;
 
-        RTCCFGbits.RTCEN = 0;
+    if (uticks > g_uLightBlockMax)
+    {
+        g_uLightBlockMax = uticks;
+    }
 
-        /* Set the RTC register to read/write. */
+    return udone;
+}
 
-        RTCCFG &= ~3;
-        //while(RTCCFGbits.RTCSYNC);
+/**
+ * Feed a readout into the ambient light estimator. The readouts are
+ * averaged exponentially and the level only changes, if the average
+ * crosses a threshold by more than the hysteresis, so readouts close to a
+ * threshold do not make the brightness flicker.
+ *
+ * @param uv    Readout of the ADC.
+ * @return      Light level, 0 is the darkest.
+ */
 
-        /* Zero the seconds. */
+unsigned char Estimate_Light_Level(unsigned short uv)
+{
+    unsigned char ulevel = g_ucLightLevel;
+    unsigned short uaverage;
 
-        RTCVALL = 0;
+    if (ulevel == LIGHT_LEVEL_NONE)
+    {
+        /* Start the average with the first readout. */
 
-        /* Enable the RTC operation again.*/
+        g_uLightAverage = uv << LIGHT_EMA_FRACTION;
 
-        RTCCFGbits.RTCEN = 1;
+        ulevel = 0;
+    }
+    else
+    {
+        g_uLightAverage += (signed short)((uv << LIGHT_EMA_FRACTION) -
+                                          g_uLightAverage) >> LIGHT_EMA_SHIFT;
+    }
 
-        /* Lock writing to the RTCC. */
+    uaverage = g_uLightAverage >> (LIGHT_EMA_FRACTION + 2);
 
-        Lock_RTCC();
+    /* Step up or down, while a threshold is crossed by the hysteresis.
+     * The first readout is taken without hysteresis. */
+
+    while ((ulevel < LIGHT_LEVELS - 1) &&
+           (uaverage >= g_light_thresholds[ulevel] +
+            ((g_ucLightLevel == LIGHT_LEVEL_NONE) ? 0 :
+             (g_light_thresholds[ulevel] >> LIGHT_HYSTERESIS_SHIFT))))
+    {
+        ulevel++;
     }
 
-  #endif
+    while ((ulevel > 0) &&
+           (uaverage + (g_light_thresholds[ulevel - 1] >> LIGHT_HYSTERESIS_SHIFT) <
+            g_light_thresholds[ulevel - 1]))
+    {
+        ulevel--;
+    }
+
+    if ((ulevel != g_ucLightLevel) && (g_ucLightLevel != LIGHT_LEVEL_NONE))
+    {
+        g_uLightLevelChanges++;
+    }
+
+    g_ucLightLevel = ulevel;
+
+    return ulevel;
 }
 
 /**
- * Called when button 3 MIN has been released.
+ * Stretch the interval to the next light measurement while the readouts
+ * are stable, and go back to the shortest interval if the readout moved
+ * or the level changed.
  */
 
-void ReleasePB3(void)
+void Adapt_Light_Interval(unsigned short uv, unsigned char uchanged)
 {
-  #if APP_WATCH_ANY_PULSAR_MODEL==APP_WATCH_PULSAR_MAGNET_SET
+    const unsigned short uprev = g_uLightPrevRaw;
+    const unsigned short udelta = (uv > uprev) ? (uv - uprev) : (uprev - uv);
+    unsigned short ustable = uv >> LIGHT_STABLE_SHIFT;
 
-    /* For Pulsar P2/P3/P4 compatibility, indicate to stop/stall the RTC,
-     * until the time readout button has been pressed the first time. */
+    if (ustable < LIGHT_STABLE_DELTA)
+    {
+        ustable = LIGHT_STABLE_DELTA;
+    }
 
-    const DisplayStateType ust = g_uDispState;
+    g_uLightPrevRaw = uv;
+    g_ulLightSamples++;
 
-    if (ust == DISP_STATE_SET_MINUTES)
+    if (uchanged || (udelta > ustable))
     {
-        g_uDispState = DISP_STATE_SECONDS_STALLED;
+        g_ucLightInterval = LIGHT_INTERVAL_MIN;
+    }
+    else if (g_ucLightInterval < (LIGHT_INTERVAL_MAX >> 1))
+    {
+        g_ucLightInterval <<= 1;
     }
     else
     {
-        /* Turn timer 2 off. */
+        g_ucLightInterval = LIGHT_INTERVAL_MAX;
+    }
+}
 
-        T2CONbits.TMR2ON = 0;
+/**
+ * Update the measurements saved against the fixed interval, counted per
+ * 1000 seconds of the display being on. Each measurement saved keeps the
+ * sensor, the CTMU and the ADC off for three multiplexing ticks.
+ */
 
-        /* Timer usage */
+void Report_Light_Savings(void)
+{
+    const unsigned long useconds = g_ulLightRounds / LIGHT_ROUNDS_PER_SECOND;
+    const unsigned long ufixed = g_ulLightFrames / (LIGHT_INTERVAL_FIXED + 1);
 
-        g_ucTimer2Usage = 0;
+    if ((!useconds) || (ufixed <= g_ulLightSamples))
+    {
+        g_uLightSavedPerKs = 0;
+
+        return;
     }
 
-  #endif
+    g_uLightSavedPerKs = (unsigned short)
+                         (((ufixed - g_ulLightSamples) * 1000) / useconds);
 }
 
-#endif // #if APP_WATCH_ANY_PULSAR_MODEL!=APP_WATCH_PULSAR_AUTO_SET
+#endif // #if APP_LIGHT_SENSOR_USAGE==1
 
-#if APP_WRIST_FLICK_USAGE==1
+#if APP_NIGHT_DIMMING_USAGE==1
 
 /**
- * Called when the Wrist flick input peaks up and has been stable for
- * some milliseconds.
+ * Check if the hour falls into the night dimming schedule, which might
+ * span midnight.
+ *
+ * @param uhours    Hours of the 24h clock in BCD.
+ * @return          Return non-zero, if the display shall be dimmed.
  */
 
-void PressPB4(void)
+unsigned char Is_Night_Time(unsigned char uhours)
 {
-    /* This handler is called, if the wrist flick input
-     * peaks up and has been stable for some milliseconds. */
-    
-    g_FlickTimeSpan = g_sPB4Timer;
+    const unsigned char ustart = g_ucNightStart;
+    const unsigned char uend = g_ucNightEnd;
+
+    /* BCD hours compare in the same order as binary ones. */
+
+    if (ustart <= uend)
+    {
+        return (uhours >= ustart) && (uhours < uend);
+    }
+
+    return (uhours >= ustart) || (uhours < uend);
 }
 
 /**
- * Called when the Wrist flick input peaks down and has been stable for
- * some milliseconds.
+ * Count the readout just ended, if it had been dimmed, and update the
+ * dark multiplexing ticks per night readout.
  */
 
-void ReleasePB4(void)
+void Report_Night_Savings(void)
 {
-    /* This handler is called, if the wrist flick input
-     * peaks down and has been stable for some milliseconds. */
-    
-    /* First read the low byte of the timer, which will buffer
-     * the high byte. */
-
-    const unsigned char ulow = TMR0L;
-
-    /* Read now the buffered high byte of the timer, that
-     * had been stored, when the low byte had been read. */
-
-    const unsigned char uhigh = TMR0H;
-
-    /* Calculate the tick count, indicating how long the wrist flick
-     * input had been peaked up. */
-    
-    short itimer  = ulow | (uhigh << 8);
-          itimer -= g_FlickTimeSpan;
-    
-    /* Check the wrist flick input for being turned on within a plausible
-     * time span. To put it into a nutstell. The input shall be on not
-     * too short and not too long. */
-          
-    if (itimer >= 0)
+    if (!g_ucNightReadout)
     {
-        if (itimer <= T0_WRIST_FLICK)
-        {
-            /* Check if the display is still blank. */
-            
-            if (g_uDispState == DISP_STATE_BLANK)
-            {
-                if ((!g_ucPB0TIMEState) && \
-                    (!g_ucPB1DATEState)
+        return;
+    }
 
-                  #if APP_WATCH_ANY_PULSAR_MODEL != APP_WATCH_PULSAR_AUTO_SET
-                    && (!g_ucPB2HOURState) \
-                    && (!g_ucPB3MINTState)
-                  #endif
-                   )
-                {
-                    /* Press virtually the readout button for the time. */
+    g_ucNightReadout = 0;
+    g_uNightReadouts++;
 
-                    PressPB0();
-                    
-                    /* Indicate, that the display is lit up by a wrist flick,
-                     * if the state has been altered to 'TIME'. */
-                    
-                    if (g_uDispState == DISP_STATE_TIME)
-                    {
-                        g_WristFlick = 1;
-                    }
-                }
-            }
-        }
-    }
+    g_uNightSavedPerReadout = (unsigned short)
+                              (g_ulNightDarkTicks / g_uNightReadouts);
 }
 
-#endif // #if APP_WRIST_FLICK_USAGE==1
+#endif // #if APP_NIGHT_DIMMING_USAGE==1
 
 /**
  * Show the time or date.
@@ -5053,13 +6784,55 @@ void Display_Digits(void)
 
   #if APP_LIGHT_SENSOR_USAGE==1
 
-    /* Measure ambient brightness via AN11. */
+    /* Advance a measurement of the ambient brightness via AN11 by one
+     * step each tick, so the display keeps being refreshed on schedule. */
+
+    if (g_ucLightState && Measure_Light_Step())
+    {
+        unsigned short uv = g_uLightRaw;
+        const unsigned char uprev = g_ucLightLevel;
+
+        /* Store the readout for showing it on the display. */
+
+        g_ucLightSensor = (unsigned char)(uv >> 6); // div by 64
+
+        /* Calculate brightness factor from the filtered readout. */
+
+        if (uv)  // If the resitor would be missing.
+        {
+            const unsigned char ulevel = Estimate_Light_Level(uv);
+
+            uv = g_light_dimming[ulevel];
+
+            g_ucDimming = (unsigned char)uv;
+            g_ucDimmingRef = (unsigned char)uv;
+        }
+        else // If the resitor would be missing.
+        {
+            g_ucDimming = 0;
+            g_ucDimmingRef = 0;
+        }
+
+        /* Adapt the interval to the next measurement. */
+
+        Adapt_Light_Interval(g_uLightRaw, g_ucLightLevel != uprev);
+    }
+
+  #endif // #if APP_LIGHT_SENSOR_USAGE==1
+
+  #if APP_DISPLAY_DIMMING_USAGE==1
 
     if (!ucPlex)
     {
         /* Check if we shall feature the last measured value or
          * if we are in need to measure again. */
 
+      #if APP_LIGHT_SENSOR_USAGE==1
+
+        g_ulLightFrames++;
+
+      #endif
+
         if (g_ucDimmingCnt)
         {
             g_ucDimmingCnt--;
@@ -5093,10 +6866,20 @@ void Display_Digits(void)
 
               #endif
 
+              #if (APP_BUZZER_ALARM_USAGE==1)
+
+                /* Set RC0/1/2/4/5..7 to output and RC3 as input. */
+
+                TRISC = 0x08; // RC2 is the buzzer output
+
+              #else
+
                 /* Set RC0/1/4/5..7 to output and RC3 and RC2(AN11) as input. */
 
                 TRISC = 0x0C; // RC2 is an input (light sensor))
 
+              #endif
+
                 /* Turn all segment outputs off. */
 
              #if APP_WATCH_COMMON_PIN_USING==APP_WATCH_COMMON_ANODE
@@ -5121,143 +6904,39 @@ void Display_Digits(void)
                #endif
 
              #endif
+
+              #if APP_NIGHT_DIMMING_USAGE==1
+
+                g_ulNightDarkTicks += uv;
+                g_ucNightReadout = 1;
+
+              #endif
             } // if (uv > 0)
         }
         else // if (g_ucDimmingCnt)
         {
-            /* Start a new measurment in another 100 cycles. */
-
-            g_ucDimmingCnt = 100;
-
-            /* Turn all common pins off by setting the outputs to tri-state
-             * high impedance by making inputs out of them. */
-
-          #if APP_WATCH_ANY_PULSAR_MODEL==APP_WATCH_PULSAR_AUTO_SET
-
-            /* Set RB1/4/6 to input, keep RB0/2/3/5/7 as output. */
-
-            TRISB = 0x52;
-
-          #else
-
-            /* Set RB0/1/4/6 to input, keep RB2/3/5/7 as output. */
-
-            TRISB = 0x53;
-
-          #endif
-
-            /* Set RC0/1/4/5..7 to output and RC3 and RC2(AN11) as input. */
-
-            TRISC = 0x0C;
-
-            /* Turn all segment outputs off. */
-
-        #if APP_WATCH_COMMON_PIN_USING==APP_WATCH_COMMON_ANODE
-
-            PORTC |= 0xF0;
-            PORTB |= 0x2C;
-
-          #if APP_DATE_SPECIAL_DOT_USAGE==1
-
-            PORTA |= 0x40;
-
-          #endif
-
-        #else
-            PORTC &= 0;
-            PORTB &= 1;
-
-          #if APP_DATE_SPECIAL_DOT_USAGE==1
-
-            PORTA &= 0xBF;
-
-          #endif
-
-        #endif
-
-            /* Turn on RA6 to power up the light sensor. */
-
-            PWR_LGTH_SENSOR = 1;
-
-            /* Measure the voltage across the resistor. */
-
-            CTMUCONHbits.CTMUEN = 1;    // Enable Charge Time Measurement Unit
-            CTMUCONLbits.EDG1STAT = 0;  // Set Edge status bits to zero
-            CTMUCONLbits.EDG2STAT = 0;
-
-            CTMUCONHbits.IDISSEN = 1;   // Drain charge on the circuit
-            for(int i=0;i<50;i++){};
-            CTMUCONHbits.IDISSEN = 0;   // End drain of circuit
-
-            CTMUCONLbits.EDG1STAT = 1;  // Begin charging the circuit
-            for(int i=0;i<50;i++){};
-            CTMUCONLbits.EDG1STAT = 0;  // Stop charging circuit
-
-            PIR1bits.ADIF = 0;          // Make sure A/D Int not set
-
-            ADCON0bits.GODONE = 1;      // and begin A/D conv.
-            while(ADCON0bits.GODONE);   // Wait for A/D convert complete
-
-            unsigned short uv = ADRES;  // Get the value from the A/D
-
-            PIR1bits.ADIF = 0;          // Clear A/D Interrupt Flag
-
-            /* Turn off RA6 to power down the light sensor. */
-
-            PWR_LGTH_SENSOR = 0;
+          #if APP_LIGHT_SENSOR_USAGE==1
 
-            /* Store the readout for showing it on the display. */
+            /* Start a new measurment after the adapted interval. */
 
-            g_ucLightSensor = (unsigned char)(uv >> 6); // div by 64
+            g_ucDimmingCnt = g_ucLightInterval;
 
-            /* Calculate brightness factor from readout. */
+            /* Start measuring with the next tick, if not still measuring. */
 
-            if (uv)  // If the resitor would be missing.
+            if (!g_ucLightState)
             {
-              #if APP_WATCH_TYPE_BUILD==APP_PROTOTYPE_BREAD_BOARD
-
-                /* Normal daylight */
-
-                if (uv > 1000)
-                {
-                    uv = 0;     // Keep maximum brightness.
-                }
-                else
-                {
-                    uv = 15 - (uv >> 6);
-
-                    /* Stop multiplexing, */
-
-                    ucPlex = 255;
-                }
-
-              #else
-
-                /* Normal daylight */
+                g_ucLightState = LIGHT_STATE_POWER;
+            }
 
-                if (uv >= 64)
-                {
-                    uv = 0;     // Keep maximum brightness.
-                }
-                else
-                {
-                    uv = 1;     // Used dimmed brightness.
+          #else // Night dimming
 
-                    /* Stop multiplexing, */
+            /* Check the hour of the last RTC readout again in a while. */
 
-                    ucPlex = 255;
-                }
+            g_ucDimmingCnt = NIGHT_CHECK_INTERVAL;
 
-              #endif
+            g_ucDimmingRef = Is_Night_Time(g_rtcc.hours) ? NIGHT_DIMMING : 0;
 
-                g_ucDimming = (unsigned char)uv;
-                g_ucDimmingRef = (unsigned char)uv;
-            }
-            else // If the resitor would be missing.
-            {
-                g_ucDimming = 0;
-                g_ucDimmingRef = 0;
-            }
+          #endif // #if APP_LIGHT_SENSOR_USAGE==1
         }
     }
     else // if (!ucPlex)
@@ -5276,7 +6955,7 @@ void Display_Digits(void)
     if (ucPlex != 255)
     {
 
-#endif // #if APP_LIGHT_SENSOR_USAGE==1
+#endif // #if APP_DISPLAY_DIMMING_USAGE==1
 
         unsigned char ucTemp;
 
@@ -5300,6 +6979,17 @@ void Display_Digits(void)
 
             g_uDispStateBackup = ustate;
 
+            /* Write the staged edits, once their set mode has been left. */
+
+            if (g_uRtccStaged && (ustate != g_uRtccStageState))
+            {
+                Commit_RTCC_Stage();
+            }
+
+            /* Take all RTC registers at once. */
+
+            Read_RTCC_Snapshot();
+
             switch(ustate)
             {
                 /* If being the table watch, show the
@@ -5315,13 +7005,9 @@ void Display_Digits(void)
 
                     /* Hours */
 
-                    RTCCFGbits.RTCPTR0 = 1;
-                    RTCCFGbits.RTCPTR1 = 0;
+                    g_ucLeftVal = VALUE_FROM_BCD(g_rtcc.hours);
 
-                    ucTemp = RTCVALL;   // read hours
-                    g_ucLeftVal = g_bcd_decimal[ucTemp];
-
-                    if (g_ucLeftVal > 23)
+                    if (g_ucLeftVal > VALUE_CONST(23))
                     {
                         g_ucLeftVal = 0;
                     }
@@ -5333,17 +7019,23 @@ void Display_Digits(void)
                  (APP_WATCH_TYPE_BUILD==APP_PULSAR_WRIST_WATCH_12H_SIF_LEGACY_MOD) || \
                  (APP_WATCH_TYPE_BUILD==APP_PULSAR_P4_WRIST_WATCH_12H_SIF_MARK_II_MOD)
 
+                  #if APP_BCD_NATIVE_ARITHMETIC==1
+
+                    g_ucLeftVal = g_24_to_12_hours[Bcd_To_Decimal(g_ucLeftVal)];
+
+                  #else
+
                     g_ucLeftVal = g_24_to_12_hours[g_ucLeftVal];
 
+                  #endif
+
              #endif
 
                     /* Minutes */
 
-                    ucTemp = RTCVALH;   // dummy to decrement
-                    ucTemp = RTCVALH;   // read minutes
-                    g_ucRightVal = g_bcd_decimal[ucTemp];
+                    g_ucRightVal = VALUE_FROM_BCD(g_rtcc.minutes);
 
-                    if (g_ucRightVal > 59)
+                    if (g_ucRightVal > VALUE_CONST(59))
                     {
                         g_ucRightVal = 0;
                     }
@@ -5372,13 +7064,10 @@ void Display_Digits(void)
                 case DISP_STATE_SECONDS:
                 case DISP_STATE_SET_SECONDS:
 
-                    RTCCFG &= ~3;
-
                     g_ucLeftVal = 255; // Hidden
-                    ucTemp = RTCVALL;
-                    g_ucRightVal = g_bcd_decimal[ucTemp];
+                    g_ucRightVal = VALUE_FROM_BCD(g_rtcc.seconds);
 
-                    if (g_ucRightVal > 59)
+                    if (g_ucRightVal > VALUE_CONST(59))
                     {
                         g_ucRightVal = 0;
                     }
@@ -5390,14 +7079,14 @@ void Display_Digits(void)
                 case DISP_STATE_AUTOSET_CALIBRA:
               #endif
 
-                    ucTemp = RTCCAL;
+                    ucTemp = g_rtcc.calibration;
 
                     /* Check the value to be negative.
                      * If yes show a minus. */
 
                     if (ucTemp & 0x80) // MSB
                     {
-                        g_ucLeftVal = 128; /*Minus*/
+                        g_ucLeftVal = DISPLAY_VALUE_MINUS;
 
                         ucTemp ^= 0xFF; // 1-compliment
                         ucTemp++;       // 2-compliment
@@ -5409,18 +7098,52 @@ void Display_Digits(void)
 
                     /* Show the absolute value on the right digits. */
 
-                    g_ucRightVal = ucTemp >> 1;
+                    g_ucRightVal = VALUE_FROM_DECIMAL(ucTemp >> 1);
                 break;
 
               #if APP_LIGHT_SENSOR_USAGE_DEBUG_SHOW_VALUE==1
 
                 case DISP_STATE_LIGHT_SENSOR:
-                    g_ucRightVal = g_ucLightSensor;
+                    g_ucRightVal = VALUE_FROM_DECIMAL(g_ucLightSensor);
                     g_ucLeftVal = 255;
                 break;
 
               #endif // #if APP_LIGHT_SENSOR_USAGE_DEBUG_SHOW_VALUE==1
 
+              #if APP_INPUT_STATISTICS_USAGE==1
+
+                /* Page 0: Bounces of TIME and DATE.
+                 * Page 1: Bounces of HOUR and MIN.
+                 * Page 2: Spurious wake ups and taps.
+                 * Page 3: Short and long presses. */
+
+                case DISP_STATE_INPUT_STATISTICS:
+                    switch (g_ucStatPage)
+                    {
+                        case 0:
+                            g_ucLeftVal = VALUE_FROM_DECIMAL(g_ucStatBounces[0]);
+                            g_ucRightVal = VALUE_FROM_DECIMAL(g_ucStatBounces[1]);
+                        break;
+
+                        case 1:
+                            g_ucLeftVal = VALUE_FROM_DECIMAL(g_ucStatBounces[2]);
+                            g_ucRightVal = VALUE_FROM_DECIMAL(g_ucStatBounces[3]);
+                        break;
+
+                        case 2:
+                            g_ucLeftVal = VALUE_FROM_DECIMAL(g_ucStatSpuriousWakes);
+                            g_ucRightVal = VALUE_FROM_DECIMAL(g_ucStatPresses[0]);
+                        break;
+
+                        default:
+                            g_ucLeftVal = VALUE_FROM_DECIMAL(g_ucStatPresses[1]);
+                            g_ucRightVal = VALUE_FROM_DECIMAL(g_ucStatPresses[2]);
+                        break;
+                    }
+                break;
+
+              #endif // #if APP_INPUT_STATISTICS_USAGE==1
+
                 case DISP_STATE_DATE:
                 case DISP_STATE_SET_MONTH:
                 case DISP_STATE_SET_DAY:
@@ -5429,23 +7152,18 @@ void Display_Digits(void)
                 case DISP_STATE_AUTOSET_DATE:
               #endif
 
-                    RTCCFGbits.RTCPTR0 = 0;
-                    RTCCFGbits.RTCPTR1 = 1;
-
                     /* Day of month */
-                    ucTemp = RTCVALL;
-                    g_ucRightVal = g_bcd_decimal[ucTemp];
+                    g_ucRightVal = VALUE_FROM_BCD(g_rtcc.day);
 
-                    if (g_ucRightVal > 31)
+                    if (g_ucRightVal > VALUE_CONST(31))
                     {
                         g_ucRightVal = 1;
                     }
 
                     /* Month */
-                    ucTemp = RTCVALH;
-                    g_ucLeftVal = g_bcd_decimal[ucTemp];
+                    g_ucLeftVal = VALUE_FROM_BCD(g_rtcc.month);
 
-                    if (g_ucLeftVal > 12)
+                    if (g_ucLeftVal > VALUE_CONST(12))
                     {
                         g_ucLeftVal = 1;
                     }
@@ -5459,11 +7177,7 @@ void Display_Digits(void)
 
                     /* Hours to indicate AM/PM dot. */
 
-                    RTCCFGbits.RTCPTR0 = 1;
-                    RTCCFGbits.RTCPTR1 = 0;
-
-                    ucTemp = RTCVALL;
-                    ucTemp = g_bcd_decimal[ucTemp];
+                    ucTemp = BCD_TO_DECIMAL(g_rtcc.hours);
 
                     if (ucTemp > 23)
                     {
@@ -5487,13 +7201,10 @@ void Display_Digits(void)
                 case DISP_STATE_AUTOSET_YEAR:
               #endif
 
-                    RTCCFG |= 3;
-
                     /* Year */
-                    ucTemp = RTCVALL;
-                    g_ucRightVal = g_bcd_decimal[ucTemp];
+                    g_ucRightVal = VALUE_FROM_BCD(g_rtcc.year);
 
-                    if (g_ucRightVal > 99)
+                    if (g_ucRightVal > VALUE_CONST(99))
                     {
                         g_ucRightVal = 0;
                     }
@@ -5507,7 +7218,7 @@ void Display_Digits(void)
 
              #else
 
-                    g_ucLeftVal = 20;     // Show year using four digits.
+                    g_ucLeftVal = VALUE_CONST(20); // Show year using four digits.
 
              #endif
                 break;
@@ -5519,11 +7230,8 @@ void Display_Digits(void)
                 case DISP_STATE_AUTOSET_WEEKDAY:
               #endif
 
-                    RTCCFGbits.RTCPTR0 = 1;
-                    RTCCFGbits.RTCPTR1 = 0;
-
                     /* Weekday */
-                    ucTemp = RTCVALH;
+                    ucTemp = g_rtcc.weekday;
 
                     if (ucTemp > 6)
                     {
@@ -5541,24 +7249,18 @@ void Display_Digits(void)
 
                     /* Alarm Hours */
 
-                    ALRMCFGbits.ALRMPTR0 = 1;
-                    ALRMCFGbits.ALRMPTR1 = 0;
-
-                    ucTemp = ALRMVALL;   // read alarm hours
-                    g_ucLeftVal = g_bcd_decimal[ucTemp];
+                    g_ucLeftVal = VALUE_FROM_BCD(g_rtcc.alarm_hours);
 
-                    if (g_ucLeftVal > 23)
+                    if (g_ucLeftVal > VALUE_CONST(23))
                     {
                         g_ucLeftVal = 0;
                     }
 
                     /* Alarm Minutes */
 
-                    ucTemp = ALRMVALH;   // dummy to decrement
-                    ucTemp = ALRMVALH;   // read minutes
-                    g_ucRightVal = g_bcd_decimal[ucTemp];
+                    g_ucRightVal = VALUE_FROM_BCD(g_rtcc.alarm_minutes);
 
-                    if (g_ucRightVal > 59)
+                    if (g_ucRightVal > VALUE_CONST(59))
                     {
                         g_ucRightVal = 0;
                     }
@@ -5567,13 +7269,117 @@ void Display_Digits(void)
 
                   #if (APP_WATCH_TYPE_BUILD==APP_PULSAR_P3_WRIST_WATCH_24H_LOKI_MOD)
 
+                  #if APP_ALARM_SCHEDULE_USAGE==1
+
+                    /* Left dot for the alarm, top dot for the chime. */
+
+                    g_ucDots = (g_alarms[ALARM_ENTRY_DAILY].flags & \
+                                ALARM_FLAG_ENABLED) ? 2 : 0;
+
+                    g_ucDots |= (g_alarms[ALARM_ENTRY_CHIME].flags & \
+                                 ALARM_FLAG_ENABLED) ? 1 : 0;
+
+                  #else
+
                     g_ucDots = ALRMCFGbits.ALRMEN ? 2 : 0;
 
                   #endif
+
+                  #endif
+                break;
+
+                case DISP_STATE_PIEZO_SWEEP:
+
+                    /* Period of the buzzer tried, the left dot while
+                     * sweeping on its own. */
+
+                    g_ucLeftVal = VALUE_FROM_DECIMAL(g_ucPiezoCandidate / 100);
+                    g_ucRightVal = VALUE_FROM_DECIMAL(g_ucPiezoCandidate % 100);
+
+                    g_ucDots = (g_ucPiezoSweep == PIEZO_SWEEP_AUTO) ? 2 : 0;
                 break;
 
              #endif // #if APP_BUZZER_ALARM_USAGE==1
 
+             #if APP_ALARM_SCHEDULE_USAGE==1
+
+                case DISP_STATE_SET_COUNTDOWN:
+                    g_ucLeftVal = VALUE_FROM_BCD(g_ucCountdownHours);
+                    g_ucRightVal = VALUE_FROM_BCD(g_ucCountdownMinutes);
+                break;
+
+                case DISP_STATE_COUNTDOWN:
+                {
+                    /* Show hours and minutes, the last hour minutes and
+                     * seconds with the left dot on. */
+
+                    unsigned long ulRemaining = Countdown_Remaining();
+
+                    if (ulRemaining >= 3600)
+                    {
+                        ulRemaining /= 60;
+
+                        g_ucLeftVal = VALUE_FROM_DECIMAL((unsigned char)(ulRemaining / 60));
+                    }
+                    else
+                    {
+                        g_ucLeftVal = VALUE_FROM_DECIMAL((unsigned char)(ulRemaining / 60));
+
+                        g_ucDots = 2;
+                    }
+
+                    g_ucRightVal = VALUE_FROM_DECIMAL((unsigned char)(ulRemaining % 60));
+                }
+                break;
+
+                case DISP_STATE_COUNTDOWN_EXPIRED:
+                    g_ucLeftVal = 0;
+                    g_ucRightVal = 0;
+                break;
+
+             #endif // #if APP_ALARM_SCHEDULE_USAGE==1
+
+             #if APP_STOPWATCH_USAGE==1
+
+                case DISP_STATE_STOPWATCH:
+                {
+                    /* Show seconds and hundredths with the top dot on, from
+                     * a minute on minutes and seconds, from an hour on hours
+                     * and minutes. The left dot marks a split shown. */
+
+                    const unsigned long ulTicks = Stopwatch_Shown();
+                    unsigned long ulSeconds = ulTicks >> STOPWATCH_TICKS_SHIFT;
+
+                    if (ulSeconds < 60)
+                    {
+                        const unsigned long ulFraction = \
+                            (ulTicks & ((1UL << STOPWATCH_TICKS_SHIFT) - 1)) * 100;
+
+                        g_ucLeftVal = VALUE_FROM_DECIMAL((unsigned char)ulSeconds);
+                        g_ucRightVal = VALUE_FROM_DECIMAL((unsigned char)(ulFraction >> STOPWATCH_TICKS_SHIFT));
+
+                        g_ucDots = 1;
+                    }
+                    else
+                    {
+                        if (ulSeconds >= 3600)
+                        {
+                            ulSeconds /= 60;
+                        }
+
+                        g_ucLeftVal = VALUE_FROM_DECIMAL((unsigned char)(ulSeconds / 60));
+                        g_ucRightVal = VALUE_FROM_DECIMAL((unsigned char)(ulSeconds % 60));
+                    }
+
+                    if (g_ucStopwatchView)
+                    {
+                        g_ucDots |= 2;
+                    }
+                }
+                break;
+
+             #endif // #if APP_STOPWATCH_USAGE==1
+
                 case DISP_STATE_SECONDS_STALLED:
                     g_ucRightVal = 7;
                 break;
@@ -5620,13 +7426,13 @@ void Display_Digits(void)
                 {
                     /* Setting the accuracy value? */
                     
-                    if (ucTemp == 128)
+                    if (ucTemp == DISPLAY_VALUE_MINUS)
                     {
                         ucTemp = *(pb + 10 /*Minus*/);
                     }
                     else
                     {
-                        ucTemp = *(pb + (g_mod10[ucTemp]));
+                        ucTemp = *(pb + VALUE_ONES(ucTemp));
                     }
 
                     ub = 0;    // Hold the bits for the B port.
@@ -5879,7 +7685,7 @@ void Display_Digits(void)
 
                     /* Ten hour digit and dots */
 
-                    if ((ucTemp >= 10) && (ucTemp <= 12))
+                    if ((ucTemp >= VALUE_CONST(10)) && (ucTemp <= VALUE_CONST(12)))
                     {
                         LED_AA_B = 1;
                         LED_AD_C = 1;
@@ -5920,7 +7726,7 @@ void Display_Digits(void)
 
              #if (APP_WATCH_TYPE_BUILD!=APP_PROTOTYPE_BREAD_BOARD)
 
-                    if (ucTemp < 10)
+                    if (ucTemp < VALUE_CONST(10))
                     {
                         switch(g_uDispStateBackup)
                         {
@@ -5952,19 +7758,19 @@ void Display_Digits(void)
                                 break;
                         }
                     }
-                    else if (ucTemp == 128) // Setting the accuracy.
+                    else if (ucTemp == DISPLAY_VALUE_MINUS) // Setting the accuracy.
                     {
                         ucTemp = 0; // blank
                     }
                     else
                     {
-                        ucTemp = g_div10[ucTemp];
+                        ucTemp = VALUE_TENS(ucTemp);
                         ucTemp = *(pb + ucTemp);
                     }
 
              #else
 
-                    ucTemp = g_div10[ucTemp];
+                    ucTemp = VALUE_TENS(ucTemp);
                     ucTemp = *(pb + ucTemp);
 
              #endif
@@ -6268,7 +8074,7 @@ void Display_Digits(void)
                     }
                     else
                     {
-                        ucTemp = *(pb + (g_mod10[ucTemp]));
+                        ucTemp = *(pb + VALUE_ONES(ucTemp));
                     }
 
                     ub = 0;    // Hold the bits for the B port.
@@ -6487,7 +8293,7 @@ void Display_Digits(void)
 
              #if (APP_WATCH_TYPE_BUILD!=APP_PROTOTYPE_BREAD_BOARD)
 
-                        if (ucTemp < 10)
+                        if (ucTemp < VALUE_CONST(10))
                         {
                             switch(g_uDispStateBackup)
                             {
@@ -6509,13 +8315,13 @@ void Display_Digits(void)
                         }
                         else
                         {
-                            ucTemp = g_div10[ucTemp];
+                            ucTemp = VALUE_TENS(ucTemp);
                             ucTemp = *(pb + ucTemp);
                         }
 
              #else
 
-                        ucTemp = g_div10[ucTemp];
+                        ucTemp = VALUE_TENS(ucTemp);
                         ucTemp = *(pb + ucTemp);
 
              #endif
@@ -6802,9 +8608,9 @@ void Display_Digits(void)
             ucPlex = 0;
         }
 
-  #if APP_LIGHT_SENSOR_USAGE==1
+  #if APP_DISPLAY_DIMMING_USAGE==1
     }
-  #endif // #if APP_LIGHT_SENSOR_USAGE==1
+  #endif // #if APP_DISPLAY_DIMMING_USAGE==1
 
     /* Store new multiplexer value. */
 
@@ -6831,6 +8637,22 @@ void main(void)
     Configure_Timer_4();
 
     Configure_Real_Time_Clock();
+
+  #if APP_BUZZER_ALARM_USAGE==1
+
+    /* Restore the resonance of the piezo found in the service mode. */
+
+    Load_Piezo_Period();
+
+  #endif // #if APP_BUZZER_ALARM_USAGE==1
+
+  #if APP_WRIST_FLICK_USAGE==1
+
+    /* Restore the strictness of the wrist flick adapted to the wearer. */
+
+    Load_Flick_Strictness();
+
+  #endif // #if APP_WRIST_FLICK_USAGE==1
     
     Init_Button_States();
 
@@ -6873,7 +8695,7 @@ void main(void)
 
         /* Turn the alarm buzzer on. */
 
-        Turn_Buzzer_On(448/*duration*/);
+        Turn_Buzzer_On(ALARM_DURATION_CHIME);
 
   #endif // #if APP_BUZZER_ALARM_USAGE==1
 
@@ -6886,13 +8708,9 @@ void main(void)
   #endif // #else #if APP_WATCH_ANY_PULSAR_MODEL!=APP_WATCH_GENERIC_BUTTON
     }
     
-    /* Enable global interrupts.
-     * INTERRUPT CONTROL REGISTER */
+    /* Enable global interrupts. */
 
-    // Global Interrupt Enable bit
-    INTCONbits.GIE = 1;      // Enables all unmasked interrupts
-    // Peripheral Interrupt Enable bit
-    INTCONbits.PEIE = 1;     // Enables all unmasked peripheral interrupts
+    Enable_Interrupts();
 
     /* INTERRUPT CONTROL REGISTER 2 */
 
@@ -6918,18 +8736,20 @@ void main(void)
 
     g_ucMplexDigits = 0;
     
-  #if APP_LIGHT_SENSOR_USAGE==1
+  #if APP_DISPLAY_DIMMING_USAGE==1
 
     g_ucDimmingCnt = 0;
     g_ucDimming = 0;
     g_ucDimmingRef = 0;
 
-  #endif // #if APP_LIGHT_SENSOR_USAGE==1
+  #endif // #if APP_DISPLAY_DIMMING_USAGE==1
     
     /* Init local variables. */
 
     g_ucStayAwake = 0;
     g_ucRollOver = 1;
+    g_uStalledRounds = 0;
+    g_ucStalledSleep = 0;
 
     udivider = 0;
 
@@ -6950,13 +8770,42 @@ void main(void)
         {
             PIR3bits.RTCCIF = 0;     // Clear RTCC interrupt.
 
+          #if APP_INPUT_STATISTICS_USAGE==1
+
+            /* The wake up had been caused by the alarm. */
+
+            g_ucStatWakePending = 0;
+
+          #endif
+
+          #if APP_ALARM_SCHEDULE_USAGE==1
+
+            /* Sound the entries due and arm the entry due next. */
+
+            const unsigned char uduration = Handle_Alarm_Due();
+
+            /* A chime while being asleep does not wake the display. */
+
+            if ((uduration == ALARM_DURATION_CHIME) && (!g_ucTimer2Usage))
+            {
+                Sound_Chime();
+            }
+            else if (uduration)
+            {
+                Turn_Buzzer_On(uduration);
+            }
+
+          #else
+
             /* Reset the alarm repeat. */
 
             ALRMRPT = 255;
 
             /* Turn the alarm buzzer on. */
 
-            Turn_Buzzer_On(6000/*duration*/);
+            Turn_Buzzer_On(ALARM_DURATION_ALARM);
+
+          #endif // #if APP_ALARM_SCHEDULE_USAGE==1
             
             /* Initialize dot animation. */
             
@@ -6969,6 +8818,47 @@ void main(void)
 
       #endif // #if APP_BUZZER_ALARM_USAGE==1
 
+        /* Check the hourly temperature sample. The measurement holds the
+         * loop for 62ms, so it waits for the buttons to be debounced. */
+
+      #if APP_TEMPERATURE_COMPENSATION==1
+
+        if ((PIR3bits.RTCCIF) && (!g_ucTimer0Usage))
+        {
+            PIR3bits.RTCCIF = 0;     // Clear RTCC interrupt.
+
+          #if APP_INPUT_STATISTICS_USAGE==1
+
+            /* The wake up had been caused by the alarm. */
+
+            g_ucStatWakePending = 0;
+
+          #endif
+
+            Compensate_Temperature();
+        }
+
+      #endif // #if APP_TEMPERATURE_COMPENSATION==1
+
+        /* Count the overflows of timer 1, timing a sync and the stopwatch. */
+
+      #if APP_TIMER_1_USAGE==1
+
+       #if (APP_STOPWATCH_USAGE==1) && (APP_INPUT_STATISTICS_USAGE==1)
+
+        /* The wake up had been caused by the stopwatch running. */
+
+        if ((PIR1bits.TMR1IF) && (g_ucStopwatchRunning))
+        {
+            g_ucStatWakePending = 0;
+        }
+
+       #endif
+
+        Count_Timer_1_Overflow();
+
+      #endif
+
         /* Debounce the buttons. */
 
         g_ucStayAwake = DebounceButtons();
@@ -6982,45 +8872,35 @@ void main(void)
             {
                 TMR2 = 0;
 
-              #if APP_BUZZER_ALARM_USAGE==1
+              #if APP_LIGHT_SENSOR_USAGE==1
+
+                g_ulLightRounds++;
 
-                /* Check if the alarm buzzer is still active. */
+              #endif
+
+              #if APP_BUZZER_ALARM_USAGE==1
 
-                unsigned short *palarm = &g_ucAlarm;
+                /* Check if the alarm buzzer is still active, the melody
+                 * and its duration are handled by the interrupt routine. */
 
-                if (*palarm)
+                if (g_ucAlarm)
                 {
-                    (*palarm)--;
+                    /* Do the dot animation. */
+
+                  #if APP_ALARM_SPECIAL_DOT_ANIMATION==1
 
-                    /* Turn the alarm buzzer off, if required. */
+                    unsigned char udot = g_dot_banner_index;
 
-                    const unsigned short ualarm = *palarm;
+                    udot++;
 
-                    if (!ualarm)
+                    if (udot >= (sizeof(g_dot_banner) << 2))
                     {
-                        Turn_Buzzer_Off();
+                        udot = 0;
                     }
-                    else
-                    {
-                        Turn_Buzzer_Fancy((ualarm >> 6) & 0x07);
-                        
-                        /* Do the dot animation. */
-            
-                    #if APP_ALARM_SPECIAL_DOT_ANIMATION==1
 
-                        unsigned char udot = g_dot_banner_index;
-                        
-                        udot++;
-                        
-                        if (udot >= (sizeof(g_dot_banner) << 2))
-                        {
-                            udot = 0;
-                        }
-                        
-                        g_dot_banner_index = udot;
+                    g_dot_banner_index = udot;
 
-                    #endif
-                    }
+                  #endif
 
                     /* If there is still the alarm buzzer activated,
                      * restart the rollover counter with a short value. */
@@ -7045,6 +8925,17 @@ void main(void)
                                 
                             g_WristFlick ? 525 : 375;
 
+                if (++g_ucRollOver >= ulimit) // Rounds per second.
+                {
+            #elif APP_STOPWATCH_USAGE==1
+
+                const DisplayStateType istate = g_uDispState;
+                const unsigned short ulimit = \
+
+                            /* Keep the stopwatch lit for long. */
+
+                            (istate == DISP_STATE_STOPWATCH) ? 1250 : 375;
+
                 if (++g_ucRollOver >= ulimit) // Rounds per second.
                 {
             #else
@@ -7079,6 +8970,13 @@ void main(void)
                         if ((istate == DISP_STATE_AUTOSET_TIME) && \
                             (g_ucTimePressCnt == HINT_AUTOSET_MINUTES_SET))
                         {
+                            /* Write the minutes set before and keep
+                             * the RTC stopped. */
+
+                            g_uRtccStaged |= RTCC_STAGED_KEEP_STOPPED;
+
+                            Commit_RTCC_Stage();
+
                             /* Unlock write access to the RTC and disable the clock. */
 
                             Unlock_RTCC();
@@ -7130,6 +9028,27 @@ void main(void)
                          * restart the rollover counter with a short value. */
 
                         g_ucRollOver = 100;
+
+                        /* Do not wait forever in the 'watch stalled' mode,
+                         * if the TIME button is never pressed. Blank the
+                         * display and go to sleep with the RTC kept
+                         * stopped, the time set is not lost that way. */
+
+                        if ((istate == DISP_STATE_SECONDS_STALLED) && \
+                            (++g_uStalledRounds >= STALLED_TIMEOUT_ROUNDS))
+                        {
+                          #if APP_DRIFT_LEARNING_USAGE==1
+
+                            /* The sync has been given up. */
+
+                            Drift_Invalidate(0);
+
+                          #endif
+
+                            g_ucStalledSleep = 1;
+
+                            g_uDispState = DISP_STATE_BLANK;
+                        }
                     }
                 }
             }
@@ -7150,7 +9069,7 @@ void main(void)
 
         if (g_ucStayAwake)
         {
-          #if APP_LIGHT_SENSOR_USAGE==1
+          #if APP_DISPLAY_DIMMING_USAGE==1
 
             if (g_ucDimming)
             {
@@ -7177,6 +9096,15 @@ void main(void)
                 udivider++;
             }
         }
+      #if APP_ALARM_SCHEDULE_USAGE==1
+
+        else if (g_ucAlarm)
+        {
+            /* Keep the display off, while a chime is played asleep. */
+        }
+
+      #endif // #if APP_ALARM_SCHEDULE_USAGE==1
+
         else // if (g_ucStayAwake)
         {
             /* Cancel the overall timeout to prevent the battery from draining
@@ -7270,18 +9198,44 @@ void main(void)
             PORTB &= 0x01;
             PORTA &= 0x27;
 
+            /* Going to sleep from the 'watch stalled' mode, e.g. by a
+             * button not handled there, keeps the RTC stopped as well. */
+
+            if (g_uDispState == DISP_STATE_SECONDS_STALLED)
+            {
+                g_ucStalledSleep = 1;
+            }
+
+            /* Write any edits still staged by a set mode. */
+
+            Commit_RTCC_Stage();
+
+          #if APP_DRIFT_LEARNING_USAGE==1
+
+            /* A sync not finished is given up, when going to sleep. */
+
+            if (g_drift.flags & DRIFT_FLAG_PENDING)
+            {
+                Drift_Invalidate(0);
+            }
+
+          #endif
+
             /* Ensure the RTC to operate, if not being in 'stalled' state,
              * after having set the minutes. */
 
-            Unlock_RTCC();
+            if (!g_ucStalledSleep)
+            {
+                Unlock_RTCC();
 
-            /* Set write enable bit. */
+                /* Set write enable bit. */
 
-            RTCCFGbits.RTCWREN = 1; // RTCC Value Registers Write Enable bit
+                RTCCFGbits.RTCWREN = 1; // RTCC Value Registers Write Enable bit
 
-            /* Enable setting pointers to read MIN and SEC. */
+                /* Enable setting pointers to read MIN and SEC. */
 
-            RTCCFGbits.RTCEN = 1;   // RTCC module is enabled
+                RTCCFGbits.RTCEN = 1;   // RTCC module is enabled
+            }
 
             /* Set blank mode. */
 
@@ -7303,6 +9257,7 @@ void main(void)
 
             g_ucTimer0Usage = 0;
             g_ucTimer2Usage = 0;
+            g_uStalledRounds = 0;
 
             /* Init Multiplexing for digits. */
 
@@ -7325,13 +9280,22 @@ void main(void)
 
             while(RTCCFGbits.RTCSYNC);
 
-            /* Clear write enable bit. */
+            if (!g_ucStalledSleep)
+            {
+                /* Clear write enable bit. */
 
-            RTCCFGbits.RTCWREN = 0; // RTCC Value Registers Write Enable bit
+                RTCCFGbits.RTCWREN = 0; // RTCC Value Registers Write Enable bit
 
-            /* Lock writing to the RTCC. */
+                /* Lock writing to the RTCC. */
 
-            Lock_RTCC();
+                Lock_RTCC();
+            }
+            else
+            {
+                /* Lock writing to the RTCC, while keeping the RTC stopped. */
+
+                RTCCFGbits.RTCWREN = 0;
+            }
 
           #if APP_BUZZER_ALARM_USAGE==1
 
@@ -7345,8 +9309,27 @@ void main(void)
             
           #if APP_WRIST_FLICK_USAGE==1
 
+            /* The display lit by the flick timed out unused. */
+
+            if (g_WristFlick == FLICK_LIT)
+            {
+                Count_Flick_Outcome(FLICK_LIT);
+            }
+
             g_WristFlick = 0;
+
+            /* The flick waking the watch is a rising edge. */
+
+            g_ucFlickLevel = 0;
             
+          #endif
+
+          #if APP_STOPWATCH_USAGE==1
+
+            /* Show the time counted again after waking up. */
+
+            g_ucStopwatchView = 0;
+
           #endif
             /* PORTB Pull-up Disable bit
              * 
@@ -7409,8 +9392,16 @@ void main(void)
             
             /* PERIPHERAL INTERRUPT REQUEST (FLAG) REGISTER 1 */
 
+          #if APP_TIMER_1_USAGE==1
+
+            Count_Timer_1_Overflow();   // Keep an overflow pending counted.
+
+          #else
+
             PIR1bits.TMR1IF = 0;    // TMR1 register did not overflow.
 
+          #endif
+
             /* PERIPHERAL INTERRUPT REQUEST (FLAG) REGISTER 3 */
 
             PIR3bits.RTCCIF = 0;    // No RTCC interrupt occurred.
@@ -7423,12 +9414,15 @@ void main(void)
 
       #endif // #if APP_BUZZER_ALARM_USAGE==1
 
-            /* INTERRUPT CONTROL REGISTER */
+      #if APP_TEMPERATURE_COMPENSATION==1
 
-            // Global Interrupt Enable bit
-            INTCONbits.GIE = 1;    // Enables all unmasked interrupts
-            // Peripheral Interrupt Enable bit
-            INTCONbits.PEIE = 1;   // Enables all unmasked peripheral interrupts
+            /* Wake up by the hourly temperature sample. */
+
+            PIE3bits.RTCCIE = 1;
+
+      #endif // #if APP_TEMPERATURE_COMPENSATION==1
+
+            Enable_Interrupts();
 
             /* Turn the ADC (Analog-to-Digital Converter) and the Charge Time
              * Measurement Unit off again to save power - about 6uA. */
@@ -7437,11 +9431,38 @@ void main(void)
             ADCON0bits.ADON = 0;    // Turn off ADC
             ANCON1bits.VBGEN = 0;   // Turn off the Bandgap to save power.
             
+          #if APP_INPUT_STATISTICS_USAGE==1
+
+            /* Count the last wake up as spurious, if no press had been
+             * confirmed since then. */
+
+            if (g_ucStatWakePending)
+            {
+                Count_Statistic(&g_ucStatSpuriousWakes);
+            }
+
+          #endif
+
             /* Enter sleep mode. This might fail, for example if inputs are
              * still high, that are used to wake up the controller via
              * rising edge. */
 
             enterSleep();
+
+          #if APP_INPUT_STATISTICS_USAGE==1
+
+            g_ucStatWakePending = 1;
+
+          #endif
+
+            /* Still waiting for the TIME button to start the RTC. */
+
+            if (g_ucStalledSleep)
+            {
+                g_ucStalledSleep = 0;
+
+                g_uDispState = DISP_STATE_SECONDS_STALLED;
+            }
             
             /* Global counter for the timer used to keep the display lit. */
 
@@ -7449,12 +9470,32 @@ void main(void)
 
             /* Reset light sensor variables. */
 
-          #if APP_LIGHT_SENSOR_USAGE==1
+          #if APP_DISPLAY_DIMMING_USAGE==1
 
             g_ucDimming = 0;
             g_ucDimmingCnt = 0;
             g_ucDimmingRef = 0;
 
+          #endif
+
+          #if APP_NIGHT_DIMMING_USAGE==1
+
+            /* Check the hour after the first cycle has read the RTC. */
+
+            g_ucDimmingCnt = 1;
+
+            Report_Night_Savings();
+
+          #endif
+
+          #if APP_LIGHT_SENSOR_USAGE==1
+
+            g_ucLightState = LIGHT_STATE_IDLE;
+            g_ucLightLevel = LIGHT_LEVEL_NONE;
+            g_ucLightInterval = LIGHT_INTERVAL_MIN;
+
+            Report_Light_Savings();
+
           #endif
 
             /* Divider for going from one digit to the next. */
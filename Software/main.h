@@ -119,6 +119,14 @@
   #define APP_WRIST_FLICK_USAGE                      0
   #define APP_COMMON_DRIVER_POSITIVE                 1 // For NMOS driving.
   #define APP_ONE_TIME_BUTTON_OPERATION              0
+  #define APP_INPUT_STATISTICS_USAGE                 1
+  #define APP_BCD_NATIVE_ARITHMETIC                  1
+  #define APP_DRIFT_LEARNING_USAGE                   1
+  #define APP_TEMPERATURE_COMPENSATION               1
+  #define APP_ALARM_SCHEDULE_USAGE                   0
+  #define APP_LIGHT_SENSOR_THRESHOLD                 0
+  #define APP_NIGHT_DIMMING_USAGE                    0
+  #define APP_STOPWATCH_USAGE                        0
 
 #elif (APP_WATCH_TYPE_BUILD == APP_PULSAR_WRIST_WATCH_12H_LEGACY_MOD)
   // Legacy Prototype (original display, common cathode, no driver n-mos))
@@ -132,6 +140,14 @@
   #define APP_WRIST_FLICK_USAGE                      0
   #define APP_COMMON_DRIVER_POSITIVE                 0
   #define APP_ONE_TIME_BUTTON_OPERATION              0
+  #define APP_INPUT_STATISTICS_USAGE                 1
+  #define APP_BCD_NATIVE_ARITHMETIC                  1
+  #define APP_DRIFT_LEARNING_USAGE                   1
+  #define APP_TEMPERATURE_COMPENSATION               1
+  #define APP_ALARM_SCHEDULE_USAGE                   0
+  #define APP_LIGHT_SENSOR_THRESHOLD                 0
+  #define APP_NIGHT_DIMMING_USAGE                    0
+  #define APP_STOPWATCH_USAGE                        0
 
 #elif (APP_WATCH_TYPE_BUILD == APP_PULSAR_P3_WRIST_WATCH_24H_LOKI_MOD)
   // P3 - Loki (replacement display with common anode or cathode - double check)
@@ -145,6 +161,14 @@
   #define APP_WRIST_FLICK_USAGE                      0
   #define APP_COMMON_DRIVER_POSITIVE                 0
   #define APP_ONE_TIME_BUTTON_OPERATION              0
+  #define APP_INPUT_STATISTICS_USAGE                 1
+  #define APP_BCD_NATIVE_ARITHMETIC                  1
+  #define APP_DRIFT_LEARNING_USAGE                   1
+  #define APP_TEMPERATURE_COMPENSATION               0
+  #define APP_ALARM_SCHEDULE_USAGE                   1
+  #define APP_LIGHT_SENSOR_THRESHOLD                 0
+  #define APP_NIGHT_DIMMING_USAGE                    1
+  #define APP_STOPWATCH_USAGE                        1
 
 #elif (APP_WATCH_TYPE_BUILD == APP_PULSAR_P4_WRIST_WATCH_24H_HEL_MOD)
   // P4 - Hel (replacement display with common anode or cathode - double check)
@@ -158,6 +182,14 @@
   #define APP_WRIST_FLICK_USAGE                      1
   #define APP_COMMON_DRIVER_POSITIVE                 0
   #define APP_ONE_TIME_BUTTON_OPERATION              0
+  #define APP_INPUT_STATISTICS_USAGE                 0
+  #define APP_BCD_NATIVE_ARITHMETIC                  1
+  #define APP_DRIFT_LEARNING_USAGE                   1
+  #define APP_TEMPERATURE_COMPENSATION               0
+  #define APP_ALARM_SCHEDULE_USAGE                   0
+  #define APP_LIGHT_SENSOR_THRESHOLD                 0
+  #define APP_NIGHT_DIMMING_USAGE                    1
+  #define APP_STOPWATCH_USAGE                        1
 
 #elif (APP_WATCH_TYPE_BUILD == APP_PULSAR_WRIST_WATCH_12H_SIF_LEGACY_MOD)
   // P4 - Sif (original display, common cathode)
@@ -171,6 +203,14 @@
   #define APP_WRIST_FLICK_USAGE                      1
   #define APP_COMMON_DRIVER_POSITIVE                 0
   #define APP_ONE_TIME_BUTTON_OPERATION              0
+  #define APP_INPUT_STATISTICS_USAGE                 0
+  #define APP_BCD_NATIVE_ARITHMETIC                  1
+  #define APP_DRIFT_LEARNING_USAGE                   1
+  #define APP_TEMPERATURE_COMPENSATION               0
+  #define APP_ALARM_SCHEDULE_USAGE                   0
+  #define APP_LIGHT_SENSOR_THRESHOLD                 0
+  #define APP_NIGHT_DIMMING_USAGE                    0
+  #define APP_STOPWATCH_USAGE                        0
 
 #elif (APP_WATCH_TYPE_BUILD == APP_PULSAR_P4_WRIST_WATCH_12H_SIF_MARK_II_MOD)
   // P4 - Sif (original display, common cathode)
@@ -184,6 +224,14 @@
   #define APP_WRIST_FLICK_USAGE                      1
   #define APP_COMMON_DRIVER_POSITIVE                 1 // For NMOS driving.
   #define APP_ONE_TIME_BUTTON_OPERATION              0
+  #define APP_INPUT_STATISTICS_USAGE                 0
+  #define APP_BCD_NATIVE_ARITHMETIC                  1
+  #define APP_DRIFT_LEARNING_USAGE                   1
+  #define APP_TEMPERATURE_COMPENSATION               0
+  #define APP_ALARM_SCHEDULE_USAGE                   0
+  #define APP_LIGHT_SENSOR_THRESHOLD                 0
+  #define APP_NIGHT_DIMMING_USAGE                    0
+  #define APP_STOPWATCH_USAGE                        0
 
 #elif (APP_WATCH_TYPE_BUILD==APP_PROTOTYPE_BREAD_BOARD)
   // Bread board
@@ -197,6 +245,14 @@
   #define APP_WRIST_FLICK_USAGE                      0
   #define APP_COMMON_DRIVER_POSITIVE                 0
   #define APP_ONE_TIME_BUTTON_OPERATION              0
+  #define APP_INPUT_STATISTICS_USAGE                 0
+  #define APP_BCD_NATIVE_ARITHMETIC                  1
+  #define APP_DRIFT_LEARNING_USAGE                   0
+  #define APP_TEMPERATURE_COMPENSATION               1
+  #define APP_ALARM_SCHEDULE_USAGE                   0
+  #define APP_LIGHT_SENSOR_THRESHOLD                 0
+  #define APP_NIGHT_DIMMING_USAGE                    0
+  #define APP_STOPWATCH_USAGE                        0
 
 #else
   // Generic
@@ -210,6 +266,14 @@
   #define APP_WRIST_FLICK_USAGE                      0
   #define APP_COMMON_DRIVER_POSITIVE                 0
   #define APP_ONE_TIME_BUTTON_OPERATION              0
+  #define APP_INPUT_STATISTICS_USAGE                 0
+  #define APP_BCD_NATIVE_ARITHMETIC                  1
+  #define APP_DRIFT_LEARNING_USAGE                   0
+  #define APP_TEMPERATURE_COMPENSATION               0
+  #define APP_ALARM_SCHEDULE_USAGE                   0
+  #define APP_LIGHT_SENSOR_THRESHOLD                 0
+  #define APP_NIGHT_DIMMING_USAGE                    0
+  #define APP_STOPWATCH_USAGE                        0
 
 #endif
 
@@ -240,6 +304,62 @@
  #endif
 #endif
 
+#if APP_TEMPERATURE_COMPENSATION==1
+ #if APP_BUZZER_ALARM_USAGE==1
+  #error "TEMPERATURE COMPENSATION feature and BUZZER feature can't be used together."
+ #endif
+#endif
+
+#if APP_DRIFT_LEARNING_USAGE==1
+ #if APP_WATCH_ANY_PULSAR_MODEL==APP_WATCH_GENERIC_BUTTON
+  #error "DRIFT LEARNING feature requires the 'watch stalled' mode of a Pulsar watch."
+ #endif
+#endif
+
+#if APP_ALARM_SCHEDULE_USAGE==1
+ #if APP_BUZZER_ALARM_USAGE==0
+  #error "ALARM SCHEDULE feature requires the BUZZER feature."
+ #endif
+#endif
+
+#if APP_LIGHT_SENSOR_THRESHOLD==1
+ #if APP_LIGHT_SENSOR_USAGE==0
+  #error "LIGHT SENSOR THRESHOLD mode requires the LIGHT SENSOR feature."
+ #endif
+#endif
+
+#if APP_NIGHT_DIMMING_USAGE==1
+ #if APP_LIGHT_SENSOR_USAGE==1
+  #error "NIGHT DIMMING feature and LIGHT SENSOR feature can't be used together."
+ #endif
+#endif
+
+#if APP_STOPWATCH_USAGE==1
+ #if APP_ONE_TIME_BUTTON_OPERATION
+  #error "STOPWATCH feature requires the DATE button."
+ #endif
+#endif
+
+/**
+ * The dimming of the display is shared by the light sensor and the night
+ * dimming schedule. */
+
+#if (APP_LIGHT_SENSOR_USAGE==1) || (APP_NIGHT_DIMMING_USAGE==1)
+  #define APP_DISPLAY_DIMMING_USAGE                  1
+#else
+  #define APP_DISPLAY_DIMMING_USAGE                  0
+#endif
+
+/**
+ * Timer 1 counts the crystal continuously, extended by its overflows, for
+ * the drift learning and the stopwatch. */
+
+#if (APP_DRIFT_LEARNING_USAGE==1) || (APP_STOPWATCH_USAGE==1)
+  #define APP_TIMER_1_USAGE                          1
+#else
+  #define APP_TIMER_1_USAGE                          0
+#endif
+
 /**
 * Defining the prototype of a handler called
 * when a button has been pressed or hold pressed. */
@@ -491,6 +611,118 @@ typedef void(*ButtonHandlerType)(void);
 #define T0_REPEAT_SLOW  0x3000
 #define T0_REPEAT_QUICK 0x2000
 #define T0_WRIST_FLICK  0x2000
+#define T0_CHORD_WINDOW 0x0300
+#define T0_STAT_TAP     0x1000
+
+/**
+ * The wrist flick is classified from the edges of its input, timed by
+ * timer 0 from the first rising edge. The edges of a window are buffered,
+ * rising ones at even and falling ones at odd indices. */
+
+#define FLICK_EDGES_MAX         16      // Edges buffered, 8 pulses
+
+#define FLICK_ACCEPT            0       // Flick shaped
+#define FLICK_REJECT_HELD       1       // Still high at the end
+#define FLICK_REJECT_RATTLE     2       // Too many edges
+#define FLICK_REJECT_PULSES     3       // Too many pulses after bouncing
+#define FLICK_REJECT_SHORT      4       // High for too short
+#define FLICK_REJECT_LONG       5       // High for too long
+#define FLICK_REJECT_SPAN       6       // First to last edge too long
+#define FLICK_REJECT_SINGLE     7       // One pulse, a double flick asked
+
+/**
+ * A flick lighting the display is either followed by a button press, or
+ * cancelled by another flick once lit for FLICK_CANCEL_ROUNDS, or times
+ * out unused. Each FLICK_ADAPT_ROUND of them the strictness is raised by
+ * one, if FLICK_ADAPT_TIGHTEN or more have been unused, or lowered by
+ * one, if FLICK_ADAPT_WIDEN or less. A cancelled flick counts as used, as
+ * the wearer did look at the display. Each level shortens the time being
+ * high accepted by FLICK_ADAPT_STEP, the top one asks for a double flick
+ * on top. */
+
+#define FLICK_LIT               1       // Display lit by a flick
+#define FLICK_ENGAGED           2       // Followed by a button press
+#define FLICK_CANCELLED         3       // Dismissed by another flick
+
+#define FLICK_CANCEL_ROUNDS     100     // 256ms of display rounds
+
+#define FLICK_ADAPT_ROUND       8       // Flicks adapted upon
+#define FLICK_ADAPT_TIGHTEN     6       // Unused ones raising strictness
+#define FLICK_ADAPT_WIDEN       2       // Unused ones lowering strictness
+#define FLICK_ADAPT_STEP        0x0400  // 65ms
+#define FLICK_MAX_HIGH_WIDEST   0x2800  // 655ms
+#define FLICK_STRICT_DEFAULT    2       // T0_WRIST_FLICK
+#define FLICK_STRICT_DOUBLE     7       // 262ms and two pulses
+
+/**
+ * Parameters of the wrist flick classifier in timer 0 ticks. A low gap
+ * shorter than bounce_gap is a bounce within a pulse. The window is
+ * closed early, once the input has been low for settle. The pulses of
+ * max_edges must fit into FLICK_EDGES_MAX. The longest time being high
+ * is adapted to the wearer, see FLICK_ADAPT_ROUND. */
+
+typedef struct
+{
+    unsigned char max_edges;    // Rising edges within the window
+    unsigned char max_pulses;   // Pulses after merging bounces
+    short bounce_gap;           // Longest low gap of a bounce
+    short min_high;             // Shortest time being high in total
+    short max_span;             // Longest time first to last edge
+    short settle;               // Low time closing the window early
+    short window;               // Longest time observing the input
+} FlickParamsType;
+
+/**
+ * Bits of the buttons held together, reported by the chord detection. */
+
+#define CHORD_TIME  (1 << DEBOUNCE_INDEX_BUTTON_TIME)
+#define CHORD_DATE  (1 << DEBOUNCE_INDEX_BUTTON_DATE)
+#define CHORD_HOUR  (1 << DEBOUNCE_INDEX_BUTTON_HOUR)
+#define CHORD_MIN   (1 << DEBOUNCE_INDEX_BUTTON_MIN)
+
+/**
+ * Number of display rounds (below a second each) the watch will wait in
+ * the 'watch stalled' mode for the TIME button, before it gives up, starts
+ * the RTC again and goes back to sleep. */
+
+#define STALLED_TIMEOUT_ROUNDS  600
+
+/**
+ * Representation of the RTC field and display values. Using the BCD-native
+ * arithmetic, the values are kept packed BCD just like in the RTCC
+ * registers, so digits are split by nibbles. Otherwise the values are
+ * decimal and converted using the lookup tables. */
+
+#if APP_BCD_NATIVE_ARITHMETIC==1
+
+  #define VALUE_CONST(d)          ((((d) / 10) << 4) | ((d) % 10))
+  #define VALUE_TENS(v)           ((v) >> 4)
+  #define VALUE_ONES(v)           ((v) & 0x0F)
+  #define VALUE_FROM_BCD(b)       (b)
+  #define VALUE_FROM_DECIMAL(d)   Decimal_To_Bcd(d)
+  #define BCD_TO_DECIMAL(b)       Bcd_To_Decimal(b)
+  #define DECIMAL_TO_BCD(d)       Decimal_To_Bcd(d)
+  #define VALUE_TO_BCD(v)         (v)
+  #define BCD_IS_VALID(b, lo, hi) Bcd_Is_Valid(b, VALUE_CONST(lo), VALUE_CONST(hi))
+
+  #define DISPLAY_VALUE_MINUS     0xA0
+
+#else
+
+  #define VALUE_CONST(d)          (d)
+  #define VALUE_TENS(v)           g_div10[v]
+  #define VALUE_ONES(v)           g_mod10[v]
+  #define VALUE_FROM_BCD(b)       g_bcd_decimal[b]
+  #define VALUE_FROM_DECIMAL(d)   (d)
+  #define BCD_TO_DECIMAL(b)       g_bcd_decimal[b]
+  #define DECIMAL_TO_BCD(d)       g_decimal_bcd[d]
+  #define VALUE_TO_BCD(v)         g_decimal_bcd[v]
+  #define BCD_IS_VALID(b, lo, hi) ((unsigned char)(g_bcd_decimal_testing[b] - (lo)) <= \
+                                   (unsigned char)((hi) - (lo)))
+
+  #define DISPLAY_VALUE_MINUS     128
+
+#endif
 
 /**
  * Hint used to indicate, that the minutes had been altered in Autoset mode.
@@ -561,13 +793,418 @@ typedef enum DisplayStateEnum
     DISP_STATE_AUTOSET_DATE = 19,
     DISP_STATE_AUTOSET_WEEKDAY = 20,
     DISP_STATE_AUTOSET_YEAR = 21,
-    DISP_STATE_AUTOSET_CALIBRA = 22
+    DISP_STATE_AUTOSET_CALIBRA = 22,
+    // Debug
+    DISP_STATE_INPUT_STATISTICS = 23,
+    // Countdown
+    DISP_STATE_SET_COUNTDOWN = 24,
+    DISP_STATE_COUNTDOWN = 25,
+    DISP_STATE_COUNTDOWN_EXPIRED = 26,
+
+    DISP_STATE_PIEZO_SWEEP = 27,
+    // Stopwatch
+    DISP_STATE_STOPWATCH = 28
 
 } DisplayStateEnum;
 
+/**
+ * Flags of an editable field of the RTC. */
+
+#define FIELD_FLAG_HIGH_BYTE    0x01    // Field is the high byte of the pair
+#define FIELD_FLAG_ALARM        0x02    // Field is an alarm register
+#define FIELD_FLAG_CALIBRA      0x04    // Field is the signed RTCCAL register
+#define FIELD_FLAG_DAY_OF_MONTH 0x08    // Maximum depends on the month
+#define FIELD_FLAG_AM_PM        0x10    // Toggle AM/PM before forwarding
+#define FIELD_FLAG_ZERO_SECONDS 0x20    // Zero the seconds after writing
+#define FIELD_FLAG_KEEP_STOPPED 0x40    // Keep the RTC stopped after writing
+#define FIELD_FLAG_CLAMP_DAY    0x80    // Clamp the day to the month length
+
+/**
+ * Descriptor of an editable field of the RTC. The value is turned around
+ * to the minimum when passing the maximum and vice versa. */
+
+typedef struct FieldStruct
+{
+    unsigned char flags;        // Field flags
+    unsigned char ptr;          // RTC respectively alarm register pointer
+    unsigned char min;          // Minimum value
+    unsigned char max;          // Maximum value
+    unsigned char step;         // Step width
+
+} FieldType;
+
+/**
+ * Index of the editable fields. */
+
+typedef enum FieldIndexEnum
+{
+    FIELD_INDEX_HOURS = 0,
+    FIELD_INDEX_MINUTES = 1,
+    FIELD_INDEX_MONTH = 2,
+    FIELD_INDEX_DAY = 3,
+    FIELD_INDEX_YEAR = 4,
+    FIELD_INDEX_WEEKDAY = 5,
+    FIELD_INDEX_CALIBRA = 6,
+    FIELD_INDEX_ALARM_HOURS = 7,
+    FIELD_INDEX_ALARM_MINUTES = 8
+
+} FieldIndexEnum;
+
+/**
+ * RAM snapshot of the RTCC value and alarm registers. The members are
+ * ordered like the register pairs, so the byte at (pointer * 2 + high)
+ * holds the register addressed by that pointer. All values are BCD. */
+
+typedef struct RtccSnapshotStruct
+{
+    unsigned char seconds;          // RTCPTR 00, low byte
+    unsigned char minutes;          // RTCPTR 00, high byte
+    unsigned char hours;            // RTCPTR 01, low byte
+    unsigned char weekday;          // RTCPTR 01, high byte
+    unsigned char day;              // RTCPTR 10, low byte
+    unsigned char month;            // RTCPTR 10, high byte
+    unsigned char year;             // RTCPTR 11, low byte
+    unsigned char reserved;         // RTCPTR 11, high byte
+    unsigned char alarm_seconds;    // ALRMPTR 00, low byte
+    unsigned char alarm_minutes;    // ALRMPTR 00, high byte
+    unsigned char alarm_hours;      // ALRMPTR 01, low byte
+    unsigned char alarm_weekday;    // ALRMPTR 01, high byte
+    unsigned char calibration;      // RTCCAL
+
+} RtccSnapshotType;
+
+/**
+ * Offsets of the alarm registers and the calibration within the
+ * RTCC snapshot. */
+
+#define RTCC_SNAPSHOT_ALARM     8
+#define RTCC_SNAPSHOT_CALIBRA   12
+
+/**
+ * Bits of the edits staged for the RTCC, one bit per snapshot byte. */
+
+#define RTCC_STAGED_TIME         0x00FF  // Any RTCC value register
+#define RTCC_STAGED_ALARM        0x0F00  // Any alarm register
+#define RTCC_STAGED_CALIBRA      0x1000  // Calibration register
+#define RTCC_STAGED_KEEP_STOPPED 0x8000  // Keep the RTC stopped on commit
+
+/**
+ * Parameters of the drift learning. A sample is taken, when the user syncs
+ * the watch via the 'watch stalled' mode. One step of RTCCAL corrects
+ * 4 clocks per minute, which are 1/491520 of the time. */
+
+#define DRIFT_HISTORY           4       // Number of samples kept
+#define DRIFT_MIN_SAMPLES       3       // Samples required to calibrate
+#define DRIFT_MIN_SECONDS       172800  // Minimum time between two syncs
+#define DRIFT_MAX_CORRECTION    300     // Larger corrections are no drift
+#define DRIFT_CAL_PER_SECOND    491520  // RTCCAL steps per relative second
+#define DRIFT_CAL_LIMIT         126     // Limit of the calibration value
+
+/**
+ * Parameters of the temperature compensation. The die temperature is
+ * derived from the internal oscillator, counted by timer 3 within a window
+ * of the 32kHz crystal. The crystal frequency drops along a parabola
+ * around its turnover temperature. The count at the turnover temperature
+ * and the slope of the internal oscillator have to be characterized for
+ * the board, the defaults assume the factory calibration at 25 degrees.
+ * Uncharacterized, the spread of the internal oscillator alone moves the
+ * estimate by tens of degrees. So setting the calibration references the
+ * count of the board, taking the watch to be at room temperature then. */
+
+#define TEMP_WINDOW_TICKS       2048    // Crystal ticks per measurement
+#define TEMP_TURNOVER_COUNT     62500   // Timer 3 count at turnover
+#define TEMP_COUNTS_PER_DEGREE  (-10)   // Timer 3 counts per degree
+#define TEMP_DELTA_LIMIT        60      // Limit of degrees from turnover
+#define TEMP_CRYSTAL_PPB        34      // Parabola in ppb per degree^2
+#define TEMP_PPB_PER_CAL        2035    // ppb corrected by one RTCCAL step
+#define TEMP_CALIBRATED_AT      (-4)    // Degrees from turnover, when set
+
+/**
+ * Steps of the light measurement, one taken each multiplexing tick. */
+
+#define LIGHT_STATE_IDLE        0       // No measurement running
+#define LIGHT_STATE_POWER       1       // Power the sensor, drain the charge
+#define LIGHT_STATE_DRAIN       2       // Charge, start the conversion
+#define LIGHT_STATE_CONVERT     3       // Collect the conversion result
+#define LIGHT_STATE_SAMPLE      4       // Read the sensor as digital input
+
+/**
+ * Time the CTMU charges the sensor for a readout, in timer 3 ticks of 8us.
+ * It replaces an empty loop of 50 passes, which took about as long at
+ * the 1MHz instruction clock, but depended on the code generated. */
+
+#define LIGHT_CHARGE_TICKS      64      // 512us
+
+/**
+ * Readouts of the threshold mode in ADC counts. There is no comparator
+ * input on RC2, so the digital input buffer of RC2 takes the decision on
+ * the divider of the sensor. The ADC, the CTMU and the band gap are never
+ * turned on, the only current is the one of the sensor while RA6 is high,
+ * and a decision takes two multiplexing ticks instead of three or more. */
+
+#define LIGHT_THRESHOLD_DARK    1       // RC2 reads low
+#define LIGHT_THRESHOLD_BRIGHT  1023    // RC2 reads high
+
+/**
+ * Parameters of the ambient light estimator. The average moves by 1/4 of
+ * the difference each readout, the hysteresis is 1/8 of the threshold, so
+ * the band is as wide for the bright thresholds of the bread board as for
+ * the dark one of the watches. */
+
+#if (APP_WATCH_TYPE_BUILD==APP_PROTOTYPE_BREAD_BOARD) && \
+    (APP_LIGHT_SENSOR_THRESHOLD==0)
+  #define LIGHT_LEVELS          4       // Number of brightness levels
+#else
+  #define LIGHT_LEVELS          2       // Number of brightness levels
+#endif
+
+#define LIGHT_EMA_FRACTION      4       // Fractional bits of the average
+#define LIGHT_EMA_SHIFT         2       // Weight 1/4 of a new readout
+#define LIGHT_HYSTERESIS_SHIFT  3       // Band of 1/8 around each threshold
+#define LIGHT_LEVEL_NONE        0xFF    // No readout since waking up
+
+/**
+ * Bounds of the adaptive interval between two light measurements in
+ * multiplexing cycles. The interval doubles while the readouts stay within
+ * LIGHT_STABLE_DELTA ADC counts or 1/4 of the readout, if more, on the
+ * same level and falls back to the minimum on a change. The fixed interval
+ * used before is the reference for the measurements saved. */
+
+#define LIGHT_INTERVAL_MIN      25      // Interval after a change
+#define LIGHT_INTERVAL_MAX      200     // Interval in steady light
+#define LIGHT_INTERVAL_FIXED    100     // Former fixed interval
+#define LIGHT_STABLE_DELTA      16      // ADC counts between stable readouts
+#define LIGHT_STABLE_SHIFT      2       // Part of the readout being stable
+#define LIGHT_ROUNDS_PER_SECOND 390     // 1 MHz / 16 / 160 timer 2 counts
+
+/**
+ * Night dimming schedule of builds without a light sensor. The hours are
+ * in BCD of the 24h clock, the night ends before NIGHT_END_HOURS. The
+ * hour is checked again every NIGHT_CHECK_INTERVAL multiplexing cycles. */
+
+#define NIGHT_START_HOURS       0x22    // Start of the night
+#define NIGHT_END_HOURS         0x07    // End of the night
+#define NIGHT_DIMMING           4       // Dimming used during the night
+#define NIGHT_CHECK_INTERVAL    100     // Cycles between two hour checks
+
+/**
+ * Stopwatch counting the crystal ticks of timer 1, extended by its 16-bit
+ * count of overflows, which lasts for 36 hours. The latest splits taken
+ * are kept. Asleep, the overflows are caught up from the half seconds the
+ * RTC counted within the week and the calibration applied every minute. */
+
+#define STOPWATCH_TICKS_SHIFT   15      // 32768 ticks per second
+#define STOPWATCH_SPLITS        4       // Splits kept
+#define STOPWATCH_HALF_SHIFT    14      // 16384 ticks per half second
+#define STOPWATCH_HALF_MINUTE   120     // Half seconds per minute
+#define STOPWATCH_HALF_WEEK     1209600 // Half seconds per week
+#define STOPWATCH_CAL_TICKS     4       // Ticks per RTCCAL step and minute
+
+/**
+ * Flags of the drift learning. */
+
+#define DRIFT_FLAG_VALID        0x01    // Time of the last sync is valid
+#define DRIFT_FLAG_PENDING      0x02    // RTC stopped for a sync
+
+/**
+ * History of the drift learning, kept in RAM during sleep. */
+
+typedef struct DriftHistoryStruct
+{
+    unsigned long seconds;          // Second of the day of the last sync
+    unsigned long own;              // Second of the day, when stopped
+    unsigned long start;            // Timer1 ticks, when stopped
+    unsigned long stopped;          // Timer1 ticks stopped until the edge
+    unsigned short days;            // Day number of the last sync
+    unsigned char flags;            // DRIFT_FLAG_xxx
+    unsigned char count;            // Number of samples
+    unsigned char index;            // Next sample to be written
+    signed char cal[DRIFT_HISTORY]; // Calibration values estimated
+
+} DriftHistoryType;
+
+/**
+ * Entries of the alarm schedule. Only the entry due next is programmed
+ * into the RTCC alarm, which is set to repeat once a week. */
+
+#define ALARM_SCHEDULE_SIZE     4       // Number of entries
+#define ALARM_ENTRY_DAILY       0       // Alarm set by the user
+#define ALARM_ENTRY_COUNTDOWN   1       // One-shot countdown
+#define ALARM_ENTRY_CHIME       2       // Hourly chime
+
+#define ALARM_FLAG_ENABLED      0x01    // Entry is active
+#define ALARM_FLAG_ONE_SHOT     0x02    // Disable after being due
+#define ALARM_FLAG_HOURLY       0x04    // Due every hour, hours ignored
+#define ALARM_FLAG_CHIME        0x08    // Short beep instead of the alarm
+
+#define ALARM_WEEKDAYS_ALL      0x7F    // Bit 0 Sunday .. bit 6 Saturday
+#define ALARM_MINUTES_NONE      0xFFFF  // Entry is never due
+#define ALARM_MINUTES_PER_DAY   1440
+
+/**
+ * Sound of the entries being due. The durations are in seconds. The
+ * chime while being asleep is a single beep played by the melody
+ * sequencer, the watch goes back to sleep once it is over. */
+
+#define ALARM_DURATION_ALARM    15      // Alarm ringing
+#define ALARM_DURATION_CHIME    1       // Chime while being awake
+#define ALARM_CHIME_MS          44      // Chime while being asleep
+
+/**
+ * Timing of the alarm melody by timer 3, counting 8us ticks of the
+ * instruction clock. The timer is loaded to overflow at the next step or
+ * second, its high priority interrupt advances the melody. */
+
+#define MELODY_TICKS_PER_MS     125L    // Timer 3 ticks per millisecond
+#define MELODY_TICKS_PER_SECOND 125000L // Timer 3 ticks per second
+#define MELODY_LOAD_TICKS       2       // Timer 3 ticks lost by loading it
+
+/**
+ * Step of an alarm melody, the timer 4 period of the tone as offset to the
+ * resonance of the piezo, the duty cycle in eighths of the period and the
+ * duration in milliseconds. A zero duty cycle is a rest, a zero duration
+ * ends the melody, which starts over then, unless the duty cycle of that
+ * step is MELODY_DUTY_STOP, which turns the buzzer off. */
+
+typedef struct
+{
+    signed char    offset;
+    unsigned char  duty;
+    unsigned short duration;
+} MelodyStepType;
+
+#define MELODY_DUTY_HALF        4       // Square wave, eighths of the period
+#define MELODY_DUTY_STOP        0xFF    // Melody played once
+
+/**
+ * Service mode sweeping the timer 4 period to find the resonance of the
+ * piezo, where it is the loudest at the same current. At 1MHz as FOSC/4
+ * and a timer 4 prescaler of 16 a period lasts (PR4+1)*16us. */
+
+#define PIEZO_PERIOD_DEFAULT    84      // 1.36ms, 735Hz
+#define PIEZO_PERIOD_MIN        16      // 272us, 3.7kHz
+#define PIEZO_PERIOD_MAX        96      // 1.55ms, 645Hz
+#define PIEZO_STEP_MS           100     // Duration of each sweep step
+#define PIEZO_SWEEP_SECONDS     60      // Sound of the service mode
+
+#define PIEZO_SWEEP_OFF         0       // No service mode
+#define PIEZO_SWEEP_AUTO        1       // Stepping up on its own
+#define PIEZO_SWEEP_MANUAL      2       // Stepped by HOUR and MIN
+
+/**
+ * Entry of the alarm schedule, times as BCD like the RTCC. */
+
+typedef struct AlarmEntryStruct
+{
+    unsigned char hours;            // Hours 0..23
+    unsigned char minutes;          // Minutes 0..59
+    unsigned char seconds;          // Seconds 0..59, zero if hourly
+    unsigned char weekdays;         // Mask of the weekdays being due
+    unsigned char flags;            // ALARM_FLAG_xxx
+
+} AlarmEntryType;
+
 /**
  * Function prototypes */
 
+void Detect_Chord(unsigned char upress);
+void Start_Stalled_RTCC(void);
+void Revoke_Stalled_RTCC(void);
+void Edit_Field(unsigned char uindex, signed char cdir);
+unsigned char Days_Of_Month(void);
+void Carry_RTCC_Day(void);
+void Forward_RTCC_Snapshot(signed char chours, signed char cminutes);
+unsigned char Bcd_Step(unsigned char ubcd, signed char cdir,
+                       unsigned char umin, unsigned char umax);
+
+#if APP_BCD_NATIVE_ARITHMETIC==1
+
+unsigned char Bcd_To_Decimal(unsigned char ubcd);
+unsigned char Decimal_To_Bcd(unsigned char udec);
+unsigned char Bcd_Is_Valid(unsigned char ubcd, unsigned char umin,
+                           unsigned char umax);
+
+#endif // #if APP_BCD_NATIVE_ARITHMETIC==1
+
+void Read_RTCC_Snapshot(void);
+
+#if APP_LIGHT_SENSOR_USAGE==1
+
+unsigned char Measure_Light_Step(void);
+unsigned char Estimate_Light_Level(unsigned short uv);
+void Adapt_Light_Interval(unsigned short uv, unsigned char uchanged);
+void Report_Light_Savings(void);
+
+#endif // #if APP_LIGHT_SENSOR_USAGE==1
+
+#if APP_NIGHT_DIMMING_USAGE==1
+
+unsigned char Is_Night_Time(unsigned char uhours);
+void Report_Night_Savings(void);
+
+#endif // #if APP_NIGHT_DIMMING_USAGE==1
+void Commit_RTCC_Stage(void);
+
+#if APP_TEMPERATURE_COMPENSATION==1
+
+unsigned short Count_Internal_Oscillator(void);
+signed char Measure_Die_Temperature(void);
+void Compensate_Temperature(void);
+
+#endif // #if APP_TEMPERATURE_COMPENSATION==1
+
+#if APP_DRIFT_LEARNING_USAGE==1
+
+void Drift_Sync_Begin(void);
+void Drift_Sync_End(void);
+void Drift_Invalidate(unsigned char uclear);
+
+#endif // #if APP_DRIFT_LEARNING_USAGE==1
+
+#if APP_TIMER_1_USAGE==1
+
+unsigned long Read_Timer_1_Ticks(void);
+
+#endif // #if APP_TIMER_1_USAGE==1
+
+#if APP_STOPWATCH_USAGE==1
+
+unsigned long Stopwatch_Shown(void);
+void Anchor_Stopwatch(void);
+void Catch_Up_Stopwatch(void);
+void Toggle_Stopwatch(void);
+void Split_Stopwatch(void);
+
+#endif // #if APP_STOPWATCH_USAGE==1
+
+#if APP_ALARM_SCHEDULE_USAGE==1
+
+unsigned short Minutes_Until_Alarm(const AlarmEntryType *palarm,
+                                   unsigned short unow,
+                                   unsigned char useconds,
+                                   unsigned char uweekday);
+void Schedule_Next_Alarm(void);
+unsigned char Handle_Alarm_Due(void);
+void Sound_Chime(void);
+void Start_Countdown(void);
+unsigned long Countdown_Remaining(void);
+
+#endif // #if APP_ALARM_SCHEDULE_USAGE==1
+
+#if APP_BUZZER_ALARM_USAGE==1
+
+void Start_Melody(const MelodyStepType *pmelody, unsigned char duration);
+void Arm_Melody_Timer(void);
+void Play_Tone(unsigned char uperiod, unsigned char uduty);
+void Play_Melody_Step(unsigned char ustep);
+void Service_Melody(void);
+void Load_Piezo_Period(void);
+void Start_Piezo_Sweep(void);
+void Step_Piezo_Sweep(signed char sdelta);
+void Store_Piezo_Period(void);
+
+#endif // #if APP_BUZZER_ALARM_USAGE==1
+
 void PressPB0(void);
 void HoldPB0(void);
 void ReleasePB0(void);
@@ -594,8 +1231,11 @@ void ReleasePB3(void);
 
 #if APP_WRIST_FLICK_USAGE==1
 
-void PressPB4(void);
-void ReleasePB4(void);
+unsigned char Classify_Flick(const short *pedges, unsigned char ucount);
+unsigned char Track_Flick(void);
+void Set_Flick_Strictness(unsigned char ustrict);
+void Load_Flick_Strictness(void);
+void Count_Flick_Outcome(unsigned char uoutcome);
 
 #endif // #if APP_WRIST_FLICK_USAGE==1
 
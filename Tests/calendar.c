@@ -0,0 +1,370 @@
+/**
+ * Calendar test of the firmware on the host harness.
+ *
+ * The set modes stage their edits and write them to the RTCC when left,
+ * while the RTC keeps running. A run starts at a random date and time,
+ * often right before the end of an hour, day, month or year, edits a few
+ * random fields as Edit_Field() does with time passing in between and
+ * commits the edits, at a random point of the second and often right
+ * before its rollover. The RTC has to hold the time edited plus the time
+ * passed since, as computed by a reference calendar, up to the rollovers
+ * seen by the RTC until it is stopped for writing.
+ *
+ * The cost of an edit step is measured as well: Edit_Field() is run up
+ * to a day after the first edit of a set mode, whose time is merged back
+ * into every snapshot. The register accesses and the basic blocks of the
+ * step must not grow with the time passed.
+ *
+ *   calendar [-n runs] [-s seed] [-v]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "main.h"
+#include "reference.h"
+#include "sim.h"
+
+#define EDITS_MAX           4
+#define WAIT_MAX            1800    // Seconds between the edits
+#define RTC_TICKS           32768   // Ticks of the prescaler per second
+#define RTC_LATE_TICKS      128     // Late in the second, RTCSYNC is 32
+#define EDIT_SPREAD_MAX     2       // Blocks of the slowest step to the fastest
+
+extern RtccSnapshotType g_rtcc;
+extern unsigned short g_uRtccStaged;
+
+void Unlock_RTCC(void);
+void Lock_RTCC(void);
+void Read_RTCC_Snapshot(void);
+void Stage_RTCC_Value(unsigned char uoffset, unsigned char uvalue);
+
+static unsigned long long s_rng;
+
+static unsigned long Random(unsigned long urange)
+{
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 7;
+    s_rng ^= s_rng << 17;
+
+    return (unsigned long)(s_rng % urange);
+}
+
+/**
+ * Random start, right before a rollover in most runs. */
+
+static void Random_Start(DateType *pd)
+{
+    pd->year = Random(4) ? (unsigned)Random(100) : 99;
+    pd->month = Random(3) ? 1 + (unsigned)Random(12) : 12;
+    pd->day = 1 + (unsigned)Random(Ref_Days_Of_Month(pd->year, pd->month));
+    pd->hours = (unsigned)Random(24);
+    pd->minutes = Random(2) ? (unsigned)Random(60) : 59;
+    pd->seconds = (unsigned)Random(60);
+
+    if (!Random(3))
+    {
+        pd->day = Ref_Days_Of_Month(pd->year, pd->month);
+        pd->hours = 23;
+    }
+
+    Ref_Date(Ref_Seconds(pd), pd);
+}
+
+static void Start_Rtc(const DateType *pd)
+{
+    Sim_Reset();
+    Sim_Set_Rtc(pd->year, pd->month, pd->day, pd->weekday, pd->hours,
+                pd->minutes, pd->seconds);
+
+    /* Half a second into the second. */
+
+    g_sim.prescaler = 16384;
+
+    Unlock_RTCC();
+    Lock_RTCC();
+
+    g_uRtccStaged = 0;
+}
+
+/**
+ * Measure the edit step after the given seconds passed since the first
+ * edit, returns the register accesses and the basic blocks of the step. */
+
+static void Measure_Edit(unsigned long useconds, unsigned long *paccesses,
+                         unsigned long *pblocks)
+{
+    static const DateType s_start = { 99, 12, 31, 4, 23, 30, 10 };
+
+    unsigned long uaccesses;
+    unsigned long ublocks;
+
+    Start_Rtc(&s_start);
+
+    Edit_Field(FIELD_INDEX_HOURS, 1);
+    Sim_Advance(useconds * SIM_NS_PER_SECOND);
+
+    uaccesses = g_sim.accesses;
+    ublocks = g_sim.blocks;
+
+    Edit_Field(FIELD_INDEX_HOURS, 1);
+
+    *paccesses = g_sim.accesses - uaccesses;
+    *pblocks = g_sim.blocks - ublocks;
+}
+
+/**
+ * Run one test: edit, wait and commit, then compare with the reference.
+ * Returns 0 on success and the text of the failure otherwise. */
+
+static int Run(char *ptext, size_t usize, int iverbose)
+{
+    static const unsigned char s_offsets[] = { 1, 2, 4, 5, 6 };
+
+    DateType start;
+    DateType ref;
+    DateType rtc;
+    unsigned long long uref;
+    unsigned long uwait;
+    unsigned long long useconds;
+    unsigned uedits = 1 + (unsigned)Random(EDITS_MAX);
+    unsigned u;
+    int ifrozen = 0;
+    int idate = 0;
+    char sexpect[32];
+    char sgot[32];
+    char sstart[32];
+
+    Random_Start(&start);
+    Start_Rtc(&start);
+
+    uref = Ref_Seconds(&start);
+    Ref_Print(sstart, sizeof(sstart), &start);
+
+    for (u = 0; u < uedits; u++)
+    {
+        const unsigned char uoffset = s_offsets[Random(sizeof(s_offsets))];
+        unsigned uvalue;
+
+        uwait = Random(4) ? Random(WAIT_MAX) : Random(5);
+        Sim_Advance(uwait * SIM_NS_PER_SECOND);
+
+        if (!ifrozen)
+        {
+            uref += uwait;
+        }
+
+        /* Edit as Edit_Field() does. */
+
+        Read_RTCC_Snapshot();
+        Ref_Date(uref, &ref);
+
+        switch (uoffset)
+        {
+            case 1:
+                uvalue = (unsigned)Random(60);
+                ref.minutes = uvalue;
+            break;
+
+            case 2:
+                uvalue = (unsigned)Random(24);
+                ref.hours = uvalue;
+            break;
+
+            case 4:
+                uvalue = 1 + (unsigned)Random(Ref_Days_Of_Month(ref.year, ref.month));
+                ref.day = uvalue;
+                idate = 1;
+            break;
+
+            case 5:
+                uvalue = 1 + (unsigned)Random(12);
+                ref.month = uvalue;
+                idate = 1;
+            break;
+
+            default:
+                uvalue = (unsigned)Random(100);
+                ref.year = ref.year / 100 * 100 + uvalue;
+                idate = 1;
+            break;
+        }
+
+        Stage_RTCC_Value(uoffset, Sim_To_Bcd(uvalue));
+
+        /* Zero the seconds, the time is then set as shown. */
+
+        if ((uoffset == 1) && (!Random(3)))
+        {
+            Stage_RTCC_Value(0, 0);
+            ref.seconds = 0;
+            ifrozen = 1;
+        }
+
+        /* Keep the day valid, if the month got shorter. */
+
+        if ((uoffset >= 5) &&
+            (ref.day > Ref_Days_Of_Month(ref.year, ref.month)))
+        {
+            ref.day = Ref_Days_Of_Month(ref.year, ref.month);
+            Stage_RTCC_Value(4, Sim_To_Bcd(ref.day));
+        }
+
+        uref = Ref_Seconds(&ref);
+
+        if (iverbose)
+        {
+            printf("  +%lus set [%u] = %02u\n", uwait, uoffset, uvalue);
+        }
+    }
+
+    uwait = Random(4) ? Random(WAIT_MAX) : Random(5);
+    Sim_Advance(uwait * SIM_NS_PER_SECOND);
+
+    if (!ifrozen)
+    {
+        uref += uwait;
+    }
+
+    /* The second of the snapshot may roll over during the commit. */
+
+    g_sim.prescaler = Random(2) ? RTC_TICKS - 1 - (long)Random(RTC_LATE_TICKS) :
+                                  (long)Random(RTC_TICKS);
+    useconds = g_sim.rtc_seconds;
+
+    Commit_RTCC_Stage();
+    Sim_Settle();
+
+    if (!ifrozen)
+    {
+        uref += g_sim.rtc_seconds - useconds;
+    }
+
+    Ref_Date(uref, &ref);
+    Ref_Rtc_Date(g_sim.rtc, &rtc);
+
+    ref.year %= 100;
+
+    /* The weekday is not edited along with the date. */
+
+    if (idate)
+    {
+        ref.weekday = rtc.weekday;
+    }
+
+    Ref_Print(sexpect, sizeof(sexpect), &ref);
+    Ref_Print(sgot, sizeof(sgot), &rtc);
+
+    if (iverbose)
+    {
+        printf("  +%lus commit: %s\n", uwait, sgot);
+    }
+
+    if (g_sim.violations)
+    {
+        snprintf(ptext, usize, "from %s: %.200s", sstart, g_sim.violation);
+        return 1;
+    }
+
+    if (memcmp(&ref, &rtc, sizeof(ref)))
+    {
+        snprintf(ptext, usize, "from %s: expected %s (weekday %u), got %s (weekday %u)",
+                 sstart, sexpect, ref.weekday, sgot, rtc.weekday);
+        return 1;
+    }
+
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long uruns = 2000;
+    unsigned long long useed = 1;
+    unsigned long ufailed = 0;
+    unsigned long n;
+    int iverbose = 0;
+    int i;
+
+    for (i = 1; i < argc; i++)
+    {
+        if ((!strcmp(argv[i], "-n")) && (i + 1 < argc))
+        {
+            uruns = strtoul(argv[++i], NULL, 0);
+        }
+        else if ((!strcmp(argv[i], "-s")) && (i + 1 < argc))
+        {
+            useed = strtoull(argv[++i], NULL, 0);
+        }
+        else if (!strcmp(argv[i], "-v"))
+        {
+            iverbose = 1;
+        }
+        else
+        {
+            fprintf(stderr, "usage: calendar [-n runs] [-s seed] [-v]\n");
+            return 2;
+        }
+    }
+
+    for (n = 0; n < uruns; n++)
+    {
+        char stext[SIM_FAIL_TEXT];
+
+        s_rng = (useed + n) * 0x9E3779B97F4A7C15ULL | 1;
+
+        if (iverbose)
+        {
+            printf("seed %llu:\n", useed + n);
+        }
+
+        if (Run(stext, sizeof(stext), iverbose))
+        {
+            ufailed++;
+
+            printf("seed %llu: %s\n", useed + n, stext);
+        }
+    }
+
+    printf("calendar: %lu of %lu runs failed\n", ufailed, uruns);
+
+    /* Cost of an edit step, from right after the first edit up to a day
+     * later, across the end of the century. */
+
+    {
+        static const unsigned long s_passed[] =
+        {
+            0, 1, 59, 60, 1799, 1800, 3600, 43200, 86339,
+        };
+
+        unsigned long uaccesses;
+        unsigned long ublocks;
+        unsigned long uaccmin = ~0UL;
+        unsigned long uaccmax = 0;
+        unsigned long umin = ~0UL;
+        unsigned long umax = 0;
+
+        for (n = 0; n < sizeof(s_passed) / sizeof(s_passed[0]); n++)
+        {
+            Measure_Edit(s_passed[n], &uaccesses, &ublocks);
+
+            uaccmin = (uaccesses < uaccmin) ? uaccesses : uaccmin;
+            uaccmax = (uaccesses > uaccmax) ? uaccesses : uaccmax;
+            umin = (ublocks < umin) ? ublocks : umin;
+            umax = (ublocks > umax) ? ublocks : umax;
+        }
+
+        printf("edit step: %lu..%lu register accesses (%lu..%lu cycles), "
+               "%lu..%lu basic blocks, 0 s..23:59 h after the first edit\n",
+               uaccmin, uaccmax, uaccmin * g_sim.cycles_per_access,
+               uaccmax * g_sim.cycles_per_access, umin, umax);
+
+        if (umax > EDIT_SPREAD_MAX * umin)
+        {
+            printf("edit step grows with the time passed\n");
+            ufailed++;
+        }
+    }
+
+    return ufailed ? 1 : 0;
+}
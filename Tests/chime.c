@@ -0,0 +1,186 @@
+/**
+ * Hourly chime sounded while asleep, on a build having the alarm schedule.
+ *
+ * The chime entry of the schedule is enabled and armed when the display
+ * shown on reset has timed out, the watch then sleeps for the time of a
+ * case. Each hour the RTCC alarm wakes the watch up, which plays the chime
+ * melody with the display off and goes back to sleep once it is over.
+ *
+ * The table lists the chimes sounded, as counted by the firmware, and the
+ * longest and shortest time awake of a chime. The test fails, if a chime
+ * is missing or counted twice, the watch woke up for anything else, stayed
+ * awake much longer than the chime lasts or left the buzzer or timer 3 on.
+ *
+ *   chime
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "main.h"
+#include "sim.h"
+
+#define RUN_TIMEOUT         120     // Seconds of real time
+#define AWAKE_SLACK_MS      4       // Handling the wake up and the sleep
+#define RUN_AFTER           (10 * SIM_NS_PER_SECOND)
+
+#define CCP1CON_CCP1M       0x0F
+
+extern AlarmEntryType g_alarms[ALARM_SCHEDULE_SIZE];
+extern unsigned short g_uChimeCount;
+
+/**
+ * Sleep of a case, starting at minutes and seconds before the hour. */
+
+typedef struct
+{
+    const char *name;
+    unsigned long hours;
+    unsigned char minutes;
+    unsigned char seconds;
+
+} CaseType;
+
+static const CaseType s_cases[] =
+{
+    { "hour",   1,   59, 30 },
+    { "day",    24,  59, 30 },
+    { "week",   168, 30, 0  },
+};
+
+#define CASES       (sizeof(s_cases) / sizeof(s_cases[0]))
+
+static unsigned char s_armed;
+static uint64_t s_twoke;
+static unsigned long s_chimes;
+static double s_awakeMin;
+static double s_awakeMax;
+
+/**
+ * Arm the chime when going to sleep the first time, afterwards time the
+ * chime and check the buzzer and timer 3 to be off. */
+
+static void On_Sleep(void)
+{
+    double dawake;
+
+    if (!s_armed)
+    {
+        s_armed = 1;
+        g_alarms[ALARM_ENTRY_CHIME].flags |= ALARM_FLAG_ENABLED;
+
+        Schedule_Next_Alarm();
+
+        return;
+    }
+
+    if (g_simSfr[SIM_CCP1CON] & CCP1CON_CCP1M)
+    {
+        Sim_Fail("buzzer on at sleep");
+    }
+
+    if (g_simSfr[SIM_T3CON] & 0x01)
+    {
+        Sim_Fail("timer 3 running at sleep");
+    }
+
+    dawake = (double)(g_sim.now - s_twoke) / 1e6;
+
+    if ((!s_chimes) || (dawake < s_awakeMin))
+    {
+        s_awakeMin = dawake;
+    }
+
+    if (dawake > s_awakeMax)
+    {
+        s_awakeMax = dawake;
+    }
+
+    s_chimes++;
+}
+
+static void On_Wake(void)
+{
+    s_twoke = g_sim.now;
+}
+
+static void Run(void *parg, SimResultType *presult)
+{
+    const CaseType *pc = (const CaseType *)parg;
+    const uint64_t tend = RUN_AFTER + pc->hours * 3600 * SIM_NS_PER_SECOND;
+
+    Sim_Set_Rtc(25, 6, 1, 0, 10, pc->minutes, pc->seconds);
+
+    g_sim.hooks.sleep = On_Sleep;
+    g_sim.hooks.wake = On_Wake;
+
+    Sim_Run(tend);
+
+    presult->values[0] = (double)g_uChimeCount;
+    presult->values[1] = (double)s_chimes;
+    presult->values[2] = (double)g_sim.wakes;
+    presult->values[3] = s_awakeMin;
+    presult->values[4] = s_awakeMax;
+    presult->status = ((s_armed) && (!g_sim.violations) &&
+                       (!g_sim.fail[0])) ? 0 : 1;
+    snprintf(presult->text, sizeof(presult->text), "%s",
+             !s_armed ? "display not timed out" :
+             g_sim.fail[0] ? g_sim.fail : g_sim.violation);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned u;
+    int ifailed = 0;
+
+    if (argc > 1)
+    {
+        fprintf(stderr, "usage: chime\n");
+        return 2;
+    }
+
+    (void)argv;
+
+    printf("%-8s %6s %7s %8s %8s\n", "case", "hours", "chimes", "min ms",
+           "max ms");
+
+    for (u = 0; u < CASES; u++)
+    {
+        const CaseType *pc = &s_cases[u];
+        SimResultType result;
+
+        if (Sim_Fork(Run, (void *)pc, &result, RUN_TIMEOUT) || result.status)
+        {
+            printf("%-8s failed: %s\n", pc->name, result.text);
+            ifailed = 1;
+            continue;
+        }
+
+        printf("%-8s %6lu %7.0f %8.1f %8.1f\n", pc->name, pc->hours,
+               result.values[0], result.values[3], result.values[4]);
+
+        if ((result.values[0] != pc->hours) ||
+            (result.values[1] != pc->hours))
+        {
+            printf("%-8s %.0f chimes counted, %.0f sounded\n", pc->name,
+                   result.values[0], result.values[1]);
+            ifailed = 1;
+        }
+
+        if (result.values[2] != pc->hours)
+        {
+            printf("%-8s woken up %.0f times\n", pc->name, result.values[2]);
+            ifailed = 1;
+        }
+
+        if ((result.values[3] < ALARM_CHIME_MS) ||
+            (result.values[4] > ALARM_CHIME_MS + AWAKE_SLACK_MS))
+        {
+            printf("%-8s chime not lasting %dms\n", pc->name, ALARM_CHIME_MS);
+            ifailed = 1;
+        }
+    }
+
+    return ifailed;
+}
@@ -0,0 +1,281 @@
+/**
+ * Replay of edge traces of the wrist flick input.
+ *
+ * The watch sleeps with the display off, while the edges of a trace are
+ * put on the flick input. Each trace gives the verdicts expected of the
+ * classifier in the order of its windows, and the times of the edges in
+ * ms, rising first and then alternating:
+ *
+ *   <name> <verdict>[,<verdict>...] : <ms> <ms> ...
+ *
+ * A verdict is 'accept', 'cancel' for a flick dismissing the display lit
+ * by the one before, or the reason of a rejection: 'held', 'rattle',
+ * 'pulses', 'short', 'long', 'span' or 'single'. The traces below model
+ * the tilt switch of a Hel, more can be read from a file of such lines.
+ * The table lists the wake ups and the time awake each trace costs. The
+ * test fails, if the classifier comes to other verdicts.
+ *
+ *   flick [-f traces]...
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "main.h"
+#include "sim.h"
+
+#define RUN_TIMEOUT         60      // Seconds of real time
+#define EDGES_MAX           64
+#define VERDICTS_MAX        8
+#define START_AT            (3 * SIM_NS_PER_SECOND)
+#define AFTER_LAST_EDGE     (20 * SIM_NS_PER_SECOND)
+
+extern unsigned short g_uFlickAccepted;
+extern unsigned short g_uFlickRejected;
+extern unsigned short g_uFlickCancelled;
+extern unsigned char g_ucFlickLastReject;
+
+static const char *const s_verdicts[] =
+{
+    "accept", "held", "rattle", "pulses", "short", "long", "span", "single",
+    "cancel",
+};
+
+#define VERDICT_CANCEL      8
+
+static const char *const s_traces[] =
+{
+    "flick accept : 0 180",
+    "bouncing accept : 0 2 3 5 6 190 191 193",
+    "double accept : 0 150 300 450",
+    "cancel accept,cancel : 0 150 1500 1650",
+    "bump short : 0 20",
+    "resting held : 0",
+    "walking rattle : 0 30 80 110 160 190 240 270 320 350 400 430 480 510",
+    "triple pulses : 0 100 200 300 400 500",
+    "tilt long : 0 600",
+    "bumps short,short : 0 20 1000 1030",
+};
+
+#define TRACES      (sizeof(s_traces) / sizeof(s_traces[0]))
+
+/**
+ * Trace replayed. */
+
+typedef struct
+{
+    char name[32];
+    unsigned long ms[EDGES_MAX];
+    unsigned cnt;
+    unsigned char verdicts[VERDICTS_MAX];
+    unsigned verdicts_cnt;
+
+} TraceType;
+
+static uint64_t s_awake;
+
+static void On_Wake(void)
+{
+    if (g_sim.wakes == 1)
+    {
+        s_awake = g_sim.awake_total;
+    }
+}
+
+static void Run(void *parg, SimResultType *presult)
+{
+    const TraceType *pt = (const TraceType *)parg;
+    unsigned char uport;
+    unsigned char ubit;
+    unsigned i;
+
+    Sim_Set_Rtc(25, 6, 1, 0, 12, 0, 0);
+    SIM_PIN(PB4_PIN, &uport, &ubit);
+
+    g_sim.hooks.wake = On_Wake;
+
+    for (i = 0; i < pt->cnt; i++)
+    {
+        Sim_Input(START_AT + pt->ms[i] * SIM_NS_PER_MS, uport, ubit,
+                  (unsigned char)(!(i & 1)));
+    }
+
+    Sim_Run(START_AT + pt->ms[pt->cnt - 1] * SIM_NS_PER_MS + AFTER_LAST_EDGE);
+
+    presult->values[0] = g_uFlickAccepted;
+    presult->values[1] = g_uFlickRejected;
+    presult->values[2] = g_uFlickCancelled;
+    presult->values[3] = g_ucFlickLastReject;
+    presult->values[4] = g_sim.wakes;
+    presult->values[5] = (double)(g_sim.awake_total - s_awake) / 1e6;
+    presult->status = g_sim.violations ? 1 : 0;
+    snprintf(presult->text, sizeof(presult->text), "%s", g_sim.violation);
+}
+
+/**
+ * Parse a trace line, returns zero if it is not one. */
+
+static int Parse(const char *pline, TraceType *pt)
+{
+    char sverdicts[80];
+    const char *p;
+    char *ptoken;
+    int ilen;
+    unsigned i;
+
+    memset(pt, 0, sizeof(*pt));
+
+    if (sscanf(pline, " %31s %79[^ :] :%n", pt->name, sverdicts, &ilen) != 2)
+    {
+        return 0;
+    }
+
+    for (ptoken = strtok(sverdicts, ","); ptoken; ptoken = strtok(NULL, ","))
+    {
+        for (i = 0; i < sizeof(s_verdicts) / sizeof(s_verdicts[0]); i++)
+        {
+            if (!strcmp(ptoken, s_verdicts[i]))
+            {
+                break;
+            }
+        }
+
+        if ((i == sizeof(s_verdicts) / sizeof(s_verdicts[0])) ||
+            (pt->verdicts_cnt >= VERDICTS_MAX))
+        {
+            return 0;
+        }
+
+        pt->verdicts[pt->verdicts_cnt++] = (unsigned char)i;
+    }
+
+    for (p = pline + ilen; pt->cnt < EDGES_MAX; )
+    {
+        char *pend;
+        const unsigned long ums = strtoul(p, &pend, 10);
+
+        if (pend == p)
+        {
+            break;
+        }
+
+        pt->ms[pt->cnt++] = ums;
+        p = pend;
+    }
+
+    return (pt->cnt > 0) && (pt->verdicts_cnt > 0);
+}
+
+static int Replay(const TraceType *pt)
+{
+    SimResultType result;
+    unsigned uaccepted = 0;
+    unsigned urejected = 0;
+    unsigned ucancelled = 0;
+    unsigned ulast = FLICK_ACCEPT;
+    unsigned i;
+
+    for (i = 0; i < pt->verdicts_cnt; i++)
+    {
+        if (pt->verdicts[i] == VERDICT_CANCEL)
+        {
+            uaccepted++;
+            ucancelled++;
+        }
+        else if (pt->verdicts[i] == FLICK_ACCEPT)
+        {
+            uaccepted++;
+        }
+        else
+        {
+            urejected++;
+            ulast = pt->verdicts[i];
+        }
+    }
+
+    if (Sim_Fork(Run, (void *)pt, &result, RUN_TIMEOUT) || result.status)
+    {
+        printf("%-10s failed: %s\n", pt->name, result.text);
+        return 1;
+    }
+
+    printf("%-10s %8.0f %8.0f %9.0f %6.0f %9.0f\n", pt->name, result.values[0],
+           result.values[1], result.values[2], result.values[4],
+           result.values[5]);
+
+    if ((result.values[0] != uaccepted) || (result.values[1] != urejected) ||
+        (result.values[2] != ucancelled) || (result.values[3] != ulast))
+    {
+        printf("%-10s expected %u accepted, %u rejected, %u cancelled, "
+               "last rejected as %s, got %s\n", pt->name, uaccepted,
+               urejected, ucancelled, s_verdicts[ulast],
+               s_verdicts[(unsigned)result.values[3] % VERDICT_CANCEL]);
+        return 1;
+    }
+
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    static TraceType s_trace;
+
+    unsigned u;
+    int ifailed = 0;
+    int ifiles = 0;
+    int i;
+
+    for (i = 1; i < argc; i++)
+    {
+        if ((strcmp(argv[i], "-f")) || (i + 1 >= argc))
+        {
+            fprintf(stderr, "usage: flick [-f traces]...\n");
+            return 2;
+        }
+
+        i++;
+    }
+
+    printf("%-10s %8s %8s %9s %6s %9s\n", "trace", "accepted", "rejected",
+           "cancelled", "wakes", "awake ms");
+
+    for (i = 2; i < argc; i += 2)
+    {
+        FILE *pf = fopen(argv[i], "r");
+        char line[512];
+
+        ifiles = 1;
+
+        if (!pf)
+        {
+            perror(argv[i]);
+            ifailed = 1;
+            continue;
+        }
+
+        while (fgets(line, sizeof(line), pf))
+        {
+            if ((line[0] != '#') && (Parse(line, &s_trace)))
+            {
+                ifailed |= Replay(&s_trace);
+            }
+        }
+
+        fclose(pf);
+    }
+
+    for (u = 0; (!ifiles) && (u < TRACES); u++)
+    {
+        if (!Parse(s_traces[u], &s_trace))
+        {
+            printf("bad trace: %s\n", s_traces[u]);
+            ifailed = 1;
+            continue;
+        }
+
+        ifailed |= Replay(&s_trace);
+    }
+
+    return ifailed;
+}
@@ -0,0 +1,805 @@
+/**
+ * Randomized test of the firmware on the host harness.
+ *
+ * A scenario starts the watch at a random date and time and then presses
+ * the buttons at random times, for random durations and with contact
+ * bounces, and shakes the wrist flick sensor on the watches having one.
+ * Each scenario runs in a fresh process and is checked for:
+ *
+ *   - no access to the RTCC against its rules, see sim.c
+ *   - no staying awake idle, the display times out
+ *   - the RTCC locked when going to sleep, and running unless it is kept
+ *     stopped in the 'stalled' state on purpose
+ *   - the timers 0, 2, 3 and 4 turned off when going to sleep
+ *   - the display, the buzzer and the light sensor turned off when going
+ *     to sleep: no output of the ports A, B and C driven high, i.e. no
+ *     common or segment of the display lit, no RC2 driving the buzzer
+ *     and no RA6 powering the light sensor, and the PWM of CCP1 off
+ *   - the RTC restarting after a stop of more than a second only on
+ *     pressing the TIME button, within a millisecond of its edge
+ *   - the RTC holding a valid date and time
+ *   - the decision on a chord of buttons held together taken within the
+ *     debounce time and a pass of the main loop from the last edge
+ *   - no crash and no hang
+ *
+ * A failing scenario is shrunk to a small one still failing the same way,
+ * by dropping steps and then shortening and simplifying the steps left.
+ * A scenario printed can be run again from a file by -r.
+ *
+ *   fuzz [-n runs] [-s seed] [-v]
+ *   fuzz -r file
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "main.h"
+#include "sim.h"
+
+#define STEPS_MAX           24
+#define RUN_TIMEOUT         60      // Seconds of real time
+#define AFTER_LAST_STEP     (600 * SIM_NS_PER_SECOND)
+#define AWAKE_LIMIT         (510 * SIM_NS_PER_SECOND)
+
+#define RTCCFG_RTCEN        0x80
+#define RTCCFG_RTCWREN      0x20
+
+#define CCP1CON_CCP1M       0x0F
+
+#define T0_NS               64000   // Timer 0 tick, 1:64 at 1MIPS
+#define CHORD_LATENCY_MAX   (T0_DEBOUNCE + 0x100)
+#define SYNC_LATENCY_MAX    SIM_NS_PER_MS
+#define SYNC_STEPS          5
+#define SYNC_STALL_MS       8000    // Display timed out, the watch stalled
+
+/**
+ * Classes of failures, a shrunk scenario has to keep its class. */
+
+typedef enum
+{
+    FAIL_NONE = 0,
+    FAIL_VIOLATION,
+    FAIL_AWAKE,
+    FAIL_UNLOCKED,
+    FAIL_STOPPED,
+    FAIL_TIMER,
+    FAIL_DRAIN,
+    FAIL_RESTART,
+    FAIL_CALENDAR,
+    FAIL_LATENCY,
+    FAIL_CRASH,
+
+} FailType;
+
+static const char *const s_failNames[] =
+{
+    "passed", "violation", "awake", "unlocked", "stopped", "timer",
+    "drain", "restart", "calendar", "latency", "crash",
+};
+
+typedef enum
+{
+    STEP_PRESS = 0,
+    STEP_FLICK,
+
+} StepKindType;
+
+/**
+ * Step of a scenario: a button press or a train of flick pulses. */
+
+typedef struct
+{
+    unsigned long gap;          // ms after the previous step
+    unsigned char kind;
+    unsigned char button;       // PB0..PB3
+    unsigned char count;        // Bounces or flick pulses
+    unsigned short len;         // ms of the press or of a pulse
+
+} StepType;
+
+typedef struct
+{
+    unsigned char year;
+    unsigned char month;
+    unsigned char day;
+    unsigned char hours;
+    unsigned char minutes;
+    unsigned char seconds;
+
+    unsigned cnt;
+    StepType steps[STEPS_MAX];
+
+} ScenarioType;
+
+extern unsigned char g_ucStalledSleep;
+extern short g_sChordLatencyMax;
+
+static const char *const s_buttonNames[] = { "TIME", "DATE", "HOUR", "MIN" };
+
+static unsigned char s_ports[5];
+static unsigned char s_bits[5];
+static unsigned char s_buttons;
+
+static const ScenarioType *s_pscenario;
+static FailType s_fail;
+static uint64_t s_syncLatency;
+static unsigned long s_syncs;
+
+static unsigned long long s_rng;
+
+static unsigned long Random(unsigned long urange)
+{
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 7;
+    s_rng ^= s_rng << 17;
+
+    return (unsigned long)((s_rng >> 11) % urange);
+}
+
+static void Fail(FailType ufail, const char *ptext)
+{
+    s_fail = ufail;
+
+    Sim_Fail("%s", ptext);
+}
+
+/**
+ * Time the TIME button has been pressed or released last. */
+
+static uint64_t Last_Time_Edge(void)
+{
+    uint64_t t = 0;
+    unsigned i;
+
+    for (i = 0; i < g_sim.events_next; i++)
+    {
+        if ((g_sim.events[i].port == s_ports[0]) &&
+            (g_sim.events[i].bit == s_bits[0]))
+        {
+            t = g_sim.events[i].t;
+        }
+    }
+
+    return t;
+}
+
+static void On_Sleep(void)
+{
+    const unsigned char ucfg = g_simSfr[SIM_RTCCFG];
+    unsigned uport;
+
+    if (ucfg & RTCCFG_RTCWREN)
+    {
+        Fail(FAIL_UNLOCKED, "RTCC left unlocked at sleep");
+    }
+
+    if ((!(ucfg & RTCCFG_RTCEN)) && (!g_ucStalledSleep))
+    {
+        Fail(FAIL_STOPPED, "RTC stopped at sleep without being stalled");
+    }
+
+    if (g_simSfr[SIM_T0CON] & 0x80)
+    {
+        Fail(FAIL_TIMER, "timer 0 running at sleep");
+    }
+
+    if (g_simSfr[SIM_T2CON] & 0x04)
+    {
+        Fail(FAIL_TIMER, "timer 2 running at sleep");
+    }
+
+    if (g_simSfr[SIM_T3CON] & 0x01)
+    {
+        Fail(FAIL_TIMER, "timer 3 running at sleep");
+    }
+
+    if (g_simSfr[SIM_T4CON] & 0x04)
+    {
+        Fail(FAIL_TIMER, "timer 4 running at sleep");
+    }
+
+    for (uport = SIM_PORT_A; uport <= SIM_PORT_C; uport++)
+    {
+        const unsigned char udriven = g_sim.lat[uport] &
+                                      (unsigned char)~g_simSfr[SIM_TRISA + uport];
+
+        if (udriven)
+        {
+            char text[SIM_FAIL_TEXT];
+
+            snprintf(text, sizeof(text), "port %c driven high at sleep: %02x",
+                     'A' + uport, udriven);
+            Fail(FAIL_DRAIN, text);
+        }
+    }
+
+    if (g_simSfr[SIM_CCP1CON] & CCP1CON_CCP1M)
+    {
+        Fail(FAIL_DRAIN, "buzzer PWM of CCP1 running at sleep");
+    }
+}
+
+static void On_Rtc_Start(uint64_t stopped)
+{
+    const int ipressed = (g_sim.pins[s_ports[0]] >> s_bits[0]) & 1;
+    const uint64_t ulatency = g_sim.now - Last_Time_Edge();
+
+    if ((stopped > 3 * SIM_NS_PER_SECOND / 2) && (!ipressed) &&
+        (ulatency > 3 * SIM_NS_PER_SECOND))
+    {
+        char text[SIM_FAIL_TEXT];
+
+        snprintf(text, sizeof(text),
+                 "RTC restarted after %.1fs without pressing TIME",
+                 stopped / 1e9);
+
+        Fail(FAIL_RESTART, text);
+    }
+
+    /* The sync of a watch stalled, the latency is taken from the edge of
+     * the input, not from the firmware seeing it. */
+
+    if ((stopped > 3 * SIM_NS_PER_SECOND / 2) && (ipressed))
+    {
+        s_syncs++;
+
+        if (ulatency > s_syncLatency)
+        {
+            s_syncLatency = ulatency;
+        }
+
+        if (ulatency > SYNC_LATENCY_MAX)
+        {
+            char text[SIM_FAIL_TEXT];
+
+            snprintf(text, sizeof(text), "RTC started %.2fms after the edge of TIME",
+                     ulatency / 1e6);
+
+            Fail(FAIL_LATENCY, text);
+        }
+    }
+}
+
+static int Rtc_Valid(void)
+{
+    static const unsigned char s_max[7] = { 59, 59, 23, 6, 31, 12, 99 };
+    static const unsigned char s_min[7] = { 0, 0, 0, 0, 1, 1, 0 };
+    unsigned i;
+
+    for (i = 0; i < 7; i++)
+    {
+        const unsigned char u = g_sim.rtc[i];
+
+        if (((u & 0x0F) > 9) || (Sim_Bcd(u) < s_min[i]) ||
+            (Sim_Bcd(u) > s_max[i]))
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * Turn the steps into pin changes, returns the time of the last one. */
+
+static uint64_t Schedule(const ScenarioType *ps)
+{
+    uint64_t t = 500 * SIM_NS_PER_MS;
+    uint64_t tlast = t;
+    unsigned i, j;
+
+    for (i = 0; i < ps->cnt; i++)
+    {
+        const StepType *pstep = &ps->steps[i];
+        const unsigned char upin = (pstep->kind == STEP_FLICK) ? 4 : pstep->button;
+        uint64_t tedge;
+
+        t += pstep->gap * SIM_NS_PER_MS;
+        tedge = t;
+
+        if (pstep->kind == STEP_FLICK)
+        {
+            for (j = 0; j < pstep->count; j++)
+            {
+                Sim_Input(tedge, s_ports[upin], s_bits[upin], 1);
+                tedge += pstep->len * SIM_NS_PER_MS;
+                Sim_Input(tedge, s_ports[upin], s_bits[upin], 0);
+                tedge += (pstep->len + 3) * SIM_NS_PER_MS;
+            }
+        }
+        else
+        {
+            /* Bounce on pressing and releasing, 0.3ms each. */
+
+            for (j = 0; j < pstep->count; j++)
+            {
+                Sim_Input(tedge, s_ports[upin], s_bits[upin], 1);
+                Sim_Input(tedge + 300000, s_ports[upin], s_bits[upin], 0);
+                tedge += 600000;
+            }
+
+            Sim_Input(tedge, s_ports[upin], s_bits[upin], 1);
+            tedge += pstep->len * SIM_NS_PER_MS;
+
+            for (j = 0; j < pstep->count; j++)
+            {
+                Sim_Input(tedge, s_ports[upin], s_bits[upin], 0);
+                Sim_Input(tedge + 300000, s_ports[upin], s_bits[upin], 1);
+                tedge += 600000;
+            }
+
+            Sim_Input(tedge, s_ports[upin], s_bits[upin], 0);
+        }
+
+        if (tedge > tlast)
+        {
+            tlast = tedge;
+        }
+    }
+
+    return tlast;
+}
+
+static void Run(void *parg, SimResultType *presult)
+{
+    const ScenarioType *ps = (const ScenarioType *)parg;
+    unsigned i;
+
+    s_pscenario = ps;
+    s_fail = FAIL_NONE;
+
+    for (i = 0; i < 5; i++)
+    {
+        g_sim.buttons[s_ports[i]] |= (unsigned char)(((s_buttons >> i) & 1) << s_bits[i]);
+    }
+
+    /* 1.1.2000 has been a Saturday, weekday 6. */
+
+    g_sim.rtc[SIM_RTC_YEAR] = ps->year;
+    g_sim.rtc[SIM_RTC_MONTH] = ps->month;
+    g_sim.rtc[SIM_RTC_DAY] = ps->day;
+    Sim_Set_Rtc(Sim_Bcd(ps->year), Sim_Bcd(ps->month), Sim_Bcd(ps->day),
+                (unsigned)((Sim_Rtc_Seconds() / 86400 + 6) % 7),
+                Sim_Bcd(ps->hours), Sim_Bcd(ps->minutes), Sim_Bcd(ps->seconds));
+
+    g_sim.awake_limit = AWAKE_LIMIT;
+    g_sim.hooks.sleep = On_Sleep;
+    g_sim.hooks.rtc_start = On_Rtc_Start;
+
+    Sim_Run(Schedule(ps) + AFTER_LAST_STEP);
+
+    if ((!s_fail) && (g_sim.fail[0]))
+    {
+        s_fail = FAIL_AWAKE;
+    }
+
+    if ((!s_fail) && (g_sim.violations))
+    {
+        s_fail = FAIL_VIOLATION;
+        snprintf(g_sim.fail, sizeof(g_sim.fail), "%s", g_sim.violation);
+    }
+
+    if ((!s_fail) && (!Rtc_Valid()))
+    {
+        s_fail = FAIL_CALENDAR;
+        snprintf(g_sim.fail, sizeof(g_sim.fail), "invalid RTC %02x.%02x.%02x %02x:%02x:%02x",
+                 g_sim.rtc[4], g_sim.rtc[5], g_sim.rtc[6],
+                 g_sim.rtc[2], g_sim.rtc[1], g_sim.rtc[0]);
+    }
+
+    if ((!s_fail) && (g_sChordLatencyMax > CHORD_LATENCY_MAX))
+    {
+        s_fail = FAIL_LATENCY;
+        snprintf(g_sim.fail, sizeof(g_sim.fail), "chord decided %.1fms after the edge",
+                 g_sChordLatencyMax * (T0_NS / 1e6));
+    }
+
+    presult->status = s_fail ? 1 : 0;
+    presult->values[0] = s_fail;
+    presult->values[1] = g_sChordLatencyMax;
+    presult->values[2] = (double)s_syncLatency;
+    presult->values[3] = (double)s_syncs;
+    snprintf(presult->text, sizeof(presult->text), "%s", g_sim.fail);
+}
+
+static FailType Try(const ScenarioType *ps, SimResultType *presult)
+{
+    if (Sim_Fork(Run, (void *)ps, presult, RUN_TIMEOUT) == 2)
+    {
+        presult->values[0] = FAIL_CRASH;
+    }
+
+    return (FailType)presult->values[0];
+}
+
+static void Generate(ScenarioType *ps, int iflick)
+{
+    static const unsigned char s_days[12] =
+    {
+        31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31
+    };
+
+    unsigned i;
+
+    memset(ps, 0, sizeof(*ps));
+
+    ps->year = Sim_To_Bcd(Random(100));
+    ps->month = Sim_To_Bcd(1 + Random(12));
+    ps->day = Sim_To_Bcd(1 + Random(s_days[Sim_Bcd(ps->month) - 1]));
+    ps->hours = Sim_To_Bcd(Random(24));
+    ps->minutes = Sim_To_Bcd(Random(60));
+    ps->seconds = Sim_To_Bcd(Random(60));
+
+    /* Start close to a rollover now and then. */
+
+    if (!Random(3))
+    {
+        ps->minutes = 0x59;
+        ps->seconds = Sim_To_Bcd(50 + Random(10));
+    }
+
+    ps->cnt = 1 + Random(STEPS_MAX);
+    i = 0;
+
+  #if APP_WATCH_ANY_PULSAR_MODEL==APP_WATCH_PULSAR_AUTO_SET
+
+    /* Sync the watch now and then, random steps rarely do: once the
+     * display shown on reset is off, three taps of TIME enter setting the
+     * time, the fourth forwards the minutes and stalls the watch, once
+     * the display timed out TIME starts it again. */
+
+    if (!Random(4))
+    {
+        static const unsigned long s_gaps[SYNC_STEPS] =
+        {
+            1500, 300, 300, 300, SYNC_STALL_MS
+        };
+
+        for (; i < SYNC_STEPS; i++)
+        {
+            ps->steps[i].gap = s_gaps[i];
+            ps->steps[i].kind = STEP_PRESS;
+            ps->steps[i].button = 0;
+            ps->steps[i].count = Random(3) ? 0 : (unsigned char)(1 + Random(4));
+            ps->steps[i].len = 100;
+        }
+
+        ps->cnt = SYNC_STEPS + Random(STEPS_MAX - SYNC_STEPS + 1);
+    }
+
+  #endif
+
+    for (; i < ps->cnt; i++)
+    {
+        StepType *pstep = &ps->steps[i];
+        const unsigned long upause = Random(10);
+
+        /* Mostly quick sequences, some pauses letting the display time
+         * out and a few long ones. */
+
+        pstep->gap = (upause < 6) ? Random(600) :
+                     (upause < 9) ? 500 + Random(5000) : Random(120000);
+
+        if ((iflick) && (!Random(4)))
+        {
+            pstep->kind = STEP_FLICK;
+            pstep->count = (unsigned char)(1 + Random(8));
+            pstep->len = (unsigned short)(2 + Random(40));
+        }
+        else
+        {
+            pstep->kind = STEP_PRESS;
+            pstep->button = (unsigned char)Random(4);
+            pstep->count = Random(3) ? 0 : (unsigned char)(1 + Random(4));
+            pstep->len = (unsigned short)(Random(4) ? 20 + Random(600) :
+                                                      500 + Random(6000));
+        }
+    }
+}
+
+static void Print(FILE *pf, const ScenarioType *ps)
+{
+    unsigned i;
+
+    fprintf(pf, "  start 20%02x-%02x-%02x %02x:%02x:%02x\n", ps->year,
+            ps->month, ps->day, ps->hours, ps->minutes, ps->seconds);
+
+    for (i = 0; i < ps->cnt; i++)
+    {
+        const StepType *pstep = &ps->steps[i];
+
+        if (pstep->kind == STEP_FLICK)
+        {
+            fprintf(pf, "  +%lums flick %u pulses of %ums\n", pstep->gap,
+                    pstep->count, pstep->len);
+        }
+        else
+        {
+            fprintf(pf, "  +%lums %s %ums, %u bounces\n", pstep->gap,
+                    s_buttonNames[pstep->button], pstep->len, pstep->count);
+        }
+    }
+}
+
+/**
+ * Read a scenario in the format printed. */
+
+static int Load(const char *pname, ScenarioType *ps)
+{
+    FILE *pf = fopen(pname, "r");
+    char line[160];
+    unsigned y, mo, d, h, mi, sec;
+
+    memset(ps, 0, sizeof(*ps));
+
+    if (!pf)
+    {
+        perror(pname);
+        return 0;
+    }
+
+    while (fgets(line, sizeof(line), pf))
+    {
+        StepType *pstep = &ps->steps[ps->cnt];
+        char name[8];
+        unsigned long ugap;
+        unsigned ucount, ulen, i;
+
+        if (sscanf(line, " start 20%x-%x-%x %x:%x:%x", &y, &mo, &d, &h, &mi, &sec) == 6)
+        {
+            ps->year = (unsigned char)y;
+            ps->month = (unsigned char)mo;
+            ps->day = (unsigned char)d;
+            ps->hours = (unsigned char)h;
+            ps->minutes = (unsigned char)mi;
+            ps->seconds = (unsigned char)sec;
+        }
+        else if (ps->cnt >= STEPS_MAX)
+        {
+            break;
+        }
+        else if (sscanf(line, " +%lums flick %u pulses of %ums", &ugap, &ucount, &ulen) == 3)
+        {
+            pstep->gap = ugap;
+            pstep->kind = STEP_FLICK;
+            pstep->count = (unsigned char)ucount;
+            pstep->len = (unsigned short)ulen;
+            ps->cnt++;
+        }
+        else if (sscanf(line, " +%lums %7s %ums, %u bounces", &ugap, name, &ulen, &ucount) == 4)
+        {
+            for (i = 0; i < 4; i++)
+            {
+                if (!strcmp(name, s_buttonNames[i]))
+                {
+                    pstep->gap = ugap;
+                    pstep->kind = STEP_PRESS;
+                    pstep->button = (unsigned char)i;
+                    pstep->count = (unsigned char)ucount;
+                    pstep->len = (unsigned short)ulen;
+                    ps->cnt++;
+                }
+            }
+        }
+    }
+
+    fclose(pf);
+
+    return ps->month != 0;
+}
+
+/**
+ * Shrink a failing scenario: drop chunks of steps, halving the chunk
+ * size down to single steps, then shorten the gaps and presses and drop
+ * the bounces, as long as the failure keeps its class. */
+
+static void Shrink(ScenarioType *ps, FailType ufail, SimResultType *presult)
+{
+    ScenarioType trial;
+    SimResultType result;
+    unsigned long utries = 0;
+    int ichanged = 1;
+
+    while (ichanged)
+    {
+        unsigned uchunk;
+        unsigned i;
+
+        ichanged = 0;
+
+        for (uchunk = ps->cnt / 2; uchunk >= 1; uchunk /= 2)
+        {
+            for (i = 0; i + uchunk <= ps->cnt; )
+            {
+                trial = *ps;
+                memmove(&trial.steps[i], &trial.steps[i + uchunk],
+                        (trial.cnt - i - uchunk) * sizeof(StepType));
+                trial.cnt -= uchunk;
+                utries++;
+
+                if (Try(&trial, &result) == ufail)
+                {
+                    *ps = trial;
+                    *presult = result;
+                    ichanged = 1;
+                }
+                else
+                {
+                    i += uchunk;
+                }
+            }
+        }
+
+        for (i = 0; i < ps->cnt; i++)
+        {
+            StepType *pstep = &trial.steps[i];
+            int k;
+
+            for (k = 0; k < 3; k++)
+            {
+                trial = *ps;
+
+                if ((k == 0) && (pstep->gap))
+                {
+                    pstep->gap /= 2;
+                }
+                else if ((k == 1) && (pstep->len > 20))
+                {
+                    pstep->len /= 2;
+                }
+                else if ((k == 2) && (pstep->kind == STEP_PRESS) && (pstep->count))
+                {
+                    pstep->count = 0;
+                }
+                else
+                {
+                    continue;
+                }
+
+                utries++;
+
+                if (Try(&trial, &result) == ufail)
+                {
+                    *ps = trial;
+                    *presult = result;
+                    ichanged = 1;
+                }
+            }
+        }
+    }
+
+    printf("  shrunk in %lu runs to %u steps: %s\n", utries, ps->cnt,
+           presult->text);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long uruns = 200;
+    unsigned long long useed = 1;
+    unsigned long ufailed = 0;
+    unsigned long n;
+    double dlatency = 0;
+    double dsync = 0;
+    double dsyncs = 0;
+    const char *preplay = NULL;
+    int iverbose = 0;
+    int iflick = 0;
+    int i;
+
+    for (i = 1; i < argc; i++)
+    {
+        if ((!strcmp(argv[i], "-n")) && (i + 1 < argc))
+        {
+            uruns = strtoul(argv[++i], NULL, 0);
+        }
+        else if ((!strcmp(argv[i], "-s")) && (i + 1 < argc))
+        {
+            useed = strtoull(argv[++i], NULL, 0);
+        }
+        else if ((!strcmp(argv[i], "-r")) && (i + 1 < argc))
+        {
+            preplay = argv[++i];
+        }
+        else if (!strcmp(argv[i], "-v"))
+        {
+            iverbose = 1;
+        }
+        else
+        {
+            fprintf(stderr, "usage: fuzz [-n runs] [-s seed] [-v] | -r file\n");
+            return 2;
+        }
+    }
+
+    SIM_PIN(PB0_PIN, &s_ports[0], &s_bits[0]);
+    SIM_PIN(PB1_PIN, &s_ports[1], &s_bits[1]);
+    SIM_PIN(PB2_PIN, &s_ports[2], &s_bits[2]);
+    SIM_PIN(PB3_PIN, &s_ports[3], &s_bits[3]);
+    s_buttons = 0x0F;
+
+  #if APP_WRIST_FLICK_USAGE==1
+
+    SIM_PIN(PB4_PIN, &s_ports[4], &s_bits[4]);
+    iflick = 1;
+
+  #else
+
+    s_ports[4] = s_ports[3];
+    s_bits[4] = s_bits[3];
+
+  #endif
+
+    if (preplay)
+    {
+        ScenarioType scenario;
+        SimResultType result;
+        FailType ufail;
+
+        if (!Load(preplay, &scenario))
+        {
+            fprintf(stderr, "fuzz: no scenario in %s\n", preplay);
+            return 2;
+        }
+
+        ufail = Try(&scenario, &result);
+
+        printf("%s: %s %s\n", preplay, s_failNames[ufail], result.text);
+
+        return ufail ? 1 : 0;
+    }
+
+    for (n = 0; n < uruns; n++)
+    {
+        ScenarioType scenario;
+        SimResultType result;
+        FailType ufail;
+
+        /* Every run has its own seed, so a failure can be run again. */
+
+        s_rng = (useed + n) * 0x9E3779B97F4A7C15ULL | 1;
+
+        Generate(&scenario, iflick);
+
+        ufail = Try(&scenario, &result);
+
+        if ((!ufail) && (result.values[1] > dlatency))
+        {
+            dlatency = result.values[1];
+        }
+
+        if ((!ufail) && (result.values[2] > dsync))
+        {
+            dsync = result.values[2];
+        }
+
+        if (!ufail)
+        {
+            dsyncs += result.values[3];
+        }
+
+        if (iverbose)
+        {
+            printf("seed %llu: %s\n", useed + n, s_failNames[ufail]);
+        }
+
+        if (ufail)
+        {
+            ufailed++;
+
+            printf("seed %llu: %s: %s\n", useed + n, s_failNames[ufail],
+                   result.text);
+            Print(stdout, &scenario);
+
+            Shrink(&scenario, ufail, &result);
+            Print(stdout, &scenario);
+        }
+    }
+
+    printf("fuzz: %lu of %lu scenarios failed, chord latency %.1fms max, "
+           "sync latency %.2fms max of %.0f\n", ufailed, uruns,
+           dlatency * (T0_NS / 1e6), dsync / 1e6, dsyncs);
+
+    return ufailed ? 1 : 0;
+}
@@ -0,0 +1,434 @@
+/**
+ * Replay of ambient light traces through the light measurement.
+ *
+ * The firmware runs with the display on, while the A/D converter returns
+ * the readout of a trace at the time of each conversion. A trace is one of
+ * the scenes below, scaled to the thresholds of the variant, or a file
+ * recorded on a watch with a line of 'ms readout' per sample, taken as a
+ * step function. Each trace is counted twice:
+ *
+ *   baseline   one readout every LIGHT_INTERVAL_FIXED cycles, compared
+ *              with the hard threshold, as the firmware did before
+ *   estimator  the readouts taken by the firmware, the level set by
+ *              Estimate_Light_Level() and the interval by
+ *              Adapt_Light_Interval()
+ *
+ * The table lists the brightness changes, each a visible step of the
+ * display, the measurements taken, the measurements saved per 1000 seconds
+ * as reported by Report_Light_Savings(), and the time the measurement
+ * blocks the multiplexing, the longest tick and the last readout. The test
+ * fails, if the estimator changes the brightness more often than the
+ * baseline, misses a change of the light, changes the brightness in steady
+ * light or measures more often than the fixed interval, if the report is
+ * off from the measurements counted, or if a tick blocks the multiplexing
+ * longer than the charge and a few register accesses.
+ *
+ *   light [-f trace]...
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "main.h"
+#include "sim.h"
+
+#define RUN_TIMEOUT         60      // Seconds of real time
+#define TRACE_SECONDS       8       // Length of the scenes
+#define TRACE_MAX           4096    // Samples of a recorded trace
+#define WAKE_AT             (3 * SIM_NS_PER_SECOND)
+#define TMR3_US             8       // Timer 3 tick, 1:8 at 1MIPS
+#define BLOCK_SLACK_US      100     // Register accesses besides the charge
+#define SAVED_TOLERANCE     0.2     // Whole seconds and the reset counted
+
+/* The long of XC8 is an int on the host, see sim/prepare.sh. */
+
+extern unsigned short g_uLightLevelChanges;
+extern unsigned short g_uLightBlock;
+extern unsigned short g_uLightBlockMax;
+extern unsigned short g_uLightSavedPerKs;
+extern unsigned int   g_ulLightFrames;
+extern const unsigned char g_light_thresholds[LIGHT_LEVELS - 1];
+
+/**
+ * Scene over the time in seconds, in readouts relative to the middle
+ * threshold of the variant, and the brightness changes it should make:
+ * -1 none expected, otherwise at least that many. */
+
+typedef struct
+{
+    const char *name;
+    double (*readout)(double dt);
+    int expect;
+
+} SceneType;
+
+static double Steady(double dt)
+{
+    (void)dt;
+
+    return 3.0;
+}
+
+static double Threshold(double dt)
+{
+    (void)dt;
+
+    return 1.0;
+}
+
+static double Lamp(double dt)
+{
+    /* Ripple of a lamp on the mains, aliased by the sampling. */
+
+    return 1.0 + 0.12 * sin(2.0 * M_PI * 100.0 * dt);
+}
+
+static double Shade(double dt)
+{
+    return ((dt >= 2.0) && (dt < 5.0)) ? 0.3 : 3.0;
+}
+
+static double Dusk(double dt)
+{
+    return 1.5 - dt / TRACE_SECONDS;
+}
+
+static const SceneType s_scenes[] =
+{
+    { "steady",    Steady,    -1 },
+    { "threshold", Threshold,  0 },
+    { "lamp",      Lamp,       0 },
+    { "shade",     Shade,      2 },
+    { "dusk",      Dusk,       1 },
+};
+
+#define SCENES      (sizeof(s_scenes) / sizeof(s_scenes[0]))
+
+/**
+ * Trace replayed, a scene or a recorded file. */
+
+typedef struct
+{
+    const char *name;
+    const SceneType *pscene;
+    unsigned cnt;
+    unsigned long ms[TRACE_MAX];
+    unsigned short readout[TRACE_MAX];
+    double seconds;
+    int expect;
+
+} TraceType;
+
+static const TraceType *s_ptrace;
+static unsigned long long s_rng;
+static unsigned short s_changes;
+static unsigned s_frames;
+static unsigned s_frameslast;
+static uint64_t s_tlast;
+static unsigned long s_samples;
+
+/**
+ * Noise of a few percent on every readout, as seen on the sensor. */
+
+static double Noise(void)
+{
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 7;
+    s_rng ^= s_rng << 17;
+
+    return ((double)((s_rng >> 11) % 2001) - 1000.0) / 1000.0 * 0.06;
+}
+
+/**
+ * Middle threshold of the variant in ADC counts. */
+
+static double Reference(void)
+{
+    return 4.0 * g_light_thresholds[(LIGHT_LEVELS - 1) / 2];
+}
+
+static unsigned short Readout(double dt)
+{
+    const TraceType *pt = s_ptrace;
+    double dv;
+    unsigned i;
+
+    if (pt->pscene)
+    {
+        dv = Reference() * (pt->pscene->readout(dt) + Noise());
+
+        return (unsigned short)((dv < 1.0) ? 1.0 : (dv > 1023.0) ? 1023.0 : dv);
+    }
+
+    for (i = 1; (i < pt->cnt) && (pt->ms[i] <= dt * 1000.0); i++)
+    {
+    }
+
+    return pt->readout[i - 1];
+}
+
+/**
+ * Dimming the firmware took from a single readout before the estimator,
+ * a hard threshold on the watches and a step per 64 counts below 1000 on
+ * the bread board. */
+
+static unsigned char Baseline_Dimming(unsigned short uv)
+{
+  #if APP_WATCH_TYPE_BUILD==APP_PROTOTYPE_BREAD_BOARD
+
+    return (uv > 1000) ? 0 : (unsigned char)(15 - (uv >> 6));
+
+  #else
+
+    return (uv >= 64) ? 0 : 1;
+
+  #endif
+}
+
+/**
+ * Count from waking up by TIME, after the display shown on reset. */
+
+static void On_Wake(void)
+{
+    if (g_sim.wakes == 1)
+    {
+        s_changes = g_uLightLevelChanges;
+        s_frames = g_ulLightFrames;
+    }
+}
+
+static unsigned short On_Adc(unsigned char uchannel)
+{
+    (void)uchannel;
+
+    if (g_sim.now < WAKE_AT)
+    {
+        return Readout(0.0);
+    }
+
+    /* Count the readouts and the frame rate up to the end of the trace. */
+
+    if (g_sim.now <= WAKE_AT + (uint64_t)(s_ptrace->seconds * 1e9))
+    {
+        s_tlast = g_sim.now;
+        s_frameslast = g_ulLightFrames;
+        s_samples++;
+    }
+
+    return Readout((double)(g_sim.now - WAKE_AT) / 1e9);
+}
+
+static void Run(void *parg, SimResultType *presult)
+{
+    const TraceType *pt = (const TraceType *)parg;
+    const uint64_t tend = WAKE_AT + (uint64_t)(pt->seconds * 1e9);
+    unsigned char upin[2];
+    unsigned long ubaseline = 0;
+    unsigned long n;
+    double dinterval;
+    int iprev = -1;
+
+    s_ptrace = pt;
+    s_rng = 0x9E3779B97F4A7C15ULL;
+
+    Sim_Set_Rtc(25, 6, 1, 0, 12, 0, 0);
+    SIM_PIN(PB0_PIN, &upin[0], &upin[1]);
+
+    g_sim.buttons[upin[0]] |= (unsigned char)(1 << upin[1]);
+    g_sim.hooks.adc = On_Adc;
+    g_sim.hooks.wake = On_Wake;
+
+    /* Hold TIME through the trace to keep the display on. */
+
+    Sim_Input(WAKE_AT, upin[0], upin[1], 1);
+    Sim_Input(tend, upin[0], upin[1], 0);
+    Sim_Run(tend + SIM_NS_PER_SECOND);
+
+    /* The baseline took a readout every LIGHT_INTERVAL_FIXED + 1 frames
+     * over the same time, at the frame rate seen. */
+
+    dinterval = (double)(s_tlast - WAKE_AT) / 1e9 *
+             (LIGHT_INTERVAL_FIXED + 1) /
+             (double)((s_frameslast > s_frames) ? s_frameslast - s_frames : 1);
+    s_rng = 0x9E3779B97F4A7C15ULL;
+
+    for (n = 0; dinterval * (double)n < pt->seconds; n++)
+    {
+        const unsigned char udim = Baseline_Dimming(Readout(dinterval * (double)n));
+
+        if ((iprev >= 0) && (udim != iprev))
+        {
+            ubaseline++;
+        }
+
+        iprev = udim;
+    }
+
+    presult->values[0] = (double)ubaseline;
+    presult->values[1] = (double)n;
+    presult->values[2] = (double)(unsigned short)(g_uLightLevelChanges - s_changes);
+    presult->values[3] = (double)s_samples;
+    presult->values[4] = (double)g_uLightBlockMax * TMR3_US;
+    presult->values[5] = (double)g_uLightBlock * TMR3_US;
+
+    Report_Light_Savings();
+
+    presult->values[6] = (double)g_uLightSavedPerKs;
+    presult->status = ((g_sim.wakes) && (!g_sim.violations)) ? 0 : 1;
+    snprintf(presult->text, sizeof(presult->text), "%s",
+             g_sim.wakes ? g_sim.violation : "no wake up by TIME");
+}
+
+/**
+ * Read a recorded trace of 'ms readout' lines. */
+
+static int Load(const char *pname, TraceType *pt)
+{
+    FILE *pf = fopen(pname, "r");
+    char line[80];
+    unsigned long ums;
+    unsigned uv;
+
+    memset(pt, 0, sizeof(*pt));
+    pt->name = pname;
+    pt->expect = 0;
+
+    if (!pf)
+    {
+        perror(pname);
+        return 0;
+    }
+
+    while ((pt->cnt < TRACE_MAX) && fgets(line, sizeof(line), pf))
+    {
+        if ((line[0] != '#') && (sscanf(line, "%lu %u", &ums, &uv) == 2))
+        {
+            pt->ms[pt->cnt] = ums;
+            pt->readout[pt->cnt] = (unsigned short)((uv > 1023) ? 1023 : uv);
+            pt->cnt++;
+        }
+    }
+
+    fclose(pf);
+
+    if (pt->cnt)
+    {
+        pt->seconds = (double)pt->ms[pt->cnt - 1] / 1000.0;
+    }
+
+    return pt->cnt > 1;
+}
+
+static int Replay(const TraceType *pt)
+{
+    SimResultType result;
+    const char *pname = pt->pscene ? pt->pscene->name : pt->name;
+    double dsaved;
+    int ifailed = 0;
+
+    if (Sim_Fork(Run, (void *)pt, &result, RUN_TIMEOUT) || result.status)
+    {
+        printf("%-10s failed: %s\n", pname, result.text);
+        return 1;
+    }
+
+    printf("%-10s %8.0f %8.0f %10.0f %8.0f %8.0f %8.0f %8.0f\n", pname,
+           result.values[0], result.values[2], result.values[1],
+           result.values[3], result.values[6], result.values[4],
+           result.values[5]);
+
+    if (result.values[2] > result.values[0])
+    {
+        printf("%-10s more changes than the baseline\n", pname);
+        ifailed = 1;
+    }
+
+    if (result.values[3] > result.values[1])
+    {
+        printf("%-10s more measurements than the fixed interval\n", pname);
+        ifailed = 1;
+    }
+
+    if ((pt->expect < 0) && (result.values[2] > 0))
+    {
+        printf("%-10s changes in steady light\n", pname);
+        ifailed = 1;
+    }
+
+    if ((pt->expect > 0) && (result.values[2] < pt->expect))
+    {
+        printf("%-10s missed a change of the light\n", pname);
+        ifailed = 1;
+    }
+
+    dsaved = (result.values[1] - result.values[3]) * 1000.0 / pt->seconds;
+
+    if (fabs(result.values[6] - dsaved) > dsaved * SAVED_TOLERANCE)
+    {
+        printf("%-10s reporting %.0f saved per 1000s instead of %.0f\n",
+               pname, result.values[6], dsaved);
+        ifailed = 1;
+    }
+
+    if (result.values[4] > LIGHT_CHARGE_TICKS * TMR3_US + BLOCK_SLACK_US)
+    {
+        printf("%-10s blocking the multiplexing too long\n", pname);
+        ifailed = 1;
+    }
+
+    return ifailed;
+}
+
+int main(int argc, char **argv)
+{
+    static TraceType s_trace;
+
+    unsigned u;
+    int ifailed = 0;
+    int ifiles = 0;
+    int i;
+
+    for (i = 1; i < argc; i++)
+    {
+        if ((strcmp(argv[i], "-f")) || (i + 1 >= argc))
+        {
+            fprintf(stderr, "usage: light [-f trace]...\n");
+            return 2;
+        }
+
+        i++;
+    }
+
+    printf("%-10s %17s %28s %17s\n", "", "changes", "measurements",
+           "blocking us");
+    printf("%-10s %8s %8s %10s %8s %8s %8s %8s\n", "trace", "baseline",
+           "filtered", "fixed", "adaptive", "saved/ks", "tick", "readout");
+
+    for (i = 2; i < argc; i += 2)
+    {
+        ifiles = 1;
+
+        if (!Load(argv[i], &s_trace))
+        {
+            printf("%-10s no samples\n", argv[i]);
+            ifailed = 1;
+            continue;
+        }
+
+        ifailed |= Replay(&s_trace);
+    }
+
+    for (u = 0; (!ifiles) && (u < SCENES); u++)
+    {
+        memset(&s_trace, 0, sizeof(s_trace));
+        s_trace.pscene = &s_scenes[u];
+        s_trace.seconds = TRACE_SECONDS;
+        s_trace.expect = s_scenes[u].expect;
+
+        ifailed |= Replay(&s_trace);
+    }
+
+    return ifailed;
+}
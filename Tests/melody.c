@@ -0,0 +1,256 @@
+/**
+ * Alarm melody played through a long pass of the main loop, on a build
+ * having the alarm schedule.
+ *
+ * The melody of a case is started when the display shown on reset has
+ * timed out, the test then keeps the firmware from coming back to its
+ * main loop until well after the melody is over, polling the buzzer like
+ * a long pass. The interrupt of timer 3 alone advances the melody and
+ * counts down the alarm duration.
+ *
+ * The table lists the edges of the buzzer seen, the largest error of an
+ * edge against the durations of the steps, the time timer 3 was turned off
+ * and the calls of the interrupt routine. The test fails, if an edge is
+ * missing or off by more than a tick of timer 3 per interrupt, or the
+ * melody is not over in time.
+ *
+ *   melody
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "main.h"
+#include "sim.h"
+
+#define RUN_TIMEOUT         60      // Seconds of real time
+#define EDGES_MAX           256
+#define TICK_MS             0.008   // Timer 3 tick, lost per interrupt
+#define START_MS            0.1     // Starting the melody
+#define PASS_AFTER_MS       2000    // Polling on after the melody is over
+
+#define CCP1CON_CCP1M       0x0F
+#define T3CON_TMR3ON        0x01
+
+extern const MelodyStepType g_alarm_melody[];
+extern const MelodyStepType g_chime_melody[];
+
+/**
+ * Melody of a case and its duration in seconds. */
+
+typedef struct
+{
+    const char *name;
+    const MelodyStepType *melody;
+    unsigned char seconds;
+
+} CaseType;
+
+static const CaseType s_cases[] =
+{
+    { "alarm",  g_alarm_melody, ALARM_DURATION_ALARM },
+    { "chime",  g_chime_melody, ALARM_DURATION_CHIME },
+};
+
+#define CASES       (sizeof(s_cases) / sizeof(s_cases[0]))
+
+static const CaseType *s_pcase;
+static unsigned char s_started;
+static double s_edges[EDGES_MAX];
+static unsigned s_edgesCnt;
+static double s_tstop;
+static unsigned long s_interrupts;
+
+/**
+ * Start the melody when going to sleep the first time and poll the
+ * buzzer and timer 3 from there, without returning to the firmware. */
+
+static void On_Sleep(void)
+{
+    const uint64_t tstart = g_sim.now;
+    const uint64_t tlimit = tstart + (s_pcase->seconds * 1000ULL +
+                                      PASS_AFTER_MS) * SIM_NS_PER_MS;
+    unsigned char uon;
+
+    if (s_started)
+    {
+        return;
+    }
+
+    s_started = 1;
+    s_interrupts = g_sim.interrupts;
+
+    Start_Melody(s_pcase->melody, s_pcase->seconds);
+
+    uon = g_simSfr[SIM_CCP1CON] & CCP1CON_CCP1M;
+
+    while (g_sim.now < tlimit)
+    {
+        const unsigned char unow = *Sim_Reg(SIM_CCP1CON) & CCP1CON_CCP1M;
+        const double dms = (double)(g_sim.now - tstart) / 1e6;
+
+        if ((!unow) != (!uon))
+        {
+            uon = unow;
+
+            if (s_edgesCnt < EDGES_MAX)
+            {
+                s_edges[s_edgesCnt++] = dms;
+            }
+        }
+
+        if ((!s_tstop) && (!(g_simSfr[SIM_T3CON] & T3CON_TMR3ON)))
+        {
+            s_tstop = dms;
+        }
+    }
+
+    s_interrupts = g_sim.interrupts - s_interrupts;
+}
+
+/**
+ * Edges of the buzzer expected within the duration of the melody, and
+ * the time it is over, which is the duration or the end of a melody
+ * played once. */
+
+static unsigned Expect(const CaseType *pc, double *pedges, double *pstop)
+{
+    const MelodyStepType *pstep = pc->melody;
+    const double dend = pc->seconds * 1000.0;
+    unsigned ucnt = 0;
+    double dms = 0;
+    int ion = pstep->duty != 0;
+
+    for (;;)
+    {
+        dms += pstep->duration;
+        pstep++;
+
+        if (!pstep->duration)
+        {
+            if (pstep->duty == MELODY_DUTY_STOP)
+            {
+                break;
+            }
+
+            pstep = pc->melody;
+        }
+
+        if (dms >= dend)
+        {
+            break;
+        }
+
+        if ((pstep->duty != 0) != ion)
+        {
+            ion = !ion;
+            pedges[ucnt++] = dms;
+        }
+    }
+
+    *pstop = (dms < dend) ? dms : dend;
+
+    /* The buzzer is turned off by the end of the melody. */
+
+    if (ion)
+    {
+        pedges[ucnt++] = *pstop;
+    }
+
+    return ucnt;
+}
+
+static void Run(void *parg, SimResultType *presult)
+{
+    double dexpected[EDGES_MAX];
+    double dstop;
+    double derror = 0;
+    unsigned ucnt;
+    unsigned i;
+
+    s_pcase = (const CaseType *)parg;
+
+    Sim_Set_Rtc(25, 6, 1, 0, 10, 0, 0);
+
+    g_sim.hooks.sleep = On_Sleep;
+
+    Sim_Run(30 * SIM_NS_PER_SECOND);
+
+    ucnt = Expect(s_pcase, dexpected, &dstop);
+
+    for (i = 0; (i < ucnt) && (i < s_edgesCnt); i++)
+    {
+        const double d = fabs(s_edges[i] - dexpected[i]);
+
+        if (d > derror)
+        {
+            derror = d;
+        }
+    }
+
+    presult->values[0] = (double)s_edgesCnt;
+    presult->values[1] = (double)ucnt;
+    presult->values[2] = derror;
+    presult->values[3] = s_tstop;
+    presult->values[4] = dstop;
+    presult->values[5] = (double)s_interrupts;
+    presult->status = ((s_started) && (!g_sim.violations) &&
+                       (!g_sim.fail[0])) ? 0 : 1;
+    snprintf(presult->text, sizeof(presult->text), "%s",
+             !s_started ? "display not timed out" :
+             g_sim.fail[0] ? g_sim.fail : g_sim.violation);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned u;
+    int ifailed = 0;
+
+    if (argc > 1)
+    {
+        fprintf(stderr, "usage: melody\n");
+        return 2;
+    }
+
+    (void)argv;
+
+    printf("%-8s %6s %9s %8s %11s\n", "case", "edges", "error ms", "stop ms",
+           "interrupts");
+
+    for (u = 0; u < CASES; u++)
+    {
+        const CaseType *pc = &s_cases[u];
+        SimResultType result;
+        double dslack;
+
+        if (Sim_Fork(Run, (void *)pc, &result, RUN_TIMEOUT) || result.status)
+        {
+            printf("%-8s failed: %s\n", pc->name, result.text);
+            ifailed = 1;
+            continue;
+        }
+
+        printf("%-8s %6.0f %9.3f %8.1f %11.0f\n", pc->name, result.values[0],
+               result.values[2], result.values[3], result.values[5]);
+
+        if (result.values[0] != result.values[1])
+        {
+            printf("%-8s %.0f of %.0f edges\n", pc->name, result.values[0],
+                   result.values[1]);
+            ifailed = 1;
+        }
+
+        dslack = START_MS + TICK_MS * result.values[5];
+
+        if ((result.values[2] > dslack) ||
+            (fabs(result.values[3] - result.values[4]) > dslack))
+        {
+            printf("%-8s melody not kept in time\n", pc->name);
+            ifailed = 1;
+        }
+    }
+
+    return ifailed;
+}
@@ -0,0 +1,148 @@
+/**
+ * Night dimming of a build without a light sensor.
+ *
+ * The watch is reset at an hour of a case and then woken up by DATE a few
+ * times, each readout timing out on its own. The report of the firmware,
+ * the readouts dimmed and the dark multiplexing ticks per readout, is
+ * updated on each wake up and once more at the end of the run.
+ *
+ * The table lists the readouts dimmed, the dark multiplexing ticks per
+ * readout, each saving the charge of a digit lit, and the time awake of
+ * the readouts woken up by DATE. The test fails, if a readout at night is
+ * not dimmed or none of its ticks is dark, or a readout at day is dimmed.
+ *
+ *   night
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "main.h"
+#include "sim.h"
+
+#define RUN_TIMEOUT         60      // Seconds of real time
+#define PRESSES             3       // Wake ups by DATE after the reset
+#define PRESS_GAP           (10 * SIM_NS_PER_SECOND)
+
+extern unsigned short g_uNightReadouts;
+extern unsigned short g_uNightSavedPerReadout;
+
+/**
+ * Hour and minutes the watch is reset at, and if it is night then. */
+
+typedef struct
+{
+    const char *name;
+    unsigned char hours;
+    unsigned char minutes;
+    unsigned char night;
+
+} CaseType;
+
+static const CaseType s_cases[] =
+{
+    { "evening",    23, 0,  1 },
+    { "midday",     12, 0,  0 },
+    { "dawn",       6,  58, 1 },
+    { "morning",    7,  0,  0 },
+};
+
+#define CASES       (sizeof(s_cases) / sizeof(s_cases[0]))
+
+/**
+ * Sum up the time awake of the readouts. */
+
+static uint64_t s_tawake;
+static uint64_t s_twoke;
+
+static void On_Wake(void)
+{
+    s_twoke = g_sim.now;
+}
+
+static void On_Sleep(void)
+{
+    s_tawake += g_sim.now - s_twoke;
+}
+
+static void Run(void *parg, SimResultType *presult)
+{
+    const CaseType *pc = (const CaseType *)parg;
+    unsigned char uport;
+    unsigned char ubit;
+    unsigned u;
+
+    Sim_Set_Rtc(25, 6, 1, 0, pc->hours, pc->minutes, 0);
+    SIM_PIN(PB1_PIN, &uport, &ubit);
+
+    g_sim.hooks.wake = On_Wake;
+    g_sim.hooks.sleep = On_Sleep;
+
+    for (u = 1; u <= PRESSES; u++)
+    {
+        Sim_Input(u * PRESS_GAP, uport, ubit, 1);
+        Sim_Input(u * PRESS_GAP + 100 * SIM_NS_PER_MS, uport, ubit, 0);
+    }
+
+    Sim_Run((PRESSES + 1) * PRESS_GAP);
+
+    Report_Night_Savings();
+
+    presult->values[0] = (double)g_uNightReadouts;
+    presult->values[1] = (double)g_uNightSavedPerReadout;
+    presult->values[2] = (double)s_tawake / 1e6;
+    presult->status = ((g_sim.wakes == PRESSES) &&
+                       (!g_sim.violations)) ? 0 : 1;
+    snprintf(presult->text, sizeof(presult->text), "%s",
+             g_sim.violations ? g_sim.violation : "not woken up by DATE");
+}
+
+int main(int argc, char **argv)
+{
+    unsigned u;
+    int ifailed = 0;
+
+    if (argc > 1)
+    {
+        fprintf(stderr, "usage: night\n");
+        return 2;
+    }
+
+    (void)argv;
+
+    printf("%-8s %5s %8s %11s %9s\n", "case", "hour", "dimmed", "dark ticks",
+           "awake ms");
+
+    for (u = 0; u < CASES; u++)
+    {
+        const CaseType *pc = &s_cases[u];
+        SimResultType result;
+
+        if (Sim_Fork(Run, (void *)pc, &result, RUN_TIMEOUT) || result.status)
+        {
+            printf("%-8s failed: %s\n", pc->name, result.text);
+            ifailed = 1;
+            continue;
+        }
+
+        printf("%-8s %2u:%02u %8.0f %11.0f %9.1f\n", pc->name, pc->hours,
+               pc->minutes, result.values[0], result.values[1],
+               result.values[2]);
+
+        if (result.values[0] != (pc->night ? PRESSES + 1 : 0))
+        {
+            printf("%-8s %.0f of %d readouts dimmed\n", pc->name,
+                   result.values[0], pc->night ? PRESSES + 1 : 0);
+            ifailed = 1;
+        }
+
+        if ((pc->night) && (result.values[1] <= 0))
+        {
+            printf("%-8s no dark ticks at night\n", pc->name);
+            ifailed = 1;
+        }
+    }
+
+    return ifailed;
+}
@@ -0,0 +1,91 @@
+/**
+ * Reference calendar of the host tests, see reference.h.
+ */
+
+#include <stdio.h>
+
+#include "reference.h"
+#include "sim.h"
+
+unsigned Ref_Days_Of_Month(unsigned uyear, unsigned umonth)
+{
+    if (umonth == 2)
+    {
+        return (uyear % 4) ? 28 : 29;
+    }
+
+    return ((umonth == 4) || (umonth == 6) || (umonth == 9) ||
+            (umonth == 11)) ? 30 : 31;
+}
+
+/**
+ * Seconds since 1.1.2000 of a date. */
+
+unsigned long long Ref_Seconds(const DateType *pd)
+{
+    unsigned long long udays = 0;
+    unsigned u;
+
+    for (u = 0; u < pd->year; u++)
+    {
+        udays += (u % 4) ? 365 : 366;
+    }
+
+    for (u = 1; u < pd->month; u++)
+    {
+        udays += Ref_Days_Of_Month(pd->year, u);
+    }
+
+    udays += pd->day - 1;
+
+    return ((udays * 24 + pd->hours) * 60 + pd->minutes) * 60 + pd->seconds;
+}
+
+/**
+ * Date of the seconds since 1.1.2000. */
+
+void Ref_Date(unsigned long long useconds, DateType *pd)
+{
+    unsigned long long udays = useconds / SECONDS_PER_DAY;
+
+    pd->seconds = (unsigned)(useconds % 60);
+    pd->minutes = (unsigned)(useconds / 60 % 60);
+    pd->hours = (unsigned)(useconds / 3600 % 24);
+
+    /* 1.1.2000 has been a Saturday. */
+
+    pd->weekday = (unsigned)((udays + 6) % 7);
+
+    for (pd->year = 0; udays >= ((pd->year % 4) ? 365U : 366U); pd->year++)
+    {
+        udays -= (pd->year % 4) ? 365 : 366;
+    }
+
+    for (pd->month = 1; udays >= Ref_Days_Of_Month(pd->year, pd->month);
+         pd->month++)
+    {
+        udays -= Ref_Days_Of_Month(pd->year, pd->month);
+    }
+
+    pd->day = (unsigned)udays + 1;
+}
+
+/**
+ * Date held by RTCC value bytes, ordered like the snapshot. */
+
+void Ref_Rtc_Date(const unsigned char *prtc, DateType *pd)
+{
+    pd->year = Sim_Bcd(prtc[SIM_RTC_YEAR]);
+    pd->month = Sim_Bcd(prtc[SIM_RTC_MONTH]);
+    pd->day = Sim_Bcd(prtc[SIM_RTC_DAY]);
+    pd->weekday = Sim_Bcd(prtc[SIM_RTC_WEEKDAY]);
+    pd->hours = Sim_Bcd(prtc[SIM_RTC_HOURS]);
+    pd->minutes = Sim_Bcd(prtc[SIM_RTC_MINUTES]);
+    pd->seconds = Sim_Bcd(prtc[SIM_RTC_SECONDS]);
+}
+
+void Ref_Print(char *ptext, size_t usize, const DateType *pd)
+{
+    snprintf(ptext, usize, "%02u.%02u.%02u %02u:%02u:%02u", pd->day,
+             pd->month, pd->year % 100, pd->hours, pd->minutes, pd->seconds);
+}
@@ -0,0 +1,37 @@
+/**
+ * Reference calendar of the host tests.
+ *
+ * It counts the days year by year and month by month instead of the way
+ * of the firmware and the harness. Like the RTCC, it takes every fourth
+ * year as a leap year and carries the weekday on into the next century.
+ */
+
+#ifndef REFERENCE_H
+#define REFERENCE_H
+
+#include <stddef.h>
+
+#define SECONDS_PER_DAY     86400ULL
+
+/**
+ * Date and time of the reference calendar. */
+
+typedef struct
+{
+    unsigned year;              // 0 for 2000, 100 for the century after
+    unsigned month;
+    unsigned day;
+    unsigned weekday;           // 0 Sunday
+    unsigned hours;
+    unsigned minutes;
+    unsigned seconds;
+
+} DateType;
+
+unsigned Ref_Days_Of_Month(unsigned uyear, unsigned umonth);
+unsigned long long Ref_Seconds(const DateType *pd);
+void Ref_Date(unsigned long long useconds, DateType *pd);
+void Ref_Rtc_Date(const unsigned char *prtc, DateType *pd);
+void Ref_Print(char *ptext, size_t usize, const DateType *pd);
+
+#endif // #ifndef REFERENCE_H
@@ -0,0 +1,655 @@
+/**
+ * Accelerated run of the RTCC handling of the firmware on the host harness.
+ *
+ * The harness models the RTCC with its pointer auto-decrement, the RTCSYNC
+ * window and the alarm matching. The RTC is reset to an invalid date and
+ * configured by Configure_Real_Time_Clock(), then runs from 1.1.2000 day
+ * by day through the century. Each day, the time is moved to a random
+ * moment and to right before midnight, from where the frames follow the
+ * rollover. A frame runs Display_Digits() in a random display state, which
+ * reads the RTCC snapshot, some frames also forward the day and the month
+ * by Edit_Field(). Every frame is checked against the reference calendar:
+ *
+ *   - the snapshot is the RTC before or after the read, not torn apart
+ *   - the snapshot holds the valid date, time and weekday of that second
+ *   - the values and dots shown match the date and time, 12h or 24h
+ *   - Days_Of_Month() and Day_Number() match the reference
+ *   - the day and month edited turn around and are clamped right
+ *   - no access to the RTCC against its rules, see sim.c
+ *
+ * The reads start at random phases of the second, many of them within the
+ * RTCSYNC window, and take up to milliseconds per register access, so a
+ * rollover while reading occurs often. On builds with the alarm schedule,
+ * random schedules run for two weeks each, their alarms have to be due at
+ * the seconds of the reference and nowhere else.
+ *
+ * The basic blocks the firmware runs per frame and per edit are printed,
+ * to compare the BCD native arithmetic with the tables, see 'make bcd'.
+ *
+ *   rtcc [-y years] [-s seed] [-v]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "main.h"
+#include "reference.h"
+#include "sim.h"
+
+#define DAYS_PER_CENTURY    36525ULL
+#define ALARM_RUNS          24
+#define ALARM_DAYS          14
+#define FAILURES_MAX        20
+
+extern RtccSnapshotType g_rtcc;
+extern RtccSnapshotType g_rtccRead;
+extern RtccSnapshotType g_rtccStage;
+extern unsigned short g_uRtccStaged;
+extern DisplayStateType g_uDispState;
+extern unsigned char g_ucMplexDigits;
+extern unsigned char g_ucLeftVal;
+extern unsigned char g_ucRightVal;
+extern unsigned char g_ucDots;
+
+#if APP_DISPLAY_DIMMING_USAGE==1
+
+extern unsigned char g_ucDimmingCnt;
+extern unsigned char g_ucDimmingRef;
+
+#endif
+
+#if APP_ALARM_SCHEDULE_USAGE==1
+
+extern AlarmEntryType g_alarms[ALARM_SCHEDULE_SIZE];
+extern unsigned char g_ucAlarmsDue;
+
+#endif
+
+#if APP_DRIFT_LEARNING_USAGE==1
+
+unsigned short Day_Number(void);
+
+#endif
+
+void Configure_Real_Time_Clock(void);
+void Display_Digits(void);
+
+#if (APP_WATCH_TYPE_BUILD==APP_PULSAR_WRIST_WATCH_12H_LEGACY_MOD) || \
+    (APP_WATCH_TYPE_BUILD==APP_PULSAR_P3_WRIST_WATCH_12H_ODIN_MARK_II_MOD) || \
+    (APP_WATCH_TYPE_BUILD==APP_PULSAR_WRIST_WATCH_12H_SIF_LEGACY_MOD) || \
+    (APP_WATCH_TYPE_BUILD==APP_PULSAR_P4_WRIST_WATCH_12H_SIF_MARK_II_MOD)
+
+  #define WATCH_12H             1
+
+#else
+
+  #define WATCH_12H             0
+
+#endif
+
+#define RTCCFG_RTCEN            0x80
+#define RTCCFG_RTCWREN          0x20
+#define PIR3_RTCCIF             0x01
+
+static unsigned long long s_rng;
+static unsigned long s_failures;
+static unsigned long s_frames;
+static unsigned long s_edits;
+static unsigned long long s_frameBlocks;
+static unsigned long long s_editBlocks;
+static int s_iVerbose;
+
+static unsigned long Random(unsigned long urange)
+{
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 7;
+    s_rng ^= s_rng << 17;
+
+    return (unsigned long)(s_rng % urange);
+}
+
+static void Fail(const char *pwhat, const DateType *pd, unsigned uexpect,
+                 unsigned ugot)
+{
+    char sdate[32];
+
+    if (++s_failures <= FAILURES_MAX)
+    {
+        Ref_Print(sdate, sizeof(sdate), pd);
+        printf("%s: %s expected %u, got %u\n", sdate, pwhat, uexpect, ugot);
+    }
+}
+
+static void Check(const char *pwhat, const DateType *pd, unsigned uexpect,
+                  unsigned ugot)
+{
+    if (uexpect != ugot)
+    {
+        Fail(pwhat, pd, uexpect, ugot);
+    }
+}
+
+/**
+ * Value as shown on the display, packed BCD with the BCD-native
+ * arithmetic, decimal otherwise. */
+
+static unsigned Shown(unsigned char uvalue)
+{
+  #if APP_BCD_NATIVE_ARITHMETIC==1
+
+    return Sim_Bcd(uvalue);
+
+  #else
+
+    return uvalue;
+
+  #endif
+}
+
+/**
+ * Seconds since 1.1.2000 of a snapshot, in the century of the day
+ * being run. */
+
+static unsigned long long Snapshot_Seconds(const unsigned char *psnap,
+                                           unsigned long long uday)
+{
+    DateType date;
+    unsigned long long useconds;
+
+    Ref_Rtc_Date(psnap, &date);
+
+    useconds = Ref_Seconds(&date);
+
+    if (useconds / SECONDS_PER_DAY + DAYS_PER_CENTURY / 2 < uday)
+    {
+        useconds += DAYS_PER_CENTURY * SECONDS_PER_DAY;
+    }
+
+    return useconds;
+}
+
+/**
+ * The snapshot has to hold a valid date of the reference calendar. */
+
+static int Check_Snapshot(const unsigned char *psnap, unsigned long long uday,
+                          DateType *pref)
+{
+    DateType date;
+
+    Ref_Rtc_Date(psnap, &date);
+
+    if ((date.month < 1) || (date.month > 12) || (date.day < 1) ||
+        (date.day > Ref_Days_Of_Month(date.year, date.month)) ||
+        (date.hours > 23) || (date.minutes > 59) || (date.seconds > 59))
+    {
+        Fail("valid date, day", &date, 1, 0);
+        return 0;
+    }
+
+    Ref_Date(Snapshot_Seconds(psnap, uday), pref);
+
+    Check("weekday", pref, pref->weekday, date.weekday);
+
+    return 1;
+}
+
+/**
+ * Forward the day and then the month of the snapshot as a set mode does,
+ * the edits are dropped afterwards. On a 12h display, forwarding the day
+ * toggles between AM and PM first. */
+
+static void Check_Edits(unsigned long long uday)
+{
+    unsigned long ublocks = g_sim.blocks;
+    DateType ref;
+    unsigned uexpect;
+
+    g_uDispState = DISP_STATE_SET_DAY;
+    Edit_Field(FIELD_INDEX_DAY, 1);
+
+    s_editBlocks += g_sim.blocks - ublocks;
+    s_edits++;
+
+    if (Check_Snapshot((const unsigned char *)&g_rtccRead, uday, &ref))
+    {
+        uexpect = ref.day % Ref_Days_Of_Month(ref.year, ref.month) + 1;
+
+      #if WATCH_12H==1
+
+        if (ref.hours < 12)
+        {
+            uexpect = ref.day;
+        }
+
+        Check("hours toggled", &ref, (ref.hours + 12) % 24,
+              Sim_Bcd(g_rtccStage.hours));
+
+      #endif
+
+        Check("days of month", &ref, Ref_Days_Of_Month(ref.year, ref.month),
+              Shown(Days_Of_Month()));
+        Check("day forwarded", &ref, uexpect, Sim_Bcd(g_rtccStage.day));
+
+        g_uDispState = DISP_STATE_SET_MONTH;
+        Edit_Field(FIELD_INDEX_MONTH, 1);
+
+        ref.month = ref.month % 12 + 1;
+
+        if (uexpect > Ref_Days_Of_Month(ref.year, ref.month))
+        {
+            uexpect = Ref_Days_Of_Month(ref.year, ref.month);
+        }
+
+        Check("month forwarded", &ref, ref.month, Sim_Bcd(g_rtccStage.month));
+        Check("day clamped", &ref, uexpect, Sim_Bcd(g_rtcc.day));
+    }
+
+    g_uRtccStaged = 0;
+}
+
+/**
+ * One frame of the display in a random state. */
+
+static void Frame(unsigned long long uday)
+{
+    static const DisplayStateType s_states[] =
+    {
+        DISP_STATE_TIME, DISP_STATE_SECONDS, DISP_STATE_DATE,
+        DISP_STATE_YEAR, DISP_STATE_WEEKDAY
+    };
+
+    const DisplayStateType ustate = s_states[Random(sizeof(s_states))];
+    unsigned long ublocks;
+    unsigned char upre[8];
+    unsigned char upost[8];
+    DateType ref;
+
+    /* Most of the time within the RTCSYNC window and slow. */
+
+    if (Random(2))
+    {
+        g_sim.prescaler = 32768 - 1 - (long)Random(48);
+    }
+
+    g_sim.cycles_per_access = Random(2) ? 4 : 4 + (unsigned)Random(4000);
+
+    memcpy(upre, g_sim.rtc, sizeof(upre));
+
+    g_uDispState = ustate;
+    g_ucMplexDigits = 0;
+
+  #if APP_DISPLAY_DIMMING_USAGE==1
+
+    g_ucDimmingCnt = 1;
+    g_ucDimmingRef = 0;
+
+  #endif
+
+    ublocks = g_sim.blocks;
+
+    Display_Digits();
+
+    s_frameBlocks += g_sim.blocks - ublocks;
+
+    memcpy(upost, g_sim.rtc, sizeof(upost));
+    g_sim.cycles_per_access = 4;
+    s_frames++;
+
+    if (!Check_Snapshot((const unsigned char *)&g_rtcc, uday, &ref))
+    {
+        return;
+    }
+
+    if (memcmp(&g_rtcc, upre, 7) && memcmp(&g_rtcc, upost, 7))
+    {
+        Fail("snapshot of the RTC, torn", &ref, 0, 1);
+    }
+
+    switch (ustate)
+    {
+        case DISP_STATE_TIME:
+
+          #if WATCH_12H==1
+
+            Check("hours shown", &ref, (ref.hours % 12) ? ref.hours % 12 : 12,
+                  Shown(g_ucLeftVal));
+            Check("dots shown", &ref, 3, g_ucDots);
+
+          #else
+
+            Check("hours shown", &ref, ref.hours, Shown(g_ucLeftVal));
+
+          #endif
+
+            Check("minutes shown", &ref, ref.minutes, Shown(g_ucRightVal));
+        break;
+
+        case DISP_STATE_SECONDS:
+            Check("seconds shown", &ref, ref.seconds, Shown(g_ucRightVal));
+        break;
+
+        case DISP_STATE_DATE:
+            Check("month shown", &ref, ref.month, Shown(g_ucLeftVal));
+            Check("day shown", &ref, ref.day, Shown(g_ucRightVal));
+
+          #if WATCH_12H==1
+
+            Check("AM/PM dot shown", &ref, (ref.hours < 12) ? 1 : 2, g_ucDots);
+
+          #endif
+        break;
+
+        case DISP_STATE_YEAR:
+            Check("year shown", &ref, ref.year % 100, Shown(g_ucRightVal));
+        break;
+
+        default:
+            Check("weekday shown", &ref, ref.weekday, g_ucRightVal);
+        break;
+    }
+
+    Check("days of month", &ref, Ref_Days_Of_Month(ref.year, ref.month),
+          Shown(Days_Of_Month()));
+
+  #if APP_DRIFT_LEARNING_USAGE==1
+
+    Check("day number", &ref,
+          (unsigned)(Ref_Seconds(&ref) / SECONDS_PER_DAY % DAYS_PER_CENTURY) + 1,
+          Day_Number());
+
+  #endif
+
+    /* Not right before midnight, the day edited would roll over. */
+
+    if ((!Random(4)) &&
+        ((ref.hours != 23) || (ref.minutes != 59) || (ref.seconds != 59)))
+    {
+        Check_Edits(uday);
+    }
+}
+
+/**
+ * Move the RTC to a time of the day, keeping the date. */
+
+static void Set_Time(unsigned uhours, unsigned uminutes, unsigned useconds)
+{
+    g_sim.rtc[SIM_RTC_HOURS] = Sim_To_Bcd(uhours);
+    g_sim.rtc[SIM_RTC_MINUTES] = Sim_To_Bcd(uminutes);
+    g_sim.rtc[SIM_RTC_SECONDS] = Sim_To_Bcd(useconds);
+    g_sim.prescaler = (long)Random(32768);
+}
+
+/**
+ * An invalid RTC gets the default date, with the weekday of that date. */
+
+static void Check_Configure(void)
+{
+    DateType ref;
+
+    Sim_Reset();
+    memset(g_sim.rtc, 0, sizeof(g_sim.rtc));
+
+    Configure_Real_Time_Clock();
+
+    ref.year = 25;
+    ref.month = 1;
+    ref.day = 1;
+    ref.hours = WATCH_12H ? 0 : 12;
+    ref.minutes = 0;
+    ref.seconds = 0;
+
+    Ref_Date(Ref_Seconds(&ref), &ref);
+
+    Check("default year", &ref, ref.year, Sim_Bcd(g_sim.rtc[SIM_RTC_YEAR]));
+    Check("default month", &ref, ref.month, Sim_Bcd(g_sim.rtc[SIM_RTC_MONTH]));
+    Check("default day", &ref, ref.day, Sim_Bcd(g_sim.rtc[SIM_RTC_DAY]));
+    Check("default weekday", &ref, ref.weekday, Sim_Bcd(g_sim.rtc[SIM_RTC_WEEKDAY]));
+    Check("default hours", &ref, ref.hours, Sim_Bcd(g_sim.rtc[SIM_RTC_HOURS]));
+    Check("RTC enabled", &ref, RTCCFG_RTCEN, RTCCFG & RTCCFG_RTCEN);
+    Check("RTC locked", &ref, 0, RTCCFG & RTCCFG_RTCWREN);
+}
+
+/**
+ * Run the days of the century from 1.1.2000 on. */
+
+static void Run_Days(unsigned long long udays)
+{
+    unsigned long long uday;
+    DateType ref;
+    DateType rtc;
+
+    /* Let the configuration find the RTC valid. */
+
+    Ref_Date(0, &ref);
+    Sim_Set_Rtc(ref.year, ref.month, ref.day, ref.weekday, 0, 0, 0);
+    Configure_Real_Time_Clock();
+
+    for (uday = 0; uday < udays; uday++)
+    {
+        Ref_Date(uday * SECONDS_PER_DAY, &ref);
+
+        Set_Time((unsigned)Random(24), (unsigned)Random(60), (unsigned)Random(60));
+        Frame(uday);
+
+        /* Follow the rollover at midnight. */
+
+        Set_Time(23, 59, 57 + (unsigned)Random(3));
+
+        while (g_sim.rtc[SIM_RTC_HOURS] == 0x23)
+        {
+            Frame(uday);
+            Sim_Advance(Random(1500) * SIM_NS_PER_MS);
+        }
+
+        Frame(uday + 1);
+
+        Ref_Date((uday + 1) * SECONDS_PER_DAY, &ref);
+
+        Ref_Rtc_Date(g_sim.rtc, &rtc);
+
+        Check("day after midnight", &ref, ref.day, rtc.day);
+        Check("month after midnight", &ref, ref.month, rtc.month);
+        Check("year after midnight", &ref, ref.year % 100, rtc.year);
+        Check("weekday after midnight", &ref, ref.weekday, rtc.weekday);
+
+        if ((s_iVerbose) && (ref.month == 1) && (ref.day == 1))
+        {
+            printf("year %u: %lu frames, %lu failures\n", 2000 + ref.year,
+                   s_frames, s_failures);
+        }
+    }
+}
+
+#if APP_ALARM_SCHEDULE_USAGE==1
+
+/**
+ * Random schedule: the daily alarm, the countdown, the chime and a spare
+ * entry, each enabled by chance. */
+
+static void Random_Schedule(void)
+{
+    unsigned i;
+
+    for (i = 0; i < ALARM_SCHEDULE_SIZE; i++)
+    {
+        AlarmEntryType *pa = &g_alarms[i];
+
+        pa->hours = Sim_To_Bcd((unsigned)Random(24));
+        pa->minutes = Sim_To_Bcd((unsigned)Random(60));
+        pa->seconds = Random(2) ? 0 : Sim_To_Bcd((unsigned)Random(60));
+        pa->weekdays = (unsigned char)(Random(2) ? ALARM_WEEKDAYS_ALL :
+                                       1 + Random(ALARM_WEEKDAYS_ALL));
+        pa->flags = Random(3) ? ALARM_FLAG_ENABLED : 0;
+
+        if (i == ALARM_ENTRY_COUNTDOWN)
+        {
+            pa->flags |= ALARM_FLAG_ONE_SHOT;
+        }
+
+        if (i == ALARM_ENTRY_CHIME)
+        {
+            pa->flags |= ALARM_FLAG_HOURLY | ALARM_FLAG_CHIME;
+            pa->seconds = 0;
+        }
+    }
+}
+
+/**
+ * Mask of the entries due at a second of the reference calendar. */
+
+static unsigned char Due_Entries(const DateType *pd, const unsigned char *pflags)
+{
+    unsigned char ucDue = 0;
+    unsigned i;
+
+    for (i = 0; i < ALARM_SCHEDULE_SIZE; i++)
+    {
+        const AlarmEntryType *pa = &g_alarms[i];
+
+        if ((!(pflags[i] & ALARM_FLAG_ENABLED)) ||
+            (!(pa->weekdays & (1 << pd->weekday))) ||
+            (Sim_Bcd(pa->minutes) != pd->minutes) ||
+            (Sim_Bcd(pa->seconds) != pd->seconds))
+        {
+            continue;
+        }
+
+        if ((pflags[i] & ALARM_FLAG_HOURLY) || (Sim_Bcd(pa->hours) == pd->hours))
+        {
+            ucDue |= (unsigned char)(1 << i);
+        }
+    }
+
+    return ucDue;
+}
+
+/**
+ * Run random schedules, the RTCC alarm has to be due exactly when the
+ * reference finds an entry due. */
+
+static void Run_Alarms(void)
+{
+    unsigned urun;
+
+    for (urun = 0; urun < ALARM_RUNS; urun++)
+    {
+        unsigned long long ustart = Random(DAYS_PER_CENTURY - ALARM_DAYS) *
+                                    SECONDS_PER_DAY + Random(SECONDS_PER_DAY);
+        unsigned long long u;
+        uint64_t t;
+        unsigned char uflags[ALARM_SCHEDULE_SIZE];
+        unsigned long ualarms = 0;
+        DateType ref;
+        unsigned i;
+
+        Ref_Date(ustart, &ref);
+        Sim_Set_Rtc(ref.year, ref.month, ref.day, ref.weekday, ref.hours,
+                    ref.minutes, ref.seconds);
+        g_sim.prescaler = (long)Random(32768);
+
+        Random_Schedule();
+
+        for (i = 0; i < ALARM_SCHEDULE_SIZE; i++)
+        {
+            uflags[i] = g_alarms[i].flags;
+        }
+
+        t = g_sim.now;
+
+        Schedule_Next_Alarm();
+
+        for (u = ustart + 1; u <= ustart + ALARM_DAYS * SECONDS_PER_DAY; u++)
+        {
+            unsigned char ucExpect;
+            unsigned char ucGot = 0;
+
+            /* Step by whole seconds, the time the firmware took included. */
+
+            t += SIM_NS_PER_SECOND;
+            Sim_Advance(t - g_sim.now);
+            Ref_Date(u, &ref);
+
+            ucExpect = Due_Entries(&ref, uflags);
+
+            if (PIR3 & PIR3_RTCCIF)
+            {
+                PIR3 &= ~PIR3_RTCCIF;
+                ucGot = g_ucAlarmsDue;
+                ualarms++;
+
+                Handle_Alarm_Due();
+            }
+
+            Check("alarm entries due", &ref, ucExpect, ucGot);
+
+            for (i = 0; i < ALARM_SCHEDULE_SIZE; i++)
+            {
+                if ((ucExpect & (1 << i)) && (uflags[i] & ALARM_FLAG_ONE_SHOT))
+                {
+                    uflags[i] &= ~ALARM_FLAG_ENABLED;
+                }
+            }
+        }
+
+        if (s_iVerbose)
+        {
+            printf("schedule %u: %lu alarms\n", urun, ualarms);
+        }
+    }
+}
+
+#endif // #if APP_ALARM_SCHEDULE_USAGE==1
+
+int main(int argc, char **argv)
+{
+    unsigned long uyears = 100;
+    unsigned long long useed = 1;
+    int i;
+
+    for (i = 1; i < argc; i++)
+    {
+        if ((!strcmp(argv[i], "-y")) && (i + 1 < argc))
+        {
+            uyears = strtoul(argv[++i], NULL, 0);
+        }
+        else if ((!strcmp(argv[i], "-s")) && (i + 1 < argc))
+        {
+            useed = strtoull(argv[++i], NULL, 0);
+        }
+        else if (!strcmp(argv[i], "-v"))
+        {
+            s_iVerbose = 1;
+        }
+        else
+        {
+            fprintf(stderr, "usage: rtcc [-y years] [-s seed] [-v]\n");
+            return 2;
+        }
+    }
+
+    s_rng = useed * 0x9E3779B97F4A7C15ULL | 1;
+
+    Check_Configure();
+
+    Run_Days(uyears * DAYS_PER_CENTURY / 100);
+
+  #if APP_ALARM_SCHEDULE_USAGE==1
+
+    Run_Alarms();
+
+  #endif
+
+    if (g_sim.violations)
+    {
+        s_failures++;
+        printf("%s\n", g_sim.violation);
+    }
+
+    printf("rtcc: %lu frames, %lu failures, %.1f blocks per frame, "
+           "%.1f per edit\n", s_frames, s_failures,
+           s_frames ? (double)s_frameBlocks / s_frames : 0.0,
+           s_edits ? (double)s_editBlocks / s_edits : 0.0);
+
+    return s_failures ? 1 : 0;
+}
@@ -0,0 +1,4 @@
+/**
+ * Host stand-in for the legacy device header, see xc.h. */
+
+#include <xc.h>
@@ -0,0 +1,44 @@
+#!/bin/sh
+#
+# Copy the firmware for a host build of one watch variant.
+#
+#   prepare.sh <firmware dir> <variant> <output dir> [FLAG=VALUE ...]
+#
+# The watch type is selected in main.h, feature flags given are forced in
+# every variant block. Plain register stores in main.c with a side effect
+# beyond the value stored (pointer auto-decrement, timer buffers, unlock
+# sequence, write protection) become calls of Sim_Write(), as a byte in
+# memory can not tell a store from a load. A bit field named like its
+# register, e.g. PR4bits.PR4, becomes the register. XC8 has a 32 bit long,
+# which becomes int, so the arithmetic wraps the same way on the host.
+
+set -e
+
+src=$1
+variant=$2
+out=$3
+shift 3
+
+mkdir -p "$out"
+
+flags=""
+
+for f in "$@"
+do
+    name=${f%%=*}
+    value=${f#*=}
+    flags="$flags -e s/^([[:space:]]*#define[[:space:]]+$name[[:space:]]+)[0-9]+/\\1$value/"
+done
+
+sed -E -e 's/\blong\b/int/g' \
+    -e "s/^(#define[[:space:]]+APP_WATCH_TYPE_BUILD[[:space:]]+).*/\\1$variant/" \
+    $flags "$src/main.h" > "$out/main.h.tmp"
+mv "$out/main.h.tmp" "$out/main.h"
+
+regs='TMR0L|TMR0H|TMR1L|TMR1H|TMR2|TMR3L|TMR3H|TMR4|RTCVALL|RTCVALH|ALRMVALL|ALRMVALH|EECON2|RTCCAL|ALRMRPT'
+
+sed -E -e 's/\blong\b/int/g' \
+    -e 's/\b([A-Z0-9]+)bits\.\1\b/\1/g' \
+    -e "s/^([[:space:]]*)($regs)[[:space:]]*=[[:space:]]*([^=;][^;]*);/\\1Sim_Write(SIM_\\2, (\\3));/" \
+    "$src/main.c" > "$out/main.c.tmp"
+mv "$out/main.c.tmp" "$out/main.c"
@@ -0,0 +1,1415 @@
+/**
+ * Host harness of the watch firmware, the peripheral models. See sim.h.
+ */
+
+#include <math.h>
+#include <setjmp.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <xc.h>
+
+#include "sim.h"
+
+/**
+ * Bits of the registers, as far as the models need them. */
+
+#define RTCCFG_RTCEN    0x80
+#define RTCCFG_RTCWREN  0x20
+#define RTCCFG_RTCSYNC  0x10
+#define RTCCFG_HALFSEC  0x08
+#define RTCCFG_PTR      0x03
+
+#define ALRMCFG_ALRMEN  0x80
+#define ALRMCFG_CHIME   0x40
+#define ALRMCFG_PTR     0x03
+
+#define INTCON_GIEH     0x80
+#define INTCON_PEIE     0x40
+#define INTCON_TMR0IE   0x20
+#define INTCON_INT0IE   0x10
+#define INTCON_TMR0IF   0x04
+#define INTCON_INT0IF   0x02
+#define INTCON2_TMR0IP  0x04
+#define INTCON2_INT3IP  0x02
+#define RCON_IPEN       0x80
+
+#define PIR1_TMR1IF     0x01
+#define PIR1_TMR2IF     0x02
+#define PIR1_ADIF       0x40
+#define PIR2_TMR3IF     0x02
+#define PIR3_RTCCIF     0x01
+#define PIR3_TMR4IF     0x08
+
+#define T0CON_TMR0ON    0x80
+#define T0CON_T08BIT    0x40
+#define T0CON_PSA       0x08
+
+#define T1CON_TMR1ON    0x01
+#define T1CON_RD16      0x02
+
+#define T2CON_TMR2ON    0x04
+
+#define ADCON0_ADON     0x01
+#define ADCON0_GODONE   0x02
+
+#define RTC_TICKS       32768L  // Crystal ticks per second
+#define RTC_SYNC_TICKS  32      // RTCSYNC is set ahead of a rollover
+#define ADC_NS          20000   // Acquisition and conversion
+
+volatile unsigned char g_simSfr[SIM_SFR_COUNT];
+SimType g_sim;
+
+static jmp_buf s_jmpEnd;
+static int s_iRunning;
+static SimRegType s_uLast = SIM_SFR_COUNT;
+static unsigned char s_ucLastValue;
+static uint64_t s_uWoke;
+static int s_iTrace;
+
+/**
+ * Remappable pins RP0..RP18 of the PIC18F24J11 (28 pin). */
+
+static const signed char s_rp[19][2] =
+{
+    { SIM_PORT_A, 0 }, { SIM_PORT_A, 1 }, { SIM_PORT_A, 5 },
+    { SIM_PORT_B, 0 }, { SIM_PORT_B, 1 }, { SIM_PORT_B, 2 },
+    { SIM_PORT_B, 3 }, { SIM_PORT_B, 4 }, { SIM_PORT_B, 5 },
+    { SIM_PORT_B, 6 }, { SIM_PORT_B, 7 }, { SIM_PORT_C, 0 },
+    { SIM_PORT_C, 1 }, { SIM_PORT_C, 2 }, { -1, 0 }, { -1, 0 },
+    { -1, 0 },         { SIM_PORT_C, 6 }, { SIM_PORT_C, 7 },
+};
+
+static const unsigned short s_daysBeforeMonth[13] =
+{
+    0, 0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334
+};
+
+static const unsigned char s_daysOfMonth[13] =
+{
+    0, 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31
+};
+
+#define SFR(r)          g_simSfr[SIM_##r]
+
+/**
+ * Interrupt routine of the firmware, if it has one. */
+
+void High_Priority_Isr(void) __attribute__((weak));
+
+/**
+ * Trace of the sleeps, the RTC and the violations to stderr, enabled by
+ * the environment variable SIM_TRACE. */
+
+static void Sim_Trace(const char *pformat, ...)
+{
+    va_list args;
+
+    if (!s_iTrace)
+    {
+        return;
+    }
+
+    fprintf(stderr, "%10.4fs %02x:%02x:%02x ", g_sim.now / 1e9,
+            g_sim.rtc[SIM_RTC_HOURS], g_sim.rtc[SIM_RTC_MINUTES],
+            g_sim.rtc[SIM_RTC_SECONDS]);
+
+    va_start(args, pformat);
+    vfprintf(stderr, pformat, args);
+    va_end(args);
+
+    fputc('\n', stderr);
+}
+
+unsigned Sim_Bcd(unsigned char ubcd)
+{
+    return (ubcd >> 4) * 10 + (ubcd & 0x0F);
+}
+
+unsigned char Sim_To_Bcd(unsigned uvalue)
+{
+    return (unsigned char)(((uvalue / 10) << 4) | (uvalue % 10));
+}
+
+static void Sim_Violation(const char *pformat, ...)
+{
+    va_list args;
+
+    if (s_iTrace)
+    {
+        va_start(args, pformat);
+        fprintf(stderr, "%10.4fs violation: ", g_sim.now / 1e9);
+        vfprintf(stderr, pformat, args);
+        fputc('\n', stderr);
+        va_end(args);
+    }
+
+    if (!g_sim.violations++)
+    {
+        int ilen = snprintf(g_sim.violation, sizeof(g_sim.violation),
+                            "%.3fs: ", g_sim.now / 1e9);
+
+        va_start(args, pformat);
+        vsnprintf(g_sim.violation + ilen, sizeof(g_sim.violation) - ilen,
+                  pformat, args);
+        va_end(args);
+    }
+}
+
+void Sim_Fail(const char *pformat, ...)
+{
+    va_list args;
+
+    if (!g_sim.fail[0])
+    {
+        int ilen = snprintf(g_sim.fail, sizeof(g_sim.fail), "%.3fs: ",
+                            g_sim.now / 1e9);
+
+        va_start(args, pformat);
+        vsnprintf(g_sim.fail + ilen, sizeof(g_sim.fail) - ilen, pformat, args);
+        va_end(args);
+    }
+
+    if (s_iRunning)
+    {
+        longjmp(s_jmpEnd, 2);
+    }
+}
+
+/**
+ * Called by the firmware, built with -fsanitize-coverage=trace-pc, on
+ * entering each basic block. Counts the code run besides the register
+ * accesses, e.g. to show a routine taking the same path every time. */
+
+void __sanitizer_cov_trace_pc(void)
+{
+    g_sim.blocks++;
+}
+
+/**
+ * Environment: clocks depending on the die temperature. */
+
+static void Sim_Env(void)
+{
+    double dt;
+
+    if (g_sim.hooks.temperature)
+    {
+        g_sim.temperature = g_sim.hooks.temperature(g_sim.now);
+    }
+
+    dt = g_sim.temperature - 25.0;
+
+    g_sim.instr_hz = 1e6 * (1.0 + 1e-6 * (g_sim.instr_offset_ppm +
+                                          g_sim.instr_ppm_per_degree * dt));
+
+    dt = g_sim.temperature - g_sim.xtal_turnover;
+
+    g_sim.xtal_hz = RTC_TICKS * (1.0 + 1e-6 * g_sim.xtal_offset_ppm -
+                                 1e-9 * g_sim.xtal_ppb_parabola * dt * dt);
+
+    g_sim.env_next = g_sim.now + SIM_NS_PER_SECOND;
+}
+
+void Sim_Reset(void)
+{
+    memset(&g_sim, 0, sizeof(g_sim));
+    memset((void *)g_simSfr, 0, sizeof(g_simSfr));
+
+    SFR(TRISA) = 0xFF;
+    SFR(TRISB) = 0xFF;
+    SFR(TRISC) = 0xFF;
+    SFR(PR2) = 0xFF;
+    SFR(PR4) = 0xFF;
+    SFR(IPR1) = 0xFF;
+    SFR(IPR2) = 0xFF;
+    SFR(IPR3) = 0xFF;
+
+    g_sim.instr_ppm_per_degree = -160.0;
+    g_sim.xtal_ppb_parabola = 34.0;
+    g_sim.xtal_turnover = 25.0;
+    g_sim.temperature = 25.0;
+    g_sim.cycles_per_access = 4;
+    g_sim.awake = 1;
+    g_sim.rtc[SIM_RTC_DAY] = 0x01;
+    g_sim.rtc[SIM_RTC_MONTH] = 0x01;
+
+    s_uLast = SIM_SFR_COUNT;
+    s_uWoke = 0;
+    s_iTrace = getenv("SIM_TRACE") != NULL;
+
+    Sim_Env();
+}
+
+void Sim_Set_Rtc(unsigned uyear, unsigned umonth, unsigned uday,
+                 unsigned uweekday, unsigned uhours, unsigned uminutes,
+                 unsigned useconds)
+{
+    g_sim.rtc[SIM_RTC_SECONDS] = Sim_To_Bcd(useconds);
+    g_sim.rtc[SIM_RTC_MINUTES] = Sim_To_Bcd(uminutes);
+    g_sim.rtc[SIM_RTC_HOURS] = Sim_To_Bcd(uhours);
+    g_sim.rtc[SIM_RTC_WEEKDAY] = Sim_To_Bcd(uweekday);
+    g_sim.rtc[SIM_RTC_DAY] = Sim_To_Bcd(uday);
+    g_sim.rtc[SIM_RTC_MONTH] = Sim_To_Bcd(umonth);
+    g_sim.rtc[SIM_RTC_YEAR] = Sim_To_Bcd(uyear);
+    g_sim.prescaler = 0;
+}
+
+/**
+ * Seconds since 1.1.2000 of the RTC. */
+
+unsigned long long Sim_Rtc_Seconds(void)
+{
+    const unsigned uyear = Sim_Bcd(g_sim.rtc[SIM_RTC_YEAR]);
+    unsigned umonth = Sim_Bcd(g_sim.rtc[SIM_RTC_MONTH]);
+    unsigned long long udays;
+
+    if ((umonth < 1) || (umonth > 12))
+    {
+        umonth = 1;
+    }
+
+    udays = uyear * 365ULL + (uyear + 3) / 4 + s_daysBeforeMonth[umonth] +
+            Sim_Bcd(g_sim.rtc[SIM_RTC_DAY]) - 1;
+
+    if ((!(uyear & 3)) && (umonth > 2))
+    {
+        udays++;
+    }
+
+    return ((udays * 24 + Sim_Bcd(g_sim.rtc[SIM_RTC_HOURS])) * 60 +
+            Sim_Bcd(g_sim.rtc[SIM_RTC_MINUTES])) * 60 +
+           Sim_Bcd(g_sim.rtc[SIM_RTC_SECONDS]);
+}
+
+void Sim_Pin_Of(const char *pname, unsigned char *pport, unsigned char *pbit)
+{
+    if ((strlen(pname) != 3) || (pname[0] != 'R') ||
+        (pname[1] < 'A') || (pname[1] > 'C'))
+    {
+        fprintf(stderr, "sim: unknown pin %s\n", pname);
+        exit(2);
+    }
+
+    *pport = (unsigned char)(pname[1] - 'A');
+    *pbit = (unsigned char)(pname[2] - '0');
+}
+
+/**
+ * Alarm of the RTCC, checked each second. */
+
+static void Sim_Alarm(void)
+{
+    const unsigned char ucfg = SFR(ALRMCFG);
+    const unsigned char *pr = g_sim.rtc;
+    const unsigned char *pa = g_sim.alarm;
+    int imatch;
+
+    if (!(ucfg & ALRMCFG_ALRMEN))
+    {
+        return;
+    }
+
+    switch ((ucfg >> 2) & 0x0F)
+    {
+        case 0: // Every half second
+        case 1: // Every second
+            imatch = 1;
+        break;
+
+        case 2: // Every 10 seconds
+            imatch = (pr[0] & 0x0F) == (pa[0] & 0x0F);
+        break;
+
+        case 3: // Every minute
+            imatch = pr[0] == pa[0];
+        break;
+
+        case 4: // Every 10 minutes
+            imatch = (pr[0] == pa[0]) && ((pr[1] & 0x0F) == (pa[1] & 0x0F));
+        break;
+
+        case 5: // Every hour
+            imatch = (pr[0] == pa[0]) && (pr[1] == pa[1]);
+        break;
+
+        case 6: // Every day
+            imatch = (pr[0] == pa[0]) && (pr[1] == pa[1]) && (pr[2] == pa[2]);
+        break;
+
+        case 7: // Every week
+            imatch = (pr[0] == pa[0]) && (pr[1] == pa[1]) &&
+                     (pr[2] == pa[2]) && (pr[3] == pa[3]);
+        break;
+
+        case 8: // Every month
+            imatch = (pr[0] == pa[0]) && (pr[1] == pa[1]) &&
+                     (pr[2] == pa[2]) && (pr[4] == pa[4]);
+        break;
+
+        case 9: // Every year
+            imatch = (pr[0] == pa[0]) && (pr[1] == pa[1]) &&
+                     (pr[2] == pa[2]) && (pr[4] == pa[4]) && (pr[5] == pa[5]);
+        break;
+
+        default:
+            imatch = 0;
+        break;
+    }
+
+    if (!imatch)
+    {
+        return;
+    }
+
+    SFR(PIR3) |= PIR3_RTCCIF;
+    g_sim.alarms++;
+
+    if (SFR(ALRMRPT))
+    {
+        SFR(ALRMRPT)--;
+    }
+    else if (ucfg & ALRMCFG_CHIME)
+    {
+        SFR(ALRMRPT) = 0xFF;
+    }
+    else
+    {
+        SFR(ALRMCFG) &= ~ALRMCFG_ALRMEN;
+    }
+}
+
+/**
+ * One second of the RTC, carried through the BCD calendar. The
+ * calibration adds 4 ticks per step once a minute. */
+
+static void Sim_Rtc_Second(void)
+{
+    unsigned char *pr = g_sim.rtc;
+    unsigned uvalue = Sim_Bcd(pr[SIM_RTC_SECONDS]) + 1;
+
+    g_sim.rtc_seconds++;
+
+    if (uvalue < 60)
+    {
+        pr[SIM_RTC_SECONDS] = Sim_To_Bcd(uvalue);
+        Sim_Alarm();
+        return;
+    }
+
+    pr[SIM_RTC_SECONDS] = 0;
+
+    g_sim.prescaler += 4L * (signed char)SFR(RTCCAL);
+
+    uvalue = Sim_Bcd(pr[SIM_RTC_MINUTES]) + 1;
+
+    if (uvalue < 60)
+    {
+        pr[SIM_RTC_MINUTES] = Sim_To_Bcd(uvalue);
+    }
+    else
+    {
+        pr[SIM_RTC_MINUTES] = 0;
+
+        uvalue = Sim_Bcd(pr[SIM_RTC_HOURS]) + 1;
+
+        if (uvalue < 24)
+        {
+            pr[SIM_RTC_HOURS] = Sim_To_Bcd(uvalue);
+        }
+        else
+        {
+            const unsigned uyear = Sim_Bcd(pr[SIM_RTC_YEAR]);
+            const unsigned umonth = Sim_Bcd(pr[SIM_RTC_MONTH]);
+            unsigned udays = ((umonth >= 1) && (umonth <= 12)) ?
+                             s_daysOfMonth[umonth] : 31;
+
+            if ((umonth == 2) && (!(uyear & 3)))
+            {
+                udays = 29;
+            }
+
+            pr[SIM_RTC_HOURS] = 0;
+            pr[SIM_RTC_WEEKDAY] = (pr[SIM_RTC_WEEKDAY] >= 6) ?
+                                  0 : pr[SIM_RTC_WEEKDAY] + 1;
+
+            uvalue = Sim_Bcd(pr[SIM_RTC_DAY]) + 1;
+
+            if (uvalue <= udays)
+            {
+                pr[SIM_RTC_DAY] = Sim_To_Bcd(uvalue);
+            }
+            else
+            {
+                pr[SIM_RTC_DAY] = 1;
+
+                if (umonth < 12)
+                {
+                    pr[SIM_RTC_MONTH] = Sim_To_Bcd(umonth + 1);
+                }
+                else
+                {
+                    pr[SIM_RTC_MONTH] = 1;
+                    pr[SIM_RTC_YEAR] = Sim_To_Bcd((uyear + 1) % 100);
+                }
+            }
+        }
+    }
+
+    Sim_Alarm();
+}
+
+/**
+ * Ticks of the crystal, counted by timer 1 and the RTC. */
+
+static void Sim_Xtal(uint64_t uticks)
+{
+    const unsigned char ut1con = SFR(T1CON);
+
+    if ((ut1con & T1CON_TMR1ON) && (((ut1con >> 6) & 3) == 2))
+    {
+        const uint64_t usum = g_sim.tmr1 + (uticks >> ((ut1con >> 4) & 3));
+
+        if (usum > 0xFFFF)
+        {
+            SFR(PIR1) |= PIR1_TMR1IF;
+            g_sim.tmr1_overflows += usum >> 16;
+        }
+
+        g_sim.tmr1 = (unsigned short)usum;
+    }
+
+    if (SFR(RTCCFG) & RTCCFG_RTCEN)
+    {
+        g_sim.prescaler += (long)uticks;
+
+        while (g_sim.prescaler >= RTC_TICKS)
+        {
+            g_sim.prescaler -= RTC_TICKS;
+            Sim_Rtc_Second();
+        }
+    }
+}
+
+/**
+ * Advance a counter by cycles through a prescaler, returning the
+ * increments. */
+
+static unsigned long Sim_Prescale(unsigned long *ppre, unsigned long ucycles,
+                                  unsigned long uscale)
+{
+    *ppre += ucycles;
+
+    ucycles = *ppre / uscale;
+    *ppre %= uscale;
+
+    return ucycles;
+}
+
+/**
+ * Instruction cycles, counted by the timers 0, 2, 3 and 4. */
+
+static void Sim_Cpu(unsigned long ucycles)
+{
+    static const unsigned char s_t2scale[4] = { 1, 4, 16, 16 };
+
+    unsigned char ucon = SFR(T0CON);
+    unsigned long uinc;
+
+    if (ucon & T0CON_TMR0ON)
+    {
+        uinc = Sim_Prescale(&g_sim.tmr0_pre, ucycles,
+                            (ucon & T0CON_PSA) ? 1 : (2UL << (ucon & 7)));
+
+        if (ucon & T0CON_T08BIT)
+        {
+            uinc += g_sim.tmr0 & 0xFF;
+
+            if (uinc > 0xFF)
+            {
+                SFR(INTCON) |= INTCON_TMR0IF;
+            }
+
+            g_sim.tmr0 = (g_sim.tmr0 & 0xFF00) | (uinc & 0xFF);
+        }
+        else
+        {
+            uinc += g_sim.tmr0;
+
+            if (uinc > 0xFFFF)
+            {
+                SFR(INTCON) |= INTCON_TMR0IF;
+            }
+
+            g_sim.tmr0 = (unsigned short)uinc;
+        }
+    }
+
+    ucon = SFR(T2CON);
+
+    if (ucon & T2CON_TMR2ON)
+    {
+        const unsigned long uperiod = SFR(PR2) + 1UL;
+
+        uinc = Sim_Prescale(&g_sim.tmr2_pre, ucycles, s_t2scale[ucon & 3]);
+        uinc += g_sim.tmr2;
+
+        if (uinc >= uperiod)
+        {
+            SFR(PIR1) |= PIR1_TMR2IF;
+        }
+
+        g_sim.tmr2 = (unsigned char)(uinc % uperiod);
+    }
+
+    ucon = SFR(T3CON);
+
+    if (ucon & T1CON_TMR1ON)
+    {
+        /* TMR3CS 0: Fosc/4, 1: Fosc. */
+
+        const unsigned long uclock = (((ucon >> 6) & 3) == 1) ?
+                                     ucycles * 4 : ucycles;
+
+        uinc = Sim_Prescale(&g_sim.tmr3_pre, uclock, 1UL << ((ucon >> 4) & 3));
+        uinc += g_sim.tmr3;
+
+        if (uinc > 0xFFFF)
+        {
+            SFR(PIR2) |= PIR2_TMR3IF;
+        }
+
+        g_sim.tmr3 = (unsigned short)uinc;
+    }
+
+    ucon = SFR(T4CON);
+
+    if (ucon & T2CON_TMR2ON)
+    {
+        const unsigned long uperiod = SFR(PR4) + 1UL;
+
+        uinc = Sim_Prescale(&g_sim.tmr4_pre, ucycles, s_t2scale[ucon & 3]);
+        uinc += g_sim.tmr4;
+
+        if (uinc >= uperiod)
+        {
+            SFR(PIR3) |= PIR3_TMR4IF;
+        }
+
+        g_sim.tmr4 = (unsigned char)(uinc % uperiod);
+    }
+
+    if ((g_sim.adc_done) && (g_sim.now >= g_sim.adc_done))
+    {
+        const unsigned char uchannel = (SFR(ADCON0) >> 2) & 0x0F;
+
+        g_sim.adc_done = 0;
+        g_sim.adres = g_sim.hooks.adc ? g_sim.hooks.adc(uchannel) : 0;
+
+        SFR(ADCON0) &= ~ADCON0_GODONE;
+        SFR(PIR1) |= PIR1_ADIF;
+    }
+}
+
+/**
+ * Set an input pin, an edge on a pin mapped to INT0..INT3 sets its
+ * flag. */
+
+static void Sim_Pin(unsigned char uport, unsigned char ubit,
+                    unsigned char ulevel)
+{
+    static const unsigned char s_edge[4] = { 0x40, 0x20, 0x10, 0x08 };
+    static const unsigned char s_flag[4] = { INTCON_INT0IF, 0x01, 0x02, 0x04 };
+
+    const unsigned char umask = (unsigned char)(1 << ubit);
+    const unsigned char uold = g_sim.pins[uport] & umask;
+    unsigned char i;
+
+    if (ulevel)
+    {
+        g_sim.pins[uport] |= umask;
+    }
+    else
+    {
+        g_sim.pins[uport] &= ~umask;
+    }
+
+    if ((!uold) == (!ulevel))
+    {
+        return;
+    }
+
+    /* Idle time is counted from the release of the last button. */
+
+    if ((!ulevel) && (g_sim.buttons[uport] & umask))
+    {
+        g_sim.awake_since = g_sim.now;
+    }
+
+    for (i = 0; i < 4; i++)
+    {
+        signed char cport = SIM_PORT_B;
+        unsigned char upin = 0;
+
+        if (i)
+        {
+            const unsigned char urp = g_simSfr[SIM_RPINR1 + i - 1];
+
+            if (urp >= sizeof(s_rp) / sizeof(s_rp[0]))
+            {
+                continue;
+            }
+
+            cport = s_rp[urp][0];
+            upin = (unsigned char)s_rp[urp][1];
+        }
+
+        if ((cport != uport) || (upin != ubit))
+        {
+            continue;
+        }
+
+        /* INTEDGx set: rising edge. */
+
+        if ((!(SFR(INTCON2) & s_edge[i])) == (!ulevel))
+        {
+            if (i)
+            {
+                SFR(INTCON3) |= s_flag[i];
+            }
+            else
+            {
+                SFR(INTCON) |= s_flag[i];
+            }
+        }
+    }
+}
+
+void Sim_Input(uint64_t t, unsigned char uport, unsigned char ubit,
+               unsigned char ulevel)
+{
+    unsigned i = g_sim.events_cnt;
+
+    if (i >= SIM_EVENTS_MAX)
+    {
+        fprintf(stderr, "sim: too many events\n");
+        exit(2);
+    }
+
+    /* Keep the events sorted, stable for equal times. */
+
+    while ((i > g_sim.events_next) && (g_sim.events[i - 1].t > t))
+    {
+        g_sim.events[i] = g_sim.events[i - 1];
+        i--;
+    }
+
+    g_sim.events[i].t = t;
+    g_sim.events[i].port = uport;
+    g_sim.events[i].bit = ubit;
+    g_sim.events[i].level = ulevel;
+    g_sim.events_cnt++;
+}
+
+/**
+ * Let ns pass, of which the CPU has been running ucycles. */
+
+static void Sim_Pass(uint64_t ns, unsigned long ucycles)
+{
+    if (ns)
+    {
+        const double dticks = (double)ns * g_sim.xtal_hz / 1e9 + g_sim.xtal_frac;
+        const uint64_t uticks = (uint64_t)dticks;
+
+        g_sim.now += ns;
+        g_sim.xtal_frac = dticks - (double)uticks;
+
+        Sim_Xtal(uticks);
+    }
+
+    if (ucycles)
+    {
+        Sim_Cpu(ucycles);
+    }
+
+    while ((g_sim.events_next < g_sim.events_cnt) &&
+           (g_sim.events[g_sim.events_next].t <= g_sim.now))
+    {
+        const SimEventType *pe = &g_sim.events[g_sim.events_next++];
+
+        Sim_Trace("R%c%u %s", 'A' + pe->port, pe->bit, pe->level ? "high" : "low");
+        Sim_Pin(pe->port, pe->bit, pe->level);
+    }
+
+    if (g_sim.now >= g_sim.env_next)
+    {
+        Sim_Env();
+    }
+
+    if ((s_iRunning) && (g_sim.now >= g_sim.end))
+    {
+        longjmp(s_jmpEnd, 1);
+    }
+
+    if ((g_sim.awake) && (g_sim.awake_limit) &&
+        (g_sim.now - g_sim.awake_since > g_sim.awake_limit) &&
+        (!(g_sim.pins[0] & g_sim.buttons[0])) &&
+        (!(g_sim.pins[1] & g_sim.buttons[1])) &&
+        (!(g_sim.pins[2] & g_sim.buttons[2])))
+    {
+        Sim_Fail("awake for %.1fs without any input",
+                 (g_sim.now - g_sim.awake_since) / 1e9);
+    }
+}
+
+/**
+ * Call the interrupt routine, if a high priority interrupt is pending and
+ * GIEH set. With IPEN set INT0 is always high priority, the others by
+ * their priority bit. Without IPEN every interrupt is high priority, the
+ * peripheral ones enabled by PEIE. The routine runs with GIEH cleared,
+ * which RETFIE sets again. Low priority interrupts are not vectored, the
+ * firmware only has them wake it up. */
+
+static void Sim_Interrupt(void)
+{
+    const unsigned char uintcon = SFR(INTCON);
+    const unsigned char uintcon2 = SFR(INTCON2);
+    const unsigned char uintcon3 = SFR(INTCON3);
+
+    /* TMR0IE and INT0IE are three bits above their flags, INT1IE..INT3IE
+     * above INT1IF..INT3IF as well. */
+
+    unsigned char uint0 = uintcon & (uintcon >> 3) &
+                          (INTCON_TMR0IF | INTCON_INT0IF);
+    unsigned char uint3 = uintcon3 & (uintcon3 >> 3) & 0x07;
+    unsigned char uperipheral;
+
+    if ((!High_Priority_Isr) || (!(uintcon & INTCON_GIEH)))
+    {
+        return;
+    }
+
+    if (SFR(RCON) & RCON_IPEN)
+    {
+        /* INT1IP and INT2IP are bits 6 and 7 of INTCON3, INT3IP is bit 1
+         * of INTCON2. */
+
+        if (!(uintcon2 & INTCON2_TMR0IP))
+        {
+            uint0 &= ~INTCON_TMR0IF;
+        }
+
+        uint3 &= (uintcon3 >> 6) | ((uintcon2 & INTCON2_INT3IP) << 1);
+        uperipheral = (SFR(PIR1) & SFR(PIE1) & SFR(IPR1)) |
+                      (SFR(PIR2) & SFR(PIE2) & SFR(IPR2)) |
+                      (SFR(PIR3) & SFR(PIE3) & SFR(IPR3));
+    }
+    else
+    {
+        uperipheral = (uintcon & INTCON_PEIE) ?
+                      (SFR(PIR1) & SFR(PIE1)) | (SFR(PIR2) & SFR(PIE2)) |
+                      (SFR(PIR3) & SFR(PIE3)) : 0;
+    }
+
+    if ((!uint0) && (!uint3) && (!uperipheral))
+    {
+        return;
+    }
+
+    g_sim.interrupts++;
+
+    SFR(INTCON) &= ~INTCON_GIEH;
+    High_Priority_Isr();
+    Sim_Settle();
+    SFR(INTCON) |= INTCON_GIEH;
+}
+
+static void Sim_Step(void)
+{
+    const double dns = g_sim.cycles_per_access * 1e9 / g_sim.instr_hz +
+                       g_sim.cycle_frac;
+    const uint64_t ns = (uint64_t)dns;
+
+    g_sim.cycle_frac = dns - (double)ns;
+    g_sim.accesses++;
+
+    Sim_Pass(ns, g_sim.cycles_per_access);
+    Sim_Interrupt();
+}
+
+void Sim_Advance(uint64_t ns)
+{
+    Sim_Settle();
+
+    Sim_Pass(ns, (unsigned long)(ns * g_sim.instr_hz / 1e9));
+}
+
+/**
+ * Writes to RTCCFG: RTCWREN needs the unlock sequence right before,
+ * RTCEN needs RTCWREN. */
+
+static void Sim_Rtccfg(unsigned char uold, unsigned char unew)
+{
+    if ((unew & RTCCFG_RTCWREN) && (!(uold & RTCCFG_RTCWREN)))
+    {
+        if ((g_sim.unlock != 2) || (g_sim.accesses - g_sim.unlock_access > 2))
+        {
+            Sim_Violation("RTCWREN set without the unlock sequence");
+
+            unew &= ~RTCCFG_RTCWREN;
+        }
+
+        g_sim.unlock = 0;
+    }
+
+    if (((uold ^ unew) & RTCCFG_RTCEN) && (!(uold & RTCCFG_RTCWREN)))
+    {
+        Sim_Violation("RTCEN changed while RTCWREN is clear");
+
+        unew = (unew & ~RTCCFG_RTCEN) | (uold & RTCCFG_RTCEN);
+    }
+
+    /* The prescaler is held in reset while the RTC is disabled. */
+
+    if ((uold ^ unew) & RTCCFG_RTCEN)
+    {
+        Sim_Trace("RTC %s", (unew & RTCCFG_RTCEN) ? "started" : "stopped");
+    }
+
+    if ((uold & RTCCFG_RTCEN) && (!(unew & RTCCFG_RTCEN)))
+    {
+        g_sim.rtc_stopped = g_sim.now;
+        g_sim.prescaler = 0;
+    }
+
+    SFR(RTCCFG) = unew;
+
+    if ((!(uold & RTCCFG_RTCEN)) && (unew & RTCCFG_RTCEN) &&
+        (g_sim.hooks.rtc_start))
+    {
+        g_sim.hooks.rtc_start(g_sim.now - g_sim.rtc_stopped);
+    }
+}
+
+/**
+ * Complete the last access by a pointer: a changed value has been
+ * written, an access to RTCVALH or ALRMVALH decrements the pointer. */
+
+void Sim_Settle(void)
+{
+    const SimRegType ureg = s_uLast;
+    unsigned char uvalue;
+
+    if (ureg == SIM_SFR_COUNT)
+    {
+        return;
+    }
+
+    s_uLast = SIM_SFR_COUNT;
+    uvalue = g_simSfr[ureg];
+
+    switch (ureg)
+    {
+        case SIM_RTCCFG:
+            if (uvalue != s_ucLastValue)
+            {
+                Sim_Rtccfg(s_ucLastValue, uvalue);
+            }
+        break;
+
+        case SIM_RTCVALH:
+            if (SFR(RTCCFG) & RTCCFG_PTR)
+            {
+                SFR(RTCCFG)--;
+            }
+        break;
+
+        case SIM_ALRMVALH:
+            if (SFR(ALRMCFG) & ALRMCFG_PTR)
+            {
+                SFR(ALRMCFG)--;
+            }
+        break;
+
+        case SIM_ADCON0:
+            if ((uvalue & ADCON0_GODONE) && (!(s_ucLastValue & ADCON0_GODONE)))
+            {
+                if (uvalue & ADCON0_ADON)
+                {
+                    g_sim.adc_done = g_sim.now + ADC_NS;
+                }
+                else
+                {
+                    SFR(ADCON0) &= ~ADCON0_GODONE;
+                }
+            }
+        break;
+
+        case SIM_PORTA:
+        case SIM_PORTB:
+        case SIM_PORTC:
+            if (uvalue != s_ucLastValue)
+            {
+                g_sim.lat[ureg - SIM_PORTA] = uvalue;
+            }
+        break;
+
+        case SIM_LATA:
+        case SIM_LATB:
+        case SIM_LATC:
+            g_sim.lat[ureg - SIM_LATA] = uvalue;
+        break;
+
+        default:
+        break;
+    }
+}
+
+/**
+ * Load the value read from a register. */
+
+static void Sim_Prepare(SimRegType ureg)
+{
+    const unsigned char urtc = (SFR(RTCCFG) & RTCCFG_PTR) << 1;
+    const unsigned char ualarm = (SFR(ALRMCFG) & ALRMCFG_PTR) << 1;
+    const int ird16 = SFR(T1CON) & T1CON_RD16;
+
+    switch (ureg)
+    {
+        case SIM_RTCCFG:
+        {
+            unsigned char ucfg = SFR(RTCCFG) & ~(RTCCFG_RTCSYNC | RTCCFG_HALFSEC);
+
+            if ((ucfg & RTCCFG_RTCEN) &&
+                (g_sim.prescaler >= RTC_TICKS - RTC_SYNC_TICKS))
+            {
+                ucfg |= RTCCFG_RTCSYNC;
+            }
+
+            if (g_sim.prescaler >= RTC_TICKS / 2)
+            {
+                ucfg |= RTCCFG_HALFSEC;
+            }
+
+            SFR(RTCCFG) = ucfg;
+        }
+        break;
+
+        case SIM_RTCVALL:
+            SFR(RTCVALL) = g_sim.rtc[urtc];
+        break;
+
+        case SIM_RTCVALH:
+            SFR(RTCVALH) = (urtc == 6) ? 0 : g_sim.rtc[urtc + 1];
+        break;
+
+        case SIM_ALRMVALL:
+            SFR(ALRMVALL) = g_sim.alarm[ualarm];
+        break;
+
+        case SIM_ALRMVALH:
+            SFR(ALRMVALH) = g_sim.alarm[ualarm + 1];
+        break;
+
+        case SIM_TMR0L:
+            SFR(TMR0L) = (unsigned char)g_sim.tmr0;
+            g_sim.tmr0h = (unsigned char)(g_sim.tmr0 >> 8);
+        break;
+
+        case SIM_TMR0H:
+            SFR(TMR0H) = g_sim.tmr0h;
+        break;
+
+        case SIM_TMR1L:
+            SFR(TMR1L) = (unsigned char)g_sim.tmr1;
+
+            if (ird16)
+            {
+                g_sim.tmr1h = (unsigned char)(g_sim.tmr1 >> 8);
+            }
+        break;
+
+        case SIM_TMR1H:
+            SFR(TMR1H) = ird16 ? g_sim.tmr1h : (unsigned char)(g_sim.tmr1 >> 8);
+        break;
+
+        case SIM_TMR2:
+            SFR(TMR2) = g_sim.tmr2;
+        break;
+
+        case SIM_TMR3L:
+            SFR(TMR3L) = (unsigned char)g_sim.tmr3;
+
+            if (SFR(T3CON) & T1CON_RD16)
+            {
+                g_sim.tmr3h = (unsigned char)(g_sim.tmr3 >> 8);
+            }
+        break;
+
+        case SIM_TMR3H:
+            SFR(TMR3H) = (SFR(T3CON) & T1CON_RD16) ?
+                         g_sim.tmr3h : (unsigned char)(g_sim.tmr3 >> 8);
+        break;
+
+        case SIM_TMR4:
+            SFR(TMR4) = g_sim.tmr4;
+        break;
+
+        case SIM_PORTA:
+        case SIM_PORTB:
+        case SIM_PORTC:
+        {
+            const unsigned uport = ureg - SIM_PORTA;
+            const unsigned char utris = g_simSfr[SIM_TRISA + uport];
+
+            g_simSfr[ureg] = (g_sim.lat[uport] & ~utris) |
+                             (g_sim.pins[uport] & utris);
+        }
+        break;
+
+        default:
+        break;
+    }
+}
+
+volatile unsigned char *Sim_Reg(SimRegType ureg)
+{
+    Sim_Settle();
+    Sim_Step();
+    Sim_Prepare(ureg);
+
+    s_uLast = ureg;
+    s_ucLastValue = g_simSfr[ureg];
+
+    return &g_simSfr[ureg];
+}
+
+volatile unsigned short *Sim_Adres(void)
+{
+    Sim_Settle();
+    Sim_Step();
+
+    return &g_sim.adres;
+}
+
+void Sim_Write(SimRegType ureg, unsigned char uvalue)
+{
+    const unsigned char urtc = (SFR(RTCCFG) & RTCCFG_PTR) << 1;
+    const unsigned char ualarm = (SFR(ALRMCFG) & ALRMCFG_PTR) << 1;
+    const int ird16 = SFR(T1CON) & T1CON_RD16;
+    const int ird16t3 = SFR(T3CON) & T1CON_RD16;
+
+    Sim_Settle();
+    Sim_Step();
+
+    switch (ureg)
+    {
+        case SIM_RTCVALL:
+        case SIM_RTCVALH:
+        {
+            const unsigned char urtcptr = (SFR(RTCCFG) & RTCCFG_PTR) << 1;
+            const unsigned char uindex = urtcptr + (ureg == SIM_RTCVALH);
+
+            if (!(SFR(RTCCFG) & RTCCFG_RTCWREN))
+            {
+                Sim_Violation("RTCVAL[%u] written while locked", uindex);
+            }
+            else if ((SFR(RTCCFG) & RTCCFG_RTCEN) &&
+                     (g_sim.prescaler >= RTC_TICKS - RTC_SYNC_TICKS))
+            {
+                Sim_Violation("RTCVAL[%u] written within RTCSYNC", uindex);
+            }
+            else if (uindex != 7)
+            {
+                g_sim.rtc[uindex] = uvalue;
+            }
+
+            if ((ureg == SIM_RTCVALH) && (urtcptr))
+            {
+                SFR(RTCCFG)--;
+            }
+
+            (void)urtc;
+        }
+        break;
+
+        case SIM_ALRMVALL:
+            g_sim.alarm[ualarm] = uvalue;
+        break;
+
+        case SIM_ALRMVALH:
+            g_sim.alarm[ualarm + 1] = uvalue;
+
+            if (ualarm)
+            {
+                SFR(ALRMCFG)--;
+            }
+        break;
+
+        case SIM_EECON2:
+            if (uvalue == 0x55)
+            {
+                g_sim.unlock = 1;
+            }
+            else if ((uvalue == 0xAA) && (g_sim.unlock == 1))
+            {
+                g_sim.unlock = 2;
+                g_sim.unlock_access = g_sim.accesses;
+            }
+            else
+            {
+                g_sim.unlock = 0;
+            }
+        break;
+
+        case SIM_RTCCAL:
+            if (!(SFR(RTCCFG) & RTCCFG_RTCWREN))
+            {
+                Sim_Violation("RTCCAL written while locked");
+            }
+            else
+            {
+                SFR(RTCCAL) = uvalue;
+            }
+        break;
+
+        case SIM_TMR0L:
+            g_sim.tmr0 = (unsigned short)((g_sim.tmr0h << 8) | uvalue);
+            g_sim.tmr0_pre = 0;
+        break;
+
+        case SIM_TMR0H:
+            g_sim.tmr0h = uvalue;
+        break;
+
+        case SIM_TMR1L:
+            g_sim.tmr1 = ird16 ? (unsigned short)((g_sim.tmr1h << 8) | uvalue) :
+                                 (unsigned short)((g_sim.tmr1 & 0xFF00) | uvalue);
+        break;
+
+        case SIM_TMR1H:
+            if (ird16)
+            {
+                g_sim.tmr1h = uvalue;
+            }
+            else
+            {
+                g_sim.tmr1 = (unsigned short)((uvalue << 8) | (g_sim.tmr1 & 0xFF));
+            }
+        break;
+
+        case SIM_TMR2:
+            g_sim.tmr2 = uvalue;
+            g_sim.tmr2_pre = 0;
+        break;
+
+        case SIM_TMR3L:
+            g_sim.tmr3 = ird16t3 ? (unsigned short)((g_sim.tmr3h << 8) | uvalue) :
+                                   (unsigned short)((g_sim.tmr3 & 0xFF00) | uvalue);
+            g_sim.tmr3_pre = 0;
+        break;
+
+        case SIM_TMR3H:
+            if (ird16t3)
+            {
+                g_sim.tmr3h = uvalue;
+            }
+            else
+            {
+                g_sim.tmr3 = (unsigned short)((uvalue << 8) | (g_sim.tmr3 & 0xFF));
+            }
+        break;
+
+        case SIM_TMR4:
+            g_sim.tmr4 = uvalue;
+            g_sim.tmr4_pre = 0;
+        break;
+
+        default:
+            g_simSfr[ureg] = uvalue;
+        break;
+    }
+}
+
+/**
+ * Any interrupt flag set with its enable bit wakes the controller up,
+ * regardless of GIE. */
+
+static int Sim_Wake_Pending(void)
+{
+    const unsigned char uintcon = SFR(INTCON);
+    const unsigned char uintcon3 = SFR(INTCON3);
+
+    return ((uintcon & INTCON_INT0IE) && (uintcon & INTCON_INT0IF)) ||
+           ((uintcon & INTCON_TMR0IE) && (uintcon & INTCON_TMR0IF)) ||
+           (uintcon3 & (uintcon3 >> 3) & 0x07) ||
+           (SFR(PIR1) & SFR(PIE1)) ||
+           (SFR(PIR2) & SFR(PIE2)) ||
+           (SFR(PIR3) & SFR(PIE3));
+}
+
+void Sim_Sleep(void)
+{
+    Sim_Settle();
+
+    if (g_sim.hooks.sleep)
+    {
+        g_sim.hooks.sleep();
+    }
+
+    g_sim.awake = 0;
+    g_sim.awake_total += g_sim.now - s_uWoke;
+
+    Sim_Trace("sleep");
+
+    /* The instruction clock stops, the crystal keeps running. Go from
+     * event to event: an input, a second of the RTC, an overflow of
+     * timer 1, an update of the environment or the end of the run. */
+
+    while (!Sim_Wake_Pending())
+    {
+        uint64_t ustep = g_sim.env_next - g_sim.now;
+        double dticks = 1e18;
+
+        if (g_sim.events_next < g_sim.events_cnt)
+        {
+            const uint64_t t = g_sim.events[g_sim.events_next].t;
+
+            if (t - g_sim.now < ustep)
+            {
+                ustep = (t > g_sim.now) ? t - g_sim.now : 0;
+            }
+        }
+
+        if ((s_iRunning) && (g_sim.end - g_sim.now < ustep))
+        {
+            ustep = g_sim.end - g_sim.now;
+        }
+
+        if (SFR(RTCCFG) & RTCCFG_RTCEN)
+        {
+            dticks = (double)(RTC_TICKS - g_sim.prescaler);
+        }
+
+        if ((SFR(T1CON) & T1CON_TMR1ON) && (65536.0 - g_sim.tmr1 < dticks))
+        {
+            dticks = 65536.0 - g_sim.tmr1;
+        }
+
+        dticks -= g_sim.xtal_frac;
+
+        if (dticks < 1e17)
+        {
+            const uint64_t uxtal = (uint64_t)ceil(dticks * 1e9 / g_sim.xtal_hz);
+
+            if (uxtal < ustep)
+            {
+                ustep = uxtal ? uxtal : 1;
+            }
+        }
+
+        Sim_Pass(ustep, 0);
+    }
+
+    g_sim.awake = 1;
+    g_sim.wakes++;
+    g_sim.awake_since = g_sim.now;
+    s_uWoke = g_sim.now;
+
+    Sim_Trace("wake up");
+
+    if (g_sim.hooks.wake)
+    {
+        g_sim.hooks.wake();
+    }
+}
+
+int Sim_Run(uint64_t end)
+{
+    g_sim.end = end;
+    s_uWoke = g_sim.now;
+
+    if (!setjmp(s_jmpEnd))
+    {
+        s_iRunning = 1;
+
+        Firmware_Main();
+    }
+
+    s_iRunning = 0;
+
+    if (g_sim.awake)
+    {
+        g_sim.awake_total += g_sim.now - s_uWoke;
+    }
+
+    return g_sim.fail[0] ? 1 : 0;
+}
+
+int Sim_Fork(void (*prun)(void *, SimResultType *), void *parg,
+             SimResultType *presult, unsigned utimeout)
+{
+    SimResultType *pshared = mmap(NULL, sizeof(SimResultType),
+                                  PROT_READ | PROT_WRITE,
+                                  MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    int istatus;
+    pid_t pid;
+
+    if (pshared == MAP_FAILED)
+    {
+        perror("sim: mmap");
+        exit(2);
+    }
+
+    memset(pshared, 0, sizeof(*pshared));
+
+    fflush(stdout);
+    fflush(stderr);
+
+    pid = fork();
+
+    if (pid < 0)
+    {
+        perror("sim: fork");
+        exit(2);
+    }
+
+    if (!pid)
+    {
+        alarm(utimeout);
+
+        Sim_Reset();
+
+        prun(parg, pshared);
+
+        _exit(0);
+    }
+
+    waitpid(pid, &istatus, 0);
+
+    *presult = *pshared;
+
+    if (WIFSIGNALED(istatus))
+    {
+        presult->status = 2;
+        snprintf(presult->text, sizeof(presult->text), "%s",
+                 (WTERMSIG(istatus) == SIGALRM) ? "hung up" :
+                 strsignal(WTERMSIG(istatus)));
+    }
+    else if ((!WIFEXITED(istatus)) || (WEXITSTATUS(istatus)))
+    {
+        presult->status = 2;
+        snprintf(presult->text, sizeof(presult->text), "exit status %d",
+                 WEXITSTATUS(istatus));
+    }
+
+    munmap(pshared, sizeof(SimResultType));
+
+    return presult->status;
+}
@@ -0,0 +1,196 @@
+/**
+ * Host harness of the watch firmware.
+ *
+ * The firmware is compiled for the host with the stand-in device header
+ * xc.h, its main() renamed to Firmware_Main(). The harness models the
+ * peripherals the firmware uses: the RTCC with its calendar, pointers,
+ * write protection, calibration and alarm, the timers 0 to 4, the A/D
+ * converter, the wake-up inputs and the high priority interrupt. The time
+ * passes by a few instruction cycles on every register access while being
+ * awake, and from event to event while being asleep.
+ *
+ * A tool sets up the inputs and hooks, then runs the firmware in a forked
+ * process by Sim_Fork(), so each run starts from the power-on state.
+ */
+
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdint.h>
+
+#define SIM_NS_PER_SECOND       1000000000ULL
+#define SIM_NS_PER_MS           1000000ULL
+
+/**
+ * Ports of the input pins. */
+
+#define SIM_PORT_A              0
+#define SIM_PORT_B              1
+#define SIM_PORT_C              2
+
+/**
+ * Indices of the RTCC and alarm value bytes, the register pointer times
+ * two plus one for the high byte, like the snapshot of the firmware. */
+
+#define SIM_RTC_SECONDS         0
+#define SIM_RTC_MINUTES         1
+#define SIM_RTC_HOURS           2
+#define SIM_RTC_WEEKDAY         3
+#define SIM_RTC_DAY             4
+#define SIM_RTC_MONTH           5
+#define SIM_RTC_YEAR            6
+
+#define SIM_EVENTS_MAX          4096
+#define SIM_FAIL_TEXT           256
+
+/**
+ * Input pin change at a point in time. */
+
+typedef struct
+{
+    uint64_t t;
+    unsigned char port;
+    unsigned char bit;
+    unsigned char level;
+
+} SimEventType;
+
+/**
+ * Callbacks of a tool, all optional. */
+
+typedef struct
+{
+    /* Die temperature in degrees Celsius at a point in time. */
+    double (*temperature)(uint64_t t);
+
+    /* A/D conversion result of a channel. */
+    unsigned short (*adc)(unsigned char uchannel);
+
+    /* Called right before entering sleep and after waking up. */
+    void (*sleep)(void);
+    void (*wake)(void);
+
+    /* Called when the RTC has been enabled after being stopped. */
+    void (*rtc_start)(uint64_t stopped);
+
+} SimHooksType;
+
+/**
+ * State of the simulation. */
+
+typedef struct
+{
+    uint64_t now;                   // Simulated time in ns
+    uint64_t end;                   // End of the run
+    double   cycle_frac;            // Fraction of ns not passed yet
+    double   xtal_frac;             // Fraction of crystal ticks
+    uint64_t env_next;              // Next update of the environment
+
+    double   instr_hz;              // Instruction clock
+    double   xtal_hz;               // Crystal
+    double   instr_offset_ppm;      // Factory offset of the oscillator
+    double   instr_ppm_per_degree;  // Drift of the internal oscillator
+    double   xtal_offset_ppm;       // Offset of the crystal at turnover
+    double   xtal_ppb_parabola;     // Crystal parabola per degree^2
+    double   xtal_turnover;         // Turnover temperature
+    double   temperature;           // Current die temperature
+
+    unsigned cycles_per_access;
+
+    unsigned char awake;
+    uint64_t awake_since;           // Wake up or last input released
+    uint64_t awake_limit;           // Zero or limit of being awake idle
+    uint64_t awake_total;
+    unsigned long wakes;
+    unsigned long interrupts;       // Calls of the interrupt routine
+    unsigned long accesses;
+    unsigned long blocks;           // Basic blocks run by the firmware
+
+    /* Inputs. */
+    unsigned char pins[3];
+    unsigned char buttons[3];       // Pins counted as button inputs
+    unsigned char lat[3];
+    SimEventType events[SIM_EVENTS_MAX];
+    unsigned events_cnt;
+    unsigned events_next;
+
+    /* RTCC. */
+    unsigned char rtc[8];
+    unsigned char alarm[8];
+    long     prescaler;
+    unsigned long long rtc_seconds; // Rollovers of the prescaler
+    uint64_t rtc_stopped;           // Time the RTC got disabled
+    unsigned char unlock;           // State of the EECON2 sequence
+    unsigned long unlock_access;
+    unsigned long alarms;
+
+    /* Timers. */
+    unsigned short tmr0;
+    unsigned char  tmr0h;
+    unsigned long  tmr0_pre;
+    unsigned short tmr1;
+    unsigned char  tmr1h;
+    unsigned char  tmr2;
+    unsigned long  tmr2_pre;
+    unsigned short tmr3;
+    unsigned char  tmr3h;
+    unsigned long  tmr3_pre;
+    unsigned char  tmr4;
+    unsigned long  tmr4_pre;
+    unsigned long  tmr1_overflows;
+
+    /* A/D converter. */
+    unsigned short adres;
+    uint64_t adc_done;
+
+    /* Violations of the rules of the peripherals, the first is kept. */
+    unsigned long violations;
+    char violation[SIM_FAIL_TEXT];
+
+    /* Failure reported by a tool, ends the run. */
+    char fail[SIM_FAIL_TEXT];
+
+    SimHooksType hooks;
+
+} SimType;
+
+extern SimType g_sim;
+
+/**
+ * Result of a forked run, shared with the parent process. */
+
+typedef struct
+{
+    int  status;                    // 0 passed, 1 failed, 2 crashed
+    char text[SIM_FAIL_TEXT];
+    double values[16];              // Measurements of the tool
+
+} SimResultType;
+
+void Firmware_Main(void);
+
+void Sim_Reset(void);
+void Sim_Set_Rtc(unsigned uyear, unsigned umonth, unsigned uday,
+                 unsigned uweekday, unsigned uhours, unsigned uminutes,
+                 unsigned useconds);
+unsigned long long Sim_Rtc_Seconds(void);
+unsigned Sim_Bcd(unsigned char ubcd);
+unsigned char Sim_To_Bcd(unsigned uvalue);
+void Sim_Input(uint64_t t, unsigned char uport, unsigned char ubit,
+               unsigned char ulevel);
+void Sim_Pin_Of(const char *pname, unsigned char *pport, unsigned char *pbit);
+void Sim_Advance(uint64_t ns);
+void Sim_Settle(void);
+void Sim_Fail(const char *pformat, ...);
+int  Sim_Run(uint64_t end);
+int  Sim_Fork(void (*prun)(void *, SimResultType *), void *parg,
+              SimResultType *presult, unsigned utimeout);
+
+/**
+ * Pin of a button as named by main.h, e.g. SIM_PIN(PB0_PIN, &port, &bit). */
+
+#define SIM_STR(x)              #x
+#define SIM_XSTR(x)             SIM_STR(x)
+#define SIM_PIN(p, pport, pbit) Sim_Pin_Of(SIM_XSTR(p), pport, pbit)
+
+#endif // #ifndef SIM_H
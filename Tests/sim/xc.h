@@ -0,0 +1,675 @@
+/**
+ * Host stand-in for the XC8 device header of the PIC18F24J11.
+ *
+ * Every special function register used by the firmware is a byte of
+ * g_simSfr[], reached through Sim_Reg(). Each access lets the simulated
+ * time pass by a few instruction cycles, so busy loops polling a flag or
+ * a timer make progress. The bit structures overlay the bytes at the bit
+ * positions of the data sheet, as the firmware mixes byte and bit access.
+ *
+ * Writes, that have a side effect beyond storing the value, are turned
+ * into calls of Sim_Write() by prepare.sh, see there.
+ */
+
+#ifndef SIM_XC_H
+#define SIM_XC_H
+
+#include <stddef.h>
+
+typedef enum
+{
+    SIM_ADCON0, SIM_ADCON1, SIM_ALRMCFG, SIM_ALRMRPT, SIM_ALRMVALH,
+    SIM_ALRMVALL, SIM_ANCON0, SIM_ANCON1, SIM_CCP1CON, SIM_CCPR1L,
+    SIM_CTMUCONH, SIM_CTMUCONL, SIM_CTMUICON, SIM_DMACON1, SIM_DSCONH,
+    SIM_DSCONL, SIM_DSGPR0, SIM_DSGPR1, SIM_EECON2, SIM_HLVDCON,
+    SIM_INTCON, SIM_INTCON2, SIM_INTCON3, SIM_IOLOCK, SIM_IPR1, SIM_IPR2,
+    SIM_IPR3, SIM_LATA, SIM_LATB, SIM_LATC, SIM_OSCCON, SIM_PIE1,
+    SIM_PIE2, SIM_PIE3, SIM_PIR1, SIM_PIR2, SIM_PIR3, SIM_PORTA,
+    SIM_PORTB, SIM_PORTC, SIM_PR2, SIM_PR4, SIM_RCON, SIM_RPINR1,
+    SIM_RPINR2, SIM_RPINR3, SIM_RPOR13, SIM_RTCCAL, SIM_RTCCFG,
+    SIM_RTCVALH, SIM_RTCVALL, SIM_T0CON, SIM_T1CON, SIM_T1GCON, SIM_T2CON,
+    SIM_T3CON, SIM_T4CON, SIM_TCLKCON, SIM_TMR0H, SIM_TMR0L, SIM_TMR1H,
+    SIM_TMR1L, SIM_TMR2, SIM_TMR3H, SIM_TMR3L, SIM_TMR4, SIM_TRISA,
+    SIM_TRISB, SIM_TRISC, SIM_WDTCON,
+
+    SIM_SFR_COUNT
+
+} SimRegType;
+
+extern volatile unsigned char g_simSfr[SIM_SFR_COUNT];
+
+volatile unsigned char *Sim_Reg(SimRegType ureg);
+volatile unsigned short *Sim_Adres(void);
+void Sim_Write(SimRegType ureg, unsigned char uvalue);
+void Sim_Sleep(void);
+
+#define SIM_REG(r)      (*Sim_Reg(SIM_##r))
+#define SIM_BITS(r)     (*(volatile r##bits_t *)Sim_Reg(SIM_##r))
+
+/**
+ * Bit structures, LSB first. */
+
+typedef union
+{
+    unsigned char byte;
+    struct
+    {
+        unsigned char ADON : 1;
+        unsigned char GODONE : 1;
+        unsigned char CHS : 4;
+        unsigned char VCFG0 : 1;
+        unsigned char VCFG1 : 1;
+    };
+} ADCON0bits_t;
+
+typedef union
+{
+    unsigned char byte;
+    struct
+    {
+        unsigned char ADCS : 3;
+        unsigned char ACQT : 3;
+        unsigned char ADCAL : 1;
+        unsigned char ADFM : 1;
+    };
+} ADCON1bits_t;
+
+typedef union
+{
+    unsigned char byte;
+    struct
+    {
+        unsigned char ALRMPTR0 : 1;
+        unsigned char ALRMPTR1 : 1;
+        unsigned char AMASK : 4;
+        unsigned char CHIME : 1;
+        unsigned char ALRMEN : 1;
+    };
+} ALRMCFGbits_t;
+
+typedef union
+{
+    unsigned char byte;
+    struct
+    {
+        unsigned char PCFG8 : 1;
+        unsigned char PCFG9 : 1;
+        unsigned char PCFG10 : 1;
+        unsigned char PCFG11 : 1;
+        unsigned char PCFG12 : 1;
+        unsigned char : 2;
+        unsigned char VBGEN : 1;
+    };
+} ANCON1bits_t;
+
+typedef union
+{
+    unsigned char byte;
+    struct
+    {
+        unsigned char CCP1M : 4;
+        unsigned char DC1B : 2;
+        unsigned char P1M0 : 1;
+        unsigned char P1M1 : 1;
+    };
+} CCP1CONbits_t;
+
+typedef union
+{
+    unsigned char byte;
+    struct
+    {
+        unsigned char CCPR1L : 8;
+    };
+} CCPR1Lbits_t;
+
+typedef union
+{
+    unsigned char byte;
+    struct
+    {
+        unsigned char CTTRIG : 1;
+        unsigned char IDISSEN : 1;
+        unsigned char EDGSEQEN : 1;
+        unsigned char EDGEN : 1;
+        unsigned char TGEN : 1;
+        unsigned char CTMUSIDL : 1;
+        unsigned char : 1;
+        unsigned char CTMUEN : 1;
+    };
+} CTMUCONHbits_t;
+
+typedef union
+{
+    unsigned char byte;
+    struct
+    {
+        unsigned char EDG1STAT : 1;
+        unsigned char EDG2STAT : 1;
+        unsigned char EDG1SEL : 2;
+        unsigned char EDG1POL : 1;
+        unsigned char EDG2SEL : 2;
+        unsigned char EDG2POL : 1;
+    };
+} CTMUCONLbits_t;
+
+typedef union
+{
+    unsigned char byte;
+    struct
+    {
+        unsigned char RTCWDIS : 1;
+        unsigned char DSULPEN : 1;
+        unsigned char : 5;
+        unsigned char DSEN : 1;
+    };
+} DSCONHbits_t;
+
+typedef union
+{
+    unsigned char byte;
+    struct
+    {
+        unsigned char RELEASE : 1;
+        unsigned char DSBOR : 1;
+        unsigned char ULPWDIS : 1;
+        unsigned char : 5;
+    };
+} DSCONLbits_t;
+
+typedef union
+{
+    unsigned char byte;
+    struct
+    {
+        unsigned char RBIF : 1;
+        unsigned char INT0IF : 1;
+        unsigned char TMR0IF : 1;
+        unsigned char RBIE : 1;
+        unsigned char INT0IE : 1;
+        unsigned char TMR0IE : 1;
+        unsigned char PEIE : 1;
+        unsigned char GIE : 1;
+    };
+    struct
+    {
+        unsigned char : 6;
+        unsigned char GIEL : 1;
+        unsigned char GIEH : 1;
+    };
+} INTCONbits_t;
+
+typedef union
+{
+    unsigned char byte;
+    struct
+    {
+        unsigned char RBIP : 1;
+        unsigned char INT3IP : 1;
+        unsigned char TMR0IP : 1;
+        unsigned char INTEDG3 : 1;
+        unsigned char INTEDG2 : 1;
+        unsigned char INTEDG1 : 1;
+        unsigned char INTEDG0 : 1;
+        unsigned char RBPU : 1;
+    };
+} INTCON2bits_t;
+
+typedef union
+{
+    unsigned char byte;
+    struct
+    {
+        unsigned char INT1IF : 1;
+        unsigned char INT2IF : 1;
+        unsigned char INT3IF : 1;
+        unsigned char INT1IE : 1;
+        unsigned char INT2IE : 1;
+        unsigned char INT3IE : 1;
+        unsigned char INT1IP : 1;
+        unsigned char INT2IP : 1;
+    };
+} INTCON3bits_t;
+
+typedef union
+{
+    unsigned char byte;
+    struct
+    {
+        unsigned char CCP2IP : 1;
+        unsigned char TMR3IP : 1;
+        unsigned char LVDIP : 1;
+        unsigned char BCL1IP : 1;
+        unsigned char : 1;
+        unsigned char CM1IP : 1;
+        unsigned char CM2IP : 1;
+        unsigned char OSCFIP : 1;
+    };
+} IPR2bits_t;
+
+typedef union
+{
+    unsigned char byte;
+    struct
+    {
+        unsigned char SCS : 2;
+        unsigned char : 1;
+        unsigned char OSTS : 1;
+        unsigned char IRCF : 3;
+        unsigned char IDLEN : 1;
+    };
+} OSCCONbits_t;
+
+typedef union
+{
+    unsigned char byte;
+    struct
+    {
+        unsigned char TMR1IE : 1;
+        unsigned char TMR2IE : 1;
+        unsigned char CCP1IE : 1;
+        unsigned char SSP1IE : 1;
+        unsigned char TX1IE : 1;
+        unsigned char RC1IE : 1;
+        unsigned char ADIE : 1;
+        unsigned char PMPIE : 1;
+    };
+} PIE1bits_t;
+
+typedef union
+{
+    unsigned char byte;
+    struct
+    {
+        unsigned char CCP2IE : 1;
+        unsigned char TMR3IE : 1;
+        unsigned char LVDIE : 1;
+        unsigned char BCL1IE : 1;
+        unsigned char : 1;
+        unsigned char CM1IE : 1;
+        unsigned char CM2IE : 1;
+        unsigned char OSCFIE : 1;
+    };
+} PIE2bits_t;
+
+typedef union
+{
+    unsigned char byte;
+    struct
+    {
+        unsigned char RTCCIE : 1;
+        unsigned char TMR3GIE : 1;
+        unsigned char CTMUIE : 1;
+        unsigned char TMR4IE : 1;
+        unsigned char TX2IE : 1;
+        unsigned char RC2IE : 1;
+        unsigned char BCL2IE : 1;
+        unsigned char SSP2IE : 1;
+    };
+} PIE3bits_t;
+
+typedef union
+{
+    unsigned char byte;
+    struct
+    {
+        unsigned char TMR1IF : 1;
+        unsigned char TMR2IF : 1;
+        unsigned char CCP1IF : 1;
+        unsigned char SSP1IF : 1;
+        unsigned char TX1IF : 1;
+        unsigned char RC1IF : 1;
+        unsigned char ADIF : 1;
+        unsigned char PMPIF : 1;
+    };
+} PIR1bits_t;
+
+typedef union
+{
+    unsigned char byte;
+    struct
+    {
+        unsigned char CCP2IF : 1;
+        unsigned char TMR3IF : 1;
+        unsigned char LVDIF : 1;
+        unsigned char BCL1IF : 1;
+        unsigned char : 1;
+        unsigned char CM1IF : 1;
+        unsigned char CM2IF : 1;
+        unsigned char OSCFIF : 1;
+    };
+} PIR2bits_t;
+
+typedef union
+{
+    unsigned char byte;
+    struct
+    {
+        unsigned char RTCCIF : 1;
+        unsigned char TMR3GIF : 1;
+        unsigned char CTMUIF : 1;
+        unsigned char TMR4IF : 1;
+        unsigned char TX2IF : 1;
+        unsigned char RC2IF : 1;
+        unsigned char BCL2IF : 1;
+        unsigned char SSP2IF : 1;
+    };
+} PIR3bits_t;
+
+typedef union
+{
+    unsigned char byte;
+    struct
+    {
+        unsigned char RA0 : 1;
+        unsigned char RA1 : 1;
+        unsigned char RA2 : 1;
+        unsigned char RA3 : 1;
+        unsigned char RA4 : 1;
+        unsigned char RA5 : 1;
+        unsigned char RA6 : 1;
+        unsigned char RA7 : 1;
+    };
+} PORTAbits_t;
+
+typedef union
+{
+    unsigned char byte;
+    struct
+    {
+        unsigned char RB0 : 1;
+        unsigned char RB1 : 1;
+        unsigned char RB2 : 1;
+        unsigned char RB3 : 1;
+        unsigned char RB4 : 1;
+        unsigned char RB5 : 1;
+        unsigned char RB6 : 1;
+        unsigned char RB7 : 1;
+    };
+} PORTBbits_t;
+
+typedef union
+{
+    unsigned char byte;
+    struct
+    {
+        unsigned char RC0 : 1;
+        unsigned char RC1 : 1;
+        unsigned char RC2 : 1;
+        unsigned char RC3 : 1;
+        unsigned char RC4 : 1;
+        unsigned char RC5 : 1;
+        unsigned char RC6 : 1;
+        unsigned char RC7 : 1;
+    };
+} PORTCbits_t;
+
+typedef union
+{
+    unsigned char byte;
+    struct
+    {
+        unsigned char PR4 : 8;
+    };
+} PR4bits_t;
+
+typedef union
+{
+    unsigned char byte;
+    struct
+    {
+        unsigned char BOR : 1;
+        unsigned char POR : 1;
+        unsigned char PD : 1;
+        unsigned char TO : 1;
+        unsigned char RI : 1;
+        unsigned char CM : 1;
+        unsigned char : 1;
+        unsigned char IPEN : 1;
+    };
+} RCONbits_t;
+
+typedef union
+{
+    unsigned char byte;
+    struct
+    {
+        unsigned char RTCPTR0 : 1;
+        unsigned char RTCPTR1 : 1;
+        unsigned char RTCOE : 1;
+        unsigned char HALFSEC : 1;
+        unsigned char RTCSYNC : 1;
+        unsigned char RTCWREN : 1;
+        unsigned char : 1;
+        unsigned char RTCEN : 1;
+    };
+} RTCCFGbits_t;
+
+typedef union
+{
+    unsigned char byte;
+    struct
+    {
+        unsigned char T0PS : 3;
+        unsigned char PSA : 1;
+        unsigned char T0SE : 1;
+        unsigned char T0CS : 1;
+        unsigned char T08BIT : 1;
+        unsigned char TMR0ON : 1;
+    };
+} T0CONbits_t;
+
+typedef union
+{
+    unsigned char byte;
+    struct
+    {
+        unsigned char TMR1ON : 1;
+        unsigned char RD16 : 1;
+        unsigned char T1SYNC : 1;
+        unsigned char T1OSCEN : 1;
+        unsigned char T1CKPS : 2;
+        unsigned char TMR1CS : 2;
+    };
+} T1CONbits_t;
+
+typedef union
+{
+    unsigned char byte;
+    struct
+    {
+        unsigned char T1GSS : 2;
+        unsigned char T1GVAL : 1;
+        unsigned char T1GGO : 1;
+        unsigned char T1GSPM : 1;
+        unsigned char T1GTM : 1;
+        unsigned char T1GPOL : 1;
+        unsigned char TMR1GE : 1;
+    };
+} T1GCONbits_t;
+
+typedef union
+{
+    unsigned char byte;
+    struct
+    {
+        unsigned char T2CKPS : 2;
+        unsigned char TMR2ON : 1;
+        unsigned char T2OUTPS : 4;
+        unsigned char : 1;
+    };
+} T2CONbits_t;
+
+typedef union
+{
+    unsigned char byte;
+    struct
+    {
+        unsigned char TMR3ON : 1;
+        unsigned char RD16 : 1;
+        unsigned char T3SYNC : 1;
+        unsigned char T3OSCEN : 1;
+        unsigned char T3CKPS : 2;
+        unsigned char TMR3CS : 2;
+    };
+} T3CONbits_t;
+
+typedef union
+{
+    unsigned char byte;
+    struct
+    {
+        unsigned char T4CKPS : 2;
+        unsigned char TMR4ON : 1;
+        unsigned char T4OUTPS : 4;
+        unsigned char : 1;
+    };
+} T4CONbits_t;
+
+typedef union
+{
+    unsigned char byte;
+    struct
+    {
+        unsigned char T3CCP1 : 1;
+        unsigned char T3CCP2 : 1;
+        unsigned char : 2;
+        unsigned char T1RUN : 1;
+        unsigned char : 3;
+    };
+} TCLKCONbits_t;
+
+typedef union
+{
+    unsigned char byte;
+    struct
+    {
+        unsigned char SWDTEN : 1;
+        unsigned char ULPSINK : 1;
+        unsigned char ULPEN : 1;
+        unsigned char DS : 1;
+        unsigned char : 1;
+        unsigned char ULPLVL : 1;
+        unsigned char LVDSTAT : 1;
+        unsigned char REGSLP : 1;
+    };
+} WDTCONbits_t;
+
+/**
+ * Registers. */
+
+#define ADCON0          SIM_REG(ADCON0)
+#define ADCON1          SIM_REG(ADCON1)
+#define ADRES           (*Sim_Adres())
+#define ALRMCFG         SIM_REG(ALRMCFG)
+#define ALRMRPT         SIM_REG(ALRMRPT)
+#define ALRMVALH        SIM_REG(ALRMVALH)
+#define ALRMVALL        SIM_REG(ALRMVALL)
+#define ANCON0          SIM_REG(ANCON0)
+#define ANCON1          SIM_REG(ANCON1)
+#define CCP1CON         SIM_REG(CCP1CON)
+#define CCPR1L          SIM_REG(CCPR1L)
+#define CTMUCONH        SIM_REG(CTMUCONH)
+#define CTMUCONL        SIM_REG(CTMUCONL)
+#define CTMUICON        SIM_REG(CTMUICON)
+#define DMACON1         SIM_REG(DMACON1)
+#define DSCONH          SIM_REG(DSCONH)
+#define DSCONL          SIM_REG(DSCONL)
+#define DSGPR0          SIM_REG(DSGPR0)
+#define DSGPR1          SIM_REG(DSGPR1)
+#define EECON2          SIM_REG(EECON2)
+#define HLVDCON         SIM_REG(HLVDCON)
+#define INTCON          SIM_REG(INTCON)
+#define INTCON2         SIM_REG(INTCON2)
+#define INTCON3         SIM_REG(INTCON3)
+#define IOLOCK          SIM_REG(IOLOCK)
+#define IPR1            SIM_REG(IPR1)
+#define IPR2            SIM_REG(IPR2)
+#define IPR3            SIM_REG(IPR3)
+#define LATA            SIM_REG(LATA)
+#define LATB            SIM_REG(LATB)
+#define LATC            SIM_REG(LATC)
+#define OSCCON          SIM_REG(OSCCON)
+#define PIE1            SIM_REG(PIE1)
+#define PIE2            SIM_REG(PIE2)
+#define PIE3            SIM_REG(PIE3)
+#define PIR1            SIM_REG(PIR1)
+#define PIR2            SIM_REG(PIR2)
+#define PIR3            SIM_REG(PIR3)
+#define PORTA           SIM_REG(PORTA)
+#define PORTB           SIM_REG(PORTB)
+#define PORTC           SIM_REG(PORTC)
+#define PR2             SIM_REG(PR2)
+#define PR4             SIM_REG(PR4)
+#define RCON            SIM_REG(RCON)
+#define RPINR1          SIM_REG(RPINR1)
+#define RPINR2          SIM_REG(RPINR2)
+#define RPINR3          SIM_REG(RPINR3)
+#define RPOR13          SIM_REG(RPOR13)
+#define RTCCAL          SIM_REG(RTCCAL)
+#define RTCCFG          SIM_REG(RTCCFG)
+#define RTCVALH         SIM_REG(RTCVALH)
+#define RTCVALL         SIM_REG(RTCVALL)
+#define T0CON           SIM_REG(T0CON)
+#define T1CON           SIM_REG(T1CON)
+#define T1GCON          SIM_REG(T1GCON)
+#define T2CON           SIM_REG(T2CON)
+#define T3CON           SIM_REG(T3CON)
+#define T4CON           SIM_REG(T4CON)
+#define TCLKCON         SIM_REG(TCLKCON)
+#define TMR0H           SIM_REG(TMR0H)
+#define TMR0L           SIM_REG(TMR0L)
+#define TMR1H           SIM_REG(TMR1H)
+#define TMR1L           SIM_REG(TMR1L)
+#define TMR2            SIM_REG(TMR2)
+#define TMR3H           SIM_REG(TMR3H)
+#define TMR3L           SIM_REG(TMR3L)
+#define TMR4            SIM_REG(TMR4)
+#define TRISA           SIM_REG(TRISA)
+#define TRISB           SIM_REG(TRISB)
+#define TRISC           SIM_REG(TRISC)
+#define WDTCON          SIM_REG(WDTCON)
+
+#define ADCON0bits      SIM_BITS(ADCON0)
+#define ADCON1bits      SIM_BITS(ADCON1)
+#define ALRMCFGbits     SIM_BITS(ALRMCFG)
+#define ANCON1bits      SIM_BITS(ANCON1)
+#define CCP1CONbits     SIM_BITS(CCP1CON)
+#define CCPR1Lbits      SIM_BITS(CCPR1L)
+#define CTMUCONHbits    SIM_BITS(CTMUCONH)
+#define CTMUCONLbits    SIM_BITS(CTMUCONL)
+#define DSCONHbits      SIM_BITS(DSCONH)
+#define DSCONLbits      SIM_BITS(DSCONL)
+#define INTCONbits      SIM_BITS(INTCON)
+#define INTCON2bits     SIM_BITS(INTCON2)
+#define INTCON3bits     SIM_BITS(INTCON3)
+#define IPR2bits        SIM_BITS(IPR2)
+#define OSCCONbits      SIM_BITS(OSCCON)
+#define PIE1bits        SIM_BITS(PIE1)
+#define PIE2bits        SIM_BITS(PIE2)
+#define PIE3bits        SIM_BITS(PIE3)
+#define PIR1bits        SIM_BITS(PIR1)
+#define PIR2bits        SIM_BITS(PIR2)
+#define PIR3bits        SIM_BITS(PIR3)
+#define PORTAbits       SIM_BITS(PORTA)
+#define PORTBbits       SIM_BITS(PORTB)
+#define PORTCbits       SIM_BITS(PORTC)
+#define PR4bits         SIM_BITS(PR4)
+#define RCONbits        SIM_BITS(RCON)
+#define RTCCFGbits      SIM_BITS(RTCCFG)
+#define T0CONbits       SIM_BITS(T0CON)
+#define T1CONbits       SIM_BITS(T1CON)
+#define T1GCONbits      SIM_BITS(T1GCON)
+#define T2CONbits       SIM_BITS(T2CON)
+#define T3CONbits       SIM_BITS(T3CON)
+#define T4CONbits       SIM_BITS(T4CON)
+#define TCLKCONbits     SIM_BITS(TCLKCON)
+#define WDTCONbits      SIM_BITS(WDTCON)
+
+#define Sleep()         Sim_Sleep()
+
+/* The interrupt routine is a plain function, see Sim_Interrupt(). */
+
+#define __interrupt(p)
+
+#endif // #ifndef SIM_XC_H
@@ -0,0 +1,174 @@
+/**
+ * Stopwatch running through the sleep of a build having the stopwatch.
+ *
+ * The stopwatch is started on reset, the watch then sleeps with the
+ * display off for the time of a case and is woken up by DATE. The time of
+ * the stopwatch is compared with the ticks timer 1 counted since reset,
+ * also with the RTC calibrated, the crystal off and a sleep across the
+ * end of the week.
+ *
+ * The table lists the error in ticks of 1/32768 seconds and the wake ups
+ * and the time awake of the sleep, the wake up by DATE included. The test
+ * fails, if the stopwatch is off by more than a few ticks or the watch
+ * woke up more than hourly to count the overflows of timer 1.
+ *
+ *   stopwatch
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "main.h"
+#include "sim.h"
+
+#define RUN_TIMEOUT         300     // Seconds of real time
+#define ERROR_MAX           4       // Ticks read later by the firmware
+#define WAKES_PER_HOUR      1       // Wake ups allowed besides DATE
+#define ASLEEP_AT           (10 * SIM_NS_PER_SECOND)
+
+/* The long of XC8 is an int on the host, see sim/prepare.sh. */
+
+extern unsigned char g_ucStopwatchRunning;
+
+unsigned int Stopwatch_Shown(void);
+
+/**
+ * Sleep of a case. */
+
+typedef struct
+{
+    const char *name;
+    unsigned long seconds;
+    signed char calibration;
+    double ppm;
+    unsigned char weekday;
+
+} CaseType;
+
+static const CaseType s_cases[] =
+{
+    { "minute",     70,       0,    0.0, 1 },
+    { "hour",       3600,     0,    0.0, 1 },
+    { "fast",       3600,   100,    0.0, 1 },
+    { "slow",       3600,  -100,    0.0, 1 },
+    { "crystal",    43200,    0,   30.0, 1 },
+    { "weekend",    43200,   50,  -20.0, 6 },
+    { "day",        86400,  -30,    0.0, 1 },
+    { "36h",        129600, 127,   10.0, 3 },
+};
+
+#define CASES       (sizeof(s_cases) / sizeof(s_cases[0]))
+
+static uint64_t s_twake;
+static uint64_t s_awake[2];
+static unsigned long s_wakes[2];
+static unsigned char s_woken[2];
+
+/**
+ * Count the wake ups from the display shown on reset having timed out up
+ * to the wake up by DATE, which is included, and the time awake in
+ * between. */
+
+static void On_Wake(void)
+{
+    unsigned i;
+
+    if (g_sim.now < ASLEEP_AT)
+    {
+        return;
+    }
+
+    for (i = 0; i <= ((g_sim.now >= s_twake) ? 1u : 0u); i++)
+    {
+        if (!s_woken[i])
+        {
+            s_woken[i] = 1;
+            s_wakes[i] = g_sim.wakes;
+            s_awake[i] = g_sim.awake_total;
+        }
+    }
+}
+
+static void Run(void *parg, SimResultType *presult)
+{
+    const CaseType *pc = (const CaseType *)parg;
+    const uint64_t twake = ASLEEP_AT + pc->seconds * SIM_NS_PER_SECOND;
+    unsigned char uport;
+    unsigned char ubit;
+    unsigned int ushown;
+    unsigned int utruth;
+
+    Sim_Set_Rtc(25, 6, 1, pc->weekday, 23, 59, 30);
+    SIM_PIN(PB1_PIN, &uport, &ubit);
+
+    g_sim.xtal_offset_ppm = pc->ppm;
+    g_simSfr[SIM_RTCCAL] = (unsigned char)pc->calibration;
+    g_sim.hooks.wake = On_Wake;
+    g_ucStopwatchRunning = 1;
+    s_twake = twake;
+
+    Sim_Input(twake, uport, ubit, 1);
+    Sim_Input(twake + 100 * SIM_NS_PER_MS, uport, ubit, 0);
+    Sim_Run(twake + SIM_NS_PER_SECOND);
+
+    /* Timer 1 started counting from zero on reset. */
+
+    ushown = Stopwatch_Shown();
+    utruth = (unsigned int)(g_sim.tmr1_overflows << 16) + g_sim.tmr1;
+
+    presult->values[0] = (double)(int)(ushown - utruth);
+    presult->values[1] = (double)(s_wakes[1] - s_wakes[0] + 1);
+    presult->values[2] = (double)(s_awake[1] - s_awake[0]) / 1e6;
+    presult->status = ((s_woken[1]) && (!g_sim.violations)) ? 0 : 1;
+    snprintf(presult->text, sizeof(presult->text), "%s",
+             s_woken[1] ? g_sim.violation : "no wake up by DATE");
+}
+
+int main(int argc, char **argv)
+{
+    unsigned u;
+    int ifailed = 0;
+
+    if (argc > 1)
+    {
+        fprintf(stderr, "usage: stopwatch\n");
+        return 2;
+    }
+
+    (void)argv;
+
+    printf("%-8s %8s %4s %6s %7s %6s %9s\n", "case", "hours", "cal", "ppm",
+           "error", "wakes", "awake ms");
+
+    for (u = 0; u < CASES; u++)
+    {
+        const CaseType *pc = &s_cases[u];
+        SimResultType result;
+
+        if (Sim_Fork(Run, (void *)pc, &result, RUN_TIMEOUT) || result.status)
+        {
+            printf("%-8s failed: %s\n", pc->name, result.text);
+            ifailed = 1;
+            continue;
+        }
+
+        printf("%-8s %8.2f %4d %6.1f %7.0f %6.0f %9.1f\n", pc->name,
+               pc->seconds / 3600.0, pc->calibration, pc->ppm,
+               result.values[0], result.values[1], result.values[2]);
+
+        if ((result.values[0] > ERROR_MAX) || (result.values[0] < -ERROR_MAX))
+        {
+            printf("%-8s off by %.0f ticks\n", pc->name, result.values[0]);
+            ifailed = 1;
+        }
+
+        if (result.values[1] > 1 + WAKES_PER_HOUR * (pc->seconds / 3600))
+        {
+            printf("%-8s woken up to count timer 1\n", pc->name);
+            ifailed = 1;
+        }
+    }
+
+    return ifailed;
+}
@@ -0,0 +1,265 @@
+/**
+ * Year of temperature cycles of a build with the temperature compensation.
+ *
+ * The harness models the 32kHz crystal running slow along a parabola
+ * around its turnover temperature and the internal oscillator, from which
+ * the firmware estimates the die temperature, drifting with temperature.
+ * A run lets the firmware sleep through a year of one temperature profile,
+ * waking up by the hourly alarm to compensate. The error of the RTC is
+ * compared with the error of the crystal alone, integrated over the same
+ * temperatures, as it would be without the compensation:
+ *
+ *   wrist       worn from 7:00 to 23:00, on the nightstand at night
+ *   nightstand  room temperature with its daily and seasonal swing
+ *   outdoor     a cold garage, swinging around 12 degrees
+ *
+ * Each profile runs with the internal oscillator as characterized by the
+ * TEMP_xxx parameters of main.h and with a factory offset of 0.15%, as
+ * it would be on a board not characterized. Before the year, the watch is
+ * calibrated at room temperature, which references the internal
+ * oscillator of the board. The table lists the error in seconds after
+ * each quarter and after the year. The test fails, if the compensation
+ * ends up worse than the crystal, with or without the offset.
+ *
+ *   temperature [-d days]
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "main.h"
+#include "sim.h"
+
+#define RUN_TIMEOUT         600     // Seconds of real time
+#define OFFSET_PPM          1500.0  // Internal oscillator not characterized
+#define CALIBRATED_AT       21.0    // Room temperature, when calibrating
+#define QUARTERS            4
+
+#define RTCCFG_RTCEN        0x80
+
+extern unsigned short g_uRtccStaged;
+extern RtccSnapshotType g_rtcc;
+extern RtccSnapshotType g_rtccStage;
+
+void Configure_Timer_1(void);
+void Unlock_RTCC(void);
+void Lock_RTCC(void);
+void Commit_RTCC_Stage(void);
+
+/**
+ * Temperature profile in degrees Celsius over the day of the year and
+ * the hour of the day. */
+
+typedef struct
+{
+    const char *name;
+    double (*temperature)(double dday, double dhour);
+
+} ProfileType;
+
+static double Room(double dday, double dhour)
+{
+    return 21.0 + 3.0 * sin(2.0 * M_PI * (dday - 110.0) / 365.0) +
+           1.5 * sin(2.0 * M_PI * (dhour - 9.0) / 24.0);
+}
+
+static double Wrist(double dday, double dhour)
+{
+    return ((dhour >= 7.0) && (dhour < 23.0)) ? 31.0 : Room(dday, dhour);
+}
+
+static double Outdoor(double dday, double dhour)
+{
+    return 12.0 + 10.0 * sin(2.0 * M_PI * (dday - 110.0) / 365.0) +
+           4.0 * sin(2.0 * M_PI * (dhour - 9.0) / 24.0);
+}
+
+static const ProfileType s_profiles[] =
+{
+    { "wrist",      Wrist },
+    { "nightstand", Room },
+    { "outdoor",    Outdoor },
+};
+
+#define PROFILES    (sizeof(s_profiles) / sizeof(s_profiles[0]))
+
+/**
+ * State of a run, within the forked process. */
+
+static const ProfileType *s_pprofile;
+static uint64_t s_t0;
+static uint64_t s_tprev;
+static double s_drtc0;
+static double s_dcrystal;
+static unsigned s_quarter;
+static uint64_t s_days;
+static SimResultType *s_presult;
+
+static double Rtc_Error(void)
+{
+    const double drtc = (double)Sim_Rtc_Seconds() +
+                        (double)g_sim.prescaler / 32768.0;
+
+    return drtc - s_drtc0 - (double)(g_sim.now - s_t0) / 1e9;
+}
+
+/**
+ * Called every simulated second by the harness. Integrates the error of
+ * the crystal and takes the error of the RTC after each quarter. */
+
+static double On_Temperature(uint64_t t)
+{
+    const double dseconds = (double)t / 1e9;
+    const double dtemp = s_pprofile->temperature(dseconds / 86400.0,
+                                                 fmod(dseconds / 3600.0, 24.0));
+
+    if (!s_t0)
+    {
+        /* Start once the firmware has enabled the RTC, looking at the
+         * register without taking an access of the firmware. */
+
+        if ((!(g_simSfr[SIM_RTCCFG] & RTCCFG_RTCEN)) || (!t))
+        {
+            return dtemp;
+        }
+
+        s_t0 = g_sim.now;
+        s_tprev = t;
+        s_drtc0 = (double)Sim_Rtc_Seconds() + (double)g_sim.prescaler / 32768.0;
+    }
+    else
+    {
+        const double dt = g_sim.temperature - g_sim.xtal_turnover;
+        const double drel = 1e-6 * g_sim.xtal_offset_ppm -
+                            1e-9 * g_sim.xtal_ppb_parabola * dt * dt;
+
+        s_dcrystal += drel * (double)(t - s_tprev) / 1e9;
+        s_tprev = t;
+    }
+
+    while ((s_quarter < QUARTERS) &&
+           (t - s_t0 >= s_days * 86400 * SIM_NS_PER_SECOND * (s_quarter + 1) / QUARTERS))
+    {
+        s_presult->values[s_quarter * 2] = s_dcrystal;
+        s_presult->values[s_quarter * 2 + 1] = Rtc_Error();
+        s_quarter++;
+    }
+
+    return dtemp;
+}
+
+static void Run(void *parg, SimResultType *presult)
+{
+    const double *poffset = (const double *)parg;
+
+    s_presult = presult;
+
+    Sim_Reset();
+    Sim_Set_Rtc(24, 1, 1, 1, 0, 0, 0);
+
+    /* Set the calibration at room temperature, as the wearer does. */
+
+    g_sim.instr_offset_ppm = *poffset;
+    g_sim.temperature = CALIBRATED_AT;
+    g_sim.env_next = g_sim.now;
+
+    Configure_Timer_1();
+    Unlock_RTCC();
+    Lock_RTCC();
+    g_rtcc.calibration = 0;
+    g_rtccStage.calibration = 0;
+    g_uRtccStaged = RTCC_STAGED_CALIBRA;
+    Commit_RTCC_Stage();
+
+    g_sim.hooks.temperature = On_Temperature;
+
+    Sim_Run((s_days * 86400 + 60) * SIM_NS_PER_SECOND);
+
+    presult->values[QUARTERS * 2] = (double)g_sim.wakes;
+    presult->status = (s_quarter == QUARTERS) ? 0 : 1;
+    snprintf(presult->text, sizeof(presult->text), "%s",
+             g_sim.fail[0] ? g_sim.fail : g_sim.violation);
+}
+
+int main(int argc, char **argv)
+{
+    static const double s_offsets[] = { 0.0, OFFSET_PPM };
+
+    unsigned p;
+    unsigned o;
+    unsigned q;
+    int ifailed = 0;
+    int i;
+
+    s_days = 365;
+
+    for (i = 1; i < argc; i++)
+    {
+        if ((!strcmp(argv[i], "-d")) && (i + 1 < argc))
+        {
+            s_days = strtoul(argv[++i], NULL, 0);
+        }
+        else
+        {
+            fprintf(stderr, "usage: temperature [-d days]\n");
+            return 2;
+        }
+    }
+
+    printf("%-11s %-9s %-14s", "profile", "oscillator", "error in s");
+
+    for (q = 1; q <= QUARTERS; q++)
+    {
+        printf(" %7s%-2u", "Q", q);
+    }
+
+    printf("  wakes\n");
+
+    for (p = 0; p < PROFILES; p++)
+    {
+        for (o = 0; o < sizeof(s_offsets) / sizeof(s_offsets[0]); o++)
+        {
+            SimResultType result;
+
+            s_pprofile = &s_profiles[p];
+
+            if (Sim_Fork(Run, (void *)&s_offsets[o], &result, RUN_TIMEOUT) ||
+                (result.status))
+            {
+                printf("%-11s %-9s failed: %s\n", s_pprofile->name,
+                       o ? "offset" : "nominal", result.text);
+                ifailed = 1;
+                continue;
+            }
+
+            printf("%-11s %-9s %-14s", s_pprofile->name,
+                   o ? "offset" : "nominal", "crystal only");
+
+            for (q = 0; q < QUARTERS; q++)
+            {
+                printf(" %9.1f", result.values[q * 2]);
+            }
+
+            printf("\n%-11s %-9s %-14s", "", "", "compensated");
+
+            for (q = 0; q < QUARTERS; q++)
+            {
+                printf(" %9.1f", result.values[q * 2 + 1]);
+            }
+
+            printf("  %5.0f\n", result.values[QUARTERS * 2]);
+
+            if (fabs(result.values[QUARTERS * 2 - 1]) >
+                fabs(result.values[QUARTERS * 2 - 2]))
+            {
+                printf("%-11s %-9s worse than the crystal only\n",
+                       s_pprofile->name, o ? "offset" : "nominal");
+                ifailed = 1;
+            }
+        }
+    }
+
+    return ifailed;
+}